@@ -30,6 +30,12 @@
    /* time.                                                             */
 #define BTPS_TICK_COUNT_INTERVAL  (1)
 
+   /* The following constant represents the Heap ID of the default heap */
+   /* (the heap that is used by BTPS_AllocateMemory()).  This value can */
+   /* be used with the BTPS_AllocateMemoryFromHeap() and                */
+   /* BTPS_QueryHeapUsage() functions.                                  */
+#define BTPS_DEFAULT_HEAP_ID      (0)
+
    /* Miscellaneous Type definitions that should already be defined, but*/
    /* are necessary.                                                    */
 #ifndef NULL
@@ -57,6 +63,13 @@
    /*              - When defined (only when DEBUG_ENABLED is defined)  */
    /*                forces the value of this definition (unsigned long)*/
    /*                to be the Debug Zones that are enabled.            */
+   /*                                                                   */
+   /*          - DEFERRED_LOG_ENABLED                                   */
+   /*              - When defined (only when DEBUG_ENABLED is defined)  */
+   /*                DBG_MSG() records the message in the deferred log  */
+   /*                (see BTPS_LogMessage()) instead of formatting and  */
+   /*                writing it immediately.  The kernel must be built  */
+   /*                with the same definition.                          */
 #define DBG_ZONE_CRITICAL_ERROR           (1 << 0)
 #define DBG_ZONE_ENTER_EXIT               (1 << 1)
 #define DBG_ZONE_BTPSKRNL                 (1 << 2)
@@ -75,7 +88,11 @@
 #endif
 
 #ifdef DEBUG_ENABLED
-   #define DBG_MSG(_zone_, _x_)           do { if(BTPS_TestDebugZone(_zone_)) BTPS_OutputMessage _x_; } while(0)
+   #ifdef DEFERRED_LOG_ENABLED
+      #define DBG_MSG(_zone_, _x_)        do { if(BTPS_TestDebugZone(_zone_)) BTPS_LogMessage _x_; } while(0)
+   #else
+      #define DBG_MSG(_zone_, _x_)        do { if(BTPS_TestDebugZone(_zone_)) BTPS_OutputMessage _x_; } while(0)
+   #endif
    #define DBG_DUMP(_zone_, _x_)          do { if(BTPS_TestDebugZone(_zone_)) BTPS_DumpData _x_; } while(0)
 #else
    #define DBG_MSG(_zone_, _x_)
@@ -86,6 +103,18 @@
    /* Handle.                                                           */
 typedef void *Mailbox_t;
 
+   /* The following type definition defines a BTPS Kernel API Memory    */
+   /* Pool Handle.                                                      */
+typedef void *Pool_t;
+
+   /* The following type definition defines a BTPS Kernel API Single    */
+   /* Producer/Single Consumer Mailbox Handle.                          */
+typedef void *SPSCMailbox_t;
+
+   /* The following type definition defines a BTPS Kernel API Byte      */
+   /* (variable length message) Mailbox Handle.                         */
+typedef void *ByteMailbox_t;
+
    /* The following declared type represents the Prototype Function for */
    /* a function that should be registered with the BTPSKRNL module to  */
    /* retrieve the current Millisecond Tick Count.  This function will  */
@@ -145,6 +174,58 @@ typedef struct _tagBTPS_MemoryStatistics_t
    unsigned int LargestFreeFragment;
 } BTPS_MemoryStatistics_t;
 
+   /* The following constant represents the number of bins in the free  */
+   /* fragment size histogram of a heap.  Bin zero holds the number of  */
+   /* free fragments that are smaller than 32 bytes and each following  */
+   /* bin N holds the number of free fragments that are at least        */
+   /* 2^(N + 4) bytes and smaller than 2^(N + 5) bytes.                 */
+#define BTPS_FREE_SIZE_HISTOGRAM_BINS              (13)
+
+   /* The following structure represents the fragmentation statistics   */
+   /* for a heap for use with BTPS_QueryHeapFragmentation().  The       */
+   /* FragmentationIndex is the portion of the free memory (in tenths of*/
+   /* a percent) that is not part of the largest free fragment, i.e.    */
+   /* zero when all free memory is a single fragment and approaching    */
+   /* 1000 as the free memory becomes scattered.  All sizes are in bytes*/
+   /* and include the heap block overhead.                              */
+   /* * NOTE * The LargestFreeFragment is found in constant time and is */
+   /*          approximate, it may be smaller than the largest free     */
+   /*          fragment by up to one eighth of its size.                */
+typedef struct _tagBTPS_FragmentationStatistics_t
+{
+   unsigned int FreeBytes;
+   unsigned int FreeFragmentCount;
+   unsigned int LargestFreeFragment;
+   unsigned int FragmentationIndex;
+   unsigned int FreeSizeHistogram[BTPS_FREE_SIZE_HISTOGRAM_BINS];
+} BTPS_FragmentationStatistics_t;
+
+   /* The following constant represents the number of bins in the       */
+   /* allocation lifetime histogram of each allocation site.  The bins  */
+   /* hold the number of allocations that were freed within (in order)  */
+   /* 10ms, 100ms, 1s, 10s, 60s and 60s or longer of being allocated.   */
+#define BTPS_ALLOCATION_LIFETIME_BINS              (6)
+
+   /* The following structure represents the allocation profile of a    */
+   /* single allocation site for use with BTPS_QueryAllocationProfile().*/
+   /* The site is identified by either the Tag (if the allocation was   */
+   /* made with BTPS_AllocateMemoryWithTag()) or the address of the code*/
+   /* that called the allocation function.  A site with neither a Tag   */
+   /* or an address collects all allocations that could not be          */
+   /* attributed to a site.  The byte counts include the heap block     */
+   /* overhead.                                                         */
+typedef struct _tagBTPS_AllocationSiteStatistics_t
+{
+   BTPSCONST void *SiteAddress;
+   BTPSCONST char *Tag;
+   unsigned long   NumberAllocations;
+   unsigned long   NumberFrees;
+   unsigned long   NumberFailures;
+   unsigned long   CurrentBytes;
+   unsigned long   PeakBytes;
+   unsigned long   LifetimeHistogram[BTPS_ALLOCATION_LIFETIME_BINS];
+} BTPS_AllocationSiteStatistics_t;
+
    /* The following MACRO is a utility MACRO that exists to calculate   */
    /* the offset position of a particular structure member from the     */
    /* start of the structure.  This MACRO accepts as the first          */
@@ -155,6 +236,46 @@ typedef struct _tagBTPS_MemoryStatistics_t
    /* (in bytes) of the structure member.                               */
 #define BTPS_STRUCTURE_OFFSET(_x, _y)              ((unsigned int )&(((_x *)0)->_y))
 
+   /* The following structure represents the statistics for a fixed     */
+   /* size Memory Pool for use with BTPS_QueryPoolStatistics().         */
+   /* * NOTE * The BlockSize member is the actual size (in bytes) of    */
+   /*          each block in the pool (i.e. the requested size rounded  */
+   /*          up with BTPS_POOL_BLOCK_SIZE()).                         */
+typedef struct _tagBTPS_PoolStatistics_t
+{
+   unsigned int BlockSize;
+   unsigned int NumberBlocks;
+   unsigned int BlocksInUse;
+   unsigned int MaximumBlocksInUse;
+   unsigned int AllocationFailures;
+} BTPS_PoolStatistics_t;
+
+   /* The following MACRO is a utility MACRO that exists to determine   */
+   /* the actual size (in bytes) that a single block of a Memory Pool   */
+   /* occupies for a given requested block size.  Blocks are rounded up */
+   /* so that every block is able to hold (and is aligned for) a        */
+   /* pointer.                                                          */
+#define BTPS_POOL_BLOCK_SIZE(_x)                   ((((_x) + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *))
+
+   /* The following MACRO is a utility MACRO that exists to determine   */
+   /* the size (in bytes) of a caller supplied memory region that is    */
+   /* required to hold a Memory Pool of the specified number of blocks  */
+   /* (second parameter) of the specified size (first parameter).       */
+   /* * NOTE * The caller supplied region *MUST* be aligned on a pointer*/
+   /*          boundary.                                                */
+#define BTPS_POOL_MEMORY_SIZE(_x, _y)              (BTPS_POOL_BLOCK_SIZE(_x) * (_y))
+
+   /* The following constant represents the number of bytes that are    */
+   /* used (in addition to the message itself) to store each message in */
+   /* a Byte Mailbox.                                                   */
+#define BTPS_BYTE_MAILBOX_OVERHEAD                 (BTPS_POOL_BLOCK_SIZE(sizeof(unsigned int)))
+
+   /* The following MACRO is a utility MACRO that exists to determine   */
+   /* the number of bytes of a Byte Mailbox that are used to store a    */
+   /* message of the specified length.  This MACRO may be used to size  */
+   /* the buffer that is passed to BTPS_CreateByteMailbox().            */
+#define BTPS_BYTE_MAILBOX_MESSAGE_SIZE(_x)         (BTPS_BYTE_MAILBOX_OVERHEAD + BTPS_POOL_BLOCK_SIZE(_x))
+
    /* The following type declaration represents the Prototype for the   */
    /* function that is passed to the BTPS_DeleteMailbox() function to   */
    /* process all remaining Queued Mailbox Messages.  This allows a     */
@@ -162,6 +283,52 @@ typedef struct _tagBTPS_MemoryStatistics_t
    /* Mailbox message.                                                  */
 typedef void (BTPSAPI *BTPS_MailboxDeleteCallback_t)(void *MailboxData);
 
+   /* The following type declaration represents the Prototype for the   */
+   /* function that is passed to the BTPS_DrainMailbox() function to    */
+   /* process each queued Mailbox Message.  The MailboxData points to   */
+   /* the message in place (in the Mailbox Slot) and is only valid for  */
+   /* the duration of the callback.                                     */
+typedef void (BTPSAPI *BTPS_MailboxDrainCallback_t)(void *MailboxData, void *CallbackParameter);
+
+   /* The following type declaration represents the Prototype for the   */
+   /* function that is registered with the                              */
+   /* BTPS_RegisterMailboxWatermarkCallback() function.  The callback is*/
+   /* called with HighWatermark set to TRUE when the number of occupied */
+   /* slots of the Mailbox rises to the high watermark, and (only after */
+   /* that) with HighWatermark set to FALSE when the number of occupied */
+   /* slots falls to the low watermark.  This allows a producer to stop */
+   /* adding messages before the Mailbox is full.                       */
+   /* * NOTE * This function is called from within the Mailbox function */
+   /*          that changed the number of occupied slots and *MUST NOT* */
+   /*          delete the Mailbox.                                      */
+typedef void (BTPSAPI *BTPS_MailboxWatermarkCallback_t)(Mailbox_t Mailbox, Boolean_t HighWatermark, void *CallbackParameter);
+
+   /* The following structure represents the occupancy statistics of a  */
+   /* Mailbox for use with the BTPS_QueryMailboxStatistics() function.  */
+   /* The NumberRejected member is the number of messages that could not*/
+   /* be added because the Mailbox was full.  The AverageResidency is   */
+   /* the average time (in ticks) that a message spent in the Mailbox.  */
+   /* * NOTE * Messages are not time stamped, the AverageResidency is   */
+   /*          the total time that all messages have spent in the       */
+   /*          Mailbox divided by the number of messages removed.  This */
+   /*          is exact only when the Mailbox was empty when it was     */
+   /*          created (or the statistics were reset) and is empty when */
+   /*          the statistics are queried.  Otherwise it is an          */
+   /*          approximation that also includes the time spent by the   */
+   /*          messages that are still in the Mailbox (so it overstates */
+   /*          the residency, most noticeably while few messages have   */
+   /*          been removed).                                           */
+typedef struct _tagBTPS_MailboxStatistics_t
+{
+   unsigned int  NumberSlots;
+   unsigned int  OccupiedSlots;
+   unsigned int  MaximumOccupiedSlots;
+   unsigned long NumberAdded;
+   unsigned long NumberRejected;
+   unsigned long NumberRemoved;
+   unsigned long AverageResidency;
+} BTPS_MailboxStatistics_t;
+
    /* The following type declaration represents the Prototype for a     */
    /* Scheduler Function.  This function represents the Function that   */
    /* will be executed periodically when passed to the                  */
@@ -173,16 +340,359 @@ typedef void (BTPSAPI *BTPS_MailboxDeleteCallback_t)(void *MailboxData);
    /*          to remove it.                                            */
 typedef void (BTPSAPI *BTPS_SchedulerFunction_t)(void *ScheduleParameter);
 
+   /* The following type declaration represents the Prototype for the   */
+   /* Idle Callback that is registered with BTPS_RegisterIdleCallback().*/
+   /* This function is called by BTPS_ExecuteScheduler() whenever no    */
+   /* Scheduled Function is due and is passed the number of ticks until */
+   /* the next Scheduled Function is due (or                            */
+   /* BTPS_SCHEDULER_TIMEOUT_INFINITE if there are no Scheduled         */
+   /* Functions).  The platform may enter a low power mode for (at most)*/
+   /* this time, or until an interrupt occurs, and then return.         */
+   /* * NOTE * The platform *MUST* keep the Tick Count (see             */
+   /*          BTPS_GetTickCount()) correct across the low power period.*/
+typedef void (BTPSAPI *BTPS_IdleCallback_t)(unsigned long Timeout);
+
+   /* The following type declaration represents the Prototype for the   */
+   /* Sleep Callback that is registered with                            */
+   /* BTPS_RegisterSleepCallback().  This function is called by         */
+   /* BTPS_Delay() and is passed the number of ticks that remain in the */
+   /* delay.  The platform may enter a low power mode for (at most) this*/
+   /* time, or until an interrupt occurs, and then return.              */
+   /* * NOTE * Unlike the Idle Callback, the Scheduler is not running   */
+   /*          while the caller is delayed so the timeout *MUST NOT* be */
+   /*          limited by the Scheduler.                                */
+   /* * NOTE * The platform *MUST* keep the Tick Count (see             */
+   /*          BTPS_GetTickCount()) correct across the low power period.*/
+typedef void (BTPSAPI *BTPS_SleepCallback_t)(unsigned long Timeout);
+
+   /* The following type declaration represents the Prototype for an    */
+   /* Event Handler that is registered with BTPS_RegisterEventHandler().*/
+   /* This function is called by the Scheduler (i.e. not in interrupt   */
+   /* context) after the event has been posted with                     */
+   /* BTPS_PostEventFromISR().                                          */
+   /* * NOTE * The EventParameter is the same parameter value that was  */
+   /*          passed to BTPS_RegisterEventHandler().                   */
+   /* * NOTE * Multiple posts of the same event before the Scheduler    */
+   /*          runs result in a single call of the Event Handler, the   */
+   /*          handler must process all work that is ready.             */
+typedef void (BTPSAPI *BTPS_EventHandler_t)(void *EventParameter);
+
+   /* The following constant represents the value that is returned from */
+   /* BTPS_QuerySchedulerTimeout() (and passed to the Idle Callback)    */
+   /* when there are no Scheduled Functions.                            */
+#define BTPS_SCHEDULER_TIMEOUT_INFINITE            (0xFFFFFFFFUL)
+
+   /* The following constants represent the priority classes of         */
+   /* Scheduled Functions (and timers).  When more than one Scheduled   */
+   /* Function is due, every due function of a higher priority class is */
+   /* called before any function of a lower priority class.  Functions  */
+   /* of the same priority class are called in deadline order.          */
+   /* * NOTE * Functions that are added with                            */
+   /*          BTPS_AddFunctionToScheduler() (or timers started with    */
+   /*          BTPS_StartTimer()) use BTPS_SCHEDULER_PRIORITY_NORMAL.   */
+#define BTPS_SCHEDULER_PRIORITY_HIGH               (0)
+#define BTPS_SCHEDULER_PRIORITY_NORMAL             (1)
+#define BTPS_SCHEDULER_PRIORITY_LOW                (2)
+
+#define BTPS_SCHEDULER_NUMBER_PRIORITIES           (3)
+
+   /* The following structure represents the execution statistics of    */
+   /* a single Scheduled Function (or timer) for use with the           */
+   /* BTPS_QueryTimerStatistics() and                                   */
+   /* BTPS_QueryScheduledFunctionStatistics() functions.  All times are */
+   /* specified in ticks (Milliseconds).  The Lateness is the time from */
+   /* the deadline until the function was actually called and the Jitter*/
+   /* is the change in Lateness between two consecutive calls (i.e. the */
+   /* deviation of the interval between the calls from the Period).  The*/
+   /* NumberSkipped member is the number of periods of a periodic timer */
+   /* that were not executed because the Scheduler fell too far behind. */
+typedef struct _tagBTPS_TimerStatistics_t
+{
+   unsigned long NumberExecutions;
+   unsigned long NumberSkipped;
+   unsigned long LastLateness;
+   unsigned long MaximumLateness;
+   unsigned long TotalLateness;
+   unsigned long MaximumJitter;
+   unsigned long LastExecutionTime;
+   unsigned long MaximumExecutionTime;
+   unsigned long TotalExecutionTime;
+} BTPS_TimerStatistics_t;
+
+   /* The following declared type represents the Prototype Function for */
+   /* a function that can be registered with                            */
+   /* BTPS_RegisterCycleCounter() to retrieve the current value of a    */
+   /* free running, high resolution counter (e.g. the processor cycle   */
+   /* counter).  The counter is used to measure the time that is spent  */
+   /* in each Scheduled Function and Event Handler (see                 */
+   /* BTPS_QuerySchedulerStatistics()) and to time                      */
+   /* BTPS_DelayMicroseconds().                                         */
+   /* * NOTE * The counter *MUST* count up and wrap from the maximum    */
+   /*          unsigned long value to zero.                             */
+typedef unsigned long (BTPSAPI *BTPS_GetCycleCountCallback_t)(void);
+
+   /* The following declared type represents the Prototype Function for */
+   /* a function that can be registered with                            */
+   /* BTPS_RegisterTimestampCallback() to retrieve the current          */
+   /* Timestamp (see BTPS_GetTimestamp()).  The Timestamp is a 64 bit,  */
+   /* monotonic time in Microseconds.                                   */
+   /* * NOTE * This function may be called from an ISR.                 */
+typedef QWord_t (BTPSAPI *BTPS_GetTimestampCallback_t)(void);
+
+   /* The following constant represents the number of bins in the       */
+   /* execution time histogram of each task.  The bins hold the number  */
+   /* of calls that executed for (in order) less than 2^10, 2^13, 2^16, */
+   /* 2^19, 2^22 and 2^22 or more cycles (approximately 21us, 171us,    */
+   /* 1.4ms, 11ms, 87ms and longer at 48 MHz).                          */
+#define BTPS_TASK_CYCLE_HISTOGRAM_BINS             (6)
+
+   /* The following structure represents the execution profile of a     */
+   /* single task (a Scheduled Function, timer or Event Handler) for use*/
+   /* with BTPS_QuerySchedulerStatistics().  Tasks are identified by    */
+   /* their function (all timers that share a function are accounted    */
+   /* together).  A task with no function collects all calls that could */
+   /* not be attributed to a task.  All times are specified in cycles of*/
+   /* the registered cycle counter.  The WindowCycles member is the time*/
+   /* that the task executed during the last complete CPU load window.  */
+typedef struct _tagBTPS_TaskStatistics_t
+{
+   BTPS_SchedulerFunction_t TaskFunction;
+   Boolean_t                EventHandler;
+   unsigned long            NumberCalls;
+   QWord_t                  TotalCycles;
+   unsigned long            MaximumCycles;
+   unsigned long            WindowCycles;
+   unsigned long            CycleHistogram[BTPS_TASK_CYCLE_HISTOGRAM_BINS];
+} BTPS_TaskStatistics_t;
+
+   /* The following structure represents the overall execution profile  */
+   /* of the Scheduler for use with BTPS_QuerySchedulerStatistics().    */
+   /* The CPU load is measured over consecutive windows, the            */
+   /* WindowCycles member is the length of the last complete window and */
+   /* the BusyCycles member is the time (within this window) that was   */
+   /* spent in Scheduled Functions and Event Handlers.  The CPULoad     */
+   /* member is the ratio of the two (in percent).  The TotalBusyCycles */
+   /* member is the time spent in all tasks since the statistics were   */
+   /* reset.                                                            */
+typedef struct _tagBTPS_SchedulerStatistics_t
+{
+   unsigned long CyclesPerSecond;
+   unsigned long WindowCycles;
+   unsigned long BusyCycles;
+   unsigned int  CPULoad;
+   unsigned int  NumberTasks;
+   QWord_t       TotalBusyCycles;
+} BTPS_SchedulerStatistics_t;
+
+   /* The following declared type represents the Prototype Function for */
+   /* a function that can be registered with                            */
+   /* BTPS_RegisterInterruptCallbacks() to disable interrupts.  The     */
+   /* function returns the interrupt state before interrupts were       */
+   /* disabled (e.g. the PRIMASK register of a Cortex-M processor).     */
+   /* * NOTE * This function may be called from an ISR.                 */
+typedef unsigned long (BTPSAPI *BTPS_DisableInterruptsCallback_t)(void);
+
+   /* The following declared type represents the Prototype Function for */
+   /* a function that can be registered with                            */
+   /* BTPS_RegisterInterruptCallbacks() to restore the interrupt state  */
+   /* that was returned by the BTPS_DisableInterruptsCallback_t.        */
+   /* * NOTE * This function may be called from an ISR.                 */
+typedef void (BTPSAPI *BTPS_RestoreInterruptsCallback_t)(unsigned long InterruptState);
+
+   /* The following constant represents the number of bins in the       */
+   /* histogram of the time that interrupts were disabled by a critical */
+   /* section.  The bins hold the number of critical sections that      */
+   /* disabled interrupts for (in order) less than 1us, 5us, 10us, 20us,*/
+   /* 40us and 40us or longer.                                          */
+#define BTPS_CRITICAL_SECTION_HISTOGRAM_BINS       (6)
+
+   /* The following structure represents the profile of a single        */
+   /* critical section for use with BTPS_QueryCriticalSectionProfile(). */
+   /* The critical section is identified by the address of the code that*/
+   /* called BTPS_EnterCriticalSection().  A site with no address       */
+   /* collects all critical sections that could not be attributed to a  */
+   /* site.  Only the outermost critical section of a nested set is     */
+   /* measured.                                                         */
+typedef struct _tagBTPS_CriticalSectionStatistics_t
+{
+   BTPSCONST void *SiteAddress;
+   unsigned long   NumberCalls;
+   unsigned long   MaximumMicroseconds;
+   QWord_t         TotalMicroseconds;
+   unsigned long   Histogram[BTPS_CRITICAL_SECTION_HISTOGRAM_BINS];
+} BTPS_CriticalSectionStatistics_t;
+
+   /* The following structure represents the usage of the stack that was*/
+   /* registered with BTPS_RegisterStack() for use with                 */
+   /* BTPS_QueryStackUsage().  All sizes are specified in bytes.  The   */
+   /* MaximumUsage member is the deepest point of the stack that has    */
+   /* been used since the stack was registered (if this is the size of  */
+   /* the stack, the stack has overflowed).  The CurrentUsage member is */
+   /* the usage at the point of the query.                              */
+typedef struct _tagBTPS_StackStatistics_t
+{
+   unsigned long StackSize;
+   unsigned long MaximumUsage;
+   unsigned long CurrentUsage;
+} BTPS_StackStatistics_t;
+
+   /* The following structure represents the stack usage of a single    */
+   /* task (a Scheduled Function, timer, Event Handler or Coroutine     */
+   /* Function) for use with BTPS_QueryStackUsage().  Tasks are         */
+   /* identified by their function.  A task with no function collects   */
+   /* all calls that could not be attributed to a task.  The            */
+   /* MaximumUsage member is the deepest point of the stack (in bytes   */
+   /* from the top of the stack, so it includes the Scheduler and any   */
+   /* ISR that interrupted the task) that was reached by any call of the*/
+   /* task.                                                             */
+typedef struct _tagBTPS_TaskStackStatistics_t
+{
+   BTPS_SchedulerFunction_t TaskFunction;
+   unsigned long            NumberCalls;
+   unsigned long            MaximumUsage;
+} BTPS_TaskStackStatistics_t;
+
+   /* The following constants represent the values that are returned    */
+   /* from a Coroutine Function (see BTPS_CoroutineFunction_t).  These  */
+   /* values are returned by the BTPS_COROUTINE_XXX() MACROs and do not */
+   /* normally need to be used directly.                                */
+#define BTPS_COROUTINE_STATUS_WAITING              (0)
+#define BTPS_COROUTINE_STATUS_EXITED               (1)
+
+   /* The following constants represent the states of a Coroutine.      */
+#define BTPS_COROUTINE_STATE_IDLE                  (0)
+#define BTPS_COROUTINE_STATE_READY                 (1)
+#define BTPS_COROUTINE_STATE_RUNNING               (2)
+#define BTPS_COROUTINE_STATE_WAITING               (3)
+
+   /* The following type declaration represents the Prototype for a     */
+   /* Coroutine Function.  This function is called by the Scheduler each*/
+   /* time the Coroutine is resumed and continues from the point at     */
+   /* which it last waited.  The body of the function *MUST* be enclosed*/
+   /* by the BTPS_COROUTINE_BEGIN() and BTPS_COROUTINE_END() MACROs and */
+   /* the function waits (returning to the Scheduler) with the          */
+   /* BTPS_COROUTINE_YIELD(), BTPS_COROUTINE_WAIT_UNTIL(),              */
+   /* BTPS_COROUTINE_WAIT_TIMEOUT() and BTPS_COROUTINE_WAIT_EVENT()     */
+   /* MACROs.                                                           */
+   /* * NOTE * The CoroutineParameter is the same parameter value that  */
+   /*          was passed to BTPS_StartCoroutine().                     */
+   /* * NOTE * Coroutines are stackless, the values of local variables  */
+   /*          are *NOT* preserved while the Coroutine waits.  Any state*/
+   /*          that is needed after a wait must be kept in the          */
+   /*          CoroutineParameter.                                      */
+struct _tagBTPS_Coroutine_t;
+
+typedef int (BTPSAPI *BTPS_CoroutineFunction_t)(struct _tagBTPS_Coroutine_t *Coroutine, void *CoroutineParameter);
+
+   /* The following structure represents the state of a Coroutine.  The */
+   /* storage for a Coroutine is supplied by the caller of              */
+   /* BTPS_StartCoroutine() and *MUST* remain valid until the Coroutine */
+   /* exits (or is stopped with BTPS_StopCoroutine()).  The members of  */
+   /* this structure are maintained by the kernel and the               */
+   /* BTPS_COROUTINE_XXX() MACROs and should not be modified directly.  */
+   /* * NOTE * The storage *MUST* be zero initialized (idle) before the */
+   /*          Coroutine is first started.                              */
+typedef struct _tagBTPS_Coroutine_t
+{
+   BTPS_CoroutineFunction_t       CoroutineFunction;
+   void                          *CoroutineParameter;
+   unsigned int                   State;
+   unsigned int                   ResumePoint;
+   unsigned long                  Timeout;
+   unsigned int                   TimerID;
+   Boolean_t                      WaitingEvent;
+   Boolean_t                      Signalled;
+   Boolean_t                      TimedOut;
+   struct _tagBTPS_Coroutine_t   *NextReady;
+} BTPS_Coroutine_t;
+
+   /* The following MACROs are used to write the body of a Coroutine    */
+   /* Function.  The first parameter to each MACRO is the Coroutine that*/
+   /* was passed to the Coroutine Function.                             */
+   /*                                                                   */
+   /*    - BTPS_COROUTINE_BEGIN() / BTPS_COROUTINE_END()                */
+   /*         - Enclose the body of the Coroutine Function.  The        */
+   /*           Coroutine exits when the end of the body is reached.    */
+   /*                                                                   */
+   /*    - BTPS_COROUTINE_EXIT()                                        */
+   /*         - Exits the Coroutine immediately.                        */
+   /*                                                                   */
+   /*    - BTPS_COROUTINE_YIELD()                                       */
+   /*         - Returns to the Scheduler and resumes on the next pass   */
+   /*           through the Scheduler (after any work that is due).     */
+   /*                                                                   */
+   /*    - BTPS_COROUTINE_WAIT_UNTIL(Condition)                         */
+   /*         - Yields (as above) until the specified condition is true.*/
+   /*                                                                   */
+   /*    - BTPS_COROUTINE_WAIT_TIMEOUT(Timeout)                         */
+   /*         - Resumes once the specified time (in Milliseconds) has   */
+   /*           elapsed.                                                */
+   /*                                                                   */
+   /*    - BTPS_COROUTINE_WAIT_EVENT(Timeout)                           */
+   /*         - Resumes once the Coroutine has been signalled with      */
+   /*           BTPS_SignalCoroutine() or once the specified time (in   */
+   /*           Milliseconds, BTPS_SCHEDULER_TIMEOUT_INFINITE to wait   */
+   /*           forever) has elapsed, whichever is first.  A signal that*/
+   /*           is sent while the Coroutine is not waiting is remembered*/
+   /*           (so the next wait completes immediately).               */
+   /*           BTPS_COROUTINE_TIMED_OUT() is TRUE if the wait ended    */
+   /*           because the time elapsed.                               */
+   /*                                                                   */
+   /* * NOTE * The waits are implemented with a switch statement on the */
+   /*          line number, so only one wait may appear on a single line*/
+   /*          and a wait may not appear inside a switch statement of   */
+   /*          the Coroutine Function.                                  */
+#define BTPS_COROUTINE_BEGIN(_x)                   switch((_x)->ResumePoint) { case 0:
+
+#define BTPS_COROUTINE_END(_x)                     } (_x)->ResumePoint = 0; return(BTPS_COROUTINE_STATUS_EXITED)
+
+#define BTPS_COROUTINE_EXIT(_x)                    do { (_x)->ResumePoint = 0; return(BTPS_COROUTINE_STATUS_EXITED); } while(0)
+
+#define BTPS_COROUTINE_WAIT_TIMEOUT(_x, _y)        do { (_x)->Timeout = (_y); (_x)->WaitingEvent = FALSE; (_x)->ResumePoint = __LINE__; return(BTPS_COROUTINE_STATUS_WAITING); case __LINE__: ; } while(0)
+
+#define BTPS_COROUTINE_YIELD(_x)                   BTPS_COROUTINE_WAIT_TIMEOUT(_x, 0)
+
+#define BTPS_COROUTINE_WAIT_UNTIL(_x, _y)          do { (_x)->ResumePoint = __LINE__; case __LINE__: if(!(_y)) { (_x)->Timeout = 0; (_x)->WaitingEvent = FALSE; return(BTPS_COROUTINE_STATUS_WAITING); } } while(0)
+
+#define BTPS_COROUTINE_WAIT_EVENT(_x, _y)          do { (_x)->Timeout = (_y); (_x)->TimedOut = FALSE; (_x)->ResumePoint = __LINE__; case __LINE__: if((!(_x)->Signalled) && (!(_x)->TimedOut)) { (_x)->WaitingEvent = TRUE; return(BTPS_COROUTINE_STATUS_WAITING); } (_x)->WaitingEvent = FALSE; (_x)->Signalled = FALSE; } while(0)
+
+#define BTPS_COROUTINE_TIMED_OUT(_x)               ((_x)->TimedOut)
+
+   /* The following MACRO is a utility MACRO that exists to determine if*/
+   /* the specified Coroutine has been started and has not yet exited   */
+   /* (or been stopped).                                                */
+#define BTPS_COROUTINE_ACTIVE(_x)                  ((_x)->State != BTPS_COROUTINE_STATE_IDLE)
+
    /* The following function is responsible for delaying the current    */
    /* task for the specified duration (specified in Milliseconds).      */
    /* * NOTE * Very small timeouts might be smaller in granularity than */
    /*          the system can support !!!!                              */
+   /* * NOTE * If a Sleep Callback is registered (see                   */
+   /*          BTPS_RegisterSleepCallback()) the platform sleeps for the*/
+   /*          duration of the delay, otherwise the Tick Count is       */
+   /*          polled.                                                  */
 BTPSAPI_DECLARATION void BTPSAPI BTPS_Delay(unsigned long MilliSeconds);
 
 #ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
    typedef void (BTPSAPI *PFN_BTPS_Delay_t)(unsigned long MilliSeconds);
 #endif
 
+   /* The following function is responsible for delaying the current    */
+   /* task for the specified duration (specified in Microseconds).  The */
+   /* delay is timed with the counter that was registered with          */
+   /* BTPS_RegisterCycleCounter().                                      */
+   /* * NOTE * This function busy waits and is intended for short       */
+   /*          (sub-millisecond) delays, BTPS_Delay() should be used for*/
+   /*          longer delays.                                           */
+   /* * NOTE * The resolution of the delay is the resolution of the     */
+   /*          registered counter (if no counter is registered the Tick */
+   /*          Count is used).                                          */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DelayMicroseconds(unsigned long MicroSeconds);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DelayMicroseconds_t)(unsigned long MicroSeconds);
+#endif
+
    /* The following function is responsible for retrieving the current  */
    /* Tick Count of system.  This function returns the System Tick Count*/
    /* in Milliseconds resolution.                                       */
@@ -192,6 +702,23 @@ BTPSAPI_DECLARATION unsigned long BTPSAPI BTPS_GetTickCount(void);
    typedef unsigned long (BTPSAPI *PFN_BTPS_GetTickCount_t)(void);
 #endif
 
+   /* The following function is responsible for retrieving the current  */
+   /* Timestamp of the system.  This function returns a 64 bit,         */
+   /* monotonic time in Microseconds (which, unlike the Tick Count, does*/
+   /* not wrap in practice).  The Timestamp is intended to be used to   */
+   /* measure short intervals (for example, round trip or interrupt     */
+   /* latency times) by subtracting two Timestamps.                     */
+   /* * NOTE * The resolution of the Timestamp is determined by the     */
+   /*          function that was registered with                        */
+   /*          BTPS_RegisterTimestampCallback().  If no function is     */
+   /*          registered the Tick Count is used (on a Linux host a     */
+   /*          monotonic clock is used).                                */
+BTPSAPI_DECLARATION QWord_t BTPSAPI BTPS_GetTimestamp(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef QWord_t (BTPSAPI *PFN_BTPS_GetTimestamp_t)(void);
+#endif
+
    /* The following function is provided to allow a mechanism for adding*/
    /* Scheduler Functions to the Scheduler.  These functions are called */
    /* periodically by the Scheduler (based upon the requested Schedule  */
@@ -214,6 +741,19 @@ BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_AddFunctionToScheduler(BTPS_Scheduler
    typedef Boolean_t (BTPSAPI *PFN_BTPS_AddFunctionToScheduler_t)(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, unsigned int Period);
 #endif
 
+   /* The following function is provided to allow a mechanism for adding*/
+   /* Scheduler Functions of a specific priority class to the Scheduler.*/
+   /* This function is identical to BTPS_AddFunctionToScheduler() except*/
+   /* that the final parameter specifies the priority class of the      */
+   /* function (BTPS_SCHEDULER_PRIORITY_xxx).  This function returns    */
+   /* TRUE if the function was added successfully or FALSE if there was */
+   /* an error.                                                         */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_AddFunctionToSchedulerWithPriority(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, unsigned int Period, unsigned int Priority);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_AddFunctionToSchedulerWithPriority_t)(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, unsigned int Period, unsigned int Priority);
+#endif
+
    /* The following function is provided to allow a mechanism for       */
    /* deleting a Function that has previously been registered with the  */
    /* Scheduler via a successful call to the                            */
@@ -227,6 +767,53 @@ BTPSAPI_DECLARATION void BTPSAPI BTPS_DeleteFunctionFromScheduler(BTPS_Scheduler
    typedef void (BTPSAPI *PFN_BTPS_DeleteFunctionFromScheduler_t)(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter);
 #endif
 
+   /* The following function is provided to allow a mechanism to start a*/
+   /* timer.  When the timer expires the specified Timer Function is    */
+   /* called (from the Scheduler).  This function accepts as input the  */
+   /* Timeout (in Milliseconds) until the timer first expires, the      */
+   /* Period (in Milliseconds) of the timer (zero for a one-shot timer),*/
+   /* the Timer Function and the parameter that is passed to the Timer  */
+   /* Function.  This function returns a positive, non-zero, Timer ID if*/
+   /* successful or zero if there was an error.                         */
+   /* * NOTE * A one-shot timer is automatically stopped once it has    */
+   /*          expired (and the Timer ID is no longer valid).           */
+   /* * NOTE * There is no fixed limit on the number of timers (or      */
+   /*          Scheduled Functions), the Scheduler allocates its entries*/
+   /*          from the BTPS Kernel heap as needed.                     */
+   /* * NOTE * A periodic timer expires at whole multiples of the Period*/
+   /*          from the first expiration, late execution of one period  */
+   /*          does not delay the following periods.                    */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_StartTimer(unsigned long Timeout, unsigned long Period, BTPS_SchedulerFunction_t TimerFunction, void *TimerParameter);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_StartTimer_t)(unsigned long Timeout, unsigned long Period, BTPS_SchedulerFunction_t TimerFunction, void *TimerParameter);
+#endif
+
+   /* The following function is provided to allow a mechanism to start a*/
+   /* timer of a specific priority class.  This function is identical to*/
+   /* BTPS_StartTimer() except that the final parameter specifies the   */
+   /* priority class of the timer (BTPS_SCHEDULER_PRIORITY_xxx).  This  */
+   /* function returns a positive, non-zero, Timer ID if successful or  */
+   /* zero if there was an error.                                       */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_StartTimerWithPriority(unsigned long Timeout, unsigned long Period, BTPS_SchedulerFunction_t TimerFunction, void *TimerParameter, unsigned int Priority);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_StartTimerWithPriority_t)(unsigned long Timeout, unsigned long Period, BTPS_SchedulerFunction_t TimerFunction, void *TimerParameter, unsigned int Priority);
+#endif
+
+   /* The following function is provided to allow a mechanism to stop a */
+   /* timer that was started with BTPS_StartTimer().  This function     */
+   /* accepts as input the Timer ID that was returned from              */
+   /* BTPS_StartTimer().  This function returns TRUE if the timer was   */
+   /* stopped or FALSE if the Timer ID is not valid (for example, a     */
+   /* one-shot timer that has already expired).                         */
+   /* * NOTE * A timer may be stopped from its own Timer Function.      */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_StopTimer(unsigned int TimerID);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_StopTimer_t)(unsigned int TimerID);
+#endif
+
    /* The following function begins execution of the actual Scheduler.  */
    /* Once this function is called, it NEVER returns.  This function is */
    /* responsible for executing all functions that have been added to   */
@@ -252,6 +839,352 @@ BTPSAPI_DECLARATION void BTPSAPI BTPS_ProcessScheduler(void);
    typedef void (BTPSAPI *PFN_BTPS_ProcessScheduler_t)(void);
 #endif
 
+   /* The following function is provided to allow a mechanism to        */
+   /* determine how long the Scheduler may remain idle.  This function  */
+   /* returns the number of ticks until the next Scheduled Function (or */
+   /* timer) is due, zero if a Scheduled Function is already due, or    */
+   /* BTPS_SCHEDULER_TIMEOUT_INFINITE if there are no Scheduled         */
+   /* Functions.                                                        */
+   /* * NOTE * This function is intended for platforms that implement   */
+   /*          their own processing loop (see BTPS_ProcessScheduler())  */
+   /*          and would like to enter a low power mode until the next  */
+   /*          deadline (rather than waking on every tick).             */
+BTPSAPI_DECLARATION unsigned long BTPSAPI BTPS_QuerySchedulerTimeout(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned long (BTPSAPI *PFN_BTPS_QuerySchedulerTimeout_t)(void);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the function that BTPS_ExecuteScheduler() calls when no  */
+   /* Scheduled Function is due.  This function accepts as its parameter*/
+   /* the Idle Callback (or NULL to remove the current Idle Callback).  */
+   /* If no Idle Callback is registered BTPS_ExecuteScheduler()         */
+   /* continuously polls the Scheduler.                                 */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_RegisterIdleCallback(BTPS_IdleCallback_t IdleCallback);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_RegisterIdleCallback_t)(BTPS_IdleCallback_t IdleCallback);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the function that BTPS_Delay() calls to wait for the     */
+   /* delay to expire.  This function accepts as its parameter the Sleep*/
+   /* Callback (or NULL to remove the current Sleep Callback).  If no   */
+   /* Sleep Callback is registered BTPS_Delay() continuously polls the  */
+   /* Tick Count.                                                       */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_RegisterSleepCallback(BTPS_SleepCallback_t SleepCallback);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_RegisterSleepCallback_t)(BTPS_SleepCallback_t SleepCallback);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register a function that is called (from the Scheduler) each time */
+   /* an event is posted with BTPS_PostEventFromISR().  This function   */
+   /* accepts as input the Event Handler and the parameter that is      */
+   /* passed to the Event Handler.  This function returns a positive,   */
+   /* non-zero, Event ID if successful or zero if there was an error.   */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_RegisterEventHandler(BTPS_EventHandler_t EventHandler, void *EventParameter);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_RegisterEventHandler_t)(BTPS_EventHandler_t EventHandler, void *EventParameter);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* un-register an Event Handler that was registered with             */
+   /* BTPS_RegisterEventHandler().  This function accepts as its        */
+   /* parameter the Event ID that was returned from                     */
+   /* BTPS_RegisterEventHandler().                                      */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_UnRegisterEventHandler(unsigned int EventID);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_UnRegisterEventHandler_t)(unsigned int EventID);
+#endif
+
+   /* The following function is provided to allow a mechanism for an    */
+   /* Interrupt Service Routine to signal that work is ready for the    */
+   /* specified Event Handler.  This function accepts as its parameter  */
+   /* the Event ID that was returned from BTPS_RegisterEventHandler().  */
+   /* The Event Handler is called on the next pass through the Scheduler*/
+   /* (ahead of any Scheduled Function) and the Scheduler will not idle */
+   /* while an event is pending.                                        */
+   /* * NOTE * This function may be called from any ISR (as well as from*/
+   /*          the main loop).                                          */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_PostEventFromISR(unsigned int EventID);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_PostEventFromISR_t)(unsigned int EventID);
+#endif
+
+   /* The following function is provided to allow a mechanism to start  */
+   /* a Coroutine.  A Coroutine allows a long, multi-step operation to  */
+   /* be written as a single (linear) function that waits for time to   */
+   /* elapse or for an event without blocking the Scheduler.  This      */
+   /* function accepts as input the Coroutine (storage supplied by the  */
+   /* caller), the Coroutine Function and the parameter that is passed  */
+   /* to the Coroutine Function.  The Coroutine Function is first called*/
+   /* on the next pass through the Scheduler.  This function returns    */
+   /* TRUE if the Coroutine was started or FALSE if there was an error. */
+   /* * NOTE * Ready Coroutines are resumed once all Scheduled Functions*/
+   /*          and Event Handlers that are due have been called, and the*/
+   /*          Scheduler will not idle while a Coroutine is ready.      */
+   /* * NOTE * This function returns FALSE (and the Coroutine is left   */
+   /*          unchanged) if the Coroutine is active (see               */
+   /*          BTPS_COROUTINE_ACTIVE()), it must be stopped with        */
+   /*          BTPS_StopCoroutine() before it can be started again.  The*/
+   /*          only exception is that the Coroutine Function may restart*/
+   /*          its own Coroutine (it must then return with              */
+   /*          BTPS_COROUTINE_EXIT()).                                  */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_StartCoroutine(BTPS_Coroutine_t *Coroutine, BTPS_CoroutineFunction_t CoroutineFunction, void *CoroutineParameter);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_StartCoroutine_t)(BTPS_Coroutine_t *Coroutine, BTPS_CoroutineFunction_t CoroutineFunction, void *CoroutineParameter);
+#endif
+
+   /* The following function is provided to allow a mechanism to stop a */
+   /* Coroutine that was started with BTPS_StartCoroutine() before it   */
+   /* exits.  This function accepts as its parameter the Coroutine.  The*/
+   /* Coroutine Function is not called again.                           */
+   /* * NOTE * This function may be called from the Coroutine Function  */
+   /*          itself.                                                  */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_StopCoroutine(BTPS_Coroutine_t *Coroutine);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_StopCoroutine_t)(BTPS_Coroutine_t *Coroutine);
+#endif
+
+   /* The following function is provided to allow a mechanism to signal */
+   /* a Coroutine that is waiting (or will wait) in                     */
+   /* BTPS_COROUTINE_WAIT_EVENT().  This function accepts as its        */
+   /* parameter the Coroutine to signal.                                */
+   /* * NOTE * This function may *NOT* be called from an ISR.  An ISR   */
+   /*          should post an event (see BTPS_PostEventFromISR()) whose */
+   /*          Event Handler signals the Coroutine.                     */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_SignalCoroutine(BTPS_Coroutine_t *Coroutine);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_SignalCoroutine_t)(BTPS_Coroutine_t *Coroutine);
+#endif
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the execution statistics of a timer that was started with         */
+   /* BTPS_StartTimer().  This function accepts as input the Timer ID   */
+   /* that was returned from BTPS_StartTimer() and a pointer to a buffer*/
+   /* that will receive the statistics.  This function returns zero if  */
+   /* successful or a negative value if the Timer ID is not valid.      */
+   /* * NOTE * The statistics are reset when the timer is started.      */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryTimerStatistics(unsigned int TimerID, BTPS_TimerStatistics_t *TimerStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryTimerStatistics_t)(unsigned int TimerID, BTPS_TimerStatistics_t *TimerStatistics);
+#endif
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the execution statistics of a Function that was added to the      */
+   /* Scheduler with the BTPS_AddFunctionToScheduler() function.  This  */
+   /* function accepts as input the Scheduler Function and Scheduler    */
+   /* Parameter that were registered (both *must* match) and a pointer  */
+   /* to a buffer that will receive the statistics.  This function      */
+   /* returns zero if successful or a negative value if the Scheduled   */
+   /* Function was not found.                                           */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryScheduledFunctionStatistics(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, BTPS_TimerStatistics_t *TimerStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryScheduledFunctionStatistics_t)(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, BTPS_TimerStatistics_t *TimerStatistics);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the high resolution counter that is used to measure the  */
+   /* execution time of each task (when the kernel is built with        */
+   /* SCHEDULER_PROFILE_ENABLED defined) and to time                    */
+   /* BTPS_DelayMicroseconds().  This function accepts as input the     */
+   /* function that returns the current counter value and the frequency */
+   /* of the counter (in counts per second).  If no counter is          */
+   /* registered the Tick Count is used (on a Linux host a monotonic    */
+   /* nanosecond clock is used).                                        */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_RegisterCycleCounter(BTPS_GetCycleCountCallback_t GetCycleCountCallback, unsigned long CyclesPerSecond);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_RegisterCycleCounter_t)(BTPS_GetCycleCountCallback_t GetCycleCountCallback, unsigned long CyclesPerSecond);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the function that is used to retrieve the current        */
+   /* Timestamp (see BTPS_GetTimestamp()).  This function accepts as its*/
+   /* parameter the function that returns the current Timestamp (or NULL*/
+   /* to use the default Timestamp of the platform).                    */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_RegisterTimestampCallback(BTPS_GetTimestampCallback_t GetTimestampCallback);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_RegisterTimestampCallback_t)(BTPS_GetTimestampCallback_t GetTimestampCallback);
+#endif
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the CPU load and the execution profile of each task (when the     */
+   /* kernel is built with SCHEDULER_PROFILE_ENABLED defined).  This    */
+   /* function accepts as input a pointer to a buffer that will receive */
+   /* the overall statistics, the maximum number of tasks to return and */
+   /* an array (of at least this many entries) that is to receive the   */
+   /* task statistics.  The tasks are returned in order of decreasing   */
+   /* total execution time (i.e. the top N tasks).  This function       */
+   /* returns the number of tasks that were returned if successful or a */
+   /* negative value if there was an error (or profiling is not         */
+   /* enabled).                                                         */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QuerySchedulerStatistics(BTPS_SchedulerStatistics_t *SchedulerStatistics, unsigned int MaximumTasks, BTPS_TaskStatistics_t *TaskStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QuerySchedulerStatistics_t)(BTPS_SchedulerStatistics_t *SchedulerStatistics, unsigned int MaximumTasks, BTPS_TaskStatistics_t *TaskStatistics);
+#endif
+
+   /* The following function is responsible for displaying the CPU load */
+   /* and the top N tasks (when the kernel is built with                */
+   /* SCHEDULER_PROFILE_ENABLED defined) via BTPS_OutputMessage().  This*/
+   /* function accepts as its parameter the maximum number of tasks to  */
+   /* display.                                                          */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DumpSchedulerStatistics(unsigned int NumberTasks);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DumpSchedulerStatistics_t)(unsigned int NumberTasks);
+#endif
+
+   /* The following function is provided to allow a mechanism to clear  */
+   /* the execution profile of every task and start a new CPU load      */
+   /* window (so that a specific use case can be measured).             */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_ResetSchedulerStatistics(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_ResetSchedulerStatistics_t)(void);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the functions that are used to disable and restore       */
+   /* interrupts for BTPS_EnterCriticalSection() and                    */
+   /* BTPS_LeaveCriticalSection().  This function accepts as input the  */
+   /* function that disables interrupts (and returns the previous       */
+   /* interrupt state) and the function that restores a previously      */
+   /* returned interrupt state.  If either function is NULL, critical   */
+   /* sections do not disable interrupts (which is only suitable for a  */
+   /* host without interrupts).                                         */
+   /* * NOTE * The functions can not be changed while a critical section*/
+   /*          is active.                                               */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_RegisterInterruptCallbacks(BTPS_DisableInterruptsCallback_t DisableInterruptsCallback, BTPS_RestoreInterruptsCallback_t RestoreInterruptsCallback);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_RegisterInterruptCallbacks_t)(BTPS_DisableInterruptsCallback_t DisableInterruptsCallback, BTPS_RestoreInterruptsCallback_t RestoreInterruptsCallback);
+#endif
+
+   /* The following function is provided to allow a mechanism to enter  */
+   /* a critical section (i.e. disable interrupts).  Critical sections  */
+   /* may be nested (including from an ISR).  This function returns the */
+   /* previous interrupt state which *MUST* be passed to the matching   */
+   /* call of BTPS_LeaveCriticalSection().                              */
+   /* * NOTE * When the kernel is built with                            */
+   /*          CRITICAL_SECTION_PROFILE_ENABLED defined the time that   */
+   /*          interrupts are disabled by every critical section is     */
+   /*          measured (see BTPS_QueryCriticalSectionProfile()).       */
+BTPSAPI_DECLARATION unsigned long BTPSAPI BTPS_EnterCriticalSection(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned long (BTPSAPI *PFN_BTPS_EnterCriticalSection_t)(void);
+#endif
+
+   /* The following function is provided to allow a mechanism to leave a*/
+   /* critical section that was entered with                            */
+   /* BTPS_EnterCriticalSection().  This function accepts as its        */
+   /* parameter the interrupt state that was returned when the critical */
+   /* section was entered.                                              */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_LeaveCriticalSection(unsigned long InterruptState);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_LeaveCriticalSection_t)(unsigned long InterruptState);
+#endif
+
+   /* The following function is responsible for retrieving the critical */
+   /* section profile (when the kernel is built with                    */
+   /* CRITICAL_SECTION_PROFILE_ENABLED defined).  This function accepts */
+   /* as its parameters the maximum number of sites to return and a     */
+   /* pointer to an array (of at least this many entries) that is to    */
+   /* receive the site statistics.  The sites are returned in order of  */
+   /* decreasing maximum time that interrupts were disabled (i.e. the   */
+   /* top N sites).  This function returns the number of sites that were*/
+   /* returned if successful or a negative value if there was an error  */
+   /* (or profiling is not enabled).                                    */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryCriticalSectionProfile(unsigned int MaximumSites, BTPS_CriticalSectionStatistics_t *SiteStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryCriticalSectionProfile_t)(unsigned int MaximumSites, BTPS_CriticalSectionStatistics_t *SiteStatistics);
+#endif
+
+   /* The following function is responsible for displaying the top N    */
+   /* critical sections (when the kernel is built with                  */
+   /* CRITICAL_SECTION_PROFILE_ENABLED defined) via                     */
+   /* BTPS_OutputMessage().  This function accepts as its parameter the */
+   /* maximum number of sites to display.                               */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DumpCriticalSectionProfile(unsigned int NumberSites);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DumpCriticalSectionProfile_t)(unsigned int NumberSites);
+#endif
+
+   /* The following function is provided to allow a mechanism to clear  */
+   /* the critical section profile (so that a specific use case can be  */
+   /* measured).                                                        */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_ResetCriticalSectionProfile(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_ResetCriticalSectionProfile_t)(void);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the stack that the Scheduler runs on so that the stack   */
+   /* usage can be measured (see BTPS_QueryStackUsage()).  This function*/
+   /* accepts as input a pointer to the lowest address of the stack and */
+   /* the size (in bytes) of the stack.  Every free word of the stack   */
+   /* (below the caller) is painted with a fixed pattern.  This function*/
+   /* returns zero if successful or a negative value if there was an    */
+   /* error.                                                            */
+   /* * NOTE * This function *MUST* be called on the stack that is      */
+   /*          specified, as early as possible (i.e. from main()).      */
+   /* * NOTE * When the kernel is built with STACK_PROFILE_ENABLED      */
+   /*          defined the deepest point of the stack that is reached by*/
+   /*          every Scheduled Function, timer, Event Handler and       */
+   /*          Coroutine Function is also measured.                     */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_RegisterStack(void *StackRegion, unsigned long RegionSize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_RegisterStack_t)(void *StackRegion, unsigned long RegionSize);
+#endif
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the usage of the stack that was registered with                   */
+   /* BTPS_RegisterStack() and the stack usage of each task (when the   */
+   /* kernel is built with STACK_PROFILE_ENABLED defined).  This        */
+   /* function accepts as input a pointer to a buffer that will receive */
+   /* the overall statistics, the maximum number of tasks to return and */
+   /* an array (of at least this many entries) that is to receive the   */
+   /* task statistics.  The tasks are returned in order of decreasing   */
+   /* stack usage (i.e. the top N tasks).  This function returns the    */
+   /* number of tasks that were returned (zero if the stack profiler is */
+   /* not enabled) if successful or a negative value if there was an    */
+   /* error (or no stack has been registered).                          */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryStackUsage(BTPS_StackStatistics_t *StackStatistics, unsigned int MaximumTasks, BTPS_TaskStackStatistics_t *TaskStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryStackUsage_t)(BTPS_StackStatistics_t *StackStatistics, unsigned int MaximumTasks, BTPS_TaskStackStatistics_t *TaskStatistics);
+#endif
+
+   /* The following function is responsible for displaying the usage of */
+   /* the stack that was registered with BTPS_RegisterStack() and the   */
+   /* top N tasks (when the kernel is built with STACK_PROFILE_ENABLED  */
+   /* defined) via BTPS_OutputMessage().  This function accepts as its  */
+   /* parameter the maximum number of tasks to display.                 */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DumpStackUsage(unsigned int NumberTasks);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DumpStackUsage_t)(unsigned int NumberTasks);
+#endif
+
    /* The following function is provided to allow a mechanism to        */
    /* actually allocate a Block of Memory (of at least the specified    */
    /* size).  This function accepts as input the size (in Bytes) of the */
@@ -276,6 +1209,141 @@ BTPSAPI_DECLARATION void BTPSAPI BTPS_FreeMemory(void *MemoryPointer);
    typedef void (BTPSAPI *PFN_BTPS_FreeMemory_t)(void *MemoryPointer);
 #endif
 
+   /* The following function is responsible for changing the size of a  */
+   /* Block of Memory that was successfully allocated with the          */
+   /* BTPS_AllocateMemory() function (or any of the other heap          */
+   /* allocation functions).  This function accepts the Memory Pointer  */
+   /* to resize and the new size (in Bytes) of the Memory Block.  The   */
+   /* block is grown or shrunk in place whenever the adjacent memory    */
+   /* permits it, otherwise the contents are moved to a new block in the*/
+   /* same heap.  This function returns a NON-NULL pointer to the       */
+   /* resized Memory Block if successful, or a NULL value if there was  */
+   /* not enough memory (in which case the original Memory Pointer is   */
+   /* unchanged and is still valid).                                    */
+   /* * NOTE * The returned pointer can differ from the Memory Pointer  */
+   /*          that was passed in, in which case the caller CANNOT use  */
+   /*          ANY of the Memory pointed to by the original Memory      */
+   /*          Pointer.                                                 */
+   /* * NOTE * A NULL Memory Pointer causes this function to behave like*/
+   /*          BTPS_AllocateMemory().  A Memory Size of zero causes this*/
+   /*          function to behave like BTPS_FreeMemory() (and NULL is   */
+   /*          returned).                                               */
+   /* * NOTE * Memory allocated from a pool (BTPS_AllocateFromPool())   */
+   /*          CANNOT be resized with this function.                    */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_ReallocateMemory(void *MemoryPointer, unsigned long MemorySize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_ReallocateMemory_t)(void *MemoryPointer, unsigned long MemorySize);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* allocate a Block of Memory (of at least the specified size) from  */
+   /* a specific heap.  This function accepts as input the Heap ID of   */
+   /* the heap to allocate from (either BTPS_DEFAULT_HEAP_ID or a value */
+   /* returned from BTPS_RegisterHeap()) and the size (in Bytes) of the */
+   /* Block of Memory to be allocated.  This function returns a NON-NULL*/
+   /* pointer to this Memory Buffer if the Memory was successfully      */
+   /* allocated, or a NULL value if the memory could not be allocated.  */
+   /* * NOTE * The memory is NOT allocated from any other heap if the   */
+   /*          specified heap is unable to satisfy the request.         */
+   /* * NOTE * Memory allocated with this function is freed with the    */
+   /*          BTPS_FreeMemory() function.                              */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_AllocateMemoryFromHeap(unsigned int HeapID, unsigned long MemorySize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_AllocateMemoryFromHeap_t)(unsigned int HeapID, unsigned long MemorySize);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* allocate a Block of Memory (of at least the specified size) that  */
+   /* is attributed to the specified tag (rather than the address of the*/
+   /* caller) in the allocation profile.  This function accepts as input*/
+   /* the size (in Bytes) of the Block of Memory to be allocated and a  */
+   /* pointer to a constant, NULL terminated, tag string.  This function*/
+   /* returns a NON-NULL pointer to this Memory Buffer if the Memory was*/
+   /* successfully allocated, or a NULL value if the memory could not be*/
+   /* allocated.                                                        */
+   /* * NOTE * The tag is only used when the kernel is built with       */
+   /*          MEMORY_PROFILE_ENABLED defined, otherwise this function  */
+   /*          is identical to BTPS_AllocateMemory().                   */
+   /* * NOTE * The tag pointer is stored (not the string) so it *MUST*  */
+   /*          point to a string constant.                              */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_AllocateMemoryWithTag(unsigned long MemorySize, BTPSCONST char *Tag);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_AllocateMemoryWithTag_t)(unsigned long MemorySize, BTPSCONST char *Tag);
+#endif
+
+   /* The following function is provided to allow a mechanism to create */
+   /* a fixed size Memory Pool.  A Memory Pool is a set of equally sized*/
+   /* blocks that can be allocated and freed in constant time without   */
+   /* any per block header (and without fragmenting the general heap).  */
+   /* This function accepts as input the size (in bytes) of each block, */
+   /* the number of blocks in the pool, and an optional memory region   */
+   /* (and the size of the region in bytes) that is to hold the blocks. */
+   /* If the MemoryRegion parameter is NULL then the blocks are carved  */
+   /* from the BTPS Kernel heap.  This function returns a               */
+   /* NON-NULL Pool Handle if the Pool was successfully created, or a   */
+   /* NULL Pool Handle if the Pool was unable to be created.            */
+   /* * NOTE * A caller supplied MemoryRegion *MUST* be aligned on a    */
+   /*          pointer boundary and *MUST* be at least                  */
+   /*          BTPS_POOL_MEMORY_SIZE(BlockSize, NumberBlocks) bytes.    */
+   /*          The region must remain valid until the Pool is deleted.  */
+BTPSAPI_DECLARATION Pool_t BTPSAPI BTPS_CreatePool(unsigned int BlockSize, unsigned int NumberBlocks, void *MemoryRegion, unsigned long RegionSize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Pool_t (BTPSAPI *PFN_BTPS_CreatePool_t)(unsigned int BlockSize, unsigned int NumberBlocks, void *MemoryRegion, unsigned long RegionSize);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* allocate a single block from the specified Memory Pool.  This     */
+   /* function accepts as input the Pool Handle that was returned from  */
+   /* a successful call to BTPS_CreatePool().  This function returns a  */
+   /* NON-NULL pointer to the block if a block was available, or a NULL */
+   /* value if all blocks of the pool are currently in use.             */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_AllocateFromPool(Pool_t Pool);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_AllocateFromPool_t)(Pool_t Pool);
+#endif
+
+   /* The following function is responsible for returning a block that  */
+   /* was allocated with BTPS_AllocateFromPool() to the specified Memory*/
+   /* Pool.  This function accepts as input the Pool Handle and the     */
+   /* block to free.  This function returns TRUE if the block was       */
+   /* returned to the pool, or FALSE if the block does not belong to the*/
+   /* specified pool or is not allocated, i.e. has already been freed   */
+   /* (in which case nothing is done).                                  */
+   /* * NOTE * The return value allows callers that fall back to the    */
+   /*          heap (when the pool is exhausted) to simply call         */
+   /*          BTPS_FreeMemory() when this function returns FALSE.      */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_FreeToPool(Pool_t Pool, void *MemoryPointer);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_FreeToPool_t)(Pool_t Pool, void *MemoryPointer);
+#endif
+
+   /* The following function is responsible for querying the current    */
+   /* statistics of the specified Memory Pool.  This function accepts as*/
+   /* input the Pool Handle and a pointer to a structure that is to     */
+   /* receive the statistics.  This function returns zero if successful */
+   /* or a negative value if there is an error.                         */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryPoolStatistics(Pool_t Pool, BTPS_PoolStatistics_t *PoolStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryPoolStatistics_t)(Pool_t Pool, BTPS_PoolStatistics_t *PoolStatistics);
+#endif
+
+   /* The following function is responsible for destroying a Memory Pool*/
+   /* that was created with BTPS_CreatePool().  Once this function has  */
+   /* completed the Pool Handle (and ALL blocks that were allocated from*/
+   /* the pool) are NO longer valid.                                    */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DeletePool(Pool_t Pool);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DeletePool_t)(Pool_t Pool);
+#endif
+
    /* The following function is responsible for copying a block of      */
    /* memory of the specified size from the specified source pointer to */
    /* the specified destination memory pointer.  This function accepts  */
@@ -373,15 +1441,17 @@ BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_StringLength(BTPSCONST char *Sourc
    typedef unsigned int (BTPSAPI *PFN_BTPS_StringLength_t)(BTPSCONST char *Source);
 #endif
 
-   /* The following MACRO definition is provided to allow a mechanism   */
-   /* for a C Run-Time Library sprintf() function implementation.  This */
-   /* MACRO could be redefined as a function (like the rest of the      */
-   /* functions in this file), however more code would be required to   */
-   /* implement the variable number of arguments and formatting code    */
-   /* then it would be to simply call the C Run-Time Library sprintf()  */
-   /* function.  It is simply provided here as a MACRO mapping to allow */
-   /* an easy means for a starting place to port this file to other     */
-   /* operating systems/platforms.                                      */
+   /* The following function is provided to allow a mechanism for a C   */
+   /* Run-Time Library sprintf() function implementation.  This function*/
+   /* accepts as its input the output buffer, a format string and a     */
+   /* variable number of arguments determined by the format string.     */
+   /* The function returns the number of characters written to the      */
+   /* buffer (NOT including the terminating NULL character).            */
+   /* * NOTE * The string is formatted by the BTPS Kernel formatter     */
+   /*          (which is also used by BTPS_OutputMessage()).  The d, i, */
+   /*          u, o, x, X, c, s, p and % conversions are supported (with*/
+   /*          the standard flags, field width, precision and length    */
+   /*          modifiers), floating point conversions are NOT supported.*/
 BTPSAPI_DECLARATION int BTPSAPI BTPS_SprintF(char *Buffer, BTPSCONST char *Format, ...);
 
 #ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
@@ -450,6 +1520,57 @@ BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_WaitMailbox(Mailbox_t Mailbox, void *
    typedef Boolean_t (BTPSAPI *PFN_BTPS_WaitMailbox_t)(Mailbox_t Mailbox, void *MailboxData);
 #endif
 
+   /* The following function is provided to allow a means to Add several*/
+   /* messages to the Mailbox in a single call.  This function accepts  */
+   /* as input the Mailbox Handle of the Mailbox to place the data into,*/
+   /* the number of messages to add, and a pointer to a buffer that     */
+   /* contains the messages (stored back to back, each message is the   */
+   /* Size of the Slots in the Mailbox).  This function returns the     */
+   /* number of messages that were added to the Mailbox, which will be  */
+   /* less than the number requested if the Mailbox did not have enough */
+   /* free slots (zero if the Mailbox is full or there was an error).   */
+   /* * NOTE * The messages are copied with (at most) two copies        */
+   /*          regardless of the number of messages.                    */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_AddMailboxBatch(Mailbox_t Mailbox, unsigned int NumberMessages, void *MailboxData);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_AddMailboxBatch_t)(Mailbox_t Mailbox, unsigned int NumberMessages, void *MailboxData);
+#endif
+
+   /* The following function is provided to allow a means to retrieve   */
+   /* several messages from the specified Mailbox in a single call.     */
+   /* This function accepts as input the Mailbox Handle, the maximum    */
+   /* number of messages to retrieve and a pointer to a data buffer that*/
+   /* is AT LEAST the maximum number of messages multiplied by the Size */
+   /* of the Slots in the Mailbox.  This function returns the number of */
+   /* messages that were retrieved (stored back to back in the buffer in*/
+   /* FIFO order), zero if the Mailbox is empty or there was an error.  */
+   /* * NOTE * The messages are copied with (at most) two copies        */
+   /*          regardless of the number of messages.                    */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_WaitMailboxBatch(Mailbox_t Mailbox, unsigned int MaximumMessages, void *MailboxData);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_WaitMailboxBatch_t)(Mailbox_t Mailbox, unsigned int MaximumMessages, void *MailboxData);
+#endif
+
+   /* The following function is provided to allow a means to process the*/
+   /* messages that are queued in the specified Mailbox without copying */
+   /* them out of the Mailbox.  This function accepts as input the      */
+   /* Mailbox Handle, the maximum number of messages to process (zero to*/
+   /* process all of the messages that are currently queued), and the   */
+   /* callback function (and parameter) that is called (in FIFO order)  */
+   /* with each message.  Each message is removed from the Mailbox once */
+   /* the callback returns.  This function returns the number of        */
+   /* messages that were processed.                                     */
+   /* * NOTE * The callback is free to add messages to the Mailbox,     */
+   /*          however messages that are added during the drain are not */
+   /*          processed until the next call to this function.          */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_DrainMailbox(Mailbox_t Mailbox, unsigned int MaximumMessages, BTPS_MailboxDrainCallback_t MailboxDrainCallback, void *CallbackParameter);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_DrainMailbox_t)(Mailbox_t Mailbox, unsigned int MaximumMessages, BTPS_MailboxDrainCallback_t MailboxDrainCallback, void *CallbackParameter);
+#endif
+
    /* The following function is a utility function that exists to       */
    /* determine if there is anything queued in the specified Mailbox.   */
    /* This function returns TRUE if there is something queued in the    */
@@ -478,6 +1599,248 @@ BTPSAPI_DECLARATION void BTPSAPI BTPS_DeleteMailbox(Mailbox_t Mailbox, BTPS_Mail
    typedef void (BTPSAPI *PFN_BTPS_DeleteMailbox_t)(Mailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback);
 #endif
 
+   /* The following function is provided to allow a mechanism to query  */
+   /* the occupancy statistics of the specified Mailbox.  This function */
+   /* accepts as input the Mailbox Handle and a pointer to a buffer that*/
+   /* will receive the statistics.  This function returns zero if       */
+   /* successful or a negative value if there was an error.             */
+   /* * NOTE * The statistics are collected from the time the Mailbox   */
+   /*          was created (or the statistics were last reset with      */
+   /*          BTPS_ResetMailboxStatistics()).                          */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryMailboxStatistics(Mailbox_t Mailbox, BTPS_MailboxStatistics_t *MailboxStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryMailboxStatistics_t)(Mailbox_t Mailbox, BTPS_MailboxStatistics_t *MailboxStatistics);
+#endif
+
+   /* The following function is provided to allow a mechanism to reset  */
+   /* the occupancy statistics of the specified Mailbox.  This function */
+   /* accepts as input the Mailbox Handle.                              */
+   /* * NOTE * The maximum number of occupied slots is reset to the     */
+   /*          number of slots that are currently occupied.             */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_ResetMailboxStatistics(Mailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_ResetMailboxStatistics_t)(Mailbox_t Mailbox);
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register a callback that is notified when the number of occupied  */
+   /* slots of the specified Mailbox crosses the specified watermarks.  */
+   /* This function accepts as input the Mailbox Handle, the high       */
+   /* watermark (which must be greater than the low watermark and no    */
+   /* larger than the number of slots in the Mailbox), the low watermark*/
+   /* and the callback function (and parameter).  This function returns */
+   /* zero if successful or a negative value if there was an error.     */
+   /* * NOTE * Only a single callback may be registered for a Mailbox,  */
+   /*          passing a NULL callback removes the registered callback. */
+   /* * NOTE * If the Mailbox is already at (or above) the high         */
+   /*          watermark when the callback is registered the callback is*/
+   /*          NOT called until the Mailbox falls to the low watermark. */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_RegisterMailboxWatermarkCallback(Mailbox_t Mailbox, unsigned int HighWatermark, unsigned int LowWatermark, BTPS_MailboxWatermarkCallback_t MailboxWatermarkCallback, void *CallbackParameter);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_RegisterMailboxWatermarkCallback_t)(Mailbox_t Mailbox, unsigned int HighWatermark, unsigned int LowWatermark, BTPS_MailboxWatermarkCallback_t MailboxWatermarkCallback, void *CallbackParameter);
+#endif
+
+   /* The following function is provided to allow a mechanism to create */
+   /* a Single Producer/Single Consumer (SPSC) Mailbox.  An SPSC Mailbox*/
+   /* is a Mailbox (with slots of the same size) that may be written by */
+   /* exactly one producer and read by exactly one consumer without any */
+   /* locking, so the producer may be an ISR.  Messages are written and */
+   /* read in place: the producer reserves the next free slot with      */
+   /* BTPS_ReserveSPSCMailbox(), writes the message directly into the   */
+   /* slot and then publishes it with BTPS_CommitSPSCMailbox(), the     */
+   /* consumer accesses the oldest message with BTPS_PeekSPSCMailbox()  */
+   /* and frees the slot with BTPS_ReleaseSPSCMailbox().  This function */
+   /* accepts as input the Maximum Number of Slots that will be present */
+   /* in the Mailbox and the Size of each of the Slots.  This function  */
+   /* returns a NON-NULL SPSC Mailbox Handle if the Mailbox is          */
+   /* successfully created, or a NULL Mailbox Handle if the Mailbox was */
+   /* unable to be created.                                             */
+   /* * NOTE * Each slot is aligned so that it may hold a structure.    */
+BTPSAPI_DECLARATION SPSCMailbox_t BTPSAPI BTPS_CreateSPSCMailbox(unsigned int NumberSlots, unsigned int SlotSize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef SPSCMailbox_t (BTPSAPI *PFN_BTPS_CreateSPSCMailbox_t)(unsigned int NumberSlots, unsigned int SlotSize);
+#endif
+
+   /* The following function is provided to allow the producer of an    */
+   /* SPSC Mailbox to reserve the next free slot.  This function accepts*/
+   /* as input the SPSC Mailbox Handle.  This function returns a pointer*/
+   /* to the reserved slot (which the message is to be written into), or*/
+   /* NULL if the Mailbox is full.  The message is not visible to the   */
+   /* consumer until BTPS_CommitSPSCMailbox() is called.                */
+   /* * NOTE * Calling this function again before the slot is committed */
+   /*          returns the same slot.                                   */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_ReserveSPSCMailbox(SPSCMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_ReserveSPSCMailbox_t)(SPSCMailbox_t Mailbox);
+#endif
+
+   /* The following function is provided to allow the producer of an    */
+   /* SPSC Mailbox to publish the slot that was returned from           */
+   /* BTPS_ReserveSPSCMailbox() to the consumer.  This function accepts */
+   /* as input the SPSC Mailbox Handle.  This function returns TRUE if  */
+   /* the slot was committed or FALSE if there was an error (or the     */
+   /* Mailbox is full).                                                 */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_CommitSPSCMailbox(SPSCMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_CommitSPSCMailbox_t)(SPSCMailbox_t Mailbox);
+#endif
+
+   /* The following function is provided to allow the consumer of an    */
+   /* SPSC Mailbox to access the oldest message in the Mailbox (in      */
+   /* place).  This function accepts as input the SPSC Mailbox Handle.  */
+   /* This function returns a pointer to the slot that holds the oldest */
+   /* message, or NULL if the Mailbox is empty.  The slot remains valid */
+   /* (and the message remains in the Mailbox) until                    */
+   /* BTPS_ReleaseSPSCMailbox() is called.                              */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_PeekSPSCMailbox(SPSCMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_PeekSPSCMailbox_t)(SPSCMailbox_t Mailbox);
+#endif
+
+   /* The following function is provided to allow the consumer of an    */
+   /* SPSC Mailbox to remove the oldest message (the slot returned from */
+   /* BTPS_PeekSPSCMailbox()) from the Mailbox, which returns the slot  */
+   /* to the producer.  This function accepts as input the SPSC Mailbox */
+   /* Handle.  This function returns TRUE if a message was removed or   */
+   /* FALSE if there was an error (or the Mailbox is empty).            */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_ReleaseSPSCMailbox(SPSCMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_ReleaseSPSCMailbox_t)(SPSCMailbox_t Mailbox);
+#endif
+
+   /* The following function is a utility function that exists to       */
+   /* determine the number of messages that are queued in the specified */
+   /* SPSC Mailbox.  This function returns the number of queued messages*/
+   /* (zero if the Mailbox Handle is invalid).                          */
+   /* * NOTE * This function may be called by either the producer or the*/
+   /*          consumer, the value may be out of date by the time it is */
+   /*          returned if the other side is active.                    */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_QuerySPSCMailbox(SPSCMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_QuerySPSCMailbox_t)(SPSCMailbox_t Mailbox);
+#endif
+
+   /* The following function is responsible for destroying an SPSC      */
+   /* Mailbox that was created successfully via a successful call to the*/
+   /* BTPS_CreateSPSCMailbox() function.  This function accepts as input*/
+   /* the SPSC Mailbox Handle of the Mailbox to destroy and an          */
+   /* (optional) callback function that is called for each queued       */
+   /* message.  Once this function is completed the Mailbox Handle is NO*/
+   /* longer valid and CANNOT be used.                                  */
+   /* * NOTE * The producer *MUST* be stopped (for example, the         */
+   /*          interrupt disabled) before this function is called.      */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DeleteSPSCMailbox(SPSCMailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DeleteSPSCMailbox_t)(SPSCMailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback);
+#endif
+
+   /* The following function is provided to allow a mechanism to create */
+   /* a Byte Mailbox.  A Byte Mailbox stores variable length messages   */
+   /* (each prefixed with its length) back to back in a ring buffer so  */
+   /* that the Mailbox is sized by the total number of bytes that are   */
+   /* queued rather than by a worst case slot size.  Data placed into   */
+   /* the Mailbox (via the BTPS_AddByteMailbox() function) is retrieved */
+   /* in a FIFO method either by copying the message out (via the       */
+   /* BTPS_WaitByteMailbox() function) or in place (via the             */
+   /* BTPS_PeekByteMailbox() and BTPS_ReleaseByteMailbox() functions).  */
+   /* This function accepts as input the size (in bytes) of the ring    */
+   /* buffer.  This function returns a NON-NULL Byte Mailbox Handle if  */
+   /* the Mailbox is successfully created, or a NULL Mailbox Handle if  */
+   /* the Mailbox was unable to be created.                             */
+   /* * NOTE * Each queued message also uses BTPS_BYTE_MAILBOX_OVERHEAD */
+   /*          bytes and is padded to a multiple of the size of a       */
+   /*          pointer (see BTPS_BYTE_MAILBOX_MESSAGE_SIZE()) so that   */
+   /*          each message is aligned.                                 */
+BTPSAPI_DECLARATION ByteMailbox_t BTPSAPI BTPS_CreateByteMailbox(unsigned int BufferSize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef ByteMailbox_t (BTPSAPI *PFN_BTPS_CreateByteMailbox_t)(unsigned int BufferSize);
+#endif
+
+   /* The following function is provided to allow a means to Add a      */
+   /* message to a Byte Mailbox.  This function accepts as input the    */
+   /* Byte Mailbox Handle, the length of the message (which CANNOT be   */
+   /* zero) and a pointer to the message data.  This function returns   */
+   /* TRUE if the message was added to the Mailbox or FALSE if there is */
+   /* not enough (contiguous) room in the Mailbox or there was an error.*/
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_AddByteMailbox(ByteMailbox_t Mailbox, unsigned int DataLength, void *MailboxData);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_AddByteMailbox_t)(ByteMailbox_t Mailbox, unsigned int DataLength, void *MailboxData);
+#endif
+
+   /* The following function is provided to allow a means to retrieve   */
+   /* the oldest message from a Byte Mailbox.  This function accepts as */
+   /* input the Byte Mailbox Handle and the length and pointer of the   */
+   /* buffer to copy the message into.  This function returns the length*/
+   /* of the message that was copied into the buffer and removed from   */
+   /* the Mailbox, or zero if the Mailbox is empty, the buffer is too   */
+   /* small for the message (in which case the message is left in the   */
+   /* Mailbox) or there was an error.                                   */
+BTPSAPI_DECLARATION unsigned int BTPSAPI BTPS_WaitByteMailbox(ByteMailbox_t Mailbox, unsigned int BufferLength, void *MailboxData);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef unsigned int (BTPSAPI *PFN_BTPS_WaitByteMailbox_t)(ByteMailbox_t Mailbox, unsigned int BufferLength, void *MailboxData);
+#endif
+
+   /* The following function is provided to allow a means to access the */
+   /* oldest message in a Byte Mailbox in place.  This function accepts */
+   /* as input the Byte Mailbox Handle and an (optional) pointer to     */
+   /* return the length of the message.  This function returns a pointer*/
+   /* to the (contiguous) message, or NULL if the Mailbox is empty.  The*/
+   /* message remains valid (and in the Mailbox) until                  */
+   /* BTPS_ReleaseByteMailbox() is called.                              */
+BTPSAPI_DECLARATION void *BTPSAPI BTPS_PeekByteMailbox(ByteMailbox_t Mailbox, unsigned int *DataLength);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void *(BTPSAPI *PFN_BTPS_PeekByteMailbox_t)(ByteMailbox_t Mailbox, unsigned int *DataLength);
+#endif
+
+   /* The following function is provided to allow a means to remove the */
+   /* oldest message from a Byte Mailbox (without copying it).  This    */
+   /* function accepts as input the Byte Mailbox Handle.  This function */
+   /* returns TRUE if a message was removed or FALSE if the Mailbox is  */
+   /* empty or there was an error.                                      */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_ReleaseByteMailbox(ByteMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_ReleaseByteMailbox_t)(ByteMailbox_t Mailbox);
+#endif
+
+   /* The following function is a utility function that exists to       */
+   /* determine if there is anything queued in the specified Byte       */
+   /* Mailbox.  This function returns TRUE if there is something queued */
+   /* in the Mailbox, or FALSE if there is nothing queued in the        */
+   /* specified Mailbox.                                                */
+BTPSAPI_DECLARATION Boolean_t BTPSAPI BTPS_QueryByteMailbox(ByteMailbox_t Mailbox);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef Boolean_t (BTPSAPI *PFN_BTPS_QueryByteMailbox_t)(ByteMailbox_t Mailbox);
+#endif
+
+   /* The following function is responsible for destroying a Byte       */
+   /* Mailbox that was created successfully via a successful call to the*/
+   /* BTPS_CreateByteMailbox() function.  This function accepts as input*/
+   /* the Byte Mailbox Handle of the Mailbox to destroy and an          */
+   /* (optional) callback function that is called for each queued       */
+   /* message.  Once this function is completed the Mailbox Handle is NO*/
+   /* longer valid and CANNOT be used.                                  */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DeleteByteMailbox(ByteMailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DeleteByteMailbox_t)(ByteMailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback);
+#endif
+
    /* The following function is used to initialize the Platform module. */
    /* The Platform module relies on some static variables that are used */
    /* to coordinate the abstraction.  When the module is initially      */
@@ -508,6 +1871,48 @@ BTPSAPI_DECLARATION void BTPSAPI BTPS_OutputMessage(BTPSCONST char *DebugString,
    typedef void (BTPSAPI *PFN_BTPS_OutputMessage_t)(BTPSCONST char *DebugString, ...);
 #endif
 
+   /* The following function is responsible for logging the specified   */
+   /* NULL terminated Debugging String.  When the kernel is built with  */
+   /* DEFERRED_LOG_ENABLED defined the message is not formatted, instead*/
+   /* the address of the format string, a timestamp and the raw         */
+   /* arguments are recorded in a ring buffer (the deferred log) and the*/
+   /* message is written to the Debug output later when the scheduler   */
+   /* is idle (or when BTPS_FlushLog() is called).  Otherwise the       */
+   /* message is written immediately (exactly as BTPS_OutputMessage()   */
+   /* does).                                                            */
+   /* * NOTE * The deferred log records at most six arguments, each as  */
+   /*          an unsigned long (64 bit and floating point arguments are*/
+   /*          not supported).  As only the address is recorded the     */
+   /*          format string (and any string argument) must remain valid*/
+   /*          until the message is written (i.e. it should be a string */
+   /*          constant).                                               */
+   /* * NOTE * This function must not be called from an interrupt       */
+   /*          handler.                                                 */
+   /* * NOTE * When the kernel is also built with DEFERRED_LOG_EXPORT   */
+   /*          defined the messages are not formatted on the target,    */
+   /*          instead each record is written as a line of text that    */
+   /*          starts with "DL " and is decoded on the host with the    */
+   /*          LogDecode tool that is located in the logdecode          */
+   /*          directory.                                               */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_LogMessage(BTPSCONST char *DebugString, ...);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_LogMessage_t)(BTPSCONST char *DebugString, ...);
+#endif
+
+   /* The following function is responsible for writing all messages    */
+   /* that are currently held in the deferred log to the Debug output   */
+   /* (when the kernel is built with DEFERRED_LOG_ENABLED defined).     */
+   /* * NOTE * BTPS_ExecuteScheduler() writes a few messages each time  */
+   /*          nothing is due, this function is only required when the  */
+   /*          application uses BTPS_ProcessScheduler() or before the   */
+   /*          system is reset.                                         */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_FlushLog(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_FlushLog_t)(void);
+#endif
+
    /* The following function is used to set the Debug Mask that controls*/
    /* which debug zone messages get displayed.  The function takes as   */
    /* its only parameter the Debug Mask value that is to be used.  Each */
@@ -551,4 +1956,127 @@ int BTPSAPI BTPS_QueryMemoryUsage(BTPS_MemoryStatistics_t *MemoryStatistics, Boo
    typedef int (BTPSAPI *PFN_BTPS_QueryMemoryUsage_t)(BTPS_MemoryStatistics_t *MemoryStatistics, Boolean_t AdvancedStatitics);
 #endif
 
+   /* The following function is provided to allow a mechanism to        */
+   /* register an additional memory region as a heap (for example, a    */
+   /* second bank of RAM).  Memory may then be allocated from this heap */
+   /* with BTPS_AllocateMemoryFromHeap() which keeps these allocations  */
+   /* separate from the default heap.  This function accepts as input a */
+   /* pointer to the memory region and the size (in bytes) of the       */
+   /* region.  This function returns a positive, non-zero, Heap ID if   */
+   /* successful or a negative value if there was an error.             */
+   /* * NOTE * Memory allocated from any heap is freed with             */
+   /*          BTPS_FreeMemory().                                       */
+   /* * NOTE * The memory region is owned by the kernel until the heap  */
+   /*          is removed with BTPS_UnRegisterHeap().                   */
+   /* * NOTE * The memory region may not overlap the default heap or any*/
+   /*          heap that is already registered (an error is returned).  */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_RegisterHeap(void *HeapRegion, unsigned long RegionSize);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_RegisterHeap_t)(void *HeapRegion, unsigned long RegionSize);
+#endif
+
+   /* The following function is provided to allow a mechanism to remove */
+   /* a heap that was registered with BTPS_RegisterHeap().  This        */
+   /* function accepts as input the Heap ID that was returned from a    */
+   /* successful call to BTPS_RegisterHeap().  This function returns    */
+   /* zero if successful or a negative value if there was an error.     */
+   /* * NOTE * A heap can only be removed when there are no outstanding */
+   /*          allocations from the heap.                               */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_UnRegisterHeap(unsigned int HeapID);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_UnRegisterHeap_t)(unsigned int HeapID);
+#endif
+
+   /* The following function is responsible for the Memory Usage        */
+   /* Information of the specified heap.  This function accepts as its  */
+   /* parameters the Heap ID of the heap to query, a pointer to a memory*/
+   /* statistics structure and a flag to indicate if fragment           */
+   /* information will be determined.  The function will return zero if */
+   /* successful or a negative value if there is an error.              */
+   /* * NOTE * If the advanced statistics flag is set to FALSE, then the*/
+   /*          largest free fragment and free fragment count will be set*/
+   /*          to zero.                                                 */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryHeapUsage(unsigned int HeapID, BTPS_MemoryStatistics_t *MemoryStatistics, Boolean_t AdvancedStatitics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryHeapUsage_t)(unsigned int HeapID, BTPS_MemoryStatistics_t *MemoryStatistics, Boolean_t AdvancedStatitics);
+#endif
+
+   /* The following function is responsible for querying the            */
+   /* fragmentation statistics of the specified heap.  This function    */
+   /* accepts as its parameters the Heap ID of the heap to query and a  */
+   /* pointer to a structure that is to receive the statistics.  The    */
+   /* function will return zero if successful or a negative value if    */
+   /* there is an error.                                                */
+   /* * NOTE * These statistics are maintained as memory is allocated   */
+   /*          and freed, so this function (and the advanced statistics */
+   /*          of BTPS_QueryMemoryUsage()) does not walk the heap and is*/
+   /*          cheap enough to be called periodically.                  */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryHeapFragmentation(unsigned int HeapID, BTPS_FragmentationStatistics_t *FragmentationStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryHeapFragmentation_t)(unsigned int HeapID, BTPS_FragmentationStatistics_t *FragmentationStatistics);
+#endif
+
+   /* The following function is responsible for retrieving the          */
+   /* allocation profile (when the kernel is built with                 */
+   /* MEMORY_PROFILE_ENABLED defined).  This function accepts as its    */
+   /* parameters the maximum number of sites to return and a pointer to */
+   /* an array (of at least this many entries) that is to receive the   */
+   /* site statistics.  The sites are returned in order of decreasing   */
+   /* number of bytes currently held (i.e. the top N sites).  This      */
+   /* function returns the number of sites that were returned if        */
+   /* successful or a negative value if there was an error (or profiling*/
+   /* is not enabled).                                                  */
+   /* * NOTE * The returned array can be exported as is (for example    */
+   /*          over a debug link) for offline analysis.                 */
+BTPSAPI_DECLARATION int BTPSAPI BTPS_QueryAllocationProfile(unsigned int MaximumSites, BTPS_AllocationSiteStatistics_t *SiteStatistics);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef int (BTPSAPI *PFN_BTPS_QueryAllocationProfile_t)(unsigned int MaximumSites, BTPS_AllocationSiteStatistics_t *SiteStatistics);
+#endif
+
+   /* The following function is responsible for displaying the top N    */
+   /* allocation sites (when the kernel is built with                   */
+   /* MEMORY_PROFILE_ENABLED defined) via BTPS_OutputMessage().  This   */
+   /* function accepts as its parameter the maximum number of sites to  */
+   /* display.                                                          */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_DumpAllocationProfile(unsigned int NumberSites);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_DumpAllocationProfile_t)(unsigned int NumberSites);
+#endif
+
+   /* The following function is responsible for starting or stopping the*/
+   /* allocation trace (when the kernel is built with                   */
+   /* MEMORY_TRACE_ENABLED defined).  This function accepts as its      */
+   /* parameter a flag that specifies if the trace is to be started     */
+   /* (TRUE) or stopped (FALSE).  While the trace is running every      */
+   /* allocation, free and reallocation (and the heap it was made from) */
+   /* is recorded and written to the debug output (via                  */
+   /* BTPS_OutputMessage()) as a line of text that starts with "MT ".   */
+   /* The ID and size of every heap are written when the trace is       */
+   /* started (and when a heap is registered while it is running).      */
+   /* * NOTE * The captured output can be replayed offline against the  */
+   /*          BTPS Kernel allocator (or any other allocator) with the  */
+   /*          MemReplay tool that is located in the memtrace directory.*/
+BTPSAPI_DECLARATION void BTPSAPI BTPS_EnableMemoryTrace(Boolean_t Enable);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_EnableMemoryTrace_t)(Boolean_t Enable);
+#endif
+
+   /* The following function is responsible for writing all allocation  */
+   /* trace records that are currently buffered to the debug output     */
+   /* (when the kernel is built with MEMORY_TRACE_ENABLED defined).     */
+   /* * NOTE * Records are also written automatically whenever the trace*/
+   /*          buffer fills.                                            */
+BTPSAPI_DECLARATION void BTPSAPI BTPS_FlushMemoryTrace(void);
+
+#ifdef INCLUDE_BLUETOOTH_API_PROTOTYPES
+   typedef void (BTPSAPI *PFN_BTPS_FlushMemoryTrace_t)(void);
+#endif
+
 #endif
@@ -17,40 +17,330 @@
 /******************************************************************************/
 #include <string.h>
 #include <stdarg.h>
-#include <stdio.h>
+
+#ifdef __linux__
+
+   #include <time.h>
+
+#endif
+
+#ifdef __ICCARM__
+
+   #include <intrinsics.h>
+
+#endif
 
 #include "BTPSKRNL.h"         /* BTPS Kernel Prototypes/Constants.            */
 #include "BTTypes.h"          /* BTPS internal data types.                    */
 
-   /* The following constant represents the maximum number of functions */
-   /* that can be added to the scheduler.                               */
-#define MAX_NUMBER_SCHEDULE_FUNCTIONS                (8)
+   /* The following MACRO is used to flag a parameter that is not used  */
+   /* by the current build configuration (for example when the feature  */
+   /* that uses it has been compiled out).                              */
+#define UNREFERENCED_PARAMETER(_x)                   ((void)(_x))
+
+   /* The following constant represents the number of Scheduler Entries */
+   /* that are added to the Scheduler Entry table (and the deadline     */
+   /* queue) each time the table needs to grow.  There is no limit on   */
+   /* the number of Scheduler Entries other than the available memory.  */
+#ifndef BTPS_SCHEDULER_ENTRY_GROWTH
+   #define BTPS_SCHEDULER_ENTRY_GROWTH                (8)
+#endif
+
+   /* The following constant represents the number of consecutive       */
+   /* periods of a periodic timer that are executed late (back to back) */
+   /* when the Scheduler has fallen behind by one or more periods.  Once*/
+   /* this limit has been reached the remaining missed periods are      */
+   /* skipped, the timer always stays in phase with its original        */
+   /* deadline.  A value of zero skips all missed periods.              */
+#ifndef BTPS_SCHEDULER_CATCH_UP_LIMIT
+   #define BTPS_SCHEDULER_CATCH_UP_LIMIT              (0)
+#endif
+
+   /* The following constant represents the maximum time (in ticks) that*/
+   /* is spent calling low priority Scheduled Functions during a single */
+   /* pass through the Scheduler.  Once this time has been used the     */
+   /* remaining low priority functions that are due are called on the   */
+   /* next pass (after any higher priority work).  A value of zero does */
+   /* not limit the time spent in low priority functions.               */
+#ifndef BTPS_SCHEDULER_LOW_PRIORITY_BUDGET
+   #define BTPS_SCHEDULER_LOW_PRIORITY_BUDGET         (0)
+#endif
+
+   /* The following constant represents the maximum number of Event     */
+   /* Handlers that can be registered with BTPS_RegisterEventHandler(). */
+#ifndef BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS
+   #define BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS         (8)
+#endif
+
+   /* The following constants are used to build a Timer ID from the     */
+   /* index of a Scheduler Entry (the lower bits, plus one so that a    */
+   /* Timer ID is never zero) and a generation count that is incremented*/
+   /* each time the entry is re-used (the upper bits).  This guarantees */
+   /* that a stale Timer ID never matches a newer timer.                */
+#define SCHEDULER_ENTRY_INDEX_BITS                   (16)
+#define SCHEDULER_ENTRY_INDEX_MASK                   ((1 << SCHEDULER_ENTRY_INDEX_BITS) - 1)
+#define SCHEDULER_ENTRY_MAXIMUM                      (SCHEDULER_ENTRY_INDEX_MASK - 1)
+
+#define SCHEDULER_ENTRY_TO_TIMER_ID(_i, _g)          ((((unsigned int)(_g)) << SCHEDULER_ENTRY_INDEX_BITS) | ((_i) + 1))
+#define TIMER_ID_TO_SCHEDULER_ENTRY(_x)              (((_x) & SCHEDULER_ENTRY_INDEX_MASK) - 1)
+#define TIMER_ID_GENERATION(_x)                      ((_x) >> SCHEDULER_ENTRY_INDEX_BITS)
+
+   /* The following constant is used to terminate the list of free      */
+   /* Scheduler Entries.                                                */
+#define SCHEDULER_ENTRY_INVALID                      ((unsigned int)-1)
+
+   /* The following constants represent the states of a Scheduler Entry.*/
+#define SCHEDULER_ENTRY_STATE_FREE                   (0)
+#define SCHEDULER_ENTRY_STATE_QUEUED                 (1)
+#define SCHEDULER_ENTRY_STATE_RUNNING                (2)
+#define SCHEDULER_ENTRY_STATE_CANCELLED              (3)
+
+   /* The following MACRO determines if the first deadline (tick count) */
+   /* is before the second deadline, taking into account the            */
+   /* possibility that the Tick Counter has wrapped.                    */
+#define DEADLINE_BEFORE(_x, _y)                      (((long)((_x) - (_y))) < 0)
+
+   /* The following MACRO converts a function (of any type) to the      */
+   /* Scheduler Function that identifies it as a task in the scheduler  */
+   /* and stack profiles.  The function types are not compatible, so    */
+   /* the conversion is made through an integer.                        */
+#define TASK_FUNCTION_KEY(_x)                        ((BTPS_SchedulerFunction_t)(unsigned long)(_x))
 
    /* The following type declaration represents an individual Scheduler */
-   /* Function Entry.  This Entry contains all information needed to    */
-   /* Schedule and Execute a Function that has been added to the        */
-   /* Scheduler.                                                        */
+   /* Entry (a Scheduled Function or a Timer).  This Entry contains all */
+   /* information needed to Schedule and Execute a Function that has    */
+   /* been added to the Scheduler.  The Deadline is the absolute tick   */
+   /* count at which the function is to be called next and the Period is*/
+   /* zero for a one-shot timer.  While an entry is queued, the         */
+   /* QueueIndex is the position of the entry in the deadline queue,    */
+   /* while an entry is free it is the index of the next free entry.    */
+   /* The Priority selects the deadline queue that holds the entry.  The*/
+   /* CatchUpCount is the number of consecutive periods that have been  */
+   /* executed late (see BTPS_SCHEDULER_CATCH_UP_LIMIT).                */
 typedef struct _tagSchedulerInformation_t
 {
-   unsigned long             ScheduleCount;
-   unsigned long             ScheduleExpireCount;
+   unsigned long             Deadline;
+   unsigned long             Period;
    BTPS_SchedulerFunction_t  ScheduleFunction;
    void                     *ScheduleParameter;
+   unsigned int              TimerID;
+   unsigned int              QueueIndex;
+   unsigned int              State;
+   unsigned int              Priority;
+   unsigned int              CatchUpCount;
+   BTPS_TimerStatistics_t    Statistics;
 } SchedulerInformation_t;
 
+   /* The following type declaration represents a deadline queue.  The  */
+   /* queue is a binary min-heap (ordered by deadline) of Scheduler     */
+   /* Entry indexes so the entry that is due next is always at the start*/
+   /* of the queue.                                                     */
+typedef struct _tagSchedulerQueue_t
+{
+   unsigned int *EntryList;
+   unsigned int  NumberEntries;
+} SchedulerQueue_t;
+
+   /* The following type declaration represents an individual Event     */
+   /* Handler that has been registered with BTPS_RegisterEventHandler().*/
+   /* The Pending flag is set (from an ISR) by BTPS_PostEventFromISR()  */
+   /* and cleared by the Scheduler immediately before the Event Handler */
+   /* is called.                                                        */
+typedef struct _tagEventInformation_t
+{
+   BTPS_EventHandler_t  EventHandler;
+   void                *EventParameter;
+   volatile Boolean_t   Pending;
+} EventInformation_t;
+
    /* The following type declaration represents the entire state        */
    /* information for a Mailbox.  This structure is used with all of the*/
-   /* Mailbox functions contained in this module.                       */
+   /* Mailbox functions contained in this module.  The OccupancyTime is */
+   /* the sum (over time) of the number of occupied slots multiplied by */
+   /* the time (in ticks) they were occupied, up to the LastChangeTick. */
+   /* Dividing this by the number of messages that were removed         */
+   /* approximates the average residency of a message without time      */
+   /* stamping each message (it is exact when the Mailbox is empty at   */
+   /* both ends of the measurement, see BTPS_MailboxStatistics_t).      */
 typedef struct _tagMailboxHeader_t
 {
-   unsigned int  HeadSlot;
-   unsigned int  TailSlot;
-   unsigned int  OccupiedSlots;
-   unsigned int  NumberSlots;
-   unsigned int  SlotSize;
-   void         *Slots;
+   unsigned int                     HeadSlot;
+   unsigned int                     TailSlot;
+   unsigned int                     OccupiedSlots;
+   unsigned int                     NumberSlots;
+   unsigned int                     SlotSize;
+   void                            *Slots;
+   unsigned int                     MaximumOccupiedSlots;
+   unsigned long                    NumberAdded;
+   unsigned long                    NumberRejected;
+   unsigned long                    NumberRemoved;
+   unsigned long                    LastChangeTick;
+   QWord_t                          OccupancyTime;
+   unsigned int                     HighWatermark;
+   unsigned int                     LowWatermark;
+   Boolean_t                        AboveHighWatermark;
+   BTPS_MailboxWatermarkCallback_t  WatermarkCallback;
+   void                            *WatermarkCallbackParameter;
 } MailboxHeader_t;
 
+   /* The following type declaration represents the entire state        */
+   /* information for a Single Producer/Single Consumer Mailbox.  The   */
+   /* HeadSlot is only written by the producer and the TailSlot is only */
+   /* written by the consumer, so no lock is required as long as each   */
+   /* index is read and written as a single word.  One slot is always   */
+   /* left unused so that a full Mailbox (the slot after the HeadSlot is*/
+   /* the TailSlot) can be distinguished from an empty Mailbox (the     */
+   /* HeadSlot is the TailSlot).                                        */
+typedef struct _tagSPSCMailboxHeader_t
+{
+   volatile unsigned int  HeadSlot;
+   volatile unsigned int  TailSlot;
+   unsigned int           NumberSlots;
+   unsigned int           SlotSize;
+   unsigned char         *Slots;
+} SPSCMailboxHeader_t;
+
+   /* The following MACRO is used to determine the size of the SPSC     */
+   /* Mailbox Header rounded so that the slots that immediately follow  */
+   /* the header are aligned.                                           */
+#define SPSC_MAILBOX_HEADER_SIZE       BTPS_POOL_BLOCK_SIZE(sizeof(SPSCMailboxHeader_t))
+
+   /* The following MACRO is used to advance the specified SPSC Mailbox */
+   /* slot index (taking into account wrapping the index).              */
+#define SPSC_MAILBOX_NEXT_SLOT(_h, _x) ((((_x) + 1) == (_h)->NumberSlots)?0:((_x) + 1))
+
+   /* The following MACRO is used to order the accesses to the slot data*/
+   /* with respect to the update of the SPSC Mailbox slot index that    */
+   /* publishes (or frees) the slot.  The barrier must stop both the    */
+   /* compiler and the processor from re-ordering the accesses, so a    */
+   /* data memory barrier is used for each supported toolchain.  This   */
+   /* may be overridden for a platform that requires another barrier.   */
+   /* * NOTE * There is no silent (empty) default, a toolchain that is  */
+   /*          not listed below must define BTPS_MEMORY_BARRIER().      */
+#ifndef BTPS_MEMORY_BARRIER
+   #if defined(__GNUC__)
+      #define BTPS_MEMORY_BARRIER()    __sync_synchronize()
+   #elif defined(__ICCARM__)
+      #define BTPS_MEMORY_BARRIER()    __DMB()
+   #elif defined(__CC_ARM)
+      #define BTPS_MEMORY_BARRIER()    __dmb(0xF)
+   #else
+      #error "BTPS_MEMORY_BARRIER() must be defined for this toolchain."
+   #endif
+#endif
+
+   /* The following type declaration represents the entire state        */
+   /* information for a Byte (variable length message) Mailbox.  Each   */
+   /* message is stored at the HeadOffset as a length word followed by  */
+   /* the message data (padded so the next message is aligned).  A      */
+   /* message is never split across the end of the buffer, when it does */
+   /* not fit before the end a padding marker is written in its place   */
+   /* and the message is stored at the start of the buffer.  The        */
+   /* UsedBytes includes any padding that is currently in use so that a */
+   /* full Mailbox can be distinguished from an empty Mailbox.          */
+typedef struct _tagByteMailboxHeader_t
+{
+   unsigned int   HeadOffset;
+   unsigned int   TailOffset;
+   unsigned int   UsedBytes;
+   unsigned int   BufferSize;
+   unsigned int   NumberMessages;
+   unsigned char *Buffer;
+} ByteMailboxHeader_t;
+
+   /* The following constant represents the length word that marks the  */
+   /* unused bytes at the end of the Byte Mailbox buffer (the next      */
+   /* message is at the start of the buffer).                           */
+#define BYTE_MAILBOX_PADDING           ((unsigned int)-1)
+
+   /* The following MACRO is used to access the length word that is     */
+   /* stored at the specified offset of the specified Byte Mailbox.     */
+#define BYTE_MAILBOX_LENGTH(_h, _x)    (*((unsigned int *)&((_h)->Buffer[(_x)])))
+
+   /* The following type declaration represents the entire state        */
+   /* information for a fixed size Memory Pool.  Free blocks are kept in*/
+   /* a singly linked (LIFO) list where the link is stored in the first */
+   /* bytes of the free block itself, so blocks carry no header.  The   */
+   /* header instead holds a bitmap (one bit per block) of the blocks   */
+   /* that are allocated, which is used to reject a block that is freed */
+   /* twice.                                                            */
+   /* * NOTE * The bitmap immediately follows this header.  When the    */
+   /*          blocks are carved from the heap they are allocated in the*/
+   /*          same block as (and immediately follow) the bitmap.       */
+typedef struct _tagPoolHeader_t
+{
+   unsigned int   BlockSize;
+   unsigned int   NumberBlocks;
+   unsigned int   BlocksInUse;
+   unsigned int   MaximumBlocksInUse;
+   unsigned int   AllocationFailures;
+   void          *FreeList;
+   unsigned char *FirstBlock;
+   unsigned char *LastBlock;
+   unsigned char *AllocatedMap;
+} PoolHeader_t;
+
+   /* The following MACRO is used to access the link to the next free   */
+   /* block that is stored within a free Memory Pool block.             */
+#define POOL_BLOCK_NEXT(_x)            (*((void **)(_x)))
+
+   /* The following MACROs are used to determine the size (in bytes) of */
+   /* the allocated block bitmap of a Memory Pool with the specified    */
+   /* number of blocks, and to access the bit of the specified block    */
+   /* (index) within the bitmap.                                        */
+#define POOL_MAP_SIZE(_x)              BTPS_POOL_BLOCK_SIZE(((_x) + 7) / 8)
+#define POOL_MAP_BYTE(_h, _x)          ((_h)->AllocatedMap[(_x) >> 3])
+#define POOL_MAP_BIT(_x)               ((unsigned char)(1 << ((_x) & 7)))
+
+   /* The following constants represent the flags and length modifiers  */
+   /* of a conversion specification that are used by the message        */
+   /* formatter (see FormatString()).                                   */
+#define FORMAT_FLAG_LEFT_JUSTIFY       (0x0001)
+#define FORMAT_FLAG_ZERO_PAD           (0x0002)
+#define FORMAT_FLAG_PLUS_SIGN          (0x0004)
+#define FORMAT_FLAG_SPACE_SIGN         (0x0008)
+#define FORMAT_FLAG_ALTERNATE          (0x0010)
+#define FORMAT_FLAG_SHORT              (0x0020)
+#define FORMAT_FLAG_CHAR               (0x0040)
+#define FORMAT_FLAG_LONG               (0x0080)
+#define FORMAT_FLAG_LONG_LONG          (0x0100)
+#define FORMAT_FLAG_UNSIGNED           (0x0200)
+
+   /* The following constant represents the size of the buffer that     */
+   /* holds the digits of a single converted number (large enough for a */
+   /* 64 bit value in octal).                                           */
+#define FORMAT_DIGITS_BUFFER_SIZE      (24)
+
+   /* The following constant represents the number of bytes that are    */
+   /* displayed on each line of a data dump (see BTPS_DumpData()).      */
+#define DUMP_DATA_BYTES_PER_LINE       (16)
+
+   /* The following type declaration represents the machine word that is*/
+   /* used by the memory copy, move, fill and compare functions (32 bits*/
+   /* on the target).  The word may alias any other type.               */
+#ifdef __GNUC__
+   typedef unsigned long __attribute__((__may_alias__)) MemoryWord_t;
+#else
+   typedef unsigned long MemoryWord_t;
+#endif
+
+   /* The following constants represent the size of a machine word, the */
+   /* mask of the address bits that must be zero for a word access and  */
+   /* the size of the block (of four words) that is moved with a single */
+   /* multiple register load and store.                                 */
+#define MEMORY_WORD_SIZE               (sizeof(MemoryWord_t))
+#define MEMORY_WORD_MASK               (MEMORY_WORD_SIZE - 1)
+#define MEMORY_BLOCK_SIZE              (MEMORY_WORD_SIZE * 4)
+
+   /* The following constant represents the smallest number of bytes    */
+   /* for which the memory functions switch to word accesses (smaller   */
+   /* blocks are not worth the cost of aligning the pointers).          */
+#define MEMORY_WORD_THRESHOLD          (16)
+
+   /* The following MACRO is used to determine if two pointers share the*/
+   /* same word alignment (i.e. can both be word aligned at once).      */
+#define MEMORY_SAME_ALIGNMENT(_x, _y)  (!((((unsigned long)(_x)) ^ ((unsigned long)(_y))) & MEMORY_WORD_MASK))
+
    /*********************************************************************/
    /* Heap Manager Definitions                                          */
    /*********************************************************************/
@@ -62,6 +352,13 @@ typedef struct _tagMailboxHeader_t
    /*          allocation.                                              */
 #define BTPS_MEMORY_BUFFER_SIZE        (20 * 1024)
 
+   /* Defines the maximum number of heaps (including the default heap   */
+   /* that uses the memory array above) that can be in use at one time. */
+   /* Additional heaps are registered with BTPS_RegisterHeap().         */
+#ifndef BTPS_MAXIMUM_NUMBER_HEAPS
+   #define BTPS_MAXIMUM_NUMBER_HEAPS   (4)
+#endif
+
    /* The following defines a type that is the size in bytes of the     */
    /* desired alignment of each data fragment.                          */
 typedef unsigned int Alignment_t;
@@ -75,11 +372,19 @@ typedef unsigned int Alignment_t;
    /* and the size of the block, and the start of the data region of the*/
    /* The size of the block also includes a flag to indicate if the     */
    /* block is allocated.                                               */
+   /* * NOTE * When MEMORY_PROFILE_ENABLED is defined each block also   */
+   /*          records the allocation site (index into the profile site */
+   /*          table) and the tick count at which it was allocated.     */
 typedef struct _tagBlockInfo_t
 {
-   Word_t      PrevSize;
-   Word_t      Size;
-   Alignment_t Data[1];
+   Word_t        PrevSize;
+   Word_t        Size;
+#ifdef MEMORY_PROFILE_ENABLED
+   Word_t        SiteIndex;
+   Word_t        Reserved;
+   unsigned long AllocationTick;
+#endif
+   Alignment_t   Data[1];
 } BlockInfo_t;
 
 #define BLOCK_INFO_SIZE(_x)            ((BTPS_STRUCTURE_OFFSET(BlockInfo_t, Data) / ALIGNMENT_SIZE) + (_x))
@@ -90,31 +395,527 @@ typedef struct _tagBlockInfo_t
 #define SEGMENT_ALLOCATED_BITMASK      (Word_t)(~SEGMENT_SIZE_BITMASK)
 
    /* The following defines the size in bytes of a data fragment that is*/
-   /* considered a large value.  Allocations that are equal to and      */
-   /* larger than this value will be allocated from the end of the heap.*/
-#define LARGE_SIZE                     (256 / ALIGNMENT_SIZE)
+   /* considered a large value.  When a free block is split to satisfy  */
+   /* an allocation that is equal to or larger than this value, the     */
+   /* allocated portion is taken from the end of the free block.        */
+   /* * NOTE * The threshold may be overridden (in bytes) so that       */
+   /*          different policies can be evaluated by replaying an      */
+   /*          allocation trace (see MEMORY_TRACE_ENABLED).             */
+#ifndef BTPS_LARGE_ALLOCATION_SIZE
+   #define BTPS_LARGE_ALLOCATION_SIZE  (256)
+#endif
+
+#define LARGE_SIZE                     (BTPS_LARGE_ALLOCATION_SIZE / ALIGNMENT_SIZE)
 
    /* The following defines the minimum and maximum sizes of a block (in*/
    /* Alignment_t units) that can be allocated.                         */
 #define MINIMUM_MEMORY_SIZE            (BLOCK_INFO_SIZE(1))
 #define MAXIMUM_MEMORY_SIZE            (SEGMENT_SIZE_BITMASK)
 
+   /* Free blocks are kept in segregated free lists that are indexed by */
+   /* a two level size class (TLSF).  The first level index is the      */
+   /* power of two range of the block size and the second level index   */
+   /* linearly subdivides this range into SECOND_LEVEL_INDEX_COUNT      */
+   /* classes.  Blocks that are smaller than SMALL_BLOCK_SIZE (in       */
+   /* Alignment_t units) are all placed in the first level index of     */
+   /* zero with one second level class per size.                        */
+   /* * NOTE * The second level bitmap is stored in an unsigned char so */
+   /*          SECOND_LEVEL_INDEX_COUNT must not be larger than 8.      */
+#define SECOND_LEVEL_INDEX_LOG2        (3)
+#define SECOND_LEVEL_INDEX_COUNT       (1 << SECOND_LEVEL_INDEX_LOG2)
+#define FIRST_LEVEL_INDEX_SHIFT        (SECOND_LEVEL_INDEX_LOG2)
+#define FIRST_LEVEL_INDEX_COUNT        ((sizeof(Word_t) * 8) - FIRST_LEVEL_INDEX_SHIFT)
+#define SMALL_BLOCK_SIZE               (1 << FIRST_LEVEL_INDEX_SHIFT)
+
+   /* The free list links of a free block are stored in the first two   */
+   /* Word_t's of the data region of the block.  The links are the      */
+   /* offset (in Alignment_t units) of the linked block from the start  */
+   /* of the heap, FREE_LIST_NULL is used to terminate a list.          */
+   /* * NOTE * The data region of the smallest block must be large      */
+   /*          enough to hold both links.                               */
+#define FREE_LIST_NULL                 ((Word_t)-1)
+
+   /* The following type declaration represents a free list link.  The  */
+   /* links overlay the Alignment_t data region of a free block, so the */
+   /* type is declared to alias any other type.                         */
+#ifdef __GNUC__
+   typedef Word_t __attribute__((__may_alias__)) FreeLink_t;
+#else
+   typedef Word_t FreeLink_t;
+#endif
+
+#define FREE_BLOCK_NEXT(_x)            (((FreeLink_t *)((_x)->Data))[0])
+#define FREE_BLOCK_PREV(_x)            (((FreeLink_t *)((_x)->Data))[1])
+
+   /* The following constant represents the maximum number of blocks of */
+   /* the free list of the requested size class that are examined when  */
+   /* no larger size class holds a free block (see FindFreeBlock()).    */
+   /* This bounds the time taken by an allocation, which would          */
+   /* otherwise grow with the number of free blocks as the heap fills   */
+   /* up.                                                               */
+   /* * NOTE * An allocation can therefore fail while a large enough    */
+   /*          block is further down the list of the requested class.   */
+#define FREE_LIST_SEARCH_LIMIT         (4)
+
+   /* The following MACROs convert between a block pointer and the      */
+   /* offset of the block from the start of the specified heap.         */
+#define BLOCK_TO_OFFSET(_h, _b)        ((Word_t)(((Alignment_t *)(_b)) - ((Alignment_t *)((_h)->HeapHead))))
+#define OFFSET_TO_BLOCK(_h, _o)        ((BlockInfo_t *)(((Alignment_t *)((_h)->HeapHead)) + (_o)))
+
    /* The following structure provides the information for a heap. Its  */
    /* members include a flag to indicate if it has been initializes, the*/
    /* current and maximum amount of the heap used (in Alignment_t       */
-   /* units), a pointer to the end of the heap and the start of the     */
-   /* heap.                                                             */
+   /* units), the number and total size of the free blocks along with   */
+   /* the number of free blocks in each first level size class, the     */
+   /* bitmaps and heads of the segregated free lists, a pointer to the  */
+   /* end of the heap and the start of the heap.                        */
+   /* * NOTE * The free block counters are maintained as blocks are     */
+   /*          added to and removed from the free lists so that the     */
+   /*          fragmentation statistics never require a heap walk.      */
 typedef struct _tagHeapInfo_t
 {
    Boolean_t     Initialized;
    unsigned int  CurrentHeapUsed;
    unsigned int  MaximumHeapUsed;
+   unsigned int  FreeBlockCount;
+   unsigned int  FreeHeapSize;
+   Word_t        FreeClassCount[FIRST_LEVEL_INDEX_COUNT];
+   unsigned int  FirstLevelBitmap;
+   unsigned char SecondLevelBitmap[FIRST_LEVEL_INDEX_COUNT];
+   Word_t        FreeListHead[FIRST_LEVEL_INDEX_COUNT][SECOND_LEVEL_INDEX_COUNT];
    BlockInfo_t  *HeapTail;
    BlockInfo_t   HeapHead[1];
 } HeapInfo_t;
 
 #define HEAP_INFO_SIZE(_x)             (BTPS_STRUCTURE_OFFSET(HeapInfo_t, HeapHead) + (_x))
 
+   /* The following MACRO determines if the specified memory pointer    */
+   /* lies within the data area of the specified heap.                  */
+#define HEAP_CONTAINS(_h, _p)          ((((void *)(_p)) >= (void *)((_h)->HeapHead->Data)) && (((void *)(_p)) < (void *)((_h)->HeapTail)))
+
+   /*********************************************************************/
+   /* Profile Table Definitions                                         */
+   /*********************************************************************/
+
+   /* The allocation, scheduler, critical section and stack profilers   */
+   /* each keep a table of entries that is indexed by a hash of the     */
+   /* address of the site (or task) that is profiled, followed by a     */
+   /* single overflow entry.  The functions that locate an entry and    */
+   /* walk a table are shared, and are only built when at least one of  */
+   /* these profilers is enabled.                                       */
+#if (defined(MEMORY_PROFILE_ENABLED) || defined(SCHEDULER_PROFILE_ENABLED) || defined(CRITICAL_SECTION_PROFILE_ENABLED) || defined(STACK_PROFILE_ENABLED))
+
+#define PROFILE_TABLE_ENABLED
+
+   /* The following type declaration represents the key that identifies */
+   /* an entry of a profile table (the address of the site or task).    */
+   /* An entry with a key of zero is unused (or is the overflow entry). */
+   /* * NOTE * The key *MUST* be the first member of every profile table*/
+   /*          entry.                                                   */
+typedef unsigned long ProfileKey_t;
+
+   /* The following type declaration represents the function that is    */
+   /* used to determine the value that a profile table entry is ordered */
+   /* by when the table is walked.  The function takes as its parameters*/
+   /* the entry and a pointer to receive the value.  The function       */
+   /* returns FALSE if the entry has never been used (in which case the */
+   /* entry is skipped).                                                */
+typedef Boolean_t (*ProfileEntryValueFunction_t)(void *Entry, QWord_t *Value);
+
+   /* The following MACROs are used to access the specified entry of a  */
+   /* profile table (given the size of each entry) and its key.         */
+#define PROFILE_ENTRY(_t, _s, _x)      ((void *)(((unsigned char *)(_t)) + ((_x) * (_s))))
+#define PROFILE_ENTRY_KEY(_t, _s, _x)  (*((ProfileKey_t *)PROFILE_ENTRY(_t, _s, _x)))
+
+#endif
+
+   /*********************************************************************/
+   /* Allocation Profiler Definitions                                   */
+   /*********************************************************************/
+
+   /* The following preprocessor definitions control the optional       */
+   /* allocation profiler.                                              */
+   /*                                                                   */
+   /*    - MEMORY_PROFILE_ENABLED                                       */
+   /*         - When defined every allocation is attributed to the      */
+   /*           address of the caller of the allocation function (or to */
+   /*           the tag passed to BTPS_AllocateMemoryWithTag()).        */
+   /*                                                                   */
+   /*    - MEMORY_PROFILE_MAXIMUM_SITES                                 */
+   /*         - The number of distinct allocation sites that are        */
+   /*           tracked (must be a power of two).  Allocations from any */
+   /*           sites beyond this number are attributed to a single     */
+   /*           overflow site.                                          */
+   /*                                                                   */
+   /*    - MEMORY_PROFILE_CALLER_ADDRESS()                              */
+   /*         - Expression that evaluates to the return address of the  */
+   /*           current function.  This is provided for GCC (and Clang) */
+   /*           and the Keil (ARM) compiler.  IAR has no equivalent     */
+   /*           intrinsic (__get_LR() only holds the return address     */
+   /*           until the function makes its first call, and the site   */
+   /*           is taken after the memory is allocated), so for IAR (and*/
+   /*           any other compiler) all untagged allocations are        */
+   /*           attributed to a single (NULL) site unless this is       */
+   /*           defined by the platform.                                */
+#ifdef MEMORY_PROFILE_ENABLED
+
+#ifndef MEMORY_PROFILE_MAXIMUM_SITES
+   #define MEMORY_PROFILE_MAXIMUM_SITES      (32)
+#endif
+
+#ifndef MEMORY_PROFILE_CALLER_ADDRESS
+   #if defined(__GNUC__)
+      #define MEMORY_PROFILE_CALLER_ADDRESS() ((BTPSCONST void *)__builtin_return_address(0))
+   #elif defined(__CC_ARM)
+      #define MEMORY_PROFILE_CALLER_ADDRESS() ((BTPSCONST void *)__return_address())
+   #else
+      #define MEMORY_PROFILE_CALLER_ADDRESS() ((BTPSCONST void *)NULL)
+   #endif
+#endif
+
+   /* The following constant represents the index of the site that all  */
+   /* allocations are attributed to once the site table is full.        */
+#define MEMORY_PROFILE_OVERFLOW_SITE         (MEMORY_PROFILE_MAXIMUM_SITES)
+
+   /* The following type declaration represents the profile information */
+   /* that is kept for a single allocation site.  The site is identified*/
+   /* by the tag (when Tagged is TRUE) or the address of the caller.    */
+typedef struct _tagProfileSite_t
+{
+   ProfileKey_t    Key;
+   Boolean_t       Tagged;
+   unsigned long   NumberAllocations;
+   unsigned long   NumberFrees;
+   unsigned long   NumberFailures;
+   unsigned long   CurrentBytes;
+   unsigned long   PeakBytes;
+   unsigned long   LifetimeHistogram[BTPS_ALLOCATION_LIFETIME_BINS];
+} ProfileSite_t;
+
+#else
+
+#define MEMORY_PROFILE_CALLER_ADDRESS()      ((BTPSCONST void *)NULL)
+
+#endif
+
+   /*********************************************************************/
+   /* Allocation Trace Definitions                                      */
+   /*********************************************************************/
+
+   /* The following preprocessor definitions control the optional       */
+   /* allocation trace.                                                 */
+   /*                                                                   */
+   /*    - MEMORY_TRACE_ENABLED                                         */
+   /*         - When defined every allocation, free and reallocation    */
+   /*           made while the trace is running (see                    */
+   /*           BTPS_EnableMemoryTrace()) is recorded along with its    */
+   /*           heap, size, pointer and tick count.  Records are        */
+   /*           buffered and written to the debug output (one line per  */
+   /*           record) when the buffer fills, so that a session can be */
+   /*           captured from the console and replayed offline.         */
+   /*                                                                   */
+   /*    - MEMORY_TRACE_BUFFER_RECORDS                                  */
+   /*         - The number of records that are buffered before they are */
+   /*           written to the debug output.                            */
+   /*                                                                   */
+   /* The trace lines have the following format (all values are in      */
+   /* hexadecimal):                                                     */
+   /*                                                                   */
+   /*    MT H <HeapID> <HeapSize>                   - Heap              */
+   /*    MT A <Tick> <HeapID> <Size> <Pointer>      - Allocation        */
+   /*    MT F <Tick> <HeapID> <Pointer>             - Free              */
+   /*    MT R <Tick> <HeapID> <Size> <Pointer>                          */
+   /*         <OldPointer>                          - Reallocation      */
+   /*    MT E                                       - Trace stopped     */
+   /*                                                                   */
+   /* A failed allocation (or reallocation) is recorded with a Pointer  */
+   /* of zero.  When the trace is started a heap record is written for  */
+   /* the default heap and every registered heap (the size is that of   */
+   /* the region that holds the heap), followed by an allocation record */
+   /* (with a tick count of zero) for every block that is already       */
+   /* allocated so that the trace always starts from the current heap   */
+   /* state.  A heap record is also written when a heap is registered   */
+   /* while the trace is running.                                       */
+#ifdef MEMORY_TRACE_ENABLED
+
+#ifndef MEMORY_TRACE_BUFFER_RECORDS
+   #define MEMORY_TRACE_BUFFER_RECORDS       (64)
+#endif
+
+   /* The following constants represent the operations that are         */
+   /* recorded in the allocation trace.                                 */
+#define MEMORY_TRACE_OPERATION_ALLOCATE      ('A')
+#define MEMORY_TRACE_OPERATION_FREE          ('F')
+#define MEMORY_TRACE_OPERATION_REALLOCATE    ('R')
+#define MEMORY_TRACE_OPERATION_HEAP          ('H')
+
+   /* The following MACRO is a utility MACRO that determines the size of*/
+   /* the region that holds the specified heap (as recorded in the      */
+   /* trace).                                                           */
+#define MEMORY_TRACE_HEAP_SIZE(_h)           ((unsigned long)(((unsigned char *)((_h)->HeapTail)) - ((unsigned char *)(_h))))
+
+   /* The following type declaration represents a single allocation     */
+   /* trace record.                                                     */
+typedef struct _tagTraceRecord_t
+{
+   unsigned long  TimeStamp;
+   unsigned long  Size;
+   void          *Pointer;
+   void          *PreviousPointer;
+   unsigned int   HeapID;
+   char           Operation;
+} TraceRecord_t;
+
+#endif
+
+   /*********************************************************************/
+   /* Deferred Log Definitions                                          */
+   /*********************************************************************/
+
+   /* The following preprocessor definitions control the optional       */
+   /* deferred log.                                                     */
+   /*                                                                   */
+   /*    - DEFERRED_LOG_ENABLED                                         */
+   /*         - When defined BTPS_LogMessage() (and DBG_MSG() when      */
+   /*           DEBUG_ENABLED is also defined) does not format the      */
+   /*           message.  Only the address of the format string, the    */
+   /*           low 32 bits of the timestamp (in microseconds) and the  */
+   /*           raw arguments are recorded in a ring buffer.  The       */
+   /*           records are written to the debug output by the          */
+   /*           scheduler when nothing is due (or by BTPS_FlushLog()).  */
+   /*           When the ring is full the oldest record is overwritten  */
+   /*           and the number of lost records is reported with the     */
+   /*           next record that is written.                            */
+   /*                                                                   */
+   /*    - DEFERRED_LOG_BUFFER_RECORDS                                  */
+   /*         - The number of records that the ring buffer holds.       */
+   /*                                                                   */
+   /*    - DEFERRED_LOG_FLUSH_RECORDS                                   */
+   /*         - The maximum number of records that are written each     */
+   /*           time the scheduler is idle (so that a long log does not */
+   /*           delay Scheduled Functions that become due).             */
+   /*                                                                   */
+   /*    - DEFERRED_LOG_EXPORT                                          */
+   /*         - When defined the records are not formatted on the       */
+   /*           target, instead each record is written as a line of     */
+   /*           text that is decoded on the host with the LogDecode     */
+   /*           tool that is located in the logdecode directory.        */
+   /*                                                                   */
+   /* The export lines have the following format (all values are in     */
+   /* hexadecimal):                                                     */
+   /*                                                                   */
+   /*    DL <TimeStamp> <Format> <Argument 1> ... <Argument 6>          */
+   /*    DL L <NumberLost>                                              */
+   /*                                                                   */
+   /* * NOTE * Each argument is recorded as an unsigned long, so 64 bit */
+   /*          (and floating point) arguments are not supported.  As    */
+   /*          only the address is recorded the format string (and any  */
+   /*          string argument) must remain valid until the record is   */
+   /*          written (i.e. it should be a string constant).           */
+#ifdef DEFERRED_LOG_ENABLED
+
+#ifndef DEFERRED_LOG_BUFFER_RECORDS
+   #define DEFERRED_LOG_BUFFER_RECORDS       (64)
+#endif
+
+#ifndef DEFERRED_LOG_FLUSH_RECORDS
+   #define DEFERRED_LOG_FLUSH_RECORDS        (4)
+#endif
+
+   /* The following constant represents the maximum number of arguments */
+   /* that are recorded for a single message (any further arguments are */
+   /* ignored).                                                         */
+#define DEFERRED_LOG_MAXIMUM_ARGUMENTS       (6)
+
+   /* The following type declaration represents a single deferred log   */
+   /* record.                                                           */
+typedef struct _tagLogRecord_t
+{
+   BTPSCONST char *Format;
+   unsigned long   TimeStamp;
+   unsigned long   Argument[DEFERRED_LOG_MAXIMUM_ARGUMENTS];
+} LogRecord_t;
+
+#endif
+
+   /*********************************************************************/
+   /* Scheduler Profiler Definitions                                    */
+   /*********************************************************************/
+
+   /* The following preprocessor definitions control the optional       */
+   /* scheduler profiler.                                               */
+   /*                                                                   */
+   /*    - SCHEDULER_PROFILE_ENABLED                                    */
+   /*         - When defined the execution time of every call of a      */
+   /*           Scheduled Function (or timer) and Event Handler is      */
+   /*           measured with the registered cycle counter (see         */
+   /*           BTPS_RegisterCycleCounter()) and attributed to the      */
+   /*           function that was called.                               */
+   /*                                                                   */
+   /*    - SCHEDULER_PROFILE_MAXIMUM_TASKS                              */
+   /*         - The number of distinct tasks (functions) that are       */
+   /*           tracked (must be a power of two).  Calls of any tasks   */
+   /*           beyond this number are attributed to a single overflow  */
+   /*           task.                                                   */
+   /*                                                                   */
+   /*    - SCHEDULER_PROFILE_LOAD_WINDOW                                */
+   /*         - The length (in ticks) of the window over which the CPU  */
+   /*           load is measured.                                       */
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+#ifndef SCHEDULER_PROFILE_MAXIMUM_TASKS
+   #define SCHEDULER_PROFILE_MAXIMUM_TASKS   (16)
+#endif
+
+#ifndef SCHEDULER_PROFILE_LOAD_WINDOW
+   #define SCHEDULER_PROFILE_LOAD_WINDOW     (1000)
+#endif
+
+   /* The following constant represents the index of the task that all  */
+   /* calls are attributed to once the task table is full.              */
+#define SCHEDULER_PROFILE_OVERFLOW_TASK      (SCHEDULER_PROFILE_MAXIMUM_TASKS)
+
+   /* The following type declaration represents the profile information */
+   /* that is kept for a single task.  The WindowCycles member is the   */
+   /* time spent in the task during the current CPU load window and the */
+   /* LastWindowCycles member is the time spent during the last complete*/
+   /* window.                                                           */
+typedef struct _tagProfileTask_t
+{
+   ProfileKey_t             Key;
+   Boolean_t                EventHandler;
+   unsigned long            NumberCalls;
+   QWord_t                  TotalCycles;
+   unsigned long            MaximumCycles;
+   unsigned long            WindowCycles;
+   unsigned long            LastWindowCycles;
+   unsigned long            CycleHistogram[BTPS_TASK_CYCLE_HISTOGRAM_BINS];
+} ProfileTask_t;
+
+#endif
+
+   /*********************************************************************/
+   /* Critical Section Profiler Definitions                             */
+   /*********************************************************************/
+
+   /* The following preprocessor definitions control the optional       */
+   /* critical section profiler.                                        */
+   /*                                                                   */
+   /*    - CRITICAL_SECTION_PROFILE_ENABLED                             */
+   /*         - When defined the time that interrupts are disabled by   */
+   /*           every (outermost) critical section is measured with the */
+   /*           registered cycle counter (see                           */
+   /*           BTPS_RegisterCycleCounter()) and attributed to the      */
+   /*           address of the caller of BTPS_EnterCriticalSection().   */
+   /*                                                                   */
+   /*    - CRITICAL_SECTION_PROFILE_MAXIMUM_SITES                       */
+   /*         - The number of distinct critical sections that are       */
+   /*           tracked (must be a power of two).  Critical sections    */
+   /*           beyond this number are attributed to a single overflow  */
+   /*           site.                                                   */
+   /*                                                                   */
+   /*    - CRITICAL_SECTION_PROFILE_CALLER_ADDRESS()                    */
+   /*         - Expression that evaluates to the return address of the  */
+   /*           current function.  This is provided for GCC (and Clang) */
+   /*           and the Keil (ARM) compiler.  IAR has no equivalent     */
+   /*           intrinsic (__get_LR() only holds the return address     */
+   /*           until the function makes its first call, and the site   */
+   /*           is taken after the interrupt callback is called), so    */
+   /*           for IAR (and any other compiler) all critical sections  */
+   /*           are attributed to a single (NULL) site unless this is   */
+   /*           defined by the platform.                                */
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+#ifndef CRITICAL_SECTION_PROFILE_MAXIMUM_SITES
+   #define CRITICAL_SECTION_PROFILE_MAXIMUM_SITES (16)
+#endif
+
+#ifndef CRITICAL_SECTION_PROFILE_CALLER_ADDRESS
+   #if defined(__GNUC__)
+      #define CRITICAL_SECTION_PROFILE_CALLER_ADDRESS() ((BTPSCONST void *)__builtin_return_address(0))
+   #elif defined(__CC_ARM)
+      #define CRITICAL_SECTION_PROFILE_CALLER_ADDRESS() ((BTPSCONST void *)__return_address())
+   #else
+      #define CRITICAL_SECTION_PROFILE_CALLER_ADDRESS() ((BTPSCONST void *)NULL)
+   #endif
+#endif
+
+   /* The following constant represents the index of the site that all  */
+   /* critical sections are attributed to once the site table is full.  */
+#define CRITICAL_SECTION_PROFILE_OVERFLOW_SITE (CRITICAL_SECTION_PROFILE_MAXIMUM_SITES)
+
+   /* The following type declaration represents the profile information */
+   /* that is kept for a single critical section.  All times are        */
+   /* specified in cycles of the registered cycle counter.              */
+typedef struct _tagCriticalSectionSite_t
+{
+   ProfileKey_t    Key;
+   unsigned long   NumberCalls;
+   QWord_t         TotalCycles;
+   unsigned long   MaximumCycles;
+   unsigned long   CycleHistogram[BTPS_CRITICAL_SECTION_HISTOGRAM_BINS];
+} CriticalSectionSite_t;
+
+#endif
+
+   /*********************************************************************/
+   /* Stack Profiler Definitions                                        */
+   /*********************************************************************/
+
+   /* The following constant represents the value that every free word  */
+   /* of the registered stack is painted with (see BTPS_RegisterStack())*/
+   /* so that the deepest word that has been used can be found.         */
+#define STACK_PAINT_PATTERN                  (0xA5A5A5A5UL)
+
+   /* The following constant represents the number of bytes below the   */
+   /* current position in the stack that are never painted.  This       */
+   /* covers the frame of the function that is painting (and of its     */
+   /* caller, if the compiler places them in the same frame).           */
+#define STACK_PAINT_MARGIN                   (128)
+
+   /* The following MACRO is a utility MACRO that exists to determine   */
+   /* the first word of the stack that may not be painted from the      */
+   /* address of a local variable of the function that is painting.     */
+#define STACK_PAINT_LIMIT(_x)                ((unsigned long *)((((unsigned long)(_x)) - STACK_PAINT_MARGIN) & ~((unsigned long)(sizeof(unsigned long) - 1))))
+
+   /* The following preprocessor definitions control the optional stack */
+   /* profiler.                                                         */
+   /*                                                                   */
+   /*    - STACK_PROFILE_ENABLED                                        */
+   /*         - When defined the deepest point of the registered stack  */
+   /*           (see BTPS_RegisterStack()) that is reached by every call*/
+   /*           of a Scheduled Function (or timer), Event Handler and   */
+   /*           Coroutine Function is measured and attributed to the    */
+   /*           function that was called.                               */
+   /*                                                                   */
+   /*    - STACK_PROFILE_MAXIMUM_TASKS                                  */
+   /*         - The number of distinct tasks (functions) that are       */
+   /*           tracked (must be a power of two).  Calls of any tasks   */
+   /*           beyond this number are attributed to a single overflow  */
+   /*           task.                                                   */
+#ifdef STACK_PROFILE_ENABLED
+
+#ifndef STACK_PROFILE_MAXIMUM_TASKS
+   #define STACK_PROFILE_MAXIMUM_TASKS       (16)
+#endif
+
+   /* The following constant represents the index of the task that all  */
+   /* calls are attributed to once the task table is full.              */
+#define STACK_PROFILE_OVERFLOW_TASK          (STACK_PROFILE_MAXIMUM_TASKS)
+
+   /* The following type declaration represents the stack profile that  */
+   /* is kept for a single task.  The MaximumUsage member is the deepest*/
+   /* point of the stack (in bytes from the top of the stack) that was  */
+   /* reached by any call of the task.                                  */
+typedef struct _tagStackProfileTask_t
+{
+   ProfileKey_t             Key;
+   unsigned long            NumberCalls;
+   unsigned long            MaximumUsage;
+} StackProfileTask_t;
+
+#endif
+
    /* Internal Variables to this Module (Remember that all variables    */
    /* declared static are initialized to 0 automatically by the         */
    /* compiler as part of standard C/C++).                              */
@@ -123,6 +924,77 @@ typedef struct _tagHeapInfo_t
    /* as an Alignment_t so that we can force alignment to be correct.   */
 static Alignment_t               MemoryBuffer[(BTPS_MEMORY_BUFFER_SIZE / ALIGNMENT_SIZE)];
 
+   /* Variable which holds the heaps that are currently registered,     */
+   /* indexed by Heap ID (the default heap is always at index zero).    */
+static HeapInfo_t               *HeapList[BTPS_MAXIMUM_NUMBER_HEAPS];
+
+   /* Variable which holds the number of entries of the heap list that  */
+   /* are in use.                                                       */
+static unsigned int              NumberHeaps;
+
+   /* Variable which maps each character to the character that is used  */
+   /* for a Case-Insensitive compare (lower case ASCII characters are   */
+   /* mapped to upper case, all other characters are unchanged).        */
+static BTPSCONST unsigned char   CaseFoldTable[256] =
+{
+   0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+   0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+   0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,
+   0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,
+   0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+   0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+   0x60, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+   0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,
+   0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,
+   0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+   0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+   0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+   0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+   0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+   0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+   0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF
+};
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+   /* Variable which holds the allocation profile of each allocation    */
+   /* site (the final entry is the overflow site).                      */
+static ProfileSite_t             ProfileSiteList[MEMORY_PROFILE_MAXIMUM_SITES + 1];
+
+   /* Variable which holds the upper bounds (in milliseconds) of all but*/
+   /* the final lifetime histogram bin.                                 */
+static BTPSCONST unsigned long   LifetimeBinLimit[BTPS_ALLOCATION_LIFETIME_BINS - 1] =
+{
+   10, 100, 1000, 10000, 60000
+};
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+   /* Variables which hold the allocation trace records that have not   */
+   /* yet been written to the debug output, the number of records in the*/
+   /* buffer and a flag that indicates if the trace is running.         */
+static TraceRecord_t             TraceRecordList[MEMORY_TRACE_BUFFER_RECORDS];
+static unsigned int              NumberTraceRecords;
+static Boolean_t                 TraceActive;
+
+#endif
+
+#ifdef DEFERRED_LOG_ENABLED
+
+   /* Variables which hold the deferred log ring buffer, the index of   */
+   /* the oldest record, the index of the next record to write, the     */
+   /* number of records in the ring and the number of records that have */
+   /* been overwritten since the last record was written out.           */
+static LogRecord_t               LogRecordList[DEFERRED_LOG_BUFFER_RECORDS];
+static unsigned int              LogRecordOut;
+static unsigned int              LogRecordIn;
+static unsigned int              NumberLogRecords;
+static unsigned long             NumberLostLogRecords;
+
+#endif
+
    /*********************************************************************/
    /* Miscellaneous Definitions                                         */
    /*********************************************************************/
@@ -131,20 +1003,43 @@ static Alignment_t               MemoryBuffer[(BTPS_MEMORY_BUFFER_SIZE / ALIGNME
    /* Initialized.                                                      */
 static Boolean_t               SchedulerInitialized;
 
-   /* Variable which holds the total number of Functions that have been */
-   /* added to the Scheduler.                                           */
+   /* Variable which holds the total number of Functions that are       */
+   /* currently in the deadline queues.                                 */
 static unsigned int            NumberScheduledFunctions;
 
-   /* Variable which holds ALL Information regarding ALL Scheduled      */
-   /* Functions.                                                        */
-static SchedulerInformation_t  SchedulerInformation[MAX_NUMBER_SCHEDULE_FUNCTIONS];
+   /* Variables which hold ALL Information regarding ALL Scheduled      */
+   /* Functions (allocated from the heap as needed), the number of      */
+   /* entries in the table and the index of the first free entry.       */
+static SchedulerInformation_t *SchedulerInformation;
+static unsigned int            NumberSchedulerEntries;
+static unsigned int            FreeSchedulerEntry;
+
+   /* Variable which holds the deadline queues, there is a separate     */
+   /* queue for each priority class.                                    */
+static SchedulerQueue_t        SchedulerQueue[BTPS_SCHEDULER_NUMBER_PRIORITIES];
+
+   /* Variables which hold the registered Event Handlers and a flag that*/
+   /* is set (from an ISR) whenever any event has been posted.          */
+static EventInformation_t      EventInformation[BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS];
+static volatile Boolean_t      EventPending;
+
+   /* Variables which hold the list of Coroutines that are ready to be  */
+   /* resumed (in the order they became ready) and the number of        */
+   /* Coroutines in the list.                                           */
+static BTPS_Coroutine_t       *CoroutineReadyHead;
+static BTPS_Coroutine_t       *CoroutineReadyTail;
+static unsigned int            NumberReadyCoroutines;
 
    /* Variable which holds the current Debug Zone Mask.                 */
 static unsigned long           DebugZoneMask;
 
-   /* Variable which holds the previous Tick Count that was present     */
-   /* through the last pass through the scheduler.                      */
-static unsigned long           PreviousTickCount;
+   /* Variable which holds the function that is called by the Scheduler */
+   /* when no Scheduled Function is due.                                */
+static BTPS_IdleCallback_t     IdleCallback;
+
+   /* Variable which holds the function that is called by BTPS_Delay()  */
+   /* to wait for the delay to expire.                                  */
+static BTPS_SleepCallback_t    SleepCallback;
 
    /* Variable which holds the currently registered function that is to */
    /* be called when this module needs to know the current value of the */
@@ -155,115 +1050,534 @@ static BTPS_GetTickCountCallback_t  GetTickCountCallback;
    /* UART.                                                             */
 static BTPS_MessageOutputCallback_t MessageOutputCallback;
 
+   /* Variables which hold the currently registered function that is to */
+   /* be called to read the high resolution (cycle) counter and the     */
+   /* frequency of the counter (in counts per second).                  */
+static BTPS_GetCycleCountCallback_t GetCycleCountCallback;
+static unsigned long                CyclesPerSecond;
+
+   /* Variable which holds the currently registered function that is to */
+   /* be called to read the current (Microsecond) Timestamp.            */
+static BTPS_GetTimestampCallback_t  GetTimestampCallback;
+
+   /* Variables which hold the currently registered functions that are  */
+   /* to be called to disable and restore interrupts and the nesting    */
+   /* depth of the current critical section.                            */
+static BTPS_DisableInterruptsCallback_t DisableInterruptsCallback;
+static BTPS_RestoreInterruptsCallback_t RestoreInterruptsCallback;
+static unsigned int                     CriticalSectionNesting;
+
+   /* Variables which hold the registered stack (the first word and one */
+   /* past the last word) and the lowest word of the stack that is known*/
+   /* to have been used (every word below this is still painted).       */
+static unsigned long                   *StackBottom;
+static unsigned long                   *StackTop;
+static unsigned long                   *StackLowWater;
+
+#ifndef __linux__
+
+   /* Variables which are used to extend the Tick Count to 64 bits for  */
+   /* the default Timestamp (the number of times the Tick Count has     */
+   /* wrapped and the Tick Count when the Timestamp was last read).     */
+static unsigned long                TimestampTickCountHigh;
+static unsigned long                LastTimestampTickCount;
+
+#endif
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   /* Variable which holds the execution profile of each task (the final*/
+   /* entry is the overflow task).                                      */
+static ProfileTask_t                ProfileTaskList[SCHEDULER_PROFILE_MAXIMUM_TASKS + 1];
+
+   /* Variable which holds the upper bounds (in cycles) of all but the  */
+   /* final execution time histogram bin.                               */
+static BTPSCONST unsigned long      CycleBinLimit[BTPS_TASK_CYCLE_HISTOGRAM_BINS - 1] =
+{
+   (1UL << 10), (1UL << 13), (1UL << 16), (1UL << 19), (1UL << 22)
+};
+
+   /* Variables which hold the state of the CPU load measurement: the   */
+   /* tick count at which the current window started, the time spent in */
+   /* tasks during the current window, the length of the last complete  */
+   /* window, the time spent in tasks during that window and the time   */
+   /* spent in tasks since the statistics were reset.                   */
+static unsigned long                LoadWindowStartTick;
+static unsigned long                LoadWindowBusyCycles;
+static unsigned long                LastLoadWindowCycles;
+static unsigned long                LastLoadWindowBusyCycles;
+static QWord_t                      TotalBusyCycles;
+
+#endif
+
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+   /* Variable which holds the profile of each critical section (the    */
+   /* final entry is the overflow site).                                */
+static CriticalSectionSite_t        CriticalSectionSiteList[CRITICAL_SECTION_PROFILE_MAXIMUM_SITES + 1];
+
+   /* Variable which holds the upper bounds (in microseconds) of all but*/
+   /* the final histogram bin and the same bounds converted to cycles of*/
+   /* the registered cycle counter.                                     */
+static BTPSCONST unsigned long      CriticalSectionBinLimit[BTPS_CRITICAL_SECTION_HISTOGRAM_BINS - 1] =
+{
+   1, 5, 10, 20, 40
+};
+
+static unsigned long                CriticalSectionBinCycles[BTPS_CRITICAL_SECTION_HISTOGRAM_BINS - 1];
+
+   /* Variables which hold the site of the current (outermost) critical */
+   /* section and the counter value when it was entered.                */
+static BTPSCONST void              *CriticalSectionSite;
+static unsigned long                CriticalSectionStartCycles;
+
+#endif
+
+#ifdef STACK_PROFILE_ENABLED
+
+   /* Variable which holds the stack profile of each task (the final    */
+   /* entry is the overflow task).                                      */
+static StackProfileTask_t           StackProfileTaskList[STACK_PROFILE_MAXIMUM_TASKS + 1];
+
+#endif
+
    /* Internal Function Prototypes.                                     */
+static int FindLastSet(unsigned int Value);
+static int FindFirstSet(unsigned int Value);
+static void MapBlockSize(unsigned int Size, unsigned int *FirstLevel, unsigned int *SecondLevel);
+static void InsertFreeBlock(HeapInfo_t *HeapInfo, BlockInfo_t *BlockInfo);
+static void RemoveFreeBlock(HeapInfo_t *HeapInfo, BlockInfo_t *BlockInfo);
+static BlockInfo_t *FindFreeBlock(HeapInfo_t *HeapInfo, unsigned int Size);
+static unsigned int GetLargestFreeBlock(HeapInfo_t *HeapInfo);
 static void HeapInit(void *Heap, unsigned long Size);
 static void *MemAlloc(void *Heap, unsigned long Size);
 static void MemFree(void *Heap, void *MemoryPtr);
+static void *MemResize(void *Heap, void *MemoryPtr, unsigned long Size);
 static int GetHeapStatistics(void *Heap, BTPS_MemoryStatistics_t *MemoryStatistics, Boolean_t AdvancedStatitics);
+static HeapInfo_t *FindHeap(void *MemoryPtr);
+static Boolean_t RegionOverlapsHeap(void *Region, unsigned long RegionSize);
+
+static unsigned int AllocateSchedulerEntry(void);
+static void FreeSchedulerEntryInformation(unsigned int EntryIndex);
+static void QueueSetEntry(SchedulerQueue_t *Queue, unsigned int QueueIndex, unsigned int EntryIndex);
+static void QueueSiftUp(SchedulerQueue_t *Queue, unsigned int QueueIndex);
+static void QueueSiftDown(SchedulerQueue_t *Queue, unsigned int QueueIndex);
+static void QueueInsert(unsigned int EntryIndex);
+static void QueueRemove(unsigned int EntryIndex);
+static unsigned long ExecuteSchedulerEntry(unsigned int EntryIndex);
+static void DispatchEvents(void);
+static void ReadyCoroutine(BTPS_Coroutine_t *Coroutine);
+static void UnReadyCoroutine(BTPS_Coroutine_t *Coroutine);
+static void ResumeCoroutine(BTPS_Coroutine_t *Coroutine);
+static void ResumeReadyCoroutines(void);
+static void BTPSAPI CoroutineTimerCallback(void *TimerParameter);
+static int QuerySchedulerEntryStatistics(unsigned int EntryIndex, BTPS_TimerStatistics_t *TimerStatistics);
+static void UpdateMailboxOccupancy(MailboxHeader_t *MailboxHeader, unsigned int NumberAdded, unsigned int NumberRemoved);
+static unsigned int LocateByteMailboxMessage(ByteMailboxHeader_t *MailboxHeader);
+
+#ifdef PROFILE_TABLE_ENABLED
+
+static unsigned int FindProfileEntry(void *EntryList, unsigned int EntrySize, unsigned int NumberEntries, ProfileKey_t Key);
+static int SelectNextProfileEntry(void *EntryList, unsigned int EntrySize, unsigned int NumberEntries, ProfileEntryValueFunction_t GetEntryValue, int PreviousEntry);
+static void OutputProfileEntryName(ProfileKey_t Key);
 
-   /* The following function is used to initialize the heap structure.  */
-   /* The function takes no parameters and returns no status.           */
-static void HeapInit(void *Heap, unsigned long Size)
-{
-   HeapInfo_t *HeapInfo;
+#endif
 
-   HeapInfo = (HeapInfo_t *)Heap;
+#ifdef MEMORY_PROFILE_ENABLED
 
-   /* Confirm that the parameters are valid and that the heap has not   */
-   /* already been initialized.                                         */
-   if((HeapInfo) && (!(HeapInfo->Initialized)) && (Size > HEAP_INFO_SIZE(MINIMUM_MEMORY_SIZE)))
-   {
-      Size = (Size - HEAP_INFO_SIZE(0)) / ALIGNMENT_SIZE;
+static void ProfileAllocation(void *MemoryPtr, unsigned long Size, BTPSCONST void *Site, BTPSCONST char *Tag);
+static void ProfileFree(void *MemoryPtr);
+static void ProfileResize(void *MemoryPtr, unsigned int PreviousSize);
+static Boolean_t GetProfileSiteValue(void *Entry, QWord_t *Value);
+static int SelectNextProfileSite(int PreviousSite);
 
-      /* Confirm that the size is valid.                                */
-      if((Size >= MINIMUM_MEMORY_SIZE) && (Size <= MAXIMUM_MEMORY_SIZE))
-      {
-         /* Initialize the Heap information.                            */
-         BTPS_MemInitialize(HeapInfo, 0, sizeof(HeapInfo_t));
-         HeapInfo->HeapHead->PrevSize = Size;
-         HeapInfo->HeapHead->Size     = Size;
-         HeapInfo->HeapTail           = (BlockInfo_t *)(((Alignment_t *)HeapInfo->HeapHead) + Size);
+#endif
 
-         /* Indicate the heap has been initialized.                     */
-         HeapInfo->Initialized        = TRUE;
-      }
-   }
-}
+#ifdef MEMORY_TRACE_ENABLED
 
-   /* The following function is used to allocate a fragment of memory   */
-   /* from a large buffer.  The function takes as its parameter the size*/
-   /* in bytes of the fragment to be allocated.  The function tries to  */
-   /* avoid fragmentation by obtaining memory requests larger than      */
-   /* LARGE_SIZE from the end of the buffer, while small fragments are  */
-   /* taken from the start of the buffer.                               */
-static void *MemAlloc(void *Heap, unsigned long Size)
-{
-   void        *ret_val;
-   HeapInfo_t  *HeapInfo;
-   BlockInfo_t *BlockInfo;
-   BlockInfo_t *TempBlockInfo;
-   Word_t       RemainingSize;
+static unsigned int GetHeapID(HeapInfo_t *HeapInfo);
+static void FlushTrace(void);
+static void TraceOperation(char Operation, unsigned int HeapID, void *Pointer, void *PreviousPointer, unsigned long Size);
 
-   HeapInfo = (HeapInfo_t *)Heap;
+#endif
 
-   /* Convert the requested memory allocation in bytes to alignment     */
-   /* size, rounding up, and add the block info header size to it.      */
-   Size = BLOCK_INFO_SIZE((Size + (ALIGNMENT_SIZE - 1)) / ALIGNMENT_SIZE);
+static void CopyMemoryForward(unsigned char *Destination, BTPSCONST unsigned char *Source, unsigned long Size);
+static void CopyMemoryBackward(unsigned char *Destination, BTPSCONST unsigned char *Source, unsigned long Size);
+static unsigned long CountMatchingBytes(BTPSCONST unsigned char *Source1, BTPSCONST unsigned char *Source2, unsigned long Size);
+static unsigned int FormatString(char *Buffer, unsigned int BufferSize, BTPSCONST char *Format, va_list Arguments);
+static void OutputMessageArguments(BTPSCONST char *Format, va_list Arguments);
 
-   /* Verify that the parameters are valid.                             */
-   if((HeapInfo) && (HeapInfo->Initialized) && (Size >= MINIMUM_MEMORY_SIZE) && (Size <= MAXIMUM_MEMORY_SIZE))
+#ifdef DEFERRED_LOG_ENABLED
+
+static unsigned int CountLogArguments(BTPSCONST char *Format);
+static void FlushLog(unsigned int MaximumRecords);
+
+#endif
+static unsigned long *FindStackLowWater(unsigned long *Start, unsigned long *Limit);
+
+#ifdef STACK_PROFILE_ENABLED
+
+static void ProfileStackUsage(BTPS_SchedulerFunction_t TaskFunction);
+static void RepaintStack(void);
+static Boolean_t GetStackProfileTaskValue(void *Entry, QWord_t *Value);
+static int SelectNextStackProfileTask(int PreviousTask);
+
+#endif
+
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+static void ProfileCriticalSection(BTPSCONST void *Site, unsigned long Cycles);
+static Boolean_t GetCriticalSectionSiteValue(void *Entry, QWord_t *Value);
+static int SelectNextCriticalSectionSite(int PreviousSite);
+static unsigned long CyclesToMicroseconds(QWord_t Cycles);
+
+#endif
+
+#ifdef __linux__
+
+static unsigned long BTPSAPI GetMonotonicCycleCount(void);
+static QWord_t BTPSAPI GetMonotonicTimestamp(void);
+
+#else
+
+static QWord_t BTPSAPI GetTickCountTimestamp(void);
+
+#endif
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+static void ProfileTaskExecution(BTPS_SchedulerFunction_t TaskFunction, Boolean_t EventHandler, unsigned long Cycles);
+static void UpdateLoadWindow(unsigned long CurrentTickCount);
+static Boolean_t GetProfileTaskValue(void *Entry, QWord_t *Value);
+static int SelectNextProfileTask(int PreviousTask);
+
+#endif
+
+   /* The following function is used to determine the index of the most */
+   /* significant bit that is set in the specified value.  The function */
+   /* returns the zero based bit index, or a negative value if no bits  */
+   /* are set.                                                          */
+static int FindLastSet(unsigned int Value)
+{
+   int ret_val;
+
+   if(Value)
    {
-      /* Start at the beginning of the heap for small segments and the  */
-      /* end for large segments.                                        */
-      if(Size < LARGE_SIZE)
-         BlockInfo = HeapInfo->HeapHead;
-      else
-         BlockInfo = (BlockInfo_t *)(((Alignment_t *)(HeapInfo->HeapTail)) - HeapInfo->HeapHead->PrevSize);
+      ret_val = 0;
 
-      /* Loop until we have walked the entire list.                     */
-      while(((Size < LARGE_SIZE) || (BlockInfo != HeapInfo->HeapHead)) && (BlockInfo != HeapInfo->HeapTail))
+      /* Perform a binary search for the most significant bit so that   */
+      /* the time taken does not depend on the value.                   */
+      if(Value & 0xFF00)
       {
-         /* Check to see if the current entry is free and is large      */
-         /* enough to hold the data being requested.                    */
-         if((BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK) || (BlockInfo->Size < Size))
-         {
-            /* If the requested size is larger than the limit then      */
-            /* search backwards for an available buffer, else go        */
-            /* forward.  This will hopefully help to reduce             */
-            /* fragmentation problems.                                  */
-            if(Size >= LARGE_SIZE)
-               BlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) - (BlockInfo->PrevSize));
-            else
-               BlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + (BlockInfo->Size & SEGMENT_SIZE_BITMASK));
-         }
-         else
-         {
-            /* Suitable memory block found.                             */
-            break;
-         }
+         Value   >>= 8;
+         ret_val  += 8;
       }
 
-      /* Check to see if we found a segment large enough for the        */
-      /* request.                                                       */
-      if((BlockInfo != HeapInfo->HeapTail) && (BlockInfo->Size >= Size) && (!(BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK)))
+      if(Value & 0x00F0)
       {
-         /* Check to see if we need to split this into two entries.     */
-         /* * NOTE * If there is not enough room to make another entry  */
-         /*          then we will not adjust the size of this entry to  */
-         /*          match the amount requested.                        */
-         if((RemainingSize = BlockInfo->Size - Size) >= MINIMUM_MEMORY_SIZE)
-         {
-            /* If this is a large segment allocation, then split the    */
-            /* segment so that the free segment is at the beginning.    */
-            if(Size >= LARGE_SIZE)
-            {
-               /* Re-size the current block for the remaining space.    */
-               BlockInfo->Size = RemainingSize;
-
-               /* Initialize the new block, setting it to allocated.    */
-               BlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + RemainingSize);
-               BlockInfo->PrevSize = RemainingSize;
-               BlockInfo->Size     = Size | SEGMENT_ALLOCATED_BITMASK;
+         Value   >>= 4;
+         ret_val  += 4;
+      }
+
+      if(Value & 0x000C)
+      {
+         Value   >>= 2;
+         ret_val  += 2;
+      }
+
+      if(Value & 0x0002)
+         ret_val += 1;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is used to determine the index of the     */
+   /* least significant bit that is set in the specified value.  The    */
+   /* function returns the zero based bit index, or a negative value if */
+   /* no bits are set.                                                  */
+   /* * NOTE * Only the lower 16 bits of the value are considered.      */
+static int FindFirstSet(unsigned int Value)
+{
+   /* Isolate the least significant bit and find its index.            */
+   return(FindLastSet(Value & (~Value + 1)));
+}
+
+   /* The following function is used to map a block size (in           */
+   /* Alignment_t units) to the first and second level indexes of the   */
+   /* free list that holds blocks of this size.                         */
+static void MapBlockSize(unsigned int Size, unsigned int *FirstLevel, unsigned int *SecondLevel)
+{
+   int Index;
+
+   if(Size < SMALL_BLOCK_SIZE)
+   {
+      /* Small blocks each have their own class in the first list.      */
+      *FirstLevel  = 0;
+      *SecondLevel = Size;
+   }
+   else
+   {
+      /* Take the power of two range as the first level and the next    */
+      /* SECOND_LEVEL_INDEX_LOG2 bits below it as the second level.     */
+      Index        = FindLastSet(Size);
+      *SecondLevel = (Size >> (Index - SECOND_LEVEL_INDEX_LOG2)) ^ SECOND_LEVEL_INDEX_COUNT;
+      *FirstLevel  = (unsigned int)(Index - (FIRST_LEVEL_INDEX_SHIFT - 1));
+   }
+}
+
+   /* The following function is used to insert a free block into the   */
+   /* free list that corresponds to its size.                           */
+static void InsertFreeBlock(HeapInfo_t *HeapInfo, BlockInfo_t *BlockInfo)
+{
+   Word_t       Offset;
+   unsigned int FirstLevel;
+   unsigned int SecondLevel;
+
+   MapBlockSize(BlockInfo->Size, &FirstLevel, &SecondLevel);
+
+   Offset = BLOCK_TO_OFFSET(HeapInfo, BlockInfo);
+
+   /* Insert the block at the head of the list.                         */
+   FREE_BLOCK_PREV(BlockInfo) = FREE_LIST_NULL;
+   FREE_BLOCK_NEXT(BlockInfo) = HeapInfo->FreeListHead[FirstLevel][SecondLevel];
+
+   if(FREE_BLOCK_NEXT(BlockInfo) != FREE_LIST_NULL)
+      FREE_BLOCK_PREV(OFFSET_TO_BLOCK(HeapInfo, FREE_BLOCK_NEXT(BlockInfo))) = Offset;
+
+   HeapInfo->FreeListHead[FirstLevel][SecondLevel] = Offset;
+
+   /* Flag that the list is no longer empty.                            */
+   HeapInfo->FirstLevelBitmap              |= (1 << FirstLevel);
+   HeapInfo->SecondLevelBitmap[FirstLevel] |= (unsigned char)(1 << SecondLevel);
+
+   /* Update the free block statistics.                                 */
+   HeapInfo->FreeBlockCount++;
+   HeapInfo->FreeHeapSize += BlockInfo->Size;
+   HeapInfo->FreeClassCount[FirstLevel]++;
+}
+
+   /* The following function is used to remove a free block from the   */
+   /* free list that it is currently a member of.                       */
+static void RemoveFreeBlock(HeapInfo_t *HeapInfo, BlockInfo_t *BlockInfo)
+{
+   unsigned int FirstLevel;
+   unsigned int SecondLevel;
+
+   MapBlockSize(BlockInfo->Size, &FirstLevel, &SecondLevel);
+
+   /* Unlink the block from its neighbors in the list.                  */
+   if(FREE_BLOCK_NEXT(BlockInfo) != FREE_LIST_NULL)
+      FREE_BLOCK_PREV(OFFSET_TO_BLOCK(HeapInfo, FREE_BLOCK_NEXT(BlockInfo))) = FREE_BLOCK_PREV(BlockInfo);
+
+   if(FREE_BLOCK_PREV(BlockInfo) != FREE_LIST_NULL)
+      FREE_BLOCK_NEXT(OFFSET_TO_BLOCK(HeapInfo, FREE_BLOCK_PREV(BlockInfo))) = FREE_BLOCK_NEXT(BlockInfo);
+   else
+   {
+      /* This block is the head of the list, so move the head to the    */
+      /* next block and flag if the list is now empty.                  */
+      if((HeapInfo->FreeListHead[FirstLevel][SecondLevel] = FREE_BLOCK_NEXT(BlockInfo)) == FREE_LIST_NULL)
+      {
+         HeapInfo->SecondLevelBitmap[FirstLevel] &= (unsigned char)(~(1 << SecondLevel));
+
+         if(!(HeapInfo->SecondLevelBitmap[FirstLevel]))
+            HeapInfo->FirstLevelBitmap &= ~(1 << FirstLevel);
+      }
+   }
+
+   /* Update the free block statistics.                                 */
+   HeapInfo->FreeBlockCount--;
+   HeapInfo->FreeHeapSize -= BlockInfo->Size;
+   HeapInfo->FreeClassCount[FirstLevel]--;
+}
+
+   /* The following function is used to locate a free block that is at */
+   /* least the specified size (in Alignment_t units).  The function    */
+   /* returns a pointer to the block if one was found, or NULL if there */
+   /* is no free block large enough to satisfy the request.             */
+   /* * NOTE * The block that is returned is still a member of its free */
+   /*          list.                                                    */
+static BlockInfo_t *FindFreeBlock(HeapInfo_t *HeapInfo, unsigned int Size)
+{
+   int           Index;
+   Word_t        Offset;
+   BlockInfo_t  *ret_val;
+   unsigned int  Count;
+   unsigned int  FirstLevel;
+   unsigned int  SecondLevel;
+   unsigned int  SearchSize;
+   unsigned int  Bitmap;
+
+   ret_val = NULL;
+
+   /* Round the size up to the start of the next size class so that any */
+   /* block in the class that is found is guaranteed to be large enough.*/
+   if(Size >= SMALL_BLOCK_SIZE)
+      SearchSize = Size + (1 << (FindLastSet(Size) - SECOND_LEVEL_INDEX_LOG2)) - 1;
+   else
+      SearchSize = Size;
+
+   if(SearchSize <= MAXIMUM_MEMORY_SIZE)
+   {
+      MapBlockSize(SearchSize, &FirstLevel, &SecondLevel);
+
+      /* First search the remaining classes in this first level range,  */
+      /* then move on to the next non-empty first level range.          */
+      Bitmap = HeapInfo->SecondLevelBitmap[FirstLevel] & (((unsigned int)-1) << SecondLevel);
+      if(!Bitmap)
+      {
+         Bitmap = HeapInfo->FirstLevelBitmap & (((unsigned int)-1) << (FirstLevel + 1));
+         if((Index = FindFirstSet(Bitmap)) >= 0)
+         {
+            FirstLevel = (unsigned int)Index;
+            Bitmap     = HeapInfo->SecondLevelBitmap[FirstLevel];
+         }
+         else
+            Bitmap = 0;
+      }
+
+      if((Index = FindFirstSet(Bitmap)) >= 0)
+         ret_val = OFFSET_TO_BLOCK(HeapInfo, HeapInfo->FreeListHead[FirstLevel][Index]);
+   }
+
+   /* If nothing was found in the larger classes, the class of the      */
+   /* requested size may still hold a block that is large enough.  Only */
+   /* the first FREE_LIST_SEARCH_LIMIT blocks of this list are examined */
+   /* so that the time taken remains bounded.                           */
+   if((!ret_val) && (SearchSize != Size))
+   {
+      MapBlockSize(Size, &FirstLevel, &SecondLevel);
+
+      Offset = HeapInfo->FreeListHead[FirstLevel][SecondLevel];
+      for(Count = 0; (Offset != FREE_LIST_NULL) && (Count < FREE_LIST_SEARCH_LIMIT); Count++)
+      {
+         if(OFFSET_TO_BLOCK(HeapInfo, Offset)->Size >= Size)
+         {
+            ret_val = OFFSET_TO_BLOCK(HeapInfo, Offset);
+            break;
+         }
+
+         Offset = FREE_BLOCK_NEXT(OFFSET_TO_BLOCK(HeapInfo, Offset));
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to determine the size (in          */
+   /* Alignment_t units) of the largest free block in the specified     */
+   /* heap.  The function returns zero if there are no free blocks.     */
+   /* * NOTE * The largest free block is always in the highest non-empty*/
+   /*          size class.  Only the first block of that free list is   */
+   /*          examined so that the time taken is constant, which means */
+   /*          the value returned is approximate when the list holds    */
+   /*          more than one block.  It is never larger than the largest*/
+   /*          free block and is in the same size class, i.e. it is     */
+   /*          smaller by less than one SECOND_LEVEL_INDEX_COUNT'th of  */
+   /*          the size (and is exact for small blocks).                */
+static unsigned int GetLargestFreeBlock(HeapInfo_t *HeapInfo)
+{
+   int           FirstLevel;
+   int           SecondLevel;
+   unsigned int  ret_val;
+
+   ret_val = 0;
+
+   if((FirstLevel = FindLastSet(HeapInfo->FirstLevelBitmap)) >= 0)
+   {
+      if((SecondLevel = FindLastSet(HeapInfo->SecondLevelBitmap[FirstLevel])) >= 0)
+         ret_val = OFFSET_TO_BLOCK(HeapInfo, HeapInfo->FreeListHead[FirstLevel][SecondLevel])->Size;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to initialize the heap structure.  */
+   /* The function takes no parameters and returns no status.           */
+static void HeapInit(void *Heap, unsigned long Size)
+{
+   HeapInfo_t *HeapInfo;
+
+   HeapInfo = (HeapInfo_t *)Heap;
+
+   /* Confirm that the parameters are valid and that the heap has not   */
+   /* already been initialized.                                         */
+   if((HeapInfo) && (!(HeapInfo->Initialized)) && (Size > HEAP_INFO_SIZE(MINIMUM_MEMORY_SIZE)))
+   {
+      Size = (Size - HEAP_INFO_SIZE(0)) / ALIGNMENT_SIZE;
+
+      /* Confirm that the size is valid.                                */
+      if((Size >= MINIMUM_MEMORY_SIZE) && (Size <= MAXIMUM_MEMORY_SIZE))
+      {
+         /* Initialize the Heap information.                            */
+         BTPS_MemInitialize(HeapInfo, 0, sizeof(HeapInfo_t));
+         BTPS_MemInitialize(HeapInfo->FreeListHead, 0xFF, sizeof(HeapInfo->FreeListHead));
+
+         HeapInfo->HeapHead->PrevSize = 0;
+         HeapInfo->HeapHead->Size     = Size;
+         HeapInfo->HeapTail           = (BlockInfo_t *)(((Alignment_t *)HeapInfo->HeapHead) + Size);
+
+         /* The entire heap starts out as a single free block.          */
+         InsertFreeBlock(HeapInfo, HeapInfo->HeapHead);
+
+         /* Indicate the heap has been initialized.                     */
+         HeapInfo->Initialized        = TRUE;
+      }
+   }
+}
+
+   /* The following function is used to allocate a fragment of memory   */
+   /* from a large buffer.  The function takes as its parameter the size*/
+   /* in bytes of the fragment to be allocated.  A free block of a      */
+   /* suitable size is located in constant time using the segregated    */
+   /* free lists.  To help avoid fragmentation, memory requests larger  */
+   /* than LARGE_SIZE are taken from the end of the free block, while   */
+   /* small fragments are taken from the start of the free block.       */
+static void *MemAlloc(void *Heap, unsigned long Size)
+{
+   void        *ret_val;
+   HeapInfo_t  *HeapInfo;
+   BlockInfo_t *BlockInfo;
+   BlockInfo_t *TempBlockInfo;
+   Word_t       RemainingSize;
+
+   HeapInfo = (HeapInfo_t *)Heap;
+
+   /* Convert the requested memory allocation in bytes to alignment     */
+   /* size, rounding up, and add the block info header size to it.      */
+   Size = BLOCK_INFO_SIZE((Size + (ALIGNMENT_SIZE - 1)) / ALIGNMENT_SIZE);
+
+   /* Verify that the parameters are valid.                             */
+   if((HeapInfo) && (HeapInfo->Initialized) && (Size >= MINIMUM_MEMORY_SIZE) && (Size <= MAXIMUM_MEMORY_SIZE))
+   {
+      /* Check to see if we found a segment large enough for the        */
+      /* request.                                                       */
+      if((BlockInfo = FindFreeBlock(HeapInfo, (unsigned int)Size)) != NULL)
+      {
+         /* Remove the block from the free lists.                       */
+         RemoveFreeBlock(HeapInfo, BlockInfo);
+
+         /* Check to see if we need to split this into two entries.     */
+         /* * NOTE * If there is not enough room to make another entry  */
+         /*          then we will not adjust the size of this entry to  */
+         /*          match the amount requested.                        */
+         if((RemainingSize = BlockInfo->Size - Size) >= MINIMUM_MEMORY_SIZE)
+         {
+            /* If this is a large segment allocation, then split the    */
+            /* segment so that the free segment is at the beginning.    */
+            if(Size >= LARGE_SIZE)
+            {
+               /* Re-size the current block for the remaining space and */
+               /* return it to the free lists.                          */
+               BlockInfo->Size = RemainingSize;
+               InsertFreeBlock(HeapInfo, BlockInfo);
+
+               /* Initialize the new block, setting it to allocated.    */
+               BlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + RemainingSize);
+               BlockInfo->PrevSize = RemainingSize;
+               BlockInfo->Size     = Size | SEGMENT_ALLOCATED_BITMASK;
 
                /* Set the TmpBlock pointer to the current block and the */
                /* RemainingSize to its size for setting the previous    */
@@ -276,23 +1590,18 @@ static void *MemAlloc(void *Heap, unsigned long Size)
                /* Re-size the current block and set it as allocated.    */
                BlockInfo->Size = Size | SEGMENT_ALLOCATED_BITMASK;
 
-               /* Initialize the new block.                             */
+               /* Initialize the new block and return it to the free    */
+               /* lists.                                                */
                TempBlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + Size);
                TempBlockInfo->PrevSize = Size;
                TempBlockInfo->Size     = RemainingSize;
+               InsertFreeBlock(HeapInfo, TempBlockInfo);
             }
 
-            /* Calculate the pointer to the next segment, checking for a*/
-            /* wrap condition, and update the next segment's PrevSize   */
-            /* field.                                                   */
+            /* Calculate the pointer to the next segment and update the */
+            /* next segment's PrevSize field.                           */
             if((TempBlockInfo = (BlockInfo_t *)(((Alignment_t *)TempBlockInfo) + RemainingSize)) != HeapInfo->HeapTail)
                TempBlockInfo->PrevSize = RemainingSize;
-            else
-            {
-               /* This block is the last in the Heap so set the previous*/
-               /* size of the heap head instead.                        */
-               HeapInfo->HeapHead->PrevSize = RemainingSize;
-            }
          }
          else
          {
@@ -361,6 +1670,8 @@ static void MemFree(void *Heap, void *MemoryPtr)
             if(!(TempBlockInfo->Size & SEGMENT_ALLOCATED_BITMASK))
             {
                /* Combine this segment with the newly freed segment.    */
+               RemoveFreeBlock(HeapInfo, TempBlockInfo);
+
                TempBlockInfo->Size += BlockInfo->Size;
                BlockInfo = TempBlockInfo;
             }
@@ -371,22 +1682,166 @@ static void MemFree(void *Heap, void *MemoryPtr)
          {
             if(!(TempBlockInfo->Size & SEGMENT_ALLOCATED_BITMASK))
             {
-               BlockInfo->Size += TempBlockInfo->Size;
+               RemoveFreeBlock(HeapInfo, TempBlockInfo);
 
+               BlockInfo->Size += TempBlockInfo->Size;
             }
          }
 
          /* Update the previous size of the next block.                 */
          if((TempBlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + BlockInfo->Size)) != HeapInfo->HeapTail)
             TempBlockInfo->PrevSize = BlockInfo->Size;
+
+         /* Finally return the combined block to the free lists.        */
+         InsertFreeBlock(HeapInfo, BlockInfo);
+      }
+   }
+}
+
+   /* The following function is used to resize memory that was          */
+   /* previously allocated with MemAlloc without moving it to a new     */
+   /* block.  The function takes as its parameters the pointer to the   */
+   /* memory that was allocated and the new size in bytes.  The block is*/
+   /* shrunk (returning the excess to the free lists) or grown by       */
+   /* absorbing the following free block and, if that is not enough,    */
+   /* the preceding free block (in which case the data is moved down).  */
+   /* The function returns a pointer to the (possibly moved) memory if  */
+   /* successful, or NULL if the block could not be resized in place (in*/
+   /* which case the block is left untouched).                          */
+static void *MemResize(void *Heap, void *MemoryPtr, unsigned long Size)
+{
+   void          *ret_val;
+   HeapInfo_t    *HeapInfo;
+   BlockInfo_t   *BlockInfo;
+   BlockInfo_t   *TempBlockInfo;
+   BlockInfo_t   *NextBlockInfo;
+   unsigned int   CurrentSize;
+   unsigned int   AvailableSize;
+#ifdef MEMORY_PROFILE_ENABLED
+   Word_t         SiteIndex;
+   unsigned long  AllocationTick;
+#endif
+
+   HeapInfo = (HeapInfo_t *)Heap;
+   ret_val  = NULL;
+
+   /* Convert the requested memory size in bytes to alignment size,     */
+   /* rounding up, and add the block info header size to it.            */
+   Size = BLOCK_INFO_SIZE((Size + (ALIGNMENT_SIZE - 1)) / ALIGNMENT_SIZE);
+   if(Size < MINIMUM_MEMORY_SIZE)
+      Size = MINIMUM_MEMORY_SIZE;
+
+   /* Verify that the parameters are valid.                             */
+   if((HeapInfo) && (HeapInfo->Initialized) && (MemoryPtr) && (HEAP_CONTAINS(HeapInfo, MemoryPtr)) && (Size <= MAXIMUM_MEMORY_SIZE))
+   {
+      BlockInfo = (BlockInfo_t *)(((Alignment_t *)MemoryPtr) - BLOCK_INFO_SIZE(0));
+
+      /* Verify that this segment is allocated.                         */
+      if(BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK)
+      {
+         CurrentSize   = BlockInfo->Size & SEGMENT_SIZE_BITMASK;
+         AvailableSize = CurrentSize;
+
+         /* Determine if the following block is free and can be         */
+         /* absorbed.                                                   */
+         if(((NextBlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + CurrentSize)) < HeapInfo->HeapTail) && (!(NextBlockInfo->Size & SEGMENT_ALLOCATED_BITMASK)))
+            AvailableSize += NextBlockInfo->Size;
          else
+            NextBlockInfo = NULL;
+
+         if(Size <= AvailableSize)
+         {
+            /* The block can be resized where it is.                    */
+            if(NextBlockInfo)
+               RemoveFreeBlock(HeapInfo, NextBlockInfo);
+
+            ret_val = MemoryPtr;
+         }
+         else
+         {
+            /* Check to see if the preceding block is free and, combined*/
+            /* with this block (and the following block), is large      */
+            /* enough.                                                  */
+            if(BlockInfo != HeapInfo->HeapHead)
+            {
+               TempBlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) - BlockInfo->PrevSize);
+
+               if((!(TempBlockInfo->Size & SEGMENT_ALLOCATED_BITMASK)) && (Size <= (AvailableSize + TempBlockInfo->Size)))
+               {
+                  RemoveFreeBlock(HeapInfo, TempBlockInfo);
+
+                  if(NextBlockInfo)
+                     RemoveFreeBlock(HeapInfo, NextBlockInfo);
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+                  /* Preserve the profile information of the block as   */
+                  /* the header is about to move.                       */
+                  SiteIndex      = BlockInfo->SiteIndex;
+                  AllocationTick = BlockInfo->AllocationTick;
+
+#endif
+
+                  /* Move the data down to the start of the preceding   */
+                  /* block.                                             */
+                  AvailableSize += TempBlockInfo->Size;
+
+                  BTPS_MemMove(TempBlockInfo->Data, BlockInfo->Data, (CurrentSize - BLOCK_INFO_SIZE(0)) * ALIGNMENT_SIZE);
+
+                  BlockInfo = TempBlockInfo;
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+                  BlockInfo->SiteIndex      = SiteIndex;
+                  BlockInfo->AllocationTick = AllocationTick;
+
+#endif
+
+                  ret_val = (void *)(BlockInfo->Data);
+               }
+            }
+         }
+
+         if(ret_val)
          {
-            /* This is the last block so adjust the previous size of the*/
-            /* first block instead.                                     */
-            HeapInfo->HeapHead->PrevSize = BlockInfo->Size;
+            /* The block now spans AvailableSize units.  Split off any  */
+            /* excess as a new free block.                              */
+            /* * NOTE * Any free neighbours have already been absorbed, */
+            /*          so the excess never needs to be combined with   */
+            /*          the block that follows it.                      */
+            HeapInfo->CurrentHeapUsed -= CurrentSize;
+
+            if((AvailableSize - Size) >= MINIMUM_MEMORY_SIZE)
+            {
+               BlockInfo->Size         = Size | SEGMENT_ALLOCATED_BITMASK;
+
+               TempBlockInfo           = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + Size);
+               TempBlockInfo->PrevSize = Size;
+               TempBlockInfo->Size     = AvailableSize - Size;
+               InsertFreeBlock(HeapInfo, TempBlockInfo);
+
+               AvailableSize           = TempBlockInfo->Size;
+            }
+            else
+            {
+               BlockInfo->Size = AvailableSize | SEGMENT_ALLOCATED_BITMASK;
+               TempBlockInfo   = BlockInfo;
+               Size            = AvailableSize;
+            }
+
+            /* Update the previous size of the next block.              */
+            if((TempBlockInfo = (BlockInfo_t *)(((Alignment_t *)TempBlockInfo) + AvailableSize)) != HeapInfo->HeapTail)
+               TempBlockInfo->PrevSize = AvailableSize;
+
+            /* Adjust the memory statistics.                            */
+            HeapInfo->CurrentHeapUsed += Size;
+            if(HeapInfo->MaximumHeapUsed < HeapInfo->CurrentHeapUsed)
+               HeapInfo->MaximumHeapUsed = HeapInfo->CurrentHeapUsed;
          }
       }
    }
+
+   return(ret_val);
 }
 
    /* The following function will find statistics for current heap      */
@@ -401,7 +1856,6 @@ static int GetHeapStatistics(void *Heap, BTPS_MemoryStatistics_t *MemoryStatisti
 {
    int          ret_val;
    HeapInfo_t  *HeapInfo;
-   BlockInfo_t *BlockInfo;
 
    HeapInfo = (HeapInfo_t *)Heap;
 
@@ -417,29 +1871,12 @@ static int GetHeapStatistics(void *Heap, BTPS_MemoryStatistics_t *MemoryStatisti
 
       if(AdvancedStatitics)
       {
-         /* Walk the heap and calculate the advanced statistics.        */
-         BlockInfo = HeapInfo->HeapHead;
-
-         while(BlockInfo < HeapInfo->HeapTail)
-         {
-            if(!(BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK))
-            {
-               /* Block is unallocated.                                 */
-               MemoryStatistics->FreeFragmentCount ++;
-
-               if(MemoryStatistics->LargestFreeFragment < BlockInfo->Size)
-                  MemoryStatistics->LargestFreeFragment = BlockInfo->Size;
-            }
-
-            /* Adjust the pointer to the next entry.                    */
-            BlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + (BlockInfo->Size & SEGMENT_SIZE_BITMASK));
-         }
-
-         /* Convert the size of the largest free fragment to bytes.     */
-         MemoryStatistics->LargestFreeFragment *= ALIGNMENT_SIZE;
+         /* The free block statistics are maintained as the heap is     */
+         /* used, so there is no need to walk the heap.                 */
+         MemoryStatistics->FreeFragmentCount   = HeapInfo->FreeBlockCount;
+         MemoryStatistics->LargestFreeFragment = GetLargestFreeBlock(HeapInfo) * ALIGNMENT_SIZE;
       }
 
-
       ret_val = 0;
    }
    else
@@ -461,447 +1898,4942 @@ int BTPSAPI BTPS_QueryMemoryUsage(BTPS_MemoryStatistics_t *MemoryStatistics, Boo
    return(GetHeapStatistics(MemoryBuffer, MemoryStatistics, AdvancedStatitics));
 }
 
-   /* The following function is responsible for delaying the current    */
-   /* task for the specified duration (specified in Milliseconds).      */
-   /* * NOTE * Very small timeouts might be smaller in granularity than */
-   /*          the system can support !!!!                              */
-void BTPSAPI BTPS_Delay(unsigned long MilliSeconds)
+   /* The following function is used to locate the registered heap that */
+   /* the specified memory pointer was allocated from.  The function    */
+   /* returns a pointer to the heap, or NULL if the pointer does not lie*/
+   /* within any registered heap.                                       */
+static HeapInfo_t *FindHeap(void *MemoryPtr)
 {
-   unsigned long StartTickCount;
-   unsigned long ElapsedTicks;
-   unsigned long CurrentTicks;
-
-   /* Increment the delay time by one millisecond to ensure that the    */
-   /* caller gets at least as much time as they requested.              */
-   MilliSeconds += 1;
-
-   ElapsedTicks  = 0;
-   StartTickCount = BTPS_GetTickCount();
+   HeapInfo_t   *ret_val;
+   unsigned int  Index;
 
-   while(ElapsedTicks < MilliSeconds)
+   /* Check the default heap first as this is by far the most common    */
+   /* case.                                                             */
+   if(HEAP_CONTAINS((HeapInfo_t *)MemoryBuffer, MemoryPtr))
+      ret_val = (HeapInfo_t *)MemoryBuffer;
+   else
    {
-      CurrentTicks = BTPS_GetTickCount();
-
-      if(CurrentTicks >= StartTickCount)
-      {
-         ElapsedTicks = CurrentTicks - StartTickCount;
-      }
-      else
+      for(Index = 1, ret_val = NULL; (Index < NumberHeaps) && (!ret_val); Index++)
       {
-         ElapsedTicks = ((0xFFFFFFFFUL - StartTickCount) + 1) + CurrentTicks;
+         if((HeapList[Index]) && (HEAP_CONTAINS(HeapList[Index], MemoryPtr)))
+            ret_val = HeapList[Index];
       }
    }
+
+   return(ret_val);
 }
 
-   /* The following function is responsible for retrieving the current  */
-   /* Tick Count of system.  This function returns the System Tick Count*/
-   /* in Milliseconds resolution.                                       */
-unsigned long BTPSAPI BTPS_GetTickCount(void)
+   /* The following function is used to determine if the specified      */
+   /* memory region overlaps the default heap or any heap that has been */
+   /* registered.  The function returns TRUE if the region overlaps a   */
+   /* heap, or FALSE otherwise.                                         */
+static Boolean_t RegionOverlapsHeap(void *Region, unsigned long RegionSize)
 {
-   /* Simply wrap the application-supplied get tick count function.     */
-   if(GetTickCountCallback)
-      return((*GetTickCountCallback)());
-   else
-      return(0);
-}
+   Boolean_t    ret_val;
+   unsigned int Index;
 
-   /* The following function is provided to allow a mechanism for adding*/
-   /* Scheduler Functions to the Scheduler.  These functions are called */
-   /* periodically by the Scheduler (based upon the requested Schedule  */
-   /* Period).  This function accepts as input the Scheduler Function to*/
-   /* add to the Scheduler, the Scheduler parameter that is passed to   */
-   /* the Scheduled function, and the Scheduler Period.  The Scheduler  */
-   /* Period is specified in Milliseconds.  This function returns TRUE  */
-   /* if the function was added successfully or FALSE if there was an   */
-   /* error.                                                            */
-   /* * NOTE * Once a function is added to the Scheduler, it can only be*/
-   /*          removed by calling the BTPS_DeleteFunctionFromScheduler()*/
-   /*          function.                                                */
-   /* * NOTE * The BTPS_ExecuteScheduler() function *MUST* be called    */
-   /*          ONCE (AND ONLY ONCE) to begin the Scheduler Executing    */
-   /*          periodic Scheduled functions (or calling the             */
-   /*          BTPS_ProcessScheduler() function repeatedly.             */
-Boolean_t BTPSAPI BTPS_AddFunctionToScheduler(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, unsigned int Period)
-{
-   Boolean_t ret_val;
+   /* The default heap is checked against the entire buffer (whether or */
+   /* not it has been initialized).                                     */
+   ret_val = (Boolean_t)((((unsigned char *)Region) < (((unsigned char *)MemoryBuffer) + sizeof(MemoryBuffer))) && ((((unsigned char *)Region) + RegionSize) > ((unsigned char *)MemoryBuffer)));
 
-   /* First, let's make sure that the Scheduler has been initialized    */
-   /* successfully AND that the Scheduler is NOT full.                  */
-   if((SchedulerInitialized) && (NumberScheduledFunctions != MAX_NUMBER_SCHEDULE_FUNCTIONS))
+   for(Index = 1; (Index < NumberHeaps) && (!ret_val); Index++)
    {
-      /* Next, let's make sure that the Scheduled Function specified    */
-      /* appears to be semi-valid.                                      */
-      if(SchedulerFunction)
-      {
-         /* Simply add the Scheduled Function into the Next available   */
-         /* Schedule Slot.                                              */
-         SchedulerInformation[NumberScheduledFunctions].ScheduleCount     = 0;
-         SchedulerInformation[NumberScheduledFunctions].ScheduleFunction  = SchedulerFunction;
-         SchedulerInformation[NumberScheduledFunctions].ScheduleParameter = SchedulerParameter;
-
-#if BTPS_MINIMUM_SCHEDULER_RESOLUTION
-
-         if(Period < BTPS_MINIMUM_SCHEDULER_RESOLUTION)
-            Period = BTPS_MINIMUM_SCHEDULER_RESOLUTION;
-
-#endif
-
-         SchedulerInformation[NumberScheduledFunctions].ScheduleExpireCount = Period;
-
-         /* Update the total number of Functions that have been added to*/
-         /* the Scheduler.                                              */
-         NumberScheduledFunctions++;
-
-         /* Finally return success to the caller.                       */
+      if((HeapList[Index]) && (((unsigned char *)Region) < ((unsigned char *)HeapList[Index]->HeapTail)) && ((((unsigned char *)Region) + RegionSize) > ((unsigned char *)HeapList[Index])))
          ret_val = TRUE;
-      }
-      else
-         ret_val = FALSE;
    }
-   else
-      ret_val = FALSE;
 
-   /* Finally return the result to the caller.                          */
    return(ret_val);
 }
 
-   /* The following function is provided to allow a mechanism for       */
-   /* deleting a Function that has previously been registered with the  */
-   /* Scheduler via a successful call to the                            */
-   /* BTPS_AddFunctionToScheduler() function.  This function accepts as */
-   /* input the Scheduler Function to that was added to the Scheduler,  */
-   /* as well as the Scheduler Parameter that was registered.  Both of  */
-   /* these values *must* match to remove a specific Scheduler Entry.   */
-void BTPSAPI BTPS_DeleteFunctionFromScheduler(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter)
+   /* The following function is used to allocate a free Scheduler Entry */
+   /* (growing the Scheduler Entry table and the deadline queue if there*/
+   /* are no free entries).  The function returns the index of the      */
+   /* entry if successful or SCHEDULER_ENTRY_INVALID if there is not    */
+   /* enough memory.                                                    */
+   /* * NOTE * The table may be moved when it grows so pointers to      */
+   /*          Scheduler Entries must not be held across this call.     */
+static unsigned int AllocateSchedulerEntry(void)
 {
-   unsigned int Index;
+   unsigned int            ret_val;
+   unsigned int            Index;
+   unsigned int            NewNumberEntries;
+   unsigned int           *NewQueue;
+   SchedulerInformation_t *NewInformation;
 
-   /* First, let's make sure that the Scheduler has been initialized    */
-   /* successfully AND that the Scheduler is NOT full.                  */
-   if(SchedulerInitialized)
+   if((FreeSchedulerEntry == SCHEDULER_ENTRY_INVALID) && (NumberSchedulerEntries < SCHEDULER_ENTRY_MAXIMUM))
    {
-      /* Next, let's make sure that the Scheduled Function specified    */
-      /* appears to be semi-valid.                                      */
-      if(SchedulerFunction)
+      NewNumberEntries = NumberSchedulerEntries + BTPS_SCHEDULER_ENTRY_GROWTH;
+      if(NewNumberEntries > SCHEDULER_ENTRY_MAXIMUM)
+         NewNumberEntries = SCHEDULER_ENTRY_MAXIMUM;
+
+      /* Grow the queues first, a queue that is larger than the table is*/
+      /* harmless if the table is unable to grow.  Every queue must be  */
+      /* able to hold every entry.                                      */
+      for(Index = 0; Index < BTPS_SCHEDULER_NUMBER_PRIORITIES; Index++)
       {
-         /* Loop through the scheduler and remove the function (if we   */
-         /* find it).                                                   */
-         for(Index = 0; Index < NumberScheduledFunctions; Index++)
-         {
-            if((SchedulerInformation[Index].ScheduleFunction == SchedulerFunction) && (SchedulerInformation[Index].ScheduleParameter == SchedulerParameter))
-               break;
-         }
+         if((NewQueue = (unsigned int *)BTPS_ReallocateMemory(SchedulerQueue[Index].EntryList, NewNumberEntries * sizeof(unsigned int))) != NULL)
+            SchedulerQueue[Index].EntryList = NewQueue;
+         else
+            break;
+      }
 
-         /* Check to see if we have found the scheduled function.  Also,*/
-         /* if we have we need to copy all the functions in the         */
-         /* scheduler that exist AFTER the current index into the       */
-         /* Scheduler array starting at the index that was found above. */
-         if(Index < NumberScheduledFunctions)
+      if(Index == BTPS_SCHEDULER_NUMBER_PRIORITIES)
+      {
+         if((NewInformation = (SchedulerInformation_t *)BTPS_ReallocateMemory(SchedulerInformation, NewNumberEntries * sizeof(SchedulerInformation_t))) != NULL)
          {
-            /* Simply start copying from the next location back one in  */
-            /* the array.                                               */
-            for(Index++;Index<NumberScheduledFunctions;Index++)
+            SchedulerInformation = NewInformation;
+
+            /* Add the new entries to the free list.                    */
+            BTPS_MemInitialize(&(SchedulerInformation[NumberSchedulerEntries]), 0, (NewNumberEntries - NumberSchedulerEntries) * sizeof(SchedulerInformation_t));
+
+            for(Index = NewNumberEntries; Index-- > NumberSchedulerEntries;)
             {
-               SchedulerInformation[Index - 1].ScheduleCount       = SchedulerInformation[Index].ScheduleCount;
-               SchedulerInformation[Index - 1].ScheduleFunction    = SchedulerInformation[Index].ScheduleFunction;
-               SchedulerInformation[Index - 1].ScheduleParameter   = SchedulerInformation[Index].ScheduleParameter;
-               SchedulerInformation[Index - 1].ScheduleExpireCount = SchedulerInformation[Index].ScheduleExpireCount;
+               SchedulerInformation[Index].QueueIndex = FreeSchedulerEntry;
+               FreeSchedulerEntry                     = Index;
             }
 
-            /* Update the total number of Functions that have been added*/
-            /* to the Scheduler.                                        */
-            NumberScheduledFunctions--;
+            NumberSchedulerEntries = NewNumberEntries;
          }
       }
    }
+
+   /* Remove the first entry from the free list.                        */
+   if((ret_val = FreeSchedulerEntry) != SCHEDULER_ENTRY_INVALID)
+   {
+      FreeSchedulerEntry = SchedulerInformation[ret_val].QueueIndex;
+
+      SchedulerInformation[ret_val].TimerID = SCHEDULER_ENTRY_TO_TIMER_ID(ret_val, TIMER_ID_GENERATION(SchedulerInformation[ret_val].TimerID) + 1);
+   }
+
+   return(ret_val);
 }
 
-   /* The following function begins execution of the actual Scheduler.  */
-   /* Once this function is called, it NEVER returns.  This function is */
-   /* responsible for executing all functions that have been added to   */
-   /* the Scheduler with the BTPS_AddFunctionToScheduler() function.    */
-void BTPSAPI BTPS_ExecuteScheduler(void)
+   /* The following function is used to return the specified Scheduler  */
+   /* Entry to the list of free entries.                                */
+static void FreeSchedulerEntryInformation(unsigned int EntryIndex)
 {
-   Boolean_t Done;
+   SchedulerInformation[EntryIndex].State      = SCHEDULER_ENTRY_STATE_FREE;
+   SchedulerInformation[EntryIndex].QueueIndex = FreeSchedulerEntry;
+   FreeSchedulerEntry                          = EntryIndex;
+}
 
-   /* Initialize the Scheduler state information.                       */
-   Done = FALSE;
+   /* The following function is used to place the specified Scheduler   */
+   /* Entry at the specified position of the specified deadline queue.  */
+static void QueueSetEntry(SchedulerQueue_t *Queue, unsigned int QueueIndex, unsigned int EntryIndex)
+{
+   Queue->EntryList[QueueIndex]                = EntryIndex;
+   SchedulerInformation[EntryIndex].QueueIndex = QueueIndex;
+}
 
-   /* Simply loop until Done (Forever), calling each scheduled function */
-   /* when it expires.                                                  */
-   while(!Done)
+   /* The following function is used to move the entry at the specified */
+   /* position of the specified deadline queue towards the start of the */
+   /* queue until its deadline is not before the deadline of its parent.*/
+static void QueueSiftUp(SchedulerQueue_t *Queue, unsigned int QueueIndex)
+{
+   unsigned int EntryIndex;
+   unsigned int ParentIndex;
+
+   EntryIndex = Queue->EntryList[QueueIndex];
+
+   while(QueueIndex)
    {
-      /* Simply process the scheduler.                                  */
-      BTPS_ProcessScheduler();
+      ParentIndex = (QueueIndex - 1) >> 1;
+
+      if(DEADLINE_BEFORE(SchedulerInformation[EntryIndex].Deadline, SchedulerInformation[Queue->EntryList[ParentIndex]].Deadline))
+      {
+         QueueSetEntry(Queue, QueueIndex, Queue->EntryList[ParentIndex]);
+
+         QueueIndex = ParentIndex;
+      }
+      else
+         break;
    }
+
+   QueueSetEntry(Queue, QueueIndex, EntryIndex);
 }
 
-   /* The following function is provided to allow a mechanism to process*/
-   /* the scheduled functions in the scheduler.  This function performs */
-   /* the same functionality as the BTPS_ExecuteScheduler() function    */
-   /* except that it returns as soon as it has made an iteration through*/
-   /* the scheduled functions.  This function is provided for platforms */
-   /* that would like to implement their own processing loop and/or     */
-   /* scheduler and not rely on the Bluetopia implementation.           */
-   /* * NOTE * This function should NEVER be called if the              */
-   /*          BTPS_ExecuteScheduler() schema is used.                  */
-   /* * NOTE * This function *MUST* not be called from any scheduled    */
-   /*          function that was added to the scheduler via the         */
-   /*          BTPS_AddFunctionToScheduler() function or an infinite    */
-   /*          loop will occur.                                         */
-void BTPSAPI BTPS_ProcessScheduler(void)
+   /* The following function is used to move the entry at the specified */
+   /* position of the specified deadline queue towards the end of the   */
+   /* queue until neither of its children has an earlier deadline.      */
+static void QueueSiftDown(SchedulerQueue_t *Queue, unsigned int QueueIndex)
 {
-   unsigned int  SchedulerPointer;
-   unsigned long ElapsedTicks;
-   unsigned long CurrentTickCount;
+   unsigned int EntryIndex;
+   unsigned int ChildIndex;
 
-   /* First, let's calculate the Elapsed Number of Ticks that have      */
-   /* occurred since the last time through the scheduler (taking into   */
-   /* account the possibility that the Tick Counter could have wrapped).*/
-   CurrentTickCount = BTPS_GetTickCount();
-   ElapsedTicks     = CurrentTickCount - PreviousTickCount;
+   EntryIndex = Queue->EntryList[QueueIndex];
 
-   if(ElapsedTicks)
+   while((ChildIndex = (QueueIndex << 1) + 1) < Queue->NumberEntries)
    {
-      /* Now that we have calculated the Elapsed Time, let's increment  */
-      /* the Scheduler Count for each Scheduled Function by the Elapsed */
-      /* Tick Amount.                                                   */
-      SchedulerPointer = 0;
-      while(SchedulerPointer < NumberScheduledFunctions)
-      {
-         SchedulerInformation[SchedulerPointer].ScheduleCount += ElapsedTicks;
+      /* Select the child with the earliest deadline.                   */
+      if(((ChildIndex + 1) < Queue->NumberEntries) && (DEADLINE_BEFORE(SchedulerInformation[Queue->EntryList[ChildIndex + 1]].Deadline, SchedulerInformation[Queue->EntryList[ChildIndex]].Deadline)))
+         ChildIndex++;
 
-         if(SchedulerInformation[SchedulerPointer].ScheduleCount >= SchedulerInformation[SchedulerPointer].ScheduleExpireCount)
-         {
-            /* Simply call the Scheduled function.                      */
-            (*(BTPS_SchedulerFunction_t)(SchedulerInformation[SchedulerPointer].ScheduleFunction))(SchedulerInformation[SchedulerPointer].ScheduleParameter);
-
-            /* Reset the current Schedule Count back to zero.           */
-            SchedulerInformation[SchedulerPointer].ScheduleCount = 0;
-         }
+      if(DEADLINE_BEFORE(SchedulerInformation[Queue->EntryList[ChildIndex]].Deadline, SchedulerInformation[EntryIndex].Deadline))
+      {
+         QueueSetEntry(Queue, QueueIndex, Queue->EntryList[ChildIndex]);
 
-         SchedulerPointer++;
+         QueueIndex = ChildIndex;
       }
-
-      /* Note the last time that we processed the scheduler.            */
-      PreviousTickCount = CurrentTickCount;
+      else
+         break;
    }
+
+   QueueSetEntry(Queue, QueueIndex, EntryIndex);
 }
 
-   /* The following function is provided to allow a mechanism to        */
-   /* actually allocate a Block of Memory (of at least the specified    */
-   /* size).  This function accepts as input the size (in Bytes) of the */
-   /* Block of Memory to be allocated.  This function returns a NON-NULL*/
-   /* pointer to this Memory Buffer if the Memory was successfully      */
-   /* allocated, or a NULL value if the memory could not be allocated.  */
-void *BTPSAPI BTPS_AllocateMemory(unsigned long MemorySize)
+   /* The following function is used to add the specified Scheduler     */
+   /* Entry to the deadline queue of its priority class.                */
+static void QueueInsert(unsigned int EntryIndex)
 {
-   void *ret_val;
+   SchedulerQueue_t *Queue;
 
-   ret_val = MemAlloc(MemoryBuffer, MemorySize);
+   Queue = &(SchedulerQueue[SchedulerInformation[EntryIndex].Priority]);
 
-   if(!ret_val)
-      DBG_MSG(DBG_ZONE_BTPSKRNL, ("Malloc Failed: %d.\r\n", MemorySize));
+   SchedulerInformation[EntryIndex].State = SCHEDULER_ENTRY_STATE_QUEUED;
 
-   /* Finally return the result to the caller.                          */
-   return(ret_val);
-}
+   QueueSetEntry(Queue, Queue->NumberEntries, EntryIndex);
 
-   /* The following function is responsible for de-allocating a Block of*/
-   /* Memory that was successfully allocated with the                   */
-   /* BTPS_AllocateMemory() function.  This function accepts a NON-NULL */
-   /* Memory Pointer which was returned from the BTPS_AllocateMemory()  */
-   /* function.  After this function completes the caller CANNOT use ANY*/
-   /* of the Memory pointed to by the Memory Pointer.                   */
-void BTPSAPI BTPS_FreeMemory(void *MemoryPointer)
-{
-   MemFree(MemoryBuffer, MemoryPointer);
-}
+   QueueSiftUp(Queue, Queue->NumberEntries++);
 
-   /* The following function is responsible for copying a block of      */
-   /* memory of the specified size from the specified source pointer to */
-   /* the specified destination memory pointer.  This function accepts  */
-   /* as input a pointer to the memory block that is to be Destination  */
-   /* Buffer (first parameter), a pointer to memory block that points to*/
-   /* the data to be copied into the destination buffer, and the size   */
-   /* (in bytes) of the Data to copy.  The Source and Destination Memory*/
-   /* Buffers must contain AT LEAST as many bytes as specified by the   */
-   /* Size parameter.                                                   */
-   /* * NOTE * This function does not allow the overlapping of the      */
-   /*          Source and Destination Buffers !!!!                      */
-void BTPSAPI BTPS_MemCopy(void *Destination, BTPSCONST void *Source, unsigned long Size)
-{
-   /* Simply wrap the C Run-Time memcpy() function.                     */
-   memcpy(Destination, Source, Size);
+   NumberScheduledFunctions++;
 }
 
-   /* The following function is responsible for moving a block of memory*/
-   /* of the specified size from the specified source pointer to the    */
-   /* specified destination memory pointer.  This function accepts as   */
-   /* input a pointer to the memory block that is to be Destination     */
-   /* Buffer (first parameter), a pointer to memory block that points to*/
-   /* the data to be copied into the destination buffer, and the size   */
-   /* (in bytes) of the Data to copy.  The Source and Destination Memory*/
-   /* Buffers must contain AT LEAST as many bytes as specified by the   */
-   /* Size parameter.                                                   */
-   /* * NOTE * This function DOES allow the overlapping of the Source   */
-   /*          and Destination Buffers.                                 */
-void BTPSAPI BTPS_MemMove(void *Destination, BTPSCONST void *Source, unsigned long Size)
+   /* The following function is used to remove the specified (queued)   */
+   /* Scheduler Entry from the deadline queue of its priority class.    */
+static void QueueRemove(unsigned int EntryIndex)
 {
-   /* Simply wrap the C Run-Time memmove() function.                    */
-   memmove(Destination, Source, Size);
-}
+   unsigned int      QueueIndex;
+   SchedulerQueue_t *Queue;
 
-   /* The following function is provided to allow a mechanism to fill a */
-   /* block of memory with the specified value.  This function accepts  */
-   /* as input a pointer to the Data Buffer (first parameter) that is to*/
-   /* filled with the specified value (second parameter).  The final    */
-   /* parameter to this function specifies the number of bytes that are */
-   /* to be filled in the Data Buffer.  The Destination Buffer must     */
-   /* point to a Buffer that is AT LEAST the size of the Size parameter.*/
-void BTPSAPI BTPS_MemInitialize(void *Destination, unsigned char Value, unsigned long Size)
-{
-   /* Simply wrap the C Run-Time memset() function.                     */
-   memset(Destination, Value, Size);
-}
+   Queue      = &(SchedulerQueue[SchedulerInformation[EntryIndex].Priority]);
+   QueueIndex = SchedulerInformation[EntryIndex].QueueIndex;
 
-   /* The following function is provided to allow a mechanism to Compare*/
-   /* two blocks of memory to see if the two memory blocks (each of size*/
-   /* Size (in bytes)) are equal (each and every byte up to Size bytes).*/
-   /* This function returns a negative number if Source1 is less than   */
-   /* Source2, zero if Source1 equals Source2, and a positive value if  */
-   /* Source1 is greater than Source2.                                  */
-int BTPSAPI BTPS_MemCompare(BTPSCONST void *Source1, BTPSCONST void *Source2, unsigned long Size)
-{
-   /* Simply wrap the C Run-Time memcmp() function.                     */
-   return(memcmp(Source1, Source2, Size));
+   NumberScheduledFunctions--;
+
+   /* Move the last entry of the queue into the vacated position and    */
+   /* restore the heap ordering.                                        */
+   if(QueueIndex != --(Queue->NumberEntries))
+   {
+      QueueSetEntry(Queue, QueueIndex, Queue->EntryList[Queue->NumberEntries]);
+
+      if((QueueIndex) && (DEADLINE_BEFORE(SchedulerInformation[Queue->EntryList[QueueIndex]].Deadline, SchedulerInformation[Queue->EntryList[(QueueIndex - 1) >> 1]].Deadline)))
+         QueueSiftUp(Queue, QueueIndex);
+      else
+         QueueSiftDown(Queue, QueueIndex);
+   }
 }
 
-   /* The following function is provided to allow a mechanism to Compare*/
-   /* two blocks of memory to see if the two memory blocks (each of size*/
-   /* Size (in bytes)) are equal (each and every byte up to Size bytes) */
-   /* using a Case-Insensitive Compare.  This function returns a        */
-   /* negative number if Source1 is less than Source2, zero if Source1  */
-   /* equals Source2, and a positive value if Source1 is greater than   */
-   /* Source2.                                                          */
-int BTPSAPI BTPS_MemCompareI(BTPSCONST void *Source1, BTPSCONST void *Source2, unsigned long Size)
+   /* The following function is used to call the Scheduled Function of  */
+   /* the specified Scheduler Entry (that has been removed from the     */
+   /* deadline queue) and then re-queue (or free) the entry.  A periodic*/
+   /* entry is re-scheduled relative to its previous deadline (and not  */
+   /* the time at which it was called) so that it does not drift.       */
+   /* This function returns the time (in ticks) that the Scheduled      */
+   /* Function executed.                                                */
+   /* * NOTE * The Scheduled Function may add Scheduled Functions (which*/
+   /*          can move the Scheduler Entry table), so the entry is     */
+   /*          always referenced by index.                              */
+static unsigned long ExecuteSchedulerEntry(unsigned int EntryIndex)
 {
-   int           ret_val = 0;
-   unsigned char Byte1;
-   unsigned char Byte2;
-   unsigned int  Index;
+   unsigned long           Jitter;
+   unsigned long           Lateness;
+   unsigned long           NumberSkipped;
+   unsigned long           StartTickCount;
+   unsigned long           ExecutionTime;
+   BTPS_TimerStatistics_t *Statistics;
+#ifdef SCHEDULER_PROFILE_ENABLED
+   unsigned long            StartCycleCount;
+#endif
+#if (defined(SCHEDULER_PROFILE_ENABLED) || defined(STACK_PROFILE_ENABLED))
+   BTPS_SchedulerFunction_t ScheduleFunction;
+
+   ScheduleFunction = SchedulerInformation[EntryIndex].ScheduleFunction;
+#endif
+
+   SchedulerInformation[EntryIndex].State = SCHEDULER_ENTRY_STATE_RUNNING;
+
+   /* Simply call the Scheduled function, noting when it was called and */
+   /* how long it ran.                                                  */
+   StartTickCount = BTPS_GetTickCount();
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   StartCycleCount = (*GetCycleCountCallback)();
+
+   (*ScheduleFunction)(SchedulerInformation[EntryIndex].ScheduleParameter);
+
+   ProfileTaskExecution(ScheduleFunction, FALSE, (*GetCycleCountCallback)() - StartCycleCount);
+
+#else
+
+   (*(SchedulerInformation[EntryIndex].ScheduleFunction))(SchedulerInformation[EntryIndex].ScheduleParameter);
 
-   /* Simply loop through each byte pointed to by each pointer and check*/
-   /* to see if they are equal.                                         */
-   for(Index = 0; ((Index<Size) && (!ret_val)); Index++)
+#endif
+
+#ifdef STACK_PROFILE_ENABLED
+
+   ProfileStackUsage(ScheduleFunction);
+
+#endif
+
+   ExecutionTime  = BTPS_GetTickCount() - StartTickCount;
+
+   /* Update the statistics of the entry.                               */
+   Statistics = &(SchedulerInformation[EntryIndex].Statistics);
+   Lateness   = StartTickCount - SchedulerInformation[EntryIndex].Deadline;
+
+   if(Statistics->NumberExecutions)
    {
-      /* Note each Byte that we are going to compare.                   */
-      Byte1 = ((unsigned char *)Source1)[Index];
-      Byte2 = ((unsigned char *)Source2)[Index];
+      Jitter = (Lateness > Statistics->LastLateness)?(Lateness - Statistics->LastLateness):(Statistics->LastLateness - Lateness);
 
-      /* If the Byte in the first array is lower case, go ahead and make*/
-      /* it upper case (for comparisons below).                         */
-      if((Byte1 >= 'a') && (Byte1 <= 'z'))
-         Byte1 = Byte1 - ('a' - 'A');
+      if(Jitter > Statistics->MaximumJitter)
+         Statistics->MaximumJitter = Jitter;
+   }
+
+   Statistics->NumberExecutions++;
+   Statistics->LastLateness        = Lateness;
+   Statistics->TotalLateness      += Lateness;
+   Statistics->LastExecutionTime   = ExecutionTime;
+   Statistics->TotalExecutionTime += ExecutionTime;
+
+   if(Lateness > Statistics->MaximumLateness)
+      Statistics->MaximumLateness = Lateness;
+
+   if(ExecutionTime > Statistics->MaximumExecutionTime)
+      Statistics->MaximumExecutionTime = ExecutionTime;
 
-      /* If the Byte in the second array is lower case, go ahead and    */
-      /* make it upper case (for comparisons below).                    */
-      if((Byte2 >= 'a') && (Byte2 <= 'z'))
-         Byte2 = Byte2 - ('a' - 'A');
+   /* Re-queue a periodic timer (unless it was stopped by the function),*/
+   /* otherwise free the entry.                                         */
+   if((SchedulerInformation[EntryIndex].State == SCHEDULER_ENTRY_STATE_RUNNING) && (SchedulerInformation[EntryIndex].Period))
+   {
+      SchedulerInformation[EntryIndex].Deadline += SchedulerInformation[EntryIndex].Period;
+
+      /* If the next deadline has already passed the Scheduler has      */
+      /* fallen behind by (at least) a full period.  Run the missed     */
+      /* periods back to back until the catch up limit is reached, then */
+      /* skip whatever periods remain (staying in phase).               */
+      /* * NOTE * A deadline that is the current tick has not been      */
+      /*          missed, it is simply due (and is not skipped).        */
+      StartTickCount += ExecutionTime;
 
-      /* If the two Bytes are equal then there is nothing to do.        */
-      if(Byte1 != Byte2)
+      if(DEADLINE_BEFORE(SchedulerInformation[EntryIndex].Deadline, StartTickCount))
       {
-         /* Bytes are not equal, so set the return value accordingly.   */
-         if(Byte1 < Byte2)
-            ret_val = -1;
+#if BTPS_SCHEDULER_CATCH_UP_LIMIT
+
+         if(SchedulerInformation[EntryIndex].CatchUpCount < BTPS_SCHEDULER_CATCH_UP_LIMIT)
+            SchedulerInformation[EntryIndex].CatchUpCount++;
          else
-            ret_val = 1;
+
+#endif
+
+         {
+            NumberSkipped = ((StartTickCount - SchedulerInformation[EntryIndex].Deadline - 1) / SchedulerInformation[EntryIndex].Period) + 1;
+
+            SchedulerInformation[EntryIndex].Deadline     += NumberSkipped * SchedulerInformation[EntryIndex].Period;
+            SchedulerInformation[EntryIndex].CatchUpCount  = 0;
+
+            Statistics->NumberSkipped += NumberSkipped;
+         }
       }
+      else
+         SchedulerInformation[EntryIndex].CatchUpCount = 0;
+
+      QueueInsert(EntryIndex);
    }
+   else
+      FreeSchedulerEntryInformation(EntryIndex);
 
-   /* Simply return the result of the above comparison(s).              */
-   return(ret_val);
+   return(ExecutionTime);
 }
 
-   /* The following function is provided to allow a mechanism to copy a */
-   /* source NULL Terminated ASCII (character) String to the specified  */
-   /* Destination String Buffer.  This function accepts as input a      */
-   /* pointer to a buffer (Destination) that is to receive the NULL     */
-   /* Terminated ASCII String pointed to by the Source parameter.  This */
-   /* function copies the string byte by byte from the Source to the    */
-   /* Destination (including the NULL terminator).                      */
-void BTPSAPI BTPS_StringCopy(char *Destination, BTPSCONST char *Source)
+   /* The following function is used to call the Event Handler of every */
+   /* event that has been posted since the last time the events were    */
+   /* dispatched.                                                       */
+   /* * NOTE * An event's Pending flag is cleared *before* its Event    */
+   /*          Handler is called so an event that is posted (from an    */
+   /*          ISR) while the handler is running is never lost, at worst*/
+   /*          the handler is called once more than required.           */
+static void DispatchEvents(void)
 {
-   /* Simply wrap the C Run-Time strcpy() function.                     */
-   strcpy(Destination, Source);
-}
+   unsigned int  Index;
+#ifdef SCHEDULER_PROFILE_ENABLED
+   unsigned long StartCycleCount;
+#endif
 
-   /* The following function is provided to allow a mechanism to        */
-   /* determine the Length (in characters) of the specified NULL        */
-   /* Terminated ASCII (character) String.  This function accepts as    */
-   /* input a pointer to a NULL Terminated ASCII String and returns the */
-   /* number of characters present in the string (NOT including the     */
-   /* terminating NULL character).                                      */
-unsigned int BTPSAPI BTPS_StringLength(BTPSCONST char *Source)
+   EventPending = FALSE;
+
+   for(Index = 0; Index < BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS; Index++)
+   {
+      if(EventInformation[Index].Pending)
+      {
+         EventInformation[Index].Pending = FALSE;
+
+         if(EventInformation[Index].EventHandler)
+         {
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+            StartCycleCount = (*GetCycleCountCallback)();
+
+            (*(EventInformation[Index].EventHandler))(EventInformation[Index].EventParameter);
+
+            ProfileTaskExecution(EventInformation[Index].EventHandler, TRUE, (*GetCycleCountCallback)() - StartCycleCount);
+
+#else
+
+            (*(EventInformation[Index].EventHandler))(EventInformation[Index].EventParameter);
+
+#endif
+
+#ifdef STACK_PROFILE_ENABLED
+
+            ProfileStackUsage(EventInformation[Index].EventHandler);
+
+#endif
+         }
+      }
+   }
+}
+
+   /* The following function is used to add the specified Coroutine to  */
+   /* the end of the list of ready Coroutines.                          */
+static void ReadyCoroutine(BTPS_Coroutine_t *Coroutine)
+{
+   Coroutine->State     = BTPS_COROUTINE_STATE_READY;
+   Coroutine->NextReady = NULL;
+
+   if(CoroutineReadyTail)
+      CoroutineReadyTail->NextReady = Coroutine;
+   else
+      CoroutineReadyHead = Coroutine;
+
+   CoroutineReadyTail = Coroutine;
+
+   NumberReadyCoroutines++;
+}
+
+   /* The following function is used to remove the specified Coroutine  */
+   /* from the list of ready Coroutines (if it is in the list).         */
+static void UnReadyCoroutine(BTPS_Coroutine_t *Coroutine)
+{
+   BTPS_Coroutine_t *Previous;
+   BTPS_Coroutine_t *Current;
+
+   for(Previous = NULL, Current = CoroutineReadyHead; Current; Previous = Current, Current = Current->NextReady)
+   {
+      if(Current == Coroutine)
+      {
+         if(Previous)
+            Previous->NextReady = Current->NextReady;
+         else
+            CoroutineReadyHead  = Current->NextReady;
+
+         if(CoroutineReadyTail == Current)
+            CoroutineReadyTail = Previous;
+
+         NumberReadyCoroutines--;
+         break;
+      }
+   }
+}
+
+   /* The following function is used to call the Coroutine Function of  */
+   /* the specified (ready) Coroutine and then act on the wait that the */
+   /* Coroutine Function returned with.                                 */
+static void ResumeCoroutine(BTPS_Coroutine_t *Coroutine)
+{
+   int                      Status;
+   BTPS_CoroutineFunction_t CoroutineFunction;
+#ifdef SCHEDULER_PROFILE_ENABLED
+   unsigned long            StartCycleCount;
+#endif
+
+   Coroutine->State  = BTPS_COROUTINE_STATE_RUNNING;
+   CoroutineFunction = Coroutine->CoroutineFunction;
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   StartCycleCount = (*GetCycleCountCallback)();
+
+   Status = (*CoroutineFunction)(Coroutine, Coroutine->CoroutineParameter);
+
+   ProfileTaskExecution(TASK_FUNCTION_KEY(CoroutineFunction), FALSE, (*GetCycleCountCallback)() - StartCycleCount);
+
+#else
+
+   Status = (*CoroutineFunction)(Coroutine, Coroutine->CoroutineParameter);
+
+#endif
+
+#ifdef STACK_PROFILE_ENABLED
+
+   ProfileStackUsage(TASK_FUNCTION_KEY(CoroutineFunction));
+
+#endif
+
+   /* Nothing further is done if the Coroutine was stopped (or          */
+   /* restarted) by the Coroutine Function.                             */
+   if(Coroutine->State == BTPS_COROUTINE_STATE_RUNNING)
+   {
+      if(Status == BTPS_COROUTINE_STATUS_WAITING)
+      {
+         Coroutine->State = BTPS_COROUTINE_STATE_WAITING;
+
+         /* A yield simply resumes on the next pass, otherwise a timer  */
+         /* is started for the timeout (if any).  If the timer cannot be*/
+         /* started the Coroutine is resumed on the next pass instead so*/
+         /* that it is never lost.                                      */
+         if(Coroutine->Timeout)
+         {
+            if(Coroutine->Timeout != BTPS_SCHEDULER_TIMEOUT_INFINITE)
+            {
+               if((Coroutine->TimerID = BTPS_StartTimer(Coroutine->Timeout, 0, CoroutineTimerCallback, Coroutine)) == 0)
+                  ReadyCoroutine(Coroutine);
+            }
+         }
+         else
+            ReadyCoroutine(Coroutine);
+      }
+      else
+         Coroutine->State = BTPS_COROUTINE_STATE_IDLE;
+   }
+}
+
+   /* The following function is used to resume every Coroutine that was */
+   /* ready when this function was called.  Coroutines that become ready*/
+   /* while this function is running (for example, by yielding) are     */
+   /* resumed on the next pass through the Scheduler.                   */
+static void ResumeReadyCoroutines(void)
+{
+   unsigned int      Count;
+   BTPS_Coroutine_t *Coroutine;
+
+   for(Count = NumberReadyCoroutines; (Count) && (CoroutineReadyHead); Count--)
+   {
+      Coroutine          = CoroutineReadyHead;
+      CoroutineReadyHead = Coroutine->NextReady;
+
+      if(!CoroutineReadyHead)
+         CoroutineReadyTail = NULL;
+
+      NumberReadyCoroutines--;
+
+      ResumeCoroutine(Coroutine);
+   }
+}
+
+   /* The following function is the Timer Function of the timer that is */
+   /* started while a Coroutine waits for a timeout.  The function takes*/
+   /* as its parameter the Coroutine.                                   */
+static void BTPSAPI CoroutineTimerCallback(void *TimerParameter)
+{
+   BTPS_Coroutine_t *Coroutine;
+
+   Coroutine          = (BTPS_Coroutine_t *)TimerParameter;
+   Coroutine->TimerID = 0;
+
+   if(Coroutine->State == BTPS_COROUTINE_STATE_WAITING)
+   {
+      /* Flag that a wait for an event has timed out.                   */
+      if((Coroutine->WaitingEvent) && (!Coroutine->Signalled))
+         Coroutine->TimedOut = TRUE;
+
+      ReadyCoroutine(Coroutine);
+   }
+}
+
+   /* The following function is used to copy the statistics of the      */
+   /* specified Scheduler Entry into the specified buffer.  This        */
+   /* function returns zero if successful or a negative value if the    */
+   /* entry is not in use (or the buffer is invalid).                   */
+static int QuerySchedulerEntryStatistics(unsigned int EntryIndex, BTPS_TimerStatistics_t *TimerStatistics)
+{
+   int ret_val;
+
+   if((TimerStatistics) && (EntryIndex < NumberSchedulerEntries) && ((SchedulerInformation[EntryIndex].State == SCHEDULER_ENTRY_STATE_QUEUED) || (SchedulerInformation[EntryIndex].State == SCHEDULER_ENTRY_STATE_RUNNING)))
+   {
+      BTPS_MemCopy(TimerStatistics, &(SchedulerInformation[EntryIndex].Statistics), sizeof(BTPS_TimerStatistics_t));
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is used to update the occupancy of the     */
+   /* specified Mailbox when messages are added to (or removed from) the*/
+   /* Mailbox.  This function updates the occupancy statistics and calls*/
+   /* the registered watermark callback (if any) when a watermark is    */
+   /* crossed.                                                          */
+static void UpdateMailboxOccupancy(MailboxHeader_t *MailboxHeader, unsigned int NumberAdded, unsigned int NumberRemoved)
+{
+   Boolean_t     HighWatermark;
+   unsigned long CurrentTickCount;
+
+   /* Account for the time the currently occupied slots have been       */
+   /* occupied since the last change.                                   */
+   CurrentTickCount               = BTPS_GetTickCount();
+   MailboxHeader->OccupancyTime  += (QWord_t)MailboxHeader->OccupiedSlots * (CurrentTickCount - MailboxHeader->LastChangeTick);
+   MailboxHeader->LastChangeTick  = CurrentTickCount;
+
+   MailboxHeader->OccupiedSlots  += NumberAdded;
+   MailboxHeader->OccupiedSlots  -= NumberRemoved;
+   MailboxHeader->NumberAdded    += NumberAdded;
+   MailboxHeader->NumberRemoved  += NumberRemoved;
+
+   if(MailboxHeader->OccupiedSlots > MailboxHeader->MaximumOccupiedSlots)
+      MailboxHeader->MaximumOccupiedSlots = MailboxHeader->OccupiedSlots;
+
+   /* Check to see if a watermark has been crossed.  The low watermark  */
+   /* is only reported after the high watermark has been reported.      */
+   if(MailboxHeader->WatermarkCallback)
+   {
+      if((!MailboxHeader->AboveHighWatermark) && (MailboxHeader->OccupiedSlots >= MailboxHeader->HighWatermark))
+         HighWatermark = TRUE;
+      else
+      {
+         if((MailboxHeader->AboveHighWatermark) && (MailboxHeader->OccupiedSlots <= MailboxHeader->LowWatermark))
+            HighWatermark = FALSE;
+         else
+            HighWatermark = MailboxHeader->AboveHighWatermark;
+      }
+
+      /* Note the new state before the callback is called in case the   */
+      /* callback changes the occupancy of the Mailbox.                 */
+      if(HighWatermark != MailboxHeader->AboveHighWatermark)
+      {
+         MailboxHeader->AboveHighWatermark = HighWatermark;
+
+         __BTPSTRY
+         {
+            (*MailboxHeader->WatermarkCallback)((Mailbox_t)MailboxHeader, HighWatermark, MailboxHeader->WatermarkCallbackParameter);
+         }
+         __BTPSEXCEPT(1)
+         {
+            /* Do Nothing.                                              */
+         }
+      }
+   }
+}
+
+   /* The following function is used to locate the oldest message in the*/
+   /* specified Byte Mailbox.  Any padding at the TailOffset is released*/
+   /* (so that the TailOffset refers to the message).  This function    */
+   /* returns the length of the oldest message.                         */
+   /* * NOTE * This function *MUST* only be called when there is at     */
+   /*          least one message queued in the Mailbox.                 */
+static unsigned int LocateByteMailboxMessage(ByteMailboxHeader_t *MailboxHeader)
+{
+   if(BYTE_MAILBOX_LENGTH(MailboxHeader, MailboxHeader->TailOffset) == BYTE_MAILBOX_PADDING)
+   {
+      MailboxHeader->UsedBytes  -= (MailboxHeader->BufferSize - MailboxHeader->TailOffset);
+      MailboxHeader->TailOffset  = 0;
+   }
+
+   return(BYTE_MAILBOX_LENGTH(MailboxHeader, MailboxHeader->TailOffset));
+}
+
+#ifdef PROFILE_TABLE_ENABLED
+
+   /* The following function is used to locate (or create) the entry of */
+   /* a profile table for the specified key.  The function takes as its */
+   /* parameters the table, the size of each entry, the number of       */
+   /* entries that are hashed (a power of two, the overflow entry       */
+   /* follows these) and the key.  The function returns the index of    */
+   /* the entry for the key.                                            */
+   /* * NOTE * If the table is full (or the key is zero) the overflow   */
+   /*          entry is returned.                                       */
+static unsigned int FindProfileEntry(void *EntryList, unsigned int EntrySize, unsigned int NumberEntries, ProfileKey_t Key)
+{
+   unsigned int ret_val;
+   unsigned int Index;
+   unsigned int Count;
+
+   ret_val = NumberEntries;
+
+   if(Key)
+   {
+      /* Hash the key (ignoring the low bit which is typically fixed)   */
+      /* and probe linearly from there.                                 */
+      Index = (unsigned int)((Key >> 1) * 2654435761UL) & (NumberEntries - 1);
+
+      for(Count = 0; Count < NumberEntries; Count++, Index = (Index + 1) & (NumberEntries - 1))
+      {
+         /* An entry with no key is unused, so claim it for this key.   */
+         if(!PROFILE_ENTRY_KEY(EntryList, EntrySize, Index))
+            PROFILE_ENTRY_KEY(EntryList, EntrySize, Index) = Key;
+
+         if(PROFILE_ENTRY_KEY(EntryList, EntrySize, Index) == Key)
+         {
+            ret_val = Index;
+            break;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to walk a profile table in order   */
+   /* of decreasing value (as determined by the specified function).    */
+   /* The function takes as its parameters the table, the size of each  */
+   /* entry, the number of entries that are hashed (the overflow entry  */
+   /* follows these), the function that determines the value of an      */
+   /* entry and the index of the previously returned entry (or a        */
+   /* negative value to start).  The function returns the index of the  */
+   /* next entry, or a negative value if there are no more entries.     */
+   /* * NOTE * Entries with equal values are returned in table order,   */
+   /*          which allows the walk to be done without any additional  */
+   /*          storage.                                                 */
+static int SelectNextProfileEntry(void *EntryList, unsigned int EntrySize, unsigned int NumberEntries, ProfileEntryValueFunction_t GetEntryValue, int PreviousEntry)
+{
+   int          ret_val;
+   unsigned int Index;
+   QWord_t      Value;
+   QWord_t      PreviousValue;
+   QWord_t      SelectedValue;
+
+   PreviousValue = 0;
+
+   if(PreviousEntry >= 0)
+      (*GetEntryValue)(PROFILE_ENTRY(EntryList, EntrySize, PreviousEntry), &PreviousValue);
+
+   for(Index = 0, ret_val = -1, SelectedValue = 0; Index <= NumberEntries; Index++)
+   {
+      /* Ignore entries that have never been used.                      */
+      if((*GetEntryValue)(PROFILE_ENTRY(EntryList, EntrySize, Index), &Value))
+      {
+         /* Only consider entries that follow the previous entry in the */
+         /* ordering.                                                   */
+         if((PreviousEntry < 0) || (Value < PreviousValue) || ((Value == PreviousValue) && ((int)Index > PreviousEntry)))
+         {
+            if((ret_val < 0) || (Value > SelectedValue))
+            {
+               ret_val       = (int)Index;
+               SelectedValue = Value;
+            }
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to display the name of a profile   */
+   /* table entry (the address of the site or task, or "(other)" for    */
+   /* the overflow entry) via BTPS_OutputMessage().                     */
+static void OutputProfileEntryName(ProfileKey_t Key)
+{
+   if(Key)
+      BTPS_OutputMessage("  0x%08lX", Key);
+   else
+      BTPS_OutputMessage("  %-10s", "(other)");
+}
+
+#endif
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+   /* The following function is used to record an allocation in the     */
+   /* allocation profile.  The function takes as its parameters the     */
+   /* allocated memory (NULL if the allocation failed), the size that   */
+   /* was requested and the site that requested the allocation.         */
+static void ProfileAllocation(void *MemoryPtr, unsigned long Size, BTPSCONST void *Site, BTPSCONST char *Tag)
+{
+   BlockInfo_t   *BlockInfo;
+   ProfileSite_t *ProfileSite;
+
+   /* The site is identified by the tag (if specified) or the caller    */
+   /* address.                                                          */
+   if(Tag)
+   {
+      ProfileSite         = &(ProfileSiteList[FindProfileEntry(ProfileSiteList, sizeof(ProfileSite_t), MEMORY_PROFILE_MAXIMUM_SITES, (ProfileKey_t)Tag)]);
+      ProfileSite->Tagged = TRUE;
+   }
+   else
+      ProfileSite = &(ProfileSiteList[FindProfileEntry(ProfileSiteList, sizeof(ProfileSite_t), MEMORY_PROFILE_MAXIMUM_SITES, (ProfileKey_t)Site)]);
+
+   if(MemoryPtr)
+   {
+      BlockInfo = (BlockInfo_t *)(((Alignment_t *)MemoryPtr) - BLOCK_INFO_SIZE(0));
+
+      /* Note the owner of the block and when it was allocated.         */
+      BlockInfo->SiteIndex      = (Word_t)(ProfileSite - ProfileSiteList);
+      BlockInfo->AllocationTick = BTPS_GetTickCount();
+
+      /* The block size (including the header) is what is actually      */
+      /* consumed from the heap, so this is what is accounted for.      */
+      ProfileSite->NumberAllocations++;
+      ProfileSite->CurrentBytes += (BlockInfo->Size & SEGMENT_SIZE_BITMASK) * ALIGNMENT_SIZE;
+
+      if(ProfileSite->PeakBytes < ProfileSite->CurrentBytes)
+         ProfileSite->PeakBytes = ProfileSite->CurrentBytes;
+   }
+   else
+   {
+      ProfileSite->NumberFailures++;
+
+      /* The size is only displayed in debug builds.                    */
+      UNREFERENCED_PARAMETER(Size);
+
+      DBG_MSG(DBG_ZONE_BTPSKRNL, ("Malloc Failed: %lu (Site %p).\r\n", Size, (Tag)?(BTPSCONST void *)Tag:Site));
+   }
+}
+
+   /* The following function is used to record that the specified       */
+   /* (allocated) memory is about to be freed.                          */
+static void ProfileFree(void *MemoryPtr)
+{
+   BlockInfo_t   *BlockInfo;
+   unsigned int   Index;
+   unsigned long  Bytes;
+   unsigned long  Lifetime;
+   ProfileSite_t *ProfileSite;
+
+   BlockInfo = (BlockInfo_t *)(((Alignment_t *)MemoryPtr) - BLOCK_INFO_SIZE(0));
+
+   if((BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK) && (BlockInfo->SiteIndex <= MEMORY_PROFILE_OVERFLOW_SITE))
+   {
+      ProfileSite = &(ProfileSiteList[BlockInfo->SiteIndex]);
+      Bytes       = (BlockInfo->Size & SEGMENT_SIZE_BITMASK) * ALIGNMENT_SIZE;
+      Lifetime    = BTPS_GetTickCount() - BlockInfo->AllocationTick;
+
+      ProfileSite->NumberFrees++;
+      ProfileSite->CurrentBytes = (ProfileSite->CurrentBytes > Bytes)?(ProfileSite->CurrentBytes - Bytes):0;
+
+      /* Determine which lifetime bin this allocation falls in.         */
+      for(Index = 0; (Index < (BTPS_ALLOCATION_LIFETIME_BINS - 1)) && (Lifetime >= LifetimeBinLimit[Index]); Index++)
+         ;
+
+      ProfileSite->LifetimeHistogram[Index]++;
+   }
+}
+
+   /* The following function is used to record that the specified       */
+   /* (allocated) memory was resized in place.  The function takes as   */
+   /* its parameters the memory and the previous size of the block (in  */
+   /* Alignment_t units).                                               */
+static void ProfileResize(void *MemoryPtr, unsigned int PreviousSize)
+{
+   BlockInfo_t   *BlockInfo;
+   ProfileSite_t *ProfileSite;
+
+   BlockInfo = (BlockInfo_t *)(((Alignment_t *)MemoryPtr) - BLOCK_INFO_SIZE(0));
+
+   if(BlockInfo->SiteIndex <= MEMORY_PROFILE_OVERFLOW_SITE)
+   {
+      ProfileSite = &(ProfileSiteList[BlockInfo->SiteIndex]);
+
+      ProfileSite->CurrentBytes -= PreviousSize * ALIGNMENT_SIZE;
+      ProfileSite->CurrentBytes += (BlockInfo->Size & SEGMENT_SIZE_BITMASK) * ALIGNMENT_SIZE;
+
+      if(ProfileSite->PeakBytes < ProfileSite->CurrentBytes)
+         ProfileSite->PeakBytes = ProfileSite->CurrentBytes;
+   }
+}
+
+   /* The following function is used to determine the value that the    */
+   /* profile site table is ordered by (the number of bytes currently   */
+   /* held).  See ProfileEntryValueFunction_t.                          */
+static Boolean_t GetProfileSiteValue(void *Entry, QWord_t *Value)
+{
+   *Value = ((ProfileSite_t *)Entry)->CurrentBytes;
+
+   return((Boolean_t)((((ProfileSite_t *)Entry)->NumberAllocations) || (((ProfileSite_t *)Entry)->NumberFailures)));
+}
+
+   /* The following function is used to walk the profile site table in  */
+   /* order of decreasing number of bytes currently held.  The function */
+   /* takes as its parameter the index of the previously returned site  */
+   /* (or a negative value to start) and returns the index of the next  */
+   /* site, or a negative value if there are no more sites.             */
+static int SelectNextProfileSite(int PreviousSite)
+{
+   return(SelectNextProfileEntry(ProfileSiteList, sizeof(ProfileSite_t), MEMORY_PROFILE_MAXIMUM_SITES, GetProfileSiteValue, PreviousSite));
+}
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+   /* The following function is used to determine the Heap ID of the    */
+   /* specified heap (as recorded in the allocation trace).             */
+static unsigned int GetHeapID(HeapInfo_t *HeapInfo)
+{
+   unsigned int ret_val;
+
+   for(ret_val = BTPS_DEFAULT_HEAP_ID; (ret_val < NumberHeaps) && (HeapList[ret_val] != HeapInfo); ret_val++)
+      ;
+
+   return(ret_val);
+}
+
+   /* The following function is used to write all buffered allocation   */
+   /* trace records to the debug output and empty the buffer.           */
+static void FlushTrace(void)
+{
+   unsigned int   Index;
+   TraceRecord_t *TraceRecord;
+
+   for(Index = 0, TraceRecord = TraceRecordList; Index < NumberTraceRecords; Index++, TraceRecord++)
+   {
+      switch(TraceRecord->Operation)
+      {
+         case MEMORY_TRACE_OPERATION_FREE:
+            BTPS_OutputMessage("MT F %lX %X %lX\r\n", TraceRecord->TimeStamp, TraceRecord->HeapID, (unsigned long)TraceRecord->Pointer);
+            break;
+         case MEMORY_TRACE_OPERATION_REALLOCATE:
+            BTPS_OutputMessage("MT R %lX %X %lX %lX %lX\r\n", TraceRecord->TimeStamp, TraceRecord->HeapID, TraceRecord->Size, (unsigned long)TraceRecord->Pointer, (unsigned long)TraceRecord->PreviousPointer);
+            break;
+         case MEMORY_TRACE_OPERATION_HEAP:
+            BTPS_OutputMessage("MT H %X %lX\r\n", TraceRecord->HeapID, TraceRecord->Size);
+            break;
+         default:
+            BTPS_OutputMessage("MT A %lX %X %lX %lX\r\n", TraceRecord->TimeStamp, TraceRecord->HeapID, TraceRecord->Size, (unsigned long)TraceRecord->Pointer);
+            break;
+      }
+   }
+
+   NumberTraceRecords = 0;
+}
+
+   /* The following function is used to add a record to the allocation  */
+   /* trace (if the trace is running).  The function takes as its       */
+   /* parameters the operation, the Heap ID, the resulting pointer (NULL*/
+   /* on failure), the original pointer (reallocation only) and the     */
+   /* requested size (the region size for a heap record).               */
+static void TraceOperation(char Operation, unsigned int HeapID, void *Pointer, void *PreviousPointer, unsigned long Size)
+{
+   TraceRecord_t *TraceRecord;
+
+   if(TraceActive)
+   {
+      if(NumberTraceRecords == MEMORY_TRACE_BUFFER_RECORDS)
+         FlushTrace();
+
+      TraceRecord                  = &(TraceRecordList[NumberTraceRecords++]);
+      TraceRecord->TimeStamp       = BTPS_GetTickCount();
+      TraceRecord->Size            = Size;
+      TraceRecord->Pointer         = Pointer;
+      TraceRecord->PreviousPointer = PreviousPointer;
+      TraceRecord->HeapID          = HeapID;
+      TraceRecord->Operation       = Operation;
+   }
+}
+
+#endif
+
+   /* The following function is used to copy a block of memory in       */
+   /* ascending address order (which is also safe for overlapping       */
+   /* blocks when the destination precedes the source).  The function   */
+   /* takes as its parameters the destination, the source and the number*/
+   /* of bytes to copy.                                                 */
+static void CopyMemoryForward(unsigned char *Destination, BTPSCONST unsigned char *Source, unsigned long Size)
+{
+   MemoryWord_t           *DestinationWord;
+   MemoryWord_t            Word0;
+   MemoryWord_t            Word1;
+   MemoryWord_t            Word2;
+   MemoryWord_t            Word3;
+   BTPSCONST MemoryWord_t *SourceWord;
+
+   /* Words can only be copied when both blocks share the same          */
+   /* alignment.                                                        */
+   if((Size >= MEMORY_WORD_THRESHOLD) && (MEMORY_SAME_ALIGNMENT(Destination, Source)))
+   {
+      /* Copy the leading bytes up to the first word boundary.          */
+      while(((unsigned long)Destination) & MEMORY_WORD_MASK)
+      {
+         *(Destination++) = *(Source++);
+         Size--;
+      }
+
+      DestinationWord = (MemoryWord_t *)Destination;
+      SourceWord      = (BTPSCONST MemoryWord_t *)Source;
+
+      /* Copy blocks of four words.  All four words are loaded before   */
+      /* any is stored so that the compiler can move each block with a  */
+      /* single LDM/STM pair on the Cortex-M (this also keeps           */
+      /* overlapping copies correct).                                   */
+      while(Size >= MEMORY_BLOCK_SIZE)
+      {
+         Word0               = SourceWord[0];
+         Word1               = SourceWord[1];
+         Word2               = SourceWord[2];
+         Word3               = SourceWord[3];
+
+         DestinationWord[0]  = Word0;
+         DestinationWord[1]  = Word1;
+         DestinationWord[2]  = Word2;
+         DestinationWord[3]  = Word3;
+
+         SourceWord         += 4;
+         DestinationWord    += 4;
+         Size               -= MEMORY_BLOCK_SIZE;
+      }
+
+      /* Copy the remaining whole words.                                */
+      while(Size >= MEMORY_WORD_SIZE)
+      {
+         *(DestinationWord++)  = *(SourceWord++);
+         Size                 -= MEMORY_WORD_SIZE;
+      }
+
+      Destination = (unsigned char *)DestinationWord;
+      Source      = (BTPSCONST unsigned char *)SourceWord;
+   }
+
+   /* Copy the trailing bytes (or the entire block if words could not be*/
+   /* used).                                                            */
+   while(Size--)
+      *(Destination++) = *(Source++);
+}
+
+   /* The following function is used to copy a block of memory in       */
+   /* descending address order (which is safe for overlapping blocks    */
+   /* when the destination follows the source).  The function takes as  */
+   /* its parameters the destination, the source and the number of bytes*/
+   /* to copy.                                                          */
+static void CopyMemoryBackward(unsigned char *Destination, BTPSCONST unsigned char *Source, unsigned long Size)
+{
+   MemoryWord_t           *DestinationWord;
+   MemoryWord_t            Word0;
+   MemoryWord_t            Word1;
+   MemoryWord_t            Word2;
+   MemoryWord_t            Word3;
+   BTPSCONST MemoryWord_t *SourceWord;
+
+   /* Start at the end of both blocks.                                  */
+   Destination += Size;
+   Source      += Size;
+
+   /* Words can only be copied when both blocks share the same          */
+   /* alignment.                                                        */
+   if((Size >= MEMORY_WORD_THRESHOLD) && (MEMORY_SAME_ALIGNMENT(Destination, Source)))
+   {
+      /* Copy the trailing bytes down to the last word boundary.        */
+      while(((unsigned long)Destination) & MEMORY_WORD_MASK)
+      {
+         *(--Destination) = *(--Source);
+         Size--;
+      }
+
+      DestinationWord = (MemoryWord_t *)Destination;
+      SourceWord      = (BTPSCONST MemoryWord_t *)Source;
+
+      /* Copy blocks of four words (all four words are loaded before any*/
+      /* is stored).                                                    */
+      while(Size >= MEMORY_BLOCK_SIZE)
+      {
+         SourceWord         -= 4;
+         DestinationWord    -= 4;
+
+         Word0               = SourceWord[0];
+         Word1               = SourceWord[1];
+         Word2               = SourceWord[2];
+         Word3               = SourceWord[3];
+
+         DestinationWord[0]  = Word0;
+         DestinationWord[1]  = Word1;
+         DestinationWord[2]  = Word2;
+         DestinationWord[3]  = Word3;
+
+         Size               -= MEMORY_BLOCK_SIZE;
+      }
+
+      /* Copy the remaining whole words.                                */
+      while(Size >= MEMORY_WORD_SIZE)
+      {
+         *(--DestinationWord)  = *(--SourceWord);
+         Size                 -= MEMORY_WORD_SIZE;
+      }
+
+      Destination = (unsigned char *)DestinationWord;
+      Source      = (BTPSCONST unsigned char *)SourceWord;
+   }
+
+   /* Copy the leading bytes (or the entire block if words could not be */
+   /* used).                                                            */
+   while(Size--)
+      *(--Destination) = *(--Source);
+}
+
+   /* The following function is used to determine the number of leading */
+   /* bytes that are identical in two blocks of memory.  The function   */
+   /* takes as its parameters the two blocks and the size of the blocks.*/
+   /* The function returns the number of identical leading bytes (which */
+   /* is Size if the blocks are identical).                             */
+static unsigned long CountMatchingBytes(BTPSCONST unsigned char *Source1, BTPSCONST unsigned char *Source2, unsigned long Size)
+{
+   unsigned long ret_val;
+
+   ret_val = 0;
+
+   /* Whole words can only be compared when both blocks share the same  */
+   /* alignment.                                                        */
+   if((Size >= MEMORY_WORD_THRESHOLD) && (MEMORY_SAME_ALIGNMENT(Source1, Source2)))
+   {
+      /* Compare the leading bytes up to the first word boundary.       */
+      while((((unsigned long)&(Source1[ret_val])) & MEMORY_WORD_MASK) && (Source1[ret_val] == Source2[ret_val]))
+         ret_val++;
+
+      /* Skip all identical whole words (unless a difference was found  */
+      /* before the word boundary).                                     */
+      if(!(((unsigned long)&(Source1[ret_val])) & MEMORY_WORD_MASK))
+      {
+         while(((Size - ret_val) >= MEMORY_WORD_SIZE) && (*((BTPSCONST MemoryWord_t *)&(Source1[ret_val])) == *((BTPSCONST MemoryWord_t *)&(Source2[ret_val]))))
+            ret_val += MEMORY_WORD_SIZE;
+      }
+   }
+
+   /* Locate the first differing byte.                                  */
+   while((ret_val < Size) && (Source1[ret_val] == Source2[ret_val]))
+      ret_val++;
+
+   return(ret_val);
+}
+
+   /* The following function is the message formatter that is used in   */
+   /* place of the C Run-Time vsprintf() function (which pulls in a     */
+   /* large formatter and uses a lot of stack).  The function takes as  */
+   /* its parameters the buffer to format the string into, the size of  */
+   /* the buffer (including the terminating NULL character), the format */
+   /* string and the list of arguments.  The function returns the number*/
+   /* of characters that were written to the buffer (NOT including the  */
+   /* terminating NULL character), the output is truncated if the buffer*/
+   /* is too small.  The buffer size must be at least one.              */
+   /* * NOTE * The d, i, u, o, x, X, c, s, p and % conversions are      */
+   /*          supported along with the -, 0, +, space and # flags, the */
+   /*          field width, the precision (either of which may be *)    */
+   /*          and the hh, h, l, ll, j, z and t length modifiers.       */
+   /*          Floating point conversions are NOT supported, any        */
+   /*          unsupported conversion is copied to the output as is.    */
+static unsigned int FormatString(char *Buffer, unsigned int BufferSize, BTPSCONST char *Format, va_list Arguments)
+{
+   int              Precision;
+   char             Sign;
+   char             Digits[FORMAT_DIGITS_BUFFER_SIZE];
+   unsigned int     Flags;
+   unsigned int     Width;
+   unsigned int     Length;
+   unsigned int     Base;
+   unsigned int     FieldLength;
+   unsigned int     PrefixLength;
+   unsigned int     ZeroPadding;
+   unsigned int     SpacePadding;
+   unsigned long    Value;
+   QWord_t          LongValue;
+   char            *Digit;
+   BTPSCONST char  *Field;
+   BTPSCONST char  *DigitList;
+   BTPSCONST char  *Specification;
+
+   Length = 0;
+
+   /* Note the maximum number of characters that can be written (leave  */
+   /* room for the terminating NULL character).                         */
+   BufferSize--;
+
+   while(*Format)
+   {
+      /* Copy everything up to the next conversion specification as is. */
+      if(*Format != '%')
+      {
+         if(Length < BufferSize)
+            Buffer[Length++] = *Format;
+
+         Format++;
+         continue;
+      }
+
+      Specification = Format++;
+
+      /* Parse the flags.                                               */
+      Flags = 0;
+      while(TRUE)
+      {
+         if(*Format == '-')
+            Flags |= FORMAT_FLAG_LEFT_JUSTIFY;
+         else
+         {
+            if(*Format == '0')
+               Flags |= FORMAT_FLAG_ZERO_PAD;
+            else
+            {
+               if(*Format == '+')
+                  Flags |= FORMAT_FLAG_PLUS_SIGN;
+               else
+               {
+                  if(*Format == ' ')
+                     Flags |= FORMAT_FLAG_SPACE_SIGN;
+                  else
+                  {
+                     if(*Format == '#')
+                        Flags |= FORMAT_FLAG_ALTERNATE;
+                     else
+                        break;
+                  }
+               }
+            }
+         }
+
+         Format++;
+      }
+
+      /* Parse the field width.                                         */
+      Width = 0;
+      if(*Format == '*')
+      {
+         Precision = va_arg(Arguments, int);
+         if(Precision < 0)
+         {
+            Flags     |= FORMAT_FLAG_LEFT_JUSTIFY;
+            Precision  = -Precision;
+         }
+
+         Width = (unsigned int)Precision;
+
+         Format++;
+      }
+      else
+      {
+         while((*Format >= '0') && (*Format <= '9'))
+            Width = (Width * 10) + (unsigned int)(*(Format++) - '0');
+      }
+
+      /* Parse the precision (negative if there is no precision).       */
+      Precision = -1;
+      if(*Format == '.')
+      {
+         Format++;
+
+         if(*Format == '*')
+         {
+            Precision = va_arg(Arguments, int);
+
+            Format++;
+         }
+         else
+         {
+            Precision = 0;
+            while((*Format >= '0') && (*Format <= '9'))
+               Precision = (Precision * 10) + (int)(*(Format++) - '0');
+         }
+      }
+
+      /* Parse the length modifier.                                     */
+      if(*Format == 'h')
+      {
+         if(*(++Format) == 'h')
+         {
+            Flags |= FORMAT_FLAG_CHAR;
+
+            Format++;
+         }
+         else
+            Flags |= FORMAT_FLAG_SHORT;
+      }
+      else
+      {
+         if(*Format == 'l')
+         {
+            if(*(++Format) == 'l')
+            {
+               Flags |= FORMAT_FLAG_LONG_LONG;
+
+               Format++;
+            }
+            else
+               Flags |= FORMAT_FLAG_LONG;
+         }
+         else
+         {
+            if(*Format == 'j')
+            {
+               Flags |= FORMAT_FLAG_LONG_LONG;
+
+               Format++;
+            }
+            else
+            {
+               if((*Format == 'z') || (*Format == 't'))
+               {
+                  Flags |= FORMAT_FLAG_LONG;
+
+                  Format++;
+               }
+            }
+         }
+      }
+
+      Sign         = '\0';
+      Field        = Digits;
+      FieldLength  = 0;
+      PrefixLength = 0;
+      ZeroPadding  = 0;
+      Base         = 0;
+      DigitList    = "0123456789ABCDEF";
+      Value        = 0;
+      LongValue    = 0;
+
+      /* Fetch the argument of the conversion.                          */
+      switch(*Format)
+      {
+         case 'd':
+         case 'i':
+            Base = 10;
+
+            if(Flags & FORMAT_FLAG_LONG_LONG)
+            {
+               LongValue = (QWord_t)va_arg(Arguments, long long);
+               if(((long long)LongValue) < 0)
+               {
+                  Sign      = '-';
+                  LongValue = (QWord_t)0 - LongValue;
+               }
+            }
+            else
+            {
+               if(Flags & FORMAT_FLAG_LONG)
+                  Value = (unsigned long)va_arg(Arguments, long);
+               else
+               {
+                  Value = (unsigned long)(long)va_arg(Arguments, int);
+
+                  if(Flags & FORMAT_FLAG_SHORT)
+                     Value = (unsigned long)(long)(short)Value;
+                  else
+                  {
+                     if(Flags & FORMAT_FLAG_CHAR)
+                        Value = (unsigned long)(long)(signed char)Value;
+                  }
+               }
+
+               if(((long)Value) < 0)
+               {
+                  Sign  = '-';
+                  Value = 0 - Value;
+               }
+            }
+
+            if(!Sign)
+            {
+               if(Flags & FORMAT_FLAG_PLUS_SIGN)
+                  Sign = '+';
+               else
+               {
+                  if(Flags & FORMAT_FLAG_SPACE_SIGN)
+                     Sign = ' ';
+               }
+            }
+            break;
+         case 'x':
+            DigitList = "0123456789abcdef";
+            /* Fall through.                                            */
+         case 'X':
+            Base   = 16;
+            Flags |= FORMAT_FLAG_UNSIGNED;
+            break;
+         case 'o':
+            Base   = 8;
+            Flags |= FORMAT_FLAG_UNSIGNED;
+            break;
+         case 'u':
+            Base   = 10;
+            Flags |= FORMAT_FLAG_UNSIGNED;
+            break;
+         case 'p':
+            Base       = 16;
+            DigitList  = "0123456789abcdef";
+            Flags     |= FORMAT_FLAG_ALTERNATE;
+            Value      = (unsigned long)va_arg(Arguments, void *);
+            break;
+         case 'c':
+            Digits[0]   = (char)va_arg(Arguments, int);
+            FieldLength = 1;
+            break;
+         case 's':
+            if((Field = va_arg(Arguments, BTPSCONST char *)) == NULL)
+               Field = "(null)";
+
+            while((Field[FieldLength]) && ((Precision < 0) || (FieldLength < (unsigned int)Precision)))
+               FieldLength++;
+            break;
+         case '%':
+            Digits[0]   = '%';
+            FieldLength = 1;
+            break;
+         default:
+            /* Unsupported conversion, simply copy the specification.   */
+            Field       = Specification;
+            FieldLength = (unsigned int)(Format - Specification);
+            if(*Format)
+               FieldLength++;
+            break;
+      }
+
+      /* Fetch the argument of an unsigned conversion.                  */
+      if(Flags & FORMAT_FLAG_UNSIGNED)
+      {
+         if(Flags & FORMAT_FLAG_LONG_LONG)
+            LongValue = va_arg(Arguments, unsigned long long);
+         else
+         {
+            if(Flags & FORMAT_FLAG_LONG)
+               Value = va_arg(Arguments, unsigned long);
+            else
+            {
+               Value = (unsigned long)va_arg(Arguments, unsigned int);
+
+               if(Flags & FORMAT_FLAG_SHORT)
+                  Value = (unsigned long)(unsigned short)Value;
+               else
+               {
+                  if(Flags & FORMAT_FLAG_CHAR)
+                     Value = (unsigned long)(unsigned char)Value;
+               }
+            }
+         }
+      }
+
+      /* Convert a number to digits (from the least significant digit). */
+      if(Base)
+      {
+         Digit = &(Digits[FORMAT_DIGITS_BUFFER_SIZE]);
+
+         /* A 64 bit value is converted with 64 bit arithmetic only     */
+         /* until the remainder fits in an unsigned long.               */
+         if(Flags & FORMAT_FLAG_LONG_LONG)
+         {
+            while(LongValue > (QWord_t)((unsigned long)-1))
+            {
+               *(--Digit)  = DigitList[LongValue % Base];
+               LongValue  /= Base;
+            }
+
+            Value = (unsigned long)LongValue;
+         }
+
+         /* Note that a zero value with a zero precision produces no    */
+         /* digits.                                                     */
+         if((Value) || (Precision != 0))
+         {
+            do
+            {
+               *(--Digit)  = DigitList[Value % Base];
+               Value      /= Base;
+            } while(Value);
+         }
+
+         Field       = Digit;
+         FieldLength = (unsigned int)(&(Digits[FORMAT_DIGITS_BUFFER_SIZE]) - Digit);
+
+         if((Precision >= 0) && (FieldLength < (unsigned int)Precision))
+            ZeroPadding = (unsigned int)Precision - FieldLength;
+
+         /* Note the prefix of the number.                              */
+         if(Sign)
+            PrefixLength = 1;
+         else
+         {
+            /* The alternate form only applies to a non-zero value.     */
+            if((Flags & FORMAT_FLAG_ALTERNATE) && (FieldLength) && (*Field != '0'))
+            {
+               if(Base == 16)
+                  PrefixLength = 2;
+               else
+               {
+                  if((Base == 8) && (!ZeroPadding))
+                     ZeroPadding = 1;
+               }
+            }
+         }
+      }
+
+      /* Determine the padding that is required to fill the field width.*/
+      if(Width > (PrefixLength + ZeroPadding + FieldLength))
+         SpacePadding = Width - (PrefixLength + ZeroPadding + FieldLength);
+      else
+         SpacePadding = 0;
+
+      /* Zero padding applies to numbers without a precision only.      */
+      if((Base) && (Precision < 0) && ((Flags & (FORMAT_FLAG_ZERO_PAD | FORMAT_FLAG_LEFT_JUSTIFY)) == FORMAT_FLAG_ZERO_PAD))
+      {
+         ZeroPadding  += SpacePadding;
+         SpacePadding  = 0;
+      }
+
+      /* Write the field.                                               */
+      if(!(Flags & FORMAT_FLAG_LEFT_JUSTIFY))
+      {
+         while((SpacePadding) && (Length < BufferSize))
+         {
+            Buffer[Length++] = ' ';
+            SpacePadding--;
+         }
+      }
+
+      if(PrefixLength)
+      {
+         if(Sign)
+         {
+            if(Length < BufferSize)
+               Buffer[Length++] = Sign;
+         }
+         else
+         {
+            if(Length < BufferSize)
+               Buffer[Length++] = '0';
+
+            if(Length < BufferSize)
+               Buffer[Length++] = (char)((DigitList[10] == 'a')?'x':'X');
+         }
+      }
+
+      while((ZeroPadding--) && (Length < BufferSize))
+         Buffer[Length++] = '0';
+
+      while((FieldLength--) && (Length < BufferSize))
+         Buffer[Length++] = *(Field++);
+
+      while((SpacePadding--) && (Length < BufferSize))
+         Buffer[Length++] = ' ';
+
+      if(*Format)
+         Format++;
+   }
+
+   /* Finally terminate the string.                                     */
+   Buffer[Length] = '\0';
+
+   return(Length);
+}
+
+   /* The following function is used to format the specified message    */
+   /* and write it to the debug output.  The function takes as its      */
+   /* parameters the format string and the list of arguments.           */
+static void OutputMessageArguments(BTPSCONST char *Format, va_list Arguments)
+{
+   unsigned int Length;
+   char         MsgBuffer[256];
+
+   if(MessageOutputCallback)
+   {
+      Length = FormatString(MsgBuffer, sizeof(MsgBuffer), Format, Arguments);
+
+      MessageOutputCallback(Length, MsgBuffer);
+   }
+}
+
+#ifdef DEFERRED_LOG_ENABLED
+
+   /* The following function is used to determine the number of         */
+   /* arguments that are consumed by the specified format string (a '*' */
+   /* field width or precision consumes an argument of its own).  The   */
+   /* number returned is limited to DEFERRED_LOG_MAXIMUM_ARGUMENTS.     */
+static unsigned int CountLogArguments(BTPSCONST char *Format)
+{
+   unsigned int ret_val;
+
+   ret_val = 0;
+
+   while(*Format)
+   {
+      if(*(Format++) == '%')
+      {
+         /* Skip the flags, field width, precision and length modifier  */
+         /* of the conversion.                                          */
+         while((*Format) && (strchr("-+ #0123456789.*hlzjt", *Format)))
+         {
+            if(*(Format++) == '*')
+               ret_val++;
+         }
+
+         /* Every conversion other than "%%" consumes an argument.      */
+         if(*Format)
+         {
+            if(*(Format++) != '%')
+               ret_val++;
+         }
+      }
+   }
+
+   if(ret_val > DEFERRED_LOG_MAXIMUM_ARGUMENTS)
+      ret_val = DEFERRED_LOG_MAXIMUM_ARGUMENTS;
+
+   return(ret_val);
+}
+
+   /* The following function is used to write the oldest records of the */
+   /* deferred log to the debug output and remove them from the ring.   */
+   /* The function takes as its parameter the maximum number of records */
+   /* to write.                                                         */
+static void FlushLog(unsigned int MaximumRecords)
+{
+   LogRecord_t *LogRecord;
+
+   while((NumberLogRecords) && (MaximumRecords--))
+   {
+      /* Report any records that were overwritten before this one.      */
+      if(NumberLostLogRecords)
+      {
+#ifdef DEFERRED_LOG_EXPORT
+
+         BTPS_OutputMessage("DL L %lX\r\n", NumberLostLogRecords);
+
+#else
+
+         BTPS_OutputMessage("*** %lu log records lost ***\r\n", NumberLostLogRecords);
+
+#endif
+
+         NumberLostLogRecords = 0;
+      }
+
+      LogRecord = &(LogRecordList[LogRecordOut]);
+
+#ifdef DEFERRED_LOG_EXPORT
+
+      BTPS_OutputMessage("DL %lX %lX %lX %lX %lX %lX %lX %lX\r\n", LogRecord->TimeStamp, (unsigned long)LogRecord->Format, LogRecord->Argument[0], LogRecord->Argument[1], LogRecord->Argument[2], LogRecord->Argument[3], LogRecord->Argument[4], LogRecord->Argument[5]);
+
+#else
+
+      BTPS_OutputMessage("%lu.%06lu ", (LogRecord->TimeStamp / 1000000), (LogRecord->TimeStamp % 1000000));
+      BTPS_OutputMessage(LogRecord->Format, LogRecord->Argument[0], LogRecord->Argument[1], LogRecord->Argument[2], LogRecord->Argument[3], LogRecord->Argument[4], LogRecord->Argument[5]);
+
+#endif
+
+      if(++LogRecordOut == DEFERRED_LOG_BUFFER_RECORDS)
+         LogRecordOut = 0;
+
+      NumberLogRecords--;
+   }
+}
+
+#endif
+
+#ifdef __linux__
+
+   /* The following function is the default cycle counter of a Linux    */
+   /* host.  The function returns the current value of the monotonic    */
+   /* clock in nanoseconds (wrapping at the size of an unsigned long).  */
+static unsigned long BTPSAPI GetMonotonicCycleCount(void)
+{
+   struct timespec TimeSpec;
+
+   clock_gettime(CLOCK_MONOTONIC, &TimeSpec);
+
+   return(((unsigned long)TimeSpec.tv_sec * 1000000000UL) + (unsigned long)TimeSpec.tv_nsec);
+}
+
+   /* The following function is the default Timestamp of a Linux host.  */
+   /* The function returns the current value of the monotonic clock in  */
+   /* Microseconds.                                                     */
+static QWord_t BTPSAPI GetMonotonicTimestamp(void)
+{
+   struct timespec TimeSpec;
+
+   clock_gettime(CLOCK_MONOTONIC, &TimeSpec);
+
+   return(((QWord_t)TimeSpec.tv_sec * 1000000) + (QWord_t)(TimeSpec.tv_nsec / 1000));
+}
+
+#else
+
+   /* The following function is the default Timestamp of a platform that*/
+   /* does not register a Timestamp.  The function returns the Tick     */
+   /* Count (extended to 64 bits) in Microseconds.                      */
+   /* * NOTE * The Tick Count is only extended correctly if the         */
+   /*          Timestamp is read at least once each time the Tick Count */
+   /*          wraps.                                                   */
+static QWord_t BTPSAPI GetTickCountTimestamp(void)
+{
+   unsigned long TickCount;
+
+   TickCount = BTPS_GetTickCount();
+
+   if(TickCount < LastTimestampTickCount)
+      TimestampTickCountHigh++;
+
+   LastTimestampTickCount = TickCount;
+
+   return((((QWord_t)TimestampTickCountHigh << 32) + TickCount) * (BTPS_TICK_COUNT_INTERVAL * 1000));
+}
+
+#endif
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   /* The following function is used to record a single call of a task  */
+   /* in the scheduler profile.  The function takes as its parameters   */
+   /* the function that was called, a flag that specifies if the        */
+   /* function is an Event Handler and the time (in cycles) that the    */
+   /* function executed.                                                */
+static void ProfileTaskExecution(BTPS_SchedulerFunction_t TaskFunction, Boolean_t EventHandler, unsigned long Cycles)
+{
+   unsigned int   Index;
+   ProfileTask_t *ProfileTask;
+
+   ProfileTask = &(ProfileTaskList[FindProfileEntry(ProfileTaskList, sizeof(ProfileTask_t), SCHEDULER_PROFILE_MAXIMUM_TASKS, (ProfileKey_t)TaskFunction)]);
+
+   if(!ProfileTask->NumberCalls)
+      ProfileTask->EventHandler = EventHandler;
+
+   ProfileTask->NumberCalls++;
+   ProfileTask->TotalCycles  += Cycles;
+   ProfileTask->WindowCycles += Cycles;
+
+   if(Cycles > ProfileTask->MaximumCycles)
+      ProfileTask->MaximumCycles = Cycles;
+
+   /* Determine which histogram bin this call falls in.                 */
+   for(Index = 0; (Index < (BTPS_TASK_CYCLE_HISTOGRAM_BINS - 1)) && (Cycles >= CycleBinLimit[Index]); Index++)
+      ;
+
+   ProfileTask->CycleHistogram[Index]++;
+
+   LoadWindowBusyCycles += Cycles;
+   TotalBusyCycles      += Cycles;
+}
+
+   /* The following function is used to complete the current CPU load   */
+   /* window (and start a new window) once the window length has        */
+   /* elapsed.  The function takes as its parameter the current tick    */
+   /* count.                                                            */
+   /* * NOTE * The length of the window is determined from the Tick     */
+   /*          Count rather than the cycle counter because the cycle    */
+   /*          counter may stop while the processor is in a low power   */
+   /*          mode.                                                    */
+static void UpdateLoadWindow(unsigned long CurrentTickCount)
+{
+   unsigned int  Index;
+   unsigned long ElapsedTicks;
+
+   ElapsedTicks = CurrentTickCount - LoadWindowStartTick;
+
+   if(ElapsedTicks >= SCHEDULER_PROFILE_LOAD_WINDOW)
+   {
+      LastLoadWindowCycles     = (unsigned long)((((QWord_t)ElapsedTicks) * BTPS_TICK_COUNT_INTERVAL * CyclesPerSecond) / 1000);
+      LastLoadWindowBusyCycles = LoadWindowBusyCycles;
+
+      LoadWindowStartTick      = CurrentTickCount;
+      LoadWindowBusyCycles     = 0;
+
+      for(Index = 0; Index <= SCHEDULER_PROFILE_OVERFLOW_TASK; Index++)
+      {
+         ProfileTaskList[Index].LastWindowCycles = ProfileTaskList[Index].WindowCycles;
+         ProfileTaskList[Index].WindowCycles     = 0;
+      }
+   }
+}
+
+   /* The following function is used to determine the value that the    */
+   /* profile task table is ordered by (the total execution time).  See */
+   /* ProfileEntryValueFunction_t.                                      */
+static Boolean_t GetProfileTaskValue(void *Entry, QWord_t *Value)
+{
+   *Value = ((ProfileTask_t *)Entry)->TotalCycles;
+
+   return((Boolean_t)(((ProfileTask_t *)Entry)->NumberCalls != 0));
+}
+
+   /* The following function is used to walk the profile task table in  */
+   /* order of decreasing total execution time.  The function takes as  */
+   /* its parameter the index of the previously returned task (or a     */
+   /* negative value to start) and returns the index of the next task,  */
+   /* or a negative value if there are no more tasks.                   */
+static int SelectNextProfileTask(int PreviousTask)
+{
+   return(SelectNextProfileEntry(ProfileTaskList, sizeof(ProfileTask_t), SCHEDULER_PROFILE_MAXIMUM_TASKS, GetProfileTaskValue, PreviousTask));
+}
+
+#endif
+
+   /* The following function is used to find the lowest word of the     */
+   /* registered stack that is no longer painted.  The function takes as*/
+   /* its parameters the first word to check and the word at which to   */
+   /* stop.  The function returns the first word (at or above the start)*/
+   /* that does not hold the paint pattern, or the limit if every word  */
+   /* is still painted.                                                 */
+   /* * NOTE * A word that was used but happens to hold the paint       */
+   /*          pattern is not detected, which is why the search always  */
+   /*          starts from a word that is known to be painted.          */
+static unsigned long *FindStackLowWater(unsigned long *Start, unsigned long *Limit)
+{
+   while((Start < Limit) && (*Start == STACK_PAINT_PATTERN))
+      Start++;
+
+   return(Start);
+}
+
+#ifdef STACK_PROFILE_ENABLED
+
+   /* The following function is used to record the stack usage of a     */
+   /* single call of a task that has just returned.  The function takes */
+   /* as its parameter the function that was called.  The deepest word  */
+   /* that the task used is found and the words that the task used are  */
+   /* then painted again, so that the next task is measured on its own. */
+   /* * NOTE * This function *MUST* be called from the same function    */
+   /*          that called the task (so that the task and this function */
+   /*          start at the same point of the stack).                   */
+   /* * NOTE * Any ISR that interrupts the task uses the same stack, so */
+   /*          the usage of the ISR is included, which is what is needed*/
+   /*          to size the stack.                                       */
+static void ProfileStackUsage(BTPS_SchedulerFunction_t TaskFunction)
+{
+   unsigned long       Marker;
+   unsigned long      *Limit;
+   unsigned long      *LowWater;
+   unsigned long       Usage;
+   StackProfileTask_t *ProfileTask;
+
+   Limit = STACK_PAINT_LIMIT(&Marker);
+
+   /* Nothing can be measured unless this function is running on the    */
+   /* registered stack.                                                 */
+   if((StackBottom) && (Limit > StackBottom) && (Limit < StackTop))
+   {
+      /* The words between the low water mark and this point were       */
+      /* painted after the previous task, so the task is normally found */
+      /* by searching upwards from the low water mark.  If the task went*/
+      /* below the low water mark (or this point is below it) the whole */
+      /* stack has to be searched.                                      */
+      if((StackLowWater > Limit) || ((StackLowWater > StackBottom) && (StackLowWater[-1] != STACK_PAINT_PATTERN)))
+      {
+         LowWater = FindStackLowWater(StackBottom, Limit);
+
+         if(LowWater < StackLowWater)
+            StackLowWater = LowWater;
+      }
+      else
+         LowWater = FindStackLowWater(StackLowWater, Limit);
+
+      Usage       = (unsigned long)(((unsigned char *)StackTop) - ((unsigned char *)LowWater));
+      ProfileTask = &(StackProfileTaskList[FindProfileEntry(StackProfileTaskList, sizeof(StackProfileTask_t), STACK_PROFILE_MAXIMUM_TASKS, (ProfileKey_t)TaskFunction)]);
+
+      ProfileTask->NumberCalls++;
+
+      if(Usage > ProfileTask->MaximumUsage)
+         ProfileTask->MaximumUsage = Usage;
+
+      /* Paint the words that the task used (they are no longer in use).*/
+      while(LowWater < Limit)
+         *(LowWater++) = STACK_PAINT_PATTERN;
+   }
+}
+
+   /* The following function is used to paint every word of the         */
+   /* registered stack (below the caller) that has been used, so that   */
+   /* this usage is not charged to the next task that is measured.  The */
+   /* low water mark is updated first so that the usage is not lost.    */
+static void RepaintStack(void)
+{
+   unsigned long  Marker;
+   unsigned long *Limit;
+   unsigned long *LowWater;
+
+   Limit = STACK_PAINT_LIMIT(&Marker);
+
+   if((StackBottom) && (Limit > StackBottom) && (Limit < StackTop))
+   {
+      LowWater = FindStackLowWater(StackBottom, Limit);
+
+      if(LowWater < StackLowWater)
+         StackLowWater = LowWater;
+
+      while(LowWater < Limit)
+         *(LowWater++) = STACK_PAINT_PATTERN;
+   }
+}
+
+   /* The following function is used to determine the value that the    */
+   /* stack profile task table is ordered by (the stack usage).  See    */
+   /* ProfileEntryValueFunction_t.                                      */
+static Boolean_t GetStackProfileTaskValue(void *Entry, QWord_t *Value)
+{
+   *Value = ((StackProfileTask_t *)Entry)->MaximumUsage;
+
+   return((Boolean_t)(((StackProfileTask_t *)Entry)->NumberCalls != 0));
+}
+
+   /* The following function is used to walk the stack profile task     */
+   /* table in order of decreasing stack usage.  The function takes as  */
+   /* its parameter the index of the previously returned task (or a     */
+   /* negative value to start) and returns the index of the next task,  */
+   /* or a negative value if there are no more tasks.                   */
+static int SelectNextStackProfileTask(int PreviousTask)
+{
+   return(SelectNextProfileEntry(StackProfileTaskList, sizeof(StackProfileTask_t), STACK_PROFILE_MAXIMUM_TASKS, GetStackProfileTaskValue, PreviousTask));
+}
+
+#endif
+
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+   /* The following function is used to record a single critical section*/
+   /* in the critical section profile.  The function takes as its       */
+   /* parameters the site of the critical section and the time (in      */
+   /* cycles) that interrupts were disabled.                            */
+   /* * NOTE * This function is called with interrupts disabled, so it  */
+   /*          only does the minimum amount of work (all conversions to */
+   /*          time are done when the profile is queried).              */
+static void ProfileCriticalSection(BTPSCONST void *Site, unsigned long Cycles)
+{
+   unsigned int           Index;
+   CriticalSectionSite_t *ProfileSite;
+
+   ProfileSite = &(CriticalSectionSiteList[FindProfileEntry(CriticalSectionSiteList, sizeof(CriticalSectionSite_t), CRITICAL_SECTION_PROFILE_MAXIMUM_SITES, (ProfileKey_t)Site)]);
+
+   ProfileSite->NumberCalls++;
+   ProfileSite->TotalCycles += Cycles;
+
+   if(Cycles > ProfileSite->MaximumCycles)
+      ProfileSite->MaximumCycles = Cycles;
+
+   /* Determine which histogram bin this critical section falls in.     */
+   for(Index = 0; (Index < (BTPS_CRITICAL_SECTION_HISTOGRAM_BINS - 1)) && (Cycles >= CriticalSectionBinCycles[Index]); Index++)
+      ;
+
+   ProfileSite->CycleHistogram[Index]++;
+}
+
+   /* The following function is used to determine the value that the    */
+   /* critical section site table is ordered by (the maximum duration). */
+   /* See ProfileEntryValueFunction_t.                                  */
+static Boolean_t GetCriticalSectionSiteValue(void *Entry, QWord_t *Value)
+{
+   *Value = ((CriticalSectionSite_t *)Entry)->MaximumCycles;
+
+   return((Boolean_t)(((CriticalSectionSite_t *)Entry)->NumberCalls != 0));
+}
+
+   /* The following function is used to walk the critical section site  */
+   /* table in order of decreasing maximum duration.  The function takes*/
+   /* as its parameter the index of the previously returned site (or a  */
+   /* negative value to start) and returns the index of the next site,  */
+   /* or a negative value if there are no more sites.                   */
+static int SelectNextCriticalSectionSite(int PreviousSite)
+{
+   return(SelectNextProfileEntry(CriticalSectionSiteList, sizeof(CriticalSectionSite_t), CRITICAL_SECTION_PROFILE_MAXIMUM_SITES, GetCriticalSectionSiteValue, PreviousSite));
+}
+
+   /* The following function is used to convert the specified number of */
+   /* cycles of the registered cycle counter to microseconds.           */
+static unsigned long CyclesToMicroseconds(QWord_t Cycles)
+{
+   return((unsigned long)((Cycles * 1000000) / CyclesPerSecond));
+}
+
+#endif
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register an additional memory region as a heap (for example, a    */
+   /* second bank of RAM).  Memory may then be allocated from this heap */
+   /* with BTPS_AllocateMemoryFromHeap() which keeps these allocations  */
+   /* separate from the default heap.  This function accepts as input a */
+   /* pointer to the memory region and the size (in bytes) of the       */
+   /* region.  This function returns a positive, non-zero, Heap ID if   */
+   /* successful or a negative value if there was an error.             */
+   /* * NOTE * Memory allocated from any heap is freed with             */
+   /*          BTPS_FreeMemory().                                       */
+   /* * NOTE * The memory region may not overlap the default heap or any*/
+   /*          heap that is already registered (an error is returned).  */
+int BTPSAPI BTPS_RegisterHeap(void *HeapRegion, unsigned long RegionSize)
+{
+   int           ret_val;
+   unsigned int  Index;
+   unsigned long Adjust;
+
+   /* Align the start of the region.                                    */
+   if((HeapRegion) && ((Adjust = ((unsigned long)HeapRegion) % ALIGNMENT_SIZE) != 0))
+   {
+      Adjust     = ALIGNMENT_SIZE - Adjust;
+      HeapRegion = ((unsigned char *)HeapRegion) + Adjust;
+      RegionSize = (RegionSize > Adjust)?(RegionSize - Adjust):0;
+   }
+
+   /* Make sure the region is valid and that it does not overlap with   */
+   /* the default heap or any heap that is already registered.          */
+   if((HeapRegion) && (RegionSize > HEAP_INFO_SIZE(MINIMUM_MEMORY_SIZE)) && (!RegionOverlapsHeap(HeapRegion, RegionSize)))
+   {
+      /* Find a free entry in the heap list (the default heap always    */
+      /* occupies the first entry).                                     */
+      for(Index = 1; (Index < BTPS_MAXIMUM_NUMBER_HEAPS) && (HeapList[Index]); Index++)
+         ;
+
+      if(Index < BTPS_MAXIMUM_NUMBER_HEAPS)
+      {
+         /* Clear the heap header so that the heap will be initialized  */
+         /* regardless of what the region contained.                    */
+         ((HeapInfo_t *)HeapRegion)->Initialized = FALSE;
+
+         HeapInit(HeapRegion, RegionSize);
+
+         if(((HeapInfo_t *)HeapRegion)->Initialized)
+         {
+            HeapList[Index] = (HeapInfo_t *)HeapRegion;
+
+            if(Index >= NumberHeaps)
+               NumberHeaps = Index + 1;
+
+#ifdef MEMORY_TRACE_ENABLED
+
+            TraceOperation(MEMORY_TRACE_OPERATION_HEAP, Index, NULL, NULL, MEMORY_TRACE_HEAP_SIZE(HeapList[Index]));
+
+#endif
+
+            ret_val = (int)Index;
+         }
+         else
+            ret_val = -1;
+      }
+      else
+         ret_val = -1;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to remove */
+   /* a heap that was registered with BTPS_RegisterHeap().  This        */
+   /* function accepts as input the Heap ID that was returned from a    */
+   /* successful call to BTPS_RegisterHeap().  This function returns    */
+   /* zero if successful or a negative value if there was an error.     */
+   /* * NOTE * A heap can only be removed when there are no outstanding */
+   /*          allocations from the heap.                               */
+int BTPSAPI BTPS_UnRegisterHeap(unsigned int HeapID)
+{
+   int ret_val;
+
+   if((HeapID != BTPS_DEFAULT_HEAP_ID) && (HeapID < NumberHeaps) && (HeapList[HeapID]) && (!HeapList[HeapID]->CurrentHeapUsed))
+   {
+      HeapList[HeapID]->Initialized = FALSE;
+      HeapList[HeapID]              = NULL;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for the Memory Usage        */
+   /* Information of the specified heap.  This function accepts as its  */
+   /* parameters the Heap ID of the heap to query, a pointer to a memory*/
+   /* statistics structure and a flag to indicate if fragment           */
+   /* information will be determined.  The function will return zero if */
+   /* successful or a negative value if there is an error.              */
+   /* * NOTE * If the advanced statistics flag is set to FALSE, then the*/
+   /*          largest free fragment and free fragment count will be set*/
+   /*          to zero.                                                 */
+int BTPSAPI BTPS_QueryHeapUsage(unsigned int HeapID, BTPS_MemoryStatistics_t *MemoryStatistics, Boolean_t AdvancedStatitics)
+{
+   int ret_val;
+
+   if(HeapID < NumberHeaps)
+      ret_val = GetHeapStatistics(HeapList[HeapID], MemoryStatistics, AdvancedStatitics);
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for querying the            */
+   /* fragmentation statistics of the specified heap.  This function    */
+   /* accepts as its parameters the Heap ID of the heap to query and a  */
+   /* pointer to a structure that is to receive the statistics.  The    */
+   /* function will return zero if successful or a negative value if    */
+   /* there is an error.                                                */
+   /* * NOTE * This function does not walk the heap, so it is cheap     */
+   /*          enough to be called periodically.                        */
+int BTPSAPI BTPS_QueryHeapFragmentation(unsigned int HeapID, BTPS_FragmentationStatistics_t *FragmentationStatistics)
+{
+   int           ret_val;
+   unsigned int  Index;
+   HeapInfo_t   *HeapInfo;
+
+   if((HeapID < NumberHeaps) && ((HeapInfo = HeapList[HeapID]) != NULL) && (HeapInfo->Initialized) && (FragmentationStatistics))
+   {
+      BTPS_MemInitialize(FragmentationStatistics, 0, sizeof(BTPS_FragmentationStatistics_t));
+
+      FragmentationStatistics->FreeBytes           = HeapInfo->FreeHeapSize * ALIGNMENT_SIZE;
+      FragmentationStatistics->FreeFragmentCount   = HeapInfo->FreeBlockCount;
+      FragmentationStatistics->LargestFreeFragment = GetLargestFreeBlock(HeapInfo) * ALIGNMENT_SIZE;
+
+      /* The fragmentation index is the portion (in tenths of a percent)*/
+      /* of the free memory that is NOT part of the largest free block. */
+      if(FragmentationStatistics->FreeBytes)
+         FragmentationStatistics->FragmentationIndex = 1000 - (unsigned int)((((unsigned long)FragmentationStatistics->LargestFreeFragment) * 1000) / FragmentationStatistics->FreeBytes);
+
+      /* The histogram bins are the first level size classes.           */
+      for(Index = 0; (Index < FIRST_LEVEL_INDEX_COUNT) && (Index < BTPS_FREE_SIZE_HISTOGRAM_BINS); Index++)
+         FragmentationStatistics->FreeSizeHistogram[Index] = HeapInfo->FreeClassCount[Index];
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for retrieving the          */
+   /* allocation profile (when the kernel is built with                 */
+   /* MEMORY_PROFILE_ENABLED defined).  This function accepts as its    */
+   /* parameters the maximum number of sites to return and a pointer to */
+   /* an array (of at least this many entries) that is to receive the   */
+   /* site statistics.  The sites are returned in order of decreasing   */
+   /* number of bytes currently held (i.e. the top N sites).  This      */
+   /* function returns the number of sites that were returned if        */
+   /* successful or a negative value if there was an error (or profiling*/
+   /* is not enabled).                                                  */
+int BTPSAPI BTPS_QueryAllocationProfile(unsigned int MaximumSites, BTPS_AllocationSiteStatistics_t *SiteStatistics)
+{
+   int ret_val;
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+   int Index;
+
+   if(SiteStatistics)
+   {
+      for(ret_val = 0, Index = SelectNextProfileSite(-1); (Index >= 0) && ((unsigned int)ret_val < MaximumSites); Index = SelectNextProfileSite(Index), ret_val++, SiteStatistics++)
+      {
+         SiteStatistics->SiteAddress       = (ProfileSiteList[Index].Tagged)?NULL:(BTPSCONST void *)ProfileSiteList[Index].Key;
+         SiteStatistics->Tag               = (ProfileSiteList[Index].Tagged)?(BTPSCONST char *)ProfileSiteList[Index].Key:NULL;
+         SiteStatistics->NumberAllocations = ProfileSiteList[Index].NumberAllocations;
+         SiteStatistics->NumberFrees       = ProfileSiteList[Index].NumberFrees;
+         SiteStatistics->NumberFailures    = ProfileSiteList[Index].NumberFailures;
+         SiteStatistics->CurrentBytes      = ProfileSiteList[Index].CurrentBytes;
+         SiteStatistics->PeakBytes         = ProfileSiteList[Index].PeakBytes;
+
+         BTPS_MemCopy(SiteStatistics->LifetimeHistogram, ProfileSiteList[Index].LifetimeHistogram, sizeof(SiteStatistics->LifetimeHistogram));
+      }
+   }
+   else
+      ret_val = -1;
+
+#else
+
+   UNREFERENCED_PARAMETER(MaximumSites);
+   UNREFERENCED_PARAMETER(SiteStatistics);
+
+   ret_val = -1;
+
+#endif
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the top N    */
+   /* allocation sites (when the kernel is built with                   */
+   /* MEMORY_PROFILE_ENABLED defined) via BTPS_OutputMessage().  This   */
+   /* function accepts as its parameter the maximum number of sites to  */
+   /* display.                                                          */
+void BTPSAPI BTPS_DumpAllocationProfile(unsigned int NumberSites)
+{
+#ifdef MEMORY_PROFILE_ENABLED
+
+   int Index;
+
+   BTPS_OutputMessage("\r\n  Site       Current     Peak   Allocs    Frees Failures | Lifetime <10ms <100ms <1s <10s <60s >=60s\r\n");
+
+   for(Index = SelectNextProfileSite(-1); (Index >= 0) && (NumberSites); Index = SelectNextProfileSite(Index), NumberSites--)
+   {
+      if(ProfileSiteList[Index].Tagged)
+         BTPS_OutputMessage("  %-10.10s", (BTPSCONST char *)ProfileSiteList[Index].Key);
+      else
+         OutputProfileEntryName(ProfileSiteList[Index].Key);
+
+      BTPS_OutputMessage(" %8lu %8lu %8lu %8lu %8lu |", ProfileSiteList[Index].CurrentBytes, ProfileSiteList[Index].PeakBytes, ProfileSiteList[Index].NumberAllocations, ProfileSiteList[Index].NumberFrees, ProfileSiteList[Index].NumberFailures);
+      BTPS_OutputMessage(" %lu %lu %lu %lu %lu %lu\r\n", ProfileSiteList[Index].LifetimeHistogram[0], ProfileSiteList[Index].LifetimeHistogram[1], ProfileSiteList[Index].LifetimeHistogram[2], ProfileSiteList[Index].LifetimeHistogram[3], ProfileSiteList[Index].LifetimeHistogram[4], ProfileSiteList[Index].LifetimeHistogram[5]);
+   }
+
+#else
+
+   UNREFERENCED_PARAMETER(NumberSites);
+
+#endif
+}
+
+   /* The following function is responsible for starting or stopping the*/
+   /* allocation trace (when the kernel is built with                   */
+   /* MEMORY_TRACE_ENABLED defined).  This function accepts as its      */
+   /* parameter a flag that specifies if the trace is to be started     */
+   /* (TRUE) or stopped (FALSE).  When the trace is started the ID and  */
+   /* size of every heap and all blocks that are currently allocated are*/
+   /* written to the debug output.  When the trace is stopped all       */
+   /* buffered records are written to the debug output.                 */
+void BTPSAPI BTPS_EnableMemoryTrace(Boolean_t Enable)
+{
+#ifdef MEMORY_TRACE_ENABLED
+
+   unsigned int  Index;
+   HeapInfo_t   *HeapInfo;
+   BlockInfo_t  *BlockInfo;
+
+   if((Enable) && (!TraceActive))
+   {
+      /* Record every heap and every block that is currently allocated  */
+      /* so that the replay starts from the same heap state.            */
+      for(Index = 0; Index < NumberHeaps; Index++)
+      {
+         if(((HeapInfo = HeapList[Index]) != NULL) && (HeapInfo->Initialized))
+         {
+            BTPS_OutputMessage("MT H %X %lX\r\n", Index, MEMORY_TRACE_HEAP_SIZE(HeapInfo));
+
+            BlockInfo = HeapInfo->HeapHead;
+            while(BlockInfo < HeapInfo->HeapTail)
+            {
+               if(BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK)
+                  BTPS_OutputMessage("MT A 0 %X %lX %lX\r\n", Index, (unsigned long)(((BlockInfo->Size & SEGMENT_SIZE_BITMASK) - BLOCK_INFO_SIZE(0)) * ALIGNMENT_SIZE), (unsigned long)BlockInfo->Data);
+
+               BlockInfo = (BlockInfo_t *)(((Alignment_t *)BlockInfo) + (BlockInfo->Size & SEGMENT_SIZE_BITMASK));
+            }
+         }
+      }
+
+      NumberTraceRecords = 0;
+      TraceActive        = TRUE;
+   }
+   else
+   {
+      if((!Enable) && (TraceActive))
+      {
+         TraceActive = FALSE;
+
+         FlushTrace();
+
+         BTPS_OutputMessage("MT E\r\n");
+      }
+   }
+
+#else
+
+   UNREFERENCED_PARAMETER(Enable);
+
+#endif
+}
+
+   /* The following function is responsible for writing all allocation  */
+   /* trace records that are currently buffered to the debug output     */
+   /* (when the kernel is built with MEMORY_TRACE_ENABLED defined).     */
+   /* * NOTE * Records are written automatically when the buffer fills, */
+   /*          this function can be used to write them at a more        */
+   /*          convenient time (for example when the application is     */
+   /*          idle).                                                   */
+void BTPSAPI BTPS_FlushMemoryTrace(void)
+{
+#ifdef MEMORY_TRACE_ENABLED
+
+   FlushTrace();
+
+#endif
+}
+
+   /* The following function is responsible for delaying the current    */
+   /* task for the specified duration (specified in Milliseconds).      */
+   /* * NOTE * Very small timeouts might be smaller in granularity than */
+   /*          the system can support !!!!                              */
+void BTPSAPI BTPS_Delay(unsigned long MilliSeconds)
+{
+   unsigned long StartTickCount;
+   unsigned long ElapsedTicks;
+
+   /* Increment the delay time by one millisecond to ensure that the    */
+   /* caller gets at least as much time as they requested.              */
+   MilliSeconds   += 1;
+
+   StartTickCount  = BTPS_GetTickCount();
+
+   /* Note that the unsigned subtraction yields the correct elapsed time*/
+   /* even if the Tick Count wraps during the delay.                    */
+   while((ElapsedTicks = (BTPS_GetTickCount() - StartTickCount)) < MilliSeconds)
+   {
+      /* Let the platform sleep until the delay expires (or an interrupt*/
+      /* occurs), otherwise simply poll the Tick Count.                 */
+      if(SleepCallback)
+         (*SleepCallback)(MilliSeconds - ElapsedTicks);
+   }
+}
+
+   /* The following function is responsible for delaying the current    */
+   /* task for the specified duration (specified in Microseconds).  The */
+   /* delay is timed with the counter that was registered with          */
+   /* BTPS_RegisterCycleCounter().                                      */
+   /* * NOTE * This function busy waits and is intended for short       */
+   /*          (sub-millisecond) delays.                                */
+void BTPSAPI BTPS_DelayMicroseconds(unsigned long MicroSeconds)
+{
+   unsigned long StartCycleCount;
+   unsigned long DelayCycles;
+
+   if((MicroSeconds) && (GetCycleCountCallback))
+   {
+      /* Convert the delay to counts of the counter, rounding up and    */
+      /* adding a count (the current count may have almost elapsed) to  */
+      /* ensure that the caller gets at least as much time as they      */
+      /* requested.                                                     */
+      DelayCycles     = (unsigned long)(((((QWord_t)MicroSeconds) * CyclesPerSecond) + 999999) / 1000000) + 1;
+
+      StartCycleCount = (*GetCycleCountCallback)();
+
+      while(((*GetCycleCountCallback)() - StartCycleCount) < DelayCycles)
+         ;
+   }
+}
+
+   /* The following function is responsible for retrieving the current  */
+   /* Tick Count of system.  This function returns the System Tick Count*/
+   /* in Milliseconds resolution.                                       */
+unsigned long BTPSAPI BTPS_GetTickCount(void)
+{
+   /* Simply wrap the application-supplied get tick count function.     */
+   if(GetTickCountCallback)
+      return((*GetTickCountCallback)());
+   else
+      return(0);
+}
+
+   /* The following function is responsible for retrieving the current  */
+   /* Timestamp of the system.  This function returns a 64 bit,         */
+   /* monotonic time in Microseconds.                                   */
+QWord_t BTPSAPI BTPS_GetTimestamp(void)
+{
+   /* Simply wrap the registered get timestamp function.                */
+   if(GetTimestampCallback)
+      return((*GetTimestampCallback)());
+   else
+      return(0);
+}
+
+   /* The following function is provided to allow a mechanism for adding*/
+   /* Scheduler Functions to the Scheduler.  These functions are called */
+   /* periodically by the Scheduler (based upon the requested Schedule  */
+   /* Period).  This function accepts as input the Scheduler Function to*/
+   /* add to the Scheduler, the Scheduler parameter that is passed to   */
+   /* the Scheduled function, and the Scheduler Period.  The Scheduler  */
+   /* Period is specified in Milliseconds.  This function returns TRUE  */
+   /* if the function was added successfully or FALSE if there was an   */
+   /* error.                                                            */
+   /* * NOTE * Once a function is added to the Scheduler, it can only be*/
+   /*          removed by calling the BTPS_DeleteFunctionFromScheduler()*/
+   /*          function.                                                */
+   /* * NOTE * The BTPS_ExecuteScheduler() function *MUST* be called    */
+   /*          ONCE (AND ONLY ONCE) to begin the Scheduler Executing    */
+   /*          periodic Scheduled functions (or calling the             */
+   /*          BTPS_ProcessScheduler() function repeatedly.             */
+Boolean_t BTPSAPI BTPS_AddFunctionToScheduler(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, unsigned int Period)
+{
+   return(BTPS_AddFunctionToSchedulerWithPriority(SchedulerFunction, SchedulerParameter, Period, BTPS_SCHEDULER_PRIORITY_NORMAL));
+}
+
+   /* The following function is provided to allow a mechanism for adding*/
+   /* Scheduler Functions of a specific priority class to the Scheduler.*/
+   /* This function is identical to BTPS_AddFunctionToScheduler() except*/
+   /* that the final parameter specifies the priority class of the      */
+   /* function (BTPS_SCHEDULER_PRIORITY_xxx).  This function returns    */
+   /* TRUE if the function was added successfully or FALSE if there was */
+   /* an error.                                                         */
+Boolean_t BTPSAPI BTPS_AddFunctionToSchedulerWithPriority(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, unsigned int Period, unsigned int Priority)
+{
+   Boolean_t ret_val;
+
+#if BTPS_MINIMUM_SCHEDULER_RESOLUTION
+
+   if(Period < BTPS_MINIMUM_SCHEDULER_RESOLUTION)
+      Period = BTPS_MINIMUM_SCHEDULER_RESOLUTION;
+
+#endif
+
+   /* A Period of zero means that the function is to be called on every */
+   /* pass through the Scheduler in which time has elapsed (i.e. every  */
+   /* tick), this must not be confused with a one-shot timer.           */
+   if(!Period)
+      Period = 1;
+
+   /* A Scheduled Function is simply a periodic timer that first expires*/
+   /* one period from now.                                              */
+   if(BTPS_StartTimerWithPriority(Period, Period, SchedulerFunction, SchedulerParameter, Priority))
+      ret_val = TRUE;
+   else
+      ret_val = FALSE;
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism for       */
+   /* deleting a Function that has previously been registered with the  */
+   /* Scheduler via a successful call to the                            */
+   /* BTPS_AddFunctionToScheduler() function.  This function accepts as */
+   /* input the Scheduler Function to that was added to the Scheduler,  */
+   /* as well as the Scheduler Parameter that was registered.  Both of  */
+   /* these values *must* match to remove a specific Scheduler Entry.   */
+void BTPSAPI BTPS_DeleteFunctionFromScheduler(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter)
+{
+   unsigned int Index;
+
+   /* First, let's make sure that the Scheduler has been initialized    */
+   /* successfully.                                                     */
+   if(SchedulerInitialized)
+   {
+      /* Next, let's make sure that the Scheduled Function specified    */
+      /* appears to be semi-valid.                                      */
+      if(SchedulerFunction)
+      {
+         /* Loop through the scheduler and remove the function (if we   */
+         /* find it).                                                   */
+         for(Index = 0; Index < NumberSchedulerEntries; Index++)
+         {
+            if(((SchedulerInformation[Index].State == SCHEDULER_ENTRY_STATE_QUEUED) || (SchedulerInformation[Index].State == SCHEDULER_ENTRY_STATE_RUNNING)) && (SchedulerInformation[Index].Period) && (SchedulerInformation[Index].ScheduleFunction == SchedulerFunction) && (SchedulerInformation[Index].ScheduleParameter == SchedulerParameter))
+            {
+               BTPS_StopTimer(SchedulerInformation[Index].TimerID);
+               break;
+            }
+         }
+      }
+   }
+}
+
+   /* The following function is provided to allow a mechanism to start a*/
+   /* timer.  When the timer expires the specified Timer Function is    */
+   /* called (from the Scheduler).  This function accepts as input the  */
+   /* Timeout (in Milliseconds) until the timer first expires, the      */
+   /* Period (in Milliseconds) of the timer (zero for a one-shot timer),*/
+   /* the Timer Function and the parameter that is passed to the Timer  */
+   /* Function.  This function returns a positive, non-zero, Timer ID if*/
+   /* successful or zero if there was an error.                         */
+   /* * NOTE * A one-shot timer is automatically stopped once it has    */
+   /*          expired (and the Timer ID is no longer valid).           */
+   /* * NOTE * The timers are kept in a queue that is ordered by        */
+   /*          deadline so the cost of starting or stopping a timer (and*/
+   /*          of each pass through the Scheduler) does not depend on   */
+   /*          the number of timers that have not yet expired.          */
+   /* * NOTE * A periodic timer expires at whole multiples of the Period*/
+   /*          from the first expiration, late execution of one period  */
+   /*          does not delay the following periods.                    */
+unsigned int BTPSAPI BTPS_StartTimer(unsigned long Timeout, unsigned long Period, BTPS_SchedulerFunction_t TimerFunction, void *TimerParameter)
+{
+   return(BTPS_StartTimerWithPriority(Timeout, Period, TimerFunction, TimerParameter, BTPS_SCHEDULER_PRIORITY_NORMAL));
+}
+
+   /* The following function is provided to allow a mechanism to start a*/
+   /* timer of a specific priority class.  This function is identical to*/
+   /* BTPS_StartTimer() except that the final parameter specifies the   */
+   /* priority class of the timer (BTPS_SCHEDULER_PRIORITY_xxx).  This  */
+   /* function returns a positive, non-zero, Timer ID if successful or  */
+   /* zero if there was an error.                                       */
+unsigned int BTPSAPI BTPS_StartTimerWithPriority(unsigned long Timeout, unsigned long Period, BTPS_SchedulerFunction_t TimerFunction, void *TimerParameter, unsigned int Priority)
+{
+   unsigned int ret_val;
+   unsigned int EntryIndex;
+
+   /* First, let's make sure that the Scheduler has been initialized    */
+   /* successfully AND that the Timer Function and Priority appear to be*/
+   /* semi-valid.                                                       */
+   if((SchedulerInitialized) && (TimerFunction) && (Priority < BTPS_SCHEDULER_NUMBER_PRIORITIES))
+   {
+      if((EntryIndex = AllocateSchedulerEntry()) != SCHEDULER_ENTRY_INVALID)
+      {
+         /* A timer cannot expire during the same tick in which it was  */
+         /* started (or re-started).                                    */
+         if(!Timeout)
+            Timeout = 1;
+
+         SchedulerInformation[EntryIndex].Deadline          = BTPS_GetTickCount() + Timeout;
+         SchedulerInformation[EntryIndex].Period            = Period;
+         SchedulerInformation[EntryIndex].ScheduleFunction  = TimerFunction;
+         SchedulerInformation[EntryIndex].ScheduleParameter = TimerParameter;
+         SchedulerInformation[EntryIndex].Priority          = Priority;
+         SchedulerInformation[EntryIndex].CatchUpCount      = 0;
+
+         BTPS_MemInitialize(&(SchedulerInformation[EntryIndex].Statistics), 0, sizeof(BTPS_TimerStatistics_t));
+
+         QueueInsert(EntryIndex);
+
+         ret_val = SchedulerInformation[EntryIndex].TimerID;
+      }
+      else
+         ret_val = 0;
+   }
+   else
+      ret_val = 0;
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to stop a */
+   /* timer that was started with BTPS_StartTimer().  This function     */
+   /* accepts as input the Timer ID that was returned from              */
+   /* BTPS_StartTimer().  This function returns TRUE if the timer was   */
+   /* stopped or FALSE if the Timer ID is not valid (for example, a     */
+   /* one-shot timer that has already expired).                         */
+   /* * NOTE * A timer may be stopped from its own Timer Function.      */
+Boolean_t BTPSAPI BTPS_StopTimer(unsigned int TimerID)
+{
+   Boolean_t    ret_val;
+   unsigned int EntryIndex;
+
+   EntryIndex = TIMER_ID_TO_SCHEDULER_ENTRY(TimerID);
+
+   if((SchedulerInitialized) && (TimerID) && (EntryIndex < NumberSchedulerEntries) && (SchedulerInformation[EntryIndex].TimerID == TimerID))
+   {
+      switch(SchedulerInformation[EntryIndex].State)
+      {
+         case SCHEDULER_ENTRY_STATE_QUEUED:
+            QueueRemove(EntryIndex);
+
+            FreeSchedulerEntryInformation(EntryIndex);
+
+            ret_val = TRUE;
+            break;
+         case SCHEDULER_ENTRY_STATE_RUNNING:
+            /* The timer is being stopped from its own Timer Function,  */
+            /* the Scheduler will free the entry when the function      */
+            /* returns.                                                 */
+            SchedulerInformation[EntryIndex].State = SCHEDULER_ENTRY_STATE_CANCELLED;
+
+            ret_val = TRUE;
+            break;
+         default:
+            ret_val = FALSE;
+            break;
+      }
+   }
+   else
+      ret_val = FALSE;
+
+   return(ret_val);
+}
+
+   /* The following function begins execution of the actual Scheduler.  */
+   /* Once this function is called, it NEVER returns.  This function is */
+   /* responsible for executing all functions that have been added to   */
+   /* the Scheduler with the BTPS_AddFunctionToScheduler() function.    */
+void BTPSAPI BTPS_ExecuteScheduler(void)
+{
+   Boolean_t     Done;
+   unsigned long Timeout;
+
+   /* Initialize the Scheduler state information.                       */
+   Done = FALSE;
+
+#ifdef STACK_PROFILE_ENABLED
+
+   /* The stack that was used before the Scheduler was started (e.g. to */
+   /* open the Bluetooth stack) is not part of any task.                */
+   RepaintStack();
+
+#endif
+
+   /* Simply loop until Done (Forever), calling each scheduled function */
+   /* when it expires.                                                  */
+   while(!Done)
+   {
+      /* Simply process the scheduler.                                  */
+      BTPS_ProcessScheduler();
+
+      /* If nothing is due, write out part of the deferred log (if there*/
+      /* is one) or let the platform idle until the next deadline (or an*/
+      /* interrupt).                                                    */
+      if((Timeout = BTPS_QuerySchedulerTimeout()) != 0)
+      {
+#ifdef DEFERRED_LOG_ENABLED
+         if(NumberLogRecords)
+            FlushLog(DEFERRED_LOG_FLUSH_RECORDS);
+         else
+#endif
+         {
+            if(IdleCallback)
+               (*IdleCallback)(Timeout);
+         }
+
+#ifdef STACK_PROFILE_ENABLED
+
+         /* The idle processing is accounted to the Idle Callback so    */
+         /* that it is not charged to the next task.                    */
+         ProfileStackUsage(TASK_FUNCTION_KEY(IdleCallback));
+
+#endif
+      }
+   }
+}
+
+   /* The following function is provided to allow a mechanism to process*/
+   /* the scheduled functions in the scheduler.  This function performs */
+   /* the same functionality as the BTPS_ExecuteScheduler() function    */
+   /* except that it returns as soon as it has made an iteration through*/
+   /* the scheduled functions.  This function is provided for platforms */
+   /* that would like to implement their own processing loop and/or     */
+   /* scheduler and not rely on the Bluetopia implementation.           */
+   /* * NOTE * This function should NEVER be called if the              */
+   /*          BTPS_ExecuteScheduler() schema is used.                  */
+   /* * NOTE * This function *MUST* not be called from any scheduled    */
+   /*          function that was added to the scheduler via the         */
+   /*          BTPS_AddFunctionToScheduler() function or an infinite    */
+   /*          loop will occur.                                         */
+void BTPSAPI BTPS_ProcessScheduler(void)
+{
+   unsigned int      Priority;
+   unsigned int      EntryIndex;
+   unsigned long     CurrentTickCount;
+   SchedulerQueue_t *Queue;
+#if BTPS_SCHEDULER_LOW_PRIORITY_BUDGET
+   unsigned long     LowPriorityTime;
+
+   LowPriorityTime  = 0;
+#endif
+
+   /* Note the current tick count, only functions whose deadline has    */
+   /* been reached by this time are called during this pass.            */
+   CurrentTickCount = BTPS_GetTickCount();
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   UpdateLoadWindow(CurrentTickCount);
+
+#endif
+
+   /* Events that have been posted (from an ISR) are dispatched ahead of*/
+   /* the Scheduled Functions.                                          */
+   if(EventPending)
+      DispatchEvents();
+
+   /* Call every Scheduled Function whose deadline has been reached,    */
+   /* highest priority class first.  Only the start of each deadline    */
+   /* queue needs to be examined.  After each function the search starts*/
+   /* again with the highest priority class (and any events that were   */
+   /* posted are dispatched) so that lower priority work never delays   */
+   /* higher priority work by more than a single function.              */
+   Priority = BTPS_SCHEDULER_PRIORITY_HIGH;
+   while(Priority < BTPS_SCHEDULER_NUMBER_PRIORITIES)
+   {
+      Queue = &(SchedulerQueue[Priority]);
+
+      if((Queue->NumberEntries) && (!DEADLINE_BEFORE(CurrentTickCount, SchedulerInformation[Queue->EntryList[0]].Deadline)))
+      {
+#if BTPS_SCHEDULER_LOW_PRIORITY_BUDGET
+
+         /* Leave any remaining low priority work for the next pass once*/
+         /* the budget for this pass has been used.                     */
+         if((Priority == BTPS_SCHEDULER_PRIORITY_LOW) && (LowPriorityTime >= BTPS_SCHEDULER_LOW_PRIORITY_BUDGET))
+            break;
+
+#endif
+
+         EntryIndex = Queue->EntryList[0];
+
+         QueueRemove(EntryIndex);
+
+#if BTPS_SCHEDULER_LOW_PRIORITY_BUDGET
+
+         if(Priority == BTPS_SCHEDULER_PRIORITY_LOW)
+            LowPriorityTime += ExecuteSchedulerEntry(EntryIndex);
+         else
+            ExecuteSchedulerEntry(EntryIndex);
+
+#else
+
+         ExecuteSchedulerEntry(EntryIndex);
+
+#endif
+
+         if(EventPending)
+            DispatchEvents();
+
+         Priority = BTPS_SCHEDULER_PRIORITY_HIGH;
+      }
+      else
+         Priority++;
+   }
+
+   /* Finally resume the Coroutines that are ready.                     */
+   if(NumberReadyCoroutines)
+   {
+      ResumeReadyCoroutines();
+
+      if(EventPending)
+         DispatchEvents();
+   }
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* determine how long the Scheduler may remain idle.  This function  */
+   /* returns the number of ticks until the next Scheduled Function (or */
+   /* timer) is due, zero if a Scheduled Function is already due, or    */
+   /* BTPS_SCHEDULER_TIMEOUT_INFINITE if there are no Scheduled         */
+   /* Functions.                                                        */
+unsigned long BTPSAPI BTPS_QuerySchedulerTimeout(void)
+{
+   unsigned long ret_val;
+   unsigned long Timeout;
+   unsigned long CurrentTickCount;
+   unsigned int  Priority;
+
+   /* The Scheduler may not idle while an event is waiting to be        */
+   /* dispatched (or a Coroutine is waiting to be resumed).             */
+   if((!EventPending) && (!NumberReadyCoroutines))
+   {
+      ret_val = BTPS_SCHEDULER_TIMEOUT_INFINITE;
+
+      if((SchedulerInitialized) && (NumberScheduledFunctions))
+      {
+         /* The next deadline of each priority class is always at the   */
+         /* start of its queue.                                         */
+         CurrentTickCount = BTPS_GetTickCount();
+
+         for(Priority = 0; (Priority < BTPS_SCHEDULER_NUMBER_PRIORITIES) && (ret_val); Priority++)
+         {
+            if(SchedulerQueue[Priority].NumberEntries)
+            {
+               if(DEADLINE_BEFORE(CurrentTickCount, SchedulerInformation[SchedulerQueue[Priority].EntryList[0]].Deadline))
+                  Timeout = SchedulerInformation[SchedulerQueue[Priority].EntryList[0]].Deadline - CurrentTickCount;
+               else
+                  Timeout = 0;
+
+               if(Timeout < ret_val)
+                  ret_val = Timeout;
+            }
+         }
+      }
+   }
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the function that BTPS_ExecuteScheduler() calls when no  */
+   /* Scheduled Function is due.  This function accepts as its parameter*/
+   /* the Idle Callback (or NULL to remove the current Idle Callback).  */
+void BTPSAPI BTPS_RegisterIdleCallback(BTPS_IdleCallback_t _IdleCallback)
+{
+   IdleCallback = _IdleCallback;
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the function that BTPS_Delay() calls to wait for the     */
+   /* delay to expire.  This function accepts as its parameter the Sleep*/
+   /* Callback (or NULL to remove the current Sleep Callback).          */
+void BTPSAPI BTPS_RegisterSleepCallback(BTPS_SleepCallback_t _SleepCallback)
+{
+   SleepCallback = _SleepCallback;
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register a function that is called (from the Scheduler) each time */
+   /* an event is posted with BTPS_PostEventFromISR().  This function   */
+   /* accepts as input the Event Handler and the parameter that is      */
+   /* passed to the Event Handler.  This function returns a positive,   */
+   /* non-zero, Event ID if successful or zero if there was an error.   */
+unsigned int BTPSAPI BTPS_RegisterEventHandler(BTPS_EventHandler_t EventHandler, void *EventParameter)
+{
+   unsigned int ret_val;
+   unsigned int Index;
+
+   ret_val = 0;
+
+   if(EventHandler)
+   {
+      /* Search for an unused entry in the Event Handler table.         */
+      for(Index = 0; Index < BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS; Index++)
+      {
+         if(!EventInformation[Index].EventHandler)
+         {
+            EventInformation[Index].Pending        = FALSE;
+            EventInformation[Index].EventParameter = EventParameter;
+            EventInformation[Index].EventHandler   = EventHandler;
+
+            /* The Event ID is simply the index of the entry (plus one  */
+            /* so that the Event ID is never zero).                     */
+            ret_val = Index + 1;
+            break;
+         }
+      }
+   }
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* un-register an Event Handler that was registered with             */
+   /* BTPS_RegisterEventHandler().  This function accepts as its        */
+   /* parameter the Event ID that was returned from                     */
+   /* BTPS_RegisterEventHandler().                                      */
+   /* * NOTE * The caller must make sure that the event is no longer    */
+   /*          posted (i.e. the interrupt has been disabled) before the */
+   /*          Event ID is re-used.                                     */
+void BTPSAPI BTPS_UnRegisterEventHandler(unsigned int EventID)
+{
+   if((EventID) && (EventID <= BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS))
+   {
+      EventInformation[EventID - 1].EventHandler = NULL;
+      EventInformation[EventID - 1].Pending      = FALSE;
+   }
+}
+
+   /* The following function is provided to allow a mechanism for an    */
+   /* Interrupt Service Routine to signal that work is ready for the    */
+   /* specified Event Handler.  This function accepts as its parameter  */
+   /* the Event ID that was returned from BTPS_RegisterEventHandler().  */
+   /* The Event Handler is called on the next pass through the Scheduler*/
+   /* (ahead of any Scheduled Function).                                */
+   /* * NOTE * This function only writes two flags (no locking is       */
+   /*          required) so it may be called from any ISR as well as    */
+   /*          from the main loop.  Posting an event that is already    */
+   /*          pending has no effect.                                   */
+void BTPSAPI BTPS_PostEventFromISR(unsigned int EventID)
+{
+   if((EventID) && (EventID <= BTPS_MAXIMUM_NUMBER_EVENT_HANDLERS))
+   {
+      /* Note that the event is flagged before the global flag so that  */
+      /* the Scheduler never clears the global flag without seeing the  */
+      /* event.                                                         */
+      EventInformation[EventID - 1].Pending = TRUE;
+      EventPending                          = TRUE;
+   }
+}
+
+   /* The following function is provided to allow a mechanism to start  */
+   /* a Coroutine.  This function accepts as input the Coroutine        */
+   /* (storage supplied by the caller), the Coroutine Function and the  */
+   /* parameter that is passed to the Coroutine Function.  The Coroutine*/
+   /* Function is first called on the next pass through the Scheduler.  */
+   /* This function returns TRUE if the Coroutine was started or FALSE  */
+   /* if there was an error.                                            */
+   /* * NOTE * A Coroutine that is ready or waiting is already linked   */
+   /*          into the ready list (or has a timer running), so starting*/
+   /*          it again is refused rather than corrupting the list (or  */
+   /*          losing the timer).  A running Coroutine is neither, so   */
+   /*          the Coroutine Function may restart its own Coroutine.    */
+Boolean_t BTPSAPI BTPS_StartCoroutine(BTPS_Coroutine_t *Coroutine, BTPS_CoroutineFunction_t CoroutineFunction, void *CoroutineParameter)
+{
+   Boolean_t ret_val;
+
+   if((SchedulerInitialized) && (Coroutine) && (CoroutineFunction) && ((Coroutine->State == BTPS_COROUTINE_STATE_IDLE) || (Coroutine->State == BTPS_COROUTINE_STATE_RUNNING)))
+   {
+      BTPS_MemInitialize(Coroutine, 0, sizeof(BTPS_Coroutine_t));
+
+      Coroutine->CoroutineFunction  = CoroutineFunction;
+      Coroutine->CoroutineParameter = CoroutineParameter;
+
+      ReadyCoroutine(Coroutine);
+
+      ret_val = TRUE;
+   }
+   else
+      ret_val = FALSE;
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to stop a */
+   /* Coroutine that was started with BTPS_StartCoroutine() before it   */
+   /* exits.  This function accepts as its parameter the Coroutine.     */
+void BTPSAPI BTPS_StopCoroutine(BTPS_Coroutine_t *Coroutine)
+{
+   if(Coroutine)
+   {
+      switch(Coroutine->State)
+      {
+         case BTPS_COROUTINE_STATE_READY:
+            UnReadyCoroutine(Coroutine);
+            break;
+         case BTPS_COROUTINE_STATE_WAITING:
+            if(Coroutine->TimerID)
+            {
+               BTPS_StopTimer(Coroutine->TimerID);
+
+               Coroutine->TimerID = 0;
+            }
+            break;
+         default:
+            break;
+      }
+
+      Coroutine->State = BTPS_COROUTINE_STATE_IDLE;
+   }
+}
+
+   /* The following function is provided to allow a mechanism to signal */
+   /* a Coroutine that is waiting (or will wait) in                     */
+   /* BTPS_COROUTINE_WAIT_EVENT().  This function accepts as its        */
+   /* parameter the Coroutine to signal.                                */
+void BTPSAPI BTPS_SignalCoroutine(BTPS_Coroutine_t *Coroutine)
+{
+   if((Coroutine) && (Coroutine->State != BTPS_COROUTINE_STATE_IDLE))
+   {
+      Coroutine->Signalled = TRUE;
+
+      /* Resume a Coroutine that is waiting for the event (stopping the */
+      /* timeout).  Otherwise the signal is simply remembered.          */
+      if((Coroutine->State == BTPS_COROUTINE_STATE_WAITING) && (Coroutine->WaitingEvent))
+      {
+         if(Coroutine->TimerID)
+         {
+            BTPS_StopTimer(Coroutine->TimerID);
+
+            Coroutine->TimerID = 0;
+         }
+
+         ReadyCoroutine(Coroutine);
+      }
+   }
+}
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the execution statistics of a timer that was started with         */
+   /* BTPS_StartTimer().  This function accepts as input the Timer ID   */
+   /* that was returned from BTPS_StartTimer() and a pointer to a buffer*/
+   /* that will receive the statistics.  This function returns zero if  */
+   /* successful or a negative value if the Timer ID is not valid.      */
+int BTPSAPI BTPS_QueryTimerStatistics(unsigned int TimerID, BTPS_TimerStatistics_t *TimerStatistics)
+{
+   int          ret_val;
+   unsigned int EntryIndex;
+
+   EntryIndex = TIMER_ID_TO_SCHEDULER_ENTRY(TimerID);
+
+   if((SchedulerInitialized) && (TimerID) && (EntryIndex < NumberSchedulerEntries) && (SchedulerInformation[EntryIndex].TimerID == TimerID))
+      ret_val = QuerySchedulerEntryStatistics(EntryIndex, TimerStatistics);
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the execution statistics of a Function that was added to the      */
+   /* Scheduler with the BTPS_AddFunctionToScheduler() function.  This  */
+   /* function accepts as input the Scheduler Function and Scheduler    */
+   /* Parameter that were registered (both *must* match) and a pointer  */
+   /* to a buffer that will receive the statistics.  This function      */
+   /* returns zero if successful or a negative value if the Scheduled   */
+   /* Function was not found.                                           */
+int BTPSAPI BTPS_QueryScheduledFunctionStatistics(BTPS_SchedulerFunction_t SchedulerFunction, void *SchedulerParameter, BTPS_TimerStatistics_t *TimerStatistics)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   ret_val = -1;
+
+   if((SchedulerInitialized) && (SchedulerFunction))
+   {
+      /* Locate the periodic entry that was registered with the         */
+      /* specified function and parameter.                              */
+      for(Index = 0; Index < NumberSchedulerEntries; Index++)
+      {
+         if(((SchedulerInformation[Index].State == SCHEDULER_ENTRY_STATE_QUEUED) || (SchedulerInformation[Index].State == SCHEDULER_ENTRY_STATE_RUNNING)) && (SchedulerInformation[Index].Period) && (SchedulerInformation[Index].ScheduleFunction == SchedulerFunction) && (SchedulerInformation[Index].ScheduleParameter == SchedulerParameter))
+         {
+            ret_val = QuerySchedulerEntryStatistics(Index, TimerStatistics);
+            break;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the high resolution counter that is used to measure the  */
+   /* execution time of each task (when the kernel is built with        */
+   /* SCHEDULER_PROFILE_ENABLED defined) and to time                    */
+   /* BTPS_DelayMicroseconds().  This function accepts as input the     */
+   /* function that returns the current counter value and the frequency */
+   /* of the counter (in counts per second).  If no counter is specified*/
+   /* the default counter of the platform is used.                      */
+void BTPSAPI BTPS_RegisterCycleCounter(BTPS_GetCycleCountCallback_t _GetCycleCountCallback, unsigned long _CyclesPerSecond)
+{
+   if((_GetCycleCountCallback) && (_CyclesPerSecond))
+   {
+      GetCycleCountCallback = _GetCycleCountCallback;
+      CyclesPerSecond       = _CyclesPerSecond;
+   }
+   else
+   {
+#ifdef __linux__
+
+      GetCycleCountCallback = GetMonotonicCycleCount;
+      CyclesPerSecond       = 1000000000UL;
+
+#else
+
+      GetCycleCountCallback = BTPS_GetTickCount;
+      CyclesPerSecond       = 1000 / BTPS_TICK_COUNT_INTERVAL;
+
+#endif
+   }
+
+   /* Counts of the previous counter can not be compared with the new   */
+   /* counter, so start over.                                           */
+   BTPS_ResetSchedulerStatistics();
+   BTPS_ResetCriticalSectionProfile();
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the function that is used to retrieve the current        */
+   /* Timestamp.  This function accepts as its parameter the function   */
+   /* that returns the current Timestamp (or NULL to use the default    */
+   /* Timestamp of the platform).                                       */
+void BTPSAPI BTPS_RegisterTimestampCallback(BTPS_GetTimestampCallback_t _GetTimestampCallback)
+{
+   if(_GetTimestampCallback)
+      GetTimestampCallback = _GetTimestampCallback;
+   else
+   {
+#ifdef __linux__
+
+      GetTimestampCallback = GetMonotonicTimestamp;
+
+#else
+
+      GetTimestampCallback = GetTickCountTimestamp;
+
+#endif
+   }
+}
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the CPU load and the execution profile of each task (when the     */
+   /* kernel is built with SCHEDULER_PROFILE_ENABLED defined).  This    */
+   /* function accepts as input a pointer to a buffer that will receive */
+   /* the overall statistics, the maximum number of tasks to return and */
+   /* an array (of at least this many entries) that is to receive the   */
+   /* task statistics.  The tasks are returned in order of decreasing   */
+   /* total execution time (i.e. the top N tasks).  This function       */
+   /* returns the number of tasks that were returned if successful or a */
+   /* negative value if there was an error (or profiling is not         */
+   /* enabled).                                                         */
+int BTPSAPI BTPS_QuerySchedulerStatistics(BTPS_SchedulerStatistics_t *SchedulerStatistics, unsigned int MaximumTasks, BTPS_TaskStatistics_t *TaskStatistics)
+{
+   int ret_val;
+
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   int          Index;
+   unsigned int NumberTasks;
+
+   if((SchedulerStatistics) && ((!MaximumTasks) || (TaskStatistics)))
+   {
+      for(Index = 0, NumberTasks = 0; Index <= SCHEDULER_PROFILE_OVERFLOW_TASK; Index++)
+      {
+         if(ProfileTaskList[Index].NumberCalls)
+            NumberTasks++;
+      }
+
+      SchedulerStatistics->CyclesPerSecond = CyclesPerSecond;
+      SchedulerStatistics->WindowCycles    = LastLoadWindowCycles;
+      SchedulerStatistics->BusyCycles      = LastLoadWindowBusyCycles;
+      SchedulerStatistics->NumberTasks     = NumberTasks;
+      SchedulerStatistics->TotalBusyCycles = TotalBusyCycles;
+
+      if(LastLoadWindowCycles)
+      {
+         SchedulerStatistics->CPULoad = (unsigned int)((((QWord_t)LastLoadWindowBusyCycles) * 100) / LastLoadWindowCycles);
+
+         if(SchedulerStatistics->CPULoad > 100)
+            SchedulerStatistics->CPULoad = 100;
+      }
+      else
+         SchedulerStatistics->CPULoad = 0;
+
+      for(ret_val = 0, Index = SelectNextProfileTask(-1); (Index >= 0) && ((unsigned int)ret_val < MaximumTasks); Index = SelectNextProfileTask(Index), ret_val++, TaskStatistics++)
+      {
+         TaskStatistics->TaskFunction  = (BTPS_SchedulerFunction_t)ProfileTaskList[Index].Key;
+         TaskStatistics->EventHandler  = ProfileTaskList[Index].EventHandler;
+         TaskStatistics->NumberCalls   = ProfileTaskList[Index].NumberCalls;
+         TaskStatistics->TotalCycles   = ProfileTaskList[Index].TotalCycles;
+         TaskStatistics->MaximumCycles = ProfileTaskList[Index].MaximumCycles;
+         TaskStatistics->WindowCycles  = ProfileTaskList[Index].LastWindowCycles;
+
+         BTPS_MemCopy(TaskStatistics->CycleHistogram, ProfileTaskList[Index].CycleHistogram, sizeof(TaskStatistics->CycleHistogram));
+      }
+   }
+   else
+      ret_val = -1;
+
+#else
+
+   UNREFERENCED_PARAMETER(SchedulerStatistics);
+   UNREFERENCED_PARAMETER(MaximumTasks);
+   UNREFERENCED_PARAMETER(TaskStatistics);
+
+   ret_val = -1;
+
+#endif
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the CPU load */
+   /* and the top N tasks (when the kernel is built with                */
+   /* SCHEDULER_PROFILE_ENABLED defined) via BTPS_OutputMessage().  This*/
+   /* function accepts as its parameter the maximum number of tasks to  */
+   /* display.                                                          */
+void BTPSAPI BTPS_DumpSchedulerStatistics(unsigned int NumberTasks)
+{
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   int                        Index;
+   unsigned long              Load;
+   BTPS_SchedulerStatistics_t SchedulerStatistics;
+
+   if((BTPS_QuerySchedulerStatistics(&SchedulerStatistics, 0, NULL) >= 0) && (SchedulerStatistics.CyclesPerSecond))
+   {
+      BTPS_OutputMessage("\r\n  CPU Load: %u%% (%lu of %lu cycles), Total Busy Time: %lu ms, Tasks: %u\r\n", SchedulerStatistics.CPULoad, SchedulerStatistics.BusyCycles, SchedulerStatistics.WindowCycles, (unsigned long)((SchedulerStatistics.TotalBusyCycles * 1000) / SchedulerStatistics.CyclesPerSecond), SchedulerStatistics.NumberTasks);
+      BTPS_OutputMessage("\r\n  Task            Calls  Total ms    Max us Load | Cycles <1K <8K <64K <512K <4M >=4M\r\n");
+
+      for(Index = SelectNextProfileTask(-1); (Index >= 0) && (NumberTasks); Index = SelectNextProfileTask(Index), NumberTasks--)
+      {
+         OutputProfileEntryName(ProfileTaskList[Index].Key);
+
+         if(SchedulerStatistics.WindowCycles)
+            Load = (unsigned long)((((QWord_t)ProfileTaskList[Index].LastWindowCycles) * 100) / SchedulerStatistics.WindowCycles);
+         else
+            Load = 0;
+
+         BTPS_OutputMessage(" %c %8lu %9lu %9lu %3lu%% |", (ProfileTaskList[Index].EventHandler)?'E':' ', ProfileTaskList[Index].NumberCalls, (unsigned long)((ProfileTaskList[Index].TotalCycles * 1000) / SchedulerStatistics.CyclesPerSecond), (unsigned long)((((QWord_t)ProfileTaskList[Index].MaximumCycles) * 1000000) / SchedulerStatistics.CyclesPerSecond), Load);
+         BTPS_OutputMessage(" %lu %lu %lu %lu %lu %lu\r\n", ProfileTaskList[Index].CycleHistogram[0], ProfileTaskList[Index].CycleHistogram[1], ProfileTaskList[Index].CycleHistogram[2], ProfileTaskList[Index].CycleHistogram[3], ProfileTaskList[Index].CycleHistogram[4], ProfileTaskList[Index].CycleHistogram[5]);
+      }
+   }
+
+#else
+
+   UNREFERENCED_PARAMETER(NumberTasks);
+
+#endif
+}
+
+   /* The following function is provided to allow a mechanism to clear  */
+   /* the execution profile of every task and start a new CPU load      */
+   /* window (so that a specific use case can be measured).             */
+void BTPSAPI BTPS_ResetSchedulerStatistics(void)
+{
+#ifdef SCHEDULER_PROFILE_ENABLED
+
+   BTPS_MemInitialize(ProfileTaskList, 0, sizeof(ProfileTaskList));
+
+   LoadWindowStartTick      = BTPS_GetTickCount();
+   LoadWindowBusyCycles     = 0;
+   LastLoadWindowCycles     = 0;
+   LastLoadWindowBusyCycles = 0;
+   TotalBusyCycles          = 0;
+
+#endif
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the functions that are used to disable and restore       */
+   /* interrupts for BTPS_EnterCriticalSection() and                    */
+   /* BTPS_LeaveCriticalSection().  This function accepts as input the  */
+   /* function that disables interrupts (and returns the previous       */
+   /* interrupt state) and the function that restores a previously      */
+   /* returned interrupt state.  If either function is NULL, critical   */
+   /* sections do not disable interrupts (which is only suitable for a  */
+   /* host without interrupts).                                         */
+void BTPSAPI BTPS_RegisterInterruptCallbacks(BTPS_DisableInterruptsCallback_t _DisableInterruptsCallback, BTPS_RestoreInterruptsCallback_t _RestoreInterruptsCallback)
+{
+   /* Changing the functions in the middle of a critical section would  */
+   /* restore a state that was returned by a different function, so only*/
+   /* allow this while no critical section is active.                   */
+   if(!CriticalSectionNesting)
+   {
+      if((_DisableInterruptsCallback) && (_RestoreInterruptsCallback))
+      {
+         DisableInterruptsCallback = _DisableInterruptsCallback;
+         RestoreInterruptsCallback = _RestoreInterruptsCallback;
+      }
+      else
+      {
+         DisableInterruptsCallback = NULL;
+         RestoreInterruptsCallback = NULL;
+      }
+   }
+}
+
+   /* The following function is provided to allow a mechanism to enter  */
+   /* a critical section (i.e. disable interrupts).  Critical sections  */
+   /* may be nested (including from an ISR).  This function returns the */
+   /* previous interrupt state which *MUST* be passed to the matching   */
+   /* call of BTPS_LeaveCriticalSection().                              */
+unsigned long BTPSAPI BTPS_EnterCriticalSection(void)
+{
+   unsigned long ret_val;
+
+   if(DisableInterruptsCallback)
+      ret_val = (*DisableInterruptsCallback)();
+   else
+      ret_val = 0;
+
+   /* Only the outermost critical section is measured, nested sections  */
+   /* are part of the time that interrupts are already disabled.        */
+   if(!CriticalSectionNesting++)
+   {
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+      CriticalSectionSite        = CRITICAL_SECTION_PROFILE_CALLER_ADDRESS();
+      CriticalSectionStartCycles = (GetCycleCountCallback)?(*GetCycleCountCallback)():0;
+
+#endif
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to leave a*/
+   /* critical section that was entered with                            */
+   /* BTPS_EnterCriticalSection().  This function accepts as its        */
+   /* parameter the interrupt state that was returned when the critical */
+   /* section was entered.                                              */
+void BTPSAPI BTPS_LeaveCriticalSection(unsigned long InterruptState)
+{
+   if(CriticalSectionNesting)
+   {
+      if(!--CriticalSectionNesting)
+      {
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+         if(GetCycleCountCallback)
+            ProfileCriticalSection(CriticalSectionSite, (*GetCycleCountCallback)() - CriticalSectionStartCycles);
+
+#endif
+      }
+   }
+
+   if(RestoreInterruptsCallback)
+      (*RestoreInterruptsCallback)(InterruptState);
+}
+
+   /* The following function is responsible for retrieving the critical */
+   /* section profile (when the kernel is built with                    */
+   /* CRITICAL_SECTION_PROFILE_ENABLED defined).  This function accepts */
+   /* as its parameters the maximum number of sites to return and a     */
+   /* pointer to an array (of at least this many entries) that is to    */
+   /* receive the site statistics.  The sites are returned in order of  */
+   /* decreasing maximum time that interrupts were disabled (i.e. the   */
+   /* top N sites).  This function returns the number of sites that were*/
+   /* returned if successful or a negative value if there was an error  */
+   /* (or profiling is not enabled).                                    */
+int BTPSAPI BTPS_QueryCriticalSectionProfile(unsigned int MaximumSites, BTPS_CriticalSectionStatistics_t *SiteStatistics)
+{
+   int ret_val;
+
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+   int Index;
+
+   if(SiteStatistics)
+   {
+      for(ret_val = 0, Index = SelectNextCriticalSectionSite(-1); (Index >= 0) && ((unsigned int)ret_val < MaximumSites); Index = SelectNextCriticalSectionSite(Index), ret_val++, SiteStatistics++)
+      {
+         SiteStatistics->SiteAddress         = (BTPSCONST void *)CriticalSectionSiteList[Index].Key;
+         SiteStatistics->NumberCalls         = CriticalSectionSiteList[Index].NumberCalls;
+         SiteStatistics->MaximumMicroseconds = CyclesToMicroseconds(CriticalSectionSiteList[Index].MaximumCycles);
+         SiteStatistics->TotalMicroseconds   = CyclesToMicroseconds(CriticalSectionSiteList[Index].TotalCycles);
+
+         BTPS_MemCopy(SiteStatistics->Histogram, CriticalSectionSiteList[Index].CycleHistogram, sizeof(SiteStatistics->Histogram));
+      }
+   }
+   else
+      ret_val = -1;
+
+#else
+
+   UNREFERENCED_PARAMETER(MaximumSites);
+   UNREFERENCED_PARAMETER(SiteStatistics);
+
+   ret_val = -1;
+
+#endif
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the top N    */
+   /* critical sections (when the kernel is built with                  */
+   /* CRITICAL_SECTION_PROFILE_ENABLED defined) via                     */
+   /* BTPS_OutputMessage().  This function accepts as its parameter the */
+   /* maximum number of sites to display.                               */
+void BTPSAPI BTPS_DumpCriticalSectionProfile(unsigned int NumberSites)
+{
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+   int Index;
+
+   BTPS_OutputMessage("\r\n  Site          Calls   Max us   Avg us | <1us <5us <10us <20us <40us >=40us\r\n");
+
+   for(Index = SelectNextCriticalSectionSite(-1); (Index >= 0) && (NumberSites); Index = SelectNextCriticalSectionSite(Index), NumberSites--)
+   {
+      OutputProfileEntryName(CriticalSectionSiteList[Index].Key);
+
+      BTPS_OutputMessage(" %8lu %8lu %8lu |", CriticalSectionSiteList[Index].NumberCalls, CyclesToMicroseconds(CriticalSectionSiteList[Index].MaximumCycles), CyclesToMicroseconds(CriticalSectionSiteList[Index].TotalCycles / CriticalSectionSiteList[Index].NumberCalls));
+      BTPS_OutputMessage(" %lu %lu %lu %lu %lu %lu\r\n", CriticalSectionSiteList[Index].CycleHistogram[0], CriticalSectionSiteList[Index].CycleHistogram[1], CriticalSectionSiteList[Index].CycleHistogram[2], CriticalSectionSiteList[Index].CycleHistogram[3], CriticalSectionSiteList[Index].CycleHistogram[4], CriticalSectionSiteList[Index].CycleHistogram[5]);
+   }
+
+#else
+
+   UNREFERENCED_PARAMETER(NumberSites);
+
+#endif
+}
+
+   /* The following function is provided to allow a mechanism to clear  */
+   /* the critical section profile (so that a specific use case can be  */
+   /* measured).                                                        */
+void BTPSAPI BTPS_ResetCriticalSectionProfile(void)
+{
+#ifdef CRITICAL_SECTION_PROFILE_ENABLED
+
+   unsigned int Index;
+
+   BTPS_MemInitialize(CriticalSectionSiteList, 0, sizeof(CriticalSectionSiteList));
+
+   /* Convert the histogram bounds to cycles of the current counter     */
+   /* (rounded up so that a coarse counter still places sections shorter*/
+   /* than one count in the first bin).                                 */
+   for(Index = 0; Index < (BTPS_CRITICAL_SECTION_HISTOGRAM_BINS - 1); Index++)
+      CriticalSectionBinCycles[Index] = (unsigned long)(((((QWord_t)CriticalSectionBinLimit[Index]) * CyclesPerSecond) + 999999) / 1000000);
+
+   /* A critical section that is currently active was started with the  */
+   /* previous counter, so restart its measurement.                     */
+   if((CriticalSectionNesting) && (GetCycleCountCallback))
+      CriticalSectionStartCycles = (*GetCycleCountCallback)();
+
+#endif
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register the stack that the Scheduler runs on so that the stack   */
+   /* usage can be measured.  This function accepts as input a pointer  */
+   /* to the lowest address of the stack and the size (in bytes) of the */
+   /* stack.  Every free word of the stack (below the caller) is painted*/
+   /* with a fixed pattern, the deepest point of the stack that has     */
+   /* been used is then the lowest word that no longer holds the        */
+   /* pattern.  This function returns zero if successful or a negative  */
+   /* value if there was an error.                                      */
+   /* * NOTE * This function *MUST* be called on the stack that is      */
+   /*          specified, as early as possible (i.e. from main()).      */
+int BTPSAPI BTPS_RegisterStack(void *StackRegion, unsigned long RegionSize)
+{
+   int            ret_val;
+   unsigned long  Marker;
+   unsigned long  Adjust;
+   unsigned long *Limit;
+   unsigned long *Word;
+
+   /* Align the start of the region.                                    */
+   if((StackRegion) && ((Adjust = ((unsigned long)StackRegion) % sizeof(unsigned long)) != 0))
+   {
+      Adjust      = sizeof(unsigned long) - Adjust;
+      StackRegion = ((unsigned char *)StackRegion) + Adjust;
+      RegionSize  = (RegionSize > Adjust)?(RegionSize - Adjust):0;
+   }
+
+   Limit = STACK_PAINT_LIMIT(&Marker);
+
+   /* Make sure that this function is running on the specified stack.   */
+   if((StackRegion) && (Limit > (unsigned long *)StackRegion) && (Limit < (unsigned long *)(((unsigned char *)StackRegion) + RegionSize)))
+   {
+      StackBottom   = (unsigned long *)StackRegion;
+      StackTop      = StackBottom + (RegionSize / sizeof(unsigned long));
+
+      for(Word = StackBottom; Word < Limit; Word++)
+         *Word = STACK_PAINT_PATTERN;
+
+      StackLowWater = Limit;
+
+#ifdef STACK_PROFILE_ENABLED
+
+      BTPS_MemInitialize(StackProfileTaskList, 0, sizeof(StackProfileTaskList));
+
+#endif
+
+      ret_val       = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to query  */
+   /* the usage of the stack that was registered with                   */
+   /* BTPS_RegisterStack() and the stack usage of each task (when the   */
+   /* kernel is built with STACK_PROFILE_ENABLED defined).  This        */
+   /* function accepts as input a pointer to a buffer that will receive */
+   /* the overall statistics, the maximum number of tasks to return and */
+   /* an array (of at least this many entries) that is to receive the   */
+   /* task statistics.  The tasks are returned in order of decreasing   */
+   /* stack usage (i.e. the top N tasks).  This function returns the    */
+   /* number of tasks that were returned (zero if the stack profiler is */
+   /* not enabled) if successful or a negative value if there was an    */
+   /* error (or no stack has been registered).                          */
+int BTPSAPI BTPS_QueryStackUsage(BTPS_StackStatistics_t *StackStatistics, unsigned int MaximumTasks, BTPS_TaskStackStatistics_t *TaskStatistics)
+{
+   int            ret_val;
+   unsigned long  Marker;
+   unsigned long *LowWater;
+#ifdef STACK_PROFILE_ENABLED
+   int            Index;
+#endif
+
+   if((StackBottom) && (StackStatistics) && ((!MaximumTasks) || (TaskStatistics)))
+   {
+      /* Note any words that were used since the low water mark was last*/
+      /* determined.                                                    */
+      LowWater = FindStackLowWater(StackBottom, StackTop);
+
+      if(LowWater < StackLowWater)
+         StackLowWater = LowWater;
+
+      StackStatistics->StackSize    = (unsigned long)(((unsigned char *)StackTop) - ((unsigned char *)StackBottom));
+      StackStatistics->MaximumUsage = (unsigned long)(((unsigned char *)StackTop) - ((unsigned char *)StackLowWater));
+
+      if((((unsigned char *)&Marker) >= (unsigned char *)StackBottom) && (((unsigned char *)&Marker) < (unsigned char *)StackTop))
+         StackStatistics->CurrentUsage = (unsigned long)(((unsigned char *)StackTop) - ((unsigned char *)&Marker));
+      else
+         StackStatistics->CurrentUsage = 0;
+
+      ret_val = 0;
+
+#ifdef STACK_PROFILE_ENABLED
+
+      for(Index = SelectNextStackProfileTask(-1); (Index >= 0) && ((unsigned int)ret_val < MaximumTasks); Index = SelectNextStackProfileTask(Index), ret_val++, TaskStatistics++)
+      {
+         TaskStatistics->TaskFunction = (BTPS_SchedulerFunction_t)StackProfileTaskList[Index].Key;
+         TaskStatistics->NumberCalls  = StackProfileTaskList[Index].NumberCalls;
+         TaskStatistics->MaximumUsage = StackProfileTaskList[Index].MaximumUsage;
+      }
+
+#endif
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for displaying the usage of */
+   /* the stack that was registered with BTPS_RegisterStack() and the   */
+   /* top N tasks (when the kernel is built with STACK_PROFILE_ENABLED  */
+   /* defined) via BTPS_OutputMessage().  This function accepts as its  */
+   /* parameter the maximum number of tasks to display.                 */
+void BTPSAPI BTPS_DumpStackUsage(unsigned int NumberTasks)
+{
+   BTPS_StackStatistics_t StackStatistics;
+#ifdef STACK_PROFILE_ENABLED
+   int                    Index;
+#endif
+
+   if(BTPS_QueryStackUsage(&StackStatistics, 0, NULL) >= 0)
+   {
+      BTPS_OutputMessage("\r\n  Stack: %lu bytes, %lu used (maximum), %lu used (current)\r\n", StackStatistics.StackSize, StackStatistics.MaximumUsage, StackStatistics.CurrentUsage);
+
+#ifdef STACK_PROFILE_ENABLED
+
+      BTPS_OutputMessage("\r\n  Task          Calls    Bytes\r\n");
+
+      for(Index = SelectNextStackProfileTask(-1); (Index >= 0) && (NumberTasks); Index = SelectNextStackProfileTask(Index), NumberTasks--)
+      {
+         OutputProfileEntryName(StackProfileTaskList[Index].Key);
+
+         BTPS_OutputMessage(" %8lu %8lu\r\n", StackProfileTaskList[Index].NumberCalls, StackProfileTaskList[Index].MaximumUsage);
+      }
+
+#endif
+   }
+
+#ifndef STACK_PROFILE_ENABLED
+
+   UNREFERENCED_PARAMETER(NumberTasks);
+
+#endif
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* actually allocate a Block of Memory (of at least the specified    */
+   /* size).  This function accepts as input the size (in Bytes) of the */
+   /* Block of Memory to be allocated.  This function returns a NON-NULL*/
+   /* pointer to this Memory Buffer if the Memory was successfully      */
+   /* allocated, or a NULL value if the memory could not be allocated.  */
+void *BTPSAPI BTPS_AllocateMemory(unsigned long MemorySize)
+{
+   void *ret_val;
+
+   ret_val = MemAlloc(MemoryBuffer, MemorySize);
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+   ProfileAllocation(ret_val, MemorySize, MEMORY_PROFILE_CALLER_ADDRESS(), NULL);
+
+#else
+
+   if(!ret_val)
+      DBG_MSG(DBG_ZONE_BTPSKRNL, ("Malloc Failed: %d.\r\n", MemorySize));
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+   TraceOperation(MEMORY_TRACE_OPERATION_ALLOCATE, BTPS_DEFAULT_HEAP_ID, ret_val, NULL, MemorySize);
+
+#endif
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is responsible for de-allocating a Block of*/
+   /* Memory that was successfully allocated with the                   */
+   /* BTPS_AllocateMemory() function.  This function accepts a NON-NULL */
+   /* Memory Pointer which was returned from the BTPS_AllocateMemory()  */
+   /* function.  After this function completes the caller CANNOT use ANY*/
+   /* of the Memory pointed to by the Memory Pointer.                   */
+void BTPSAPI BTPS_FreeMemory(void *MemoryPointer)
+{
+   HeapInfo_t *HeapInfo;
+
+   /* Return the memory to the heap that it was allocated from.         */
+   if((HeapInfo = FindHeap(MemoryPointer)) != NULL)
+   {
+#ifdef MEMORY_PROFILE_ENABLED
+
+      ProfileFree(MemoryPointer);
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+      TraceOperation(MEMORY_TRACE_OPERATION_FREE, GetHeapID(HeapInfo), MemoryPointer, NULL, 0);
+
+#endif
+
+      MemFree(HeapInfo, MemoryPointer);
+   }
+}
+
+   /* The following function is provided to allow a mechanism to change */
+   /* the size of a Block of Memory that was allocated with             */
+   /* BTPS_AllocateMemory() (or any of the other allocation functions). */
+   /* This function accepts as input the Memory Pointer to resize and   */
+   /* the new size (in Bytes).  The block is grown or shrunk in place   */
+   /* whenever the neighbouring memory allows it, otherwise a new block */
+   /* is allocated (from the same heap), the contents are copied and    */
+   /* the original block is freed.  This function returns a NON-NULL    */
+   /* pointer to the resized Memory Buffer if successful, or a NULL     */
+   /* value if the memory could not be resized (in which case the       */
+   /* original Memory Pointer is still valid and unchanged).            */
+   /* * NOTE * If the Memory Pointer is NULL this function behaves like */
+   /*          BTPS_AllocateMemory().  If the size is zero the memory is*/
+   /*          freed and NULL is returned.                              */
+   /* * NOTE * The returned pointer may differ from the Memory Pointer  */
+   /*          that was passed in, even when the block was resized in   */
+   /*          place (the data may be moved down into a preceding free  */
+   /*          block).                                                  */
+void *BTPSAPI BTPS_ReallocateMemory(void *MemoryPointer, unsigned long MemorySize)
+{
+   void         *ret_val;
+   HeapInfo_t   *HeapInfo;
+   BlockInfo_t  *BlockInfo;
+   unsigned int  PreviousSize;
+
+   if(!MemoryPointer)
+   {
+      ret_val = MemAlloc(MemoryBuffer, MemorySize);
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+      ProfileAllocation(ret_val, MemorySize, MEMORY_PROFILE_CALLER_ADDRESS(), NULL);
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+      TraceOperation(MEMORY_TRACE_OPERATION_ALLOCATE, BTPS_DEFAULT_HEAP_ID, ret_val, NULL, MemorySize);
+
+#endif
+   }
+   else
+   {
+      if(!MemorySize)
+      {
+         BTPS_FreeMemory(MemoryPointer);
+
+         ret_val = NULL;
+      }
+      else
+      {
+         if((HeapInfo = FindHeap(MemoryPointer)) != NULL)
+         {
+            BlockInfo    = (BlockInfo_t *)(((Alignment_t *)MemoryPointer) - BLOCK_INFO_SIZE(0));
+            PreviousSize = BlockInfo->Size & SEGMENT_SIZE_BITMASK;
+
+            /* First try to resize the block in place.                  */
+            if((ret_val = MemResize(HeapInfo, MemoryPointer, MemorySize)) != NULL)
+            {
+#ifdef MEMORY_PROFILE_ENABLED
+
+               ProfileResize(ret_val, PreviousSize);
+
+#endif
+            }
+            else
+            {
+               /* The block could not be resized in place so allocate a */
+               /* new block from the same heap and move the data.       */
+               if(BlockInfo->Size & SEGMENT_ALLOCATED_BITMASK)
+               {
+                  if((ret_val = MemAlloc(HeapInfo, MemorySize)) != NULL)
+                  {
+                     /* Only the data portion of the previous block is  */
+                     /* copied (the request is known to be larger).     */
+                     BTPS_MemCopy(ret_val, MemoryPointer, (PreviousSize - BLOCK_INFO_SIZE(0)) * ALIGNMENT_SIZE);
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+                     ProfileAllocation(ret_val, MemorySize, MEMORY_PROFILE_CALLER_ADDRESS(), NULL);
+                     ProfileFree(MemoryPointer);
+
+#endif
+
+                     MemFree(HeapInfo, MemoryPointer);
+                  }
+                  else
+                  {
+                     DBG_MSG(DBG_ZONE_BTPSKRNL, ("Realloc Failed: %d.\r\n", MemorySize));
+                  }
+               }
+            }
+
+#ifdef MEMORY_TRACE_ENABLED
+
+            TraceOperation(MEMORY_TRACE_OPERATION_REALLOCATE, GetHeapID(HeapInfo), ret_val, MemoryPointer, MemorySize);
+
+#endif
+         }
+         else
+            ret_val = NULL;
+      }
+   }
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* allocate a Block of Memory (of at least the specified size) that  */
+   /* is attributed to the specified tag (rather than the address of the*/
+   /* caller) in the allocation profile.  This function accepts as input*/
+   /* the size (in Bytes) of the Block of Memory to be allocated and a  */
+   /* pointer to a constant, NULL terminated, tag string.  This function*/
+   /* returns a NON-NULL pointer to this Memory Buffer if the Memory was*/
+   /* successfully allocated, or a NULL value if the memory could not be*/
+   /* allocated.                                                        */
+   /* * NOTE * The tag is only used when the kernel is built with       */
+   /*          MEMORY_PROFILE_ENABLED defined, otherwise this function  */
+   /*          is identical to BTPS_AllocateMemory().                   */
+   /* * NOTE * The tag pointer is stored (not the string) so it *MUST*  */
+   /*          point to a string constant.                              */
+void *BTPSAPI BTPS_AllocateMemoryWithTag(unsigned long MemorySize, BTPSCONST char *Tag)
+{
+   void *ret_val;
+
+   ret_val = MemAlloc(MemoryBuffer, MemorySize);
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+   ProfileAllocation(ret_val, MemorySize, MEMORY_PROFILE_CALLER_ADDRESS(), Tag);
+
+#else
+
+   UNREFERENCED_PARAMETER(Tag);
+
+   if(!ret_val)
+   {
+      DBG_MSG(DBG_ZONE_BTPSKRNL, ("Malloc Failed: %d.\r\n", MemorySize));
+   }
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+   TraceOperation(MEMORY_TRACE_OPERATION_ALLOCATE, BTPS_DEFAULT_HEAP_ID, ret_val, NULL, MemorySize);
+
+#endif
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* allocate a Block of Memory (of at least the specified size) from  */
+   /* a specific heap.  This function accepts as input the Heap ID of   */
+   /* the heap to allocate from (either BTPS_DEFAULT_HEAP_ID or a value */
+   /* returned from BTPS_RegisterHeap()) and the size (in Bytes) of the */
+   /* Block of Memory to be allocated.  This function returns a NON-NULL*/
+   /* pointer to this Memory Buffer if the Memory was successfully      */
+   /* allocated, or a NULL value if the memory could not be allocated.  */
+   /* * NOTE * The memory is NOT allocated from any other heap if the   */
+   /*          specified heap is unable to satisfy the request.         */
+void *BTPSAPI BTPS_AllocateMemoryFromHeap(unsigned int HeapID, unsigned long MemorySize)
+{
+   void *ret_val;
+
+   if(HeapID < NumberHeaps)
+   {
+      ret_val = MemAlloc(HeapList[HeapID], MemorySize);
+
+#ifdef MEMORY_PROFILE_ENABLED
+
+      ProfileAllocation(ret_val, MemorySize, MEMORY_PROFILE_CALLER_ADDRESS(), NULL);
+
+#else
+
+      if(!ret_val)
+      {
+         DBG_MSG(DBG_ZONE_BTPSKRNL, ("Malloc Failed: %d (Heap %u).\r\n", MemorySize, HeapID));
+      }
+
+#endif
+
+#ifdef MEMORY_TRACE_ENABLED
+
+      TraceOperation(MEMORY_TRACE_OPERATION_ALLOCATE, HeapID, ret_val, NULL, MemorySize);
+
+#endif
+   }
+   else
+      ret_val = NULL;
+
+   /* Finally return the result to the caller.                          */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to create */
+   /* a fixed size Memory Pool.  A Memory Pool is a set of equally sized*/
+   /* blocks that can be allocated and freed in constant time without   */
+   /* any per block header (and without fragmenting the general heap).  */
+   /* This function accepts as input the size (in bytes) of each block, */
+   /* the number of blocks in the pool, and an optional memory region   */
+   /* (and the size of the region in bytes) that is to hold the blocks. */
+   /* If the MemoryRegion parameter is NULL then the blocks are carved  */
+   /* from the BTPS Kernel heap.  This function returns a               */
+   /* NON-NULL Pool Handle if the Pool was successfully created, or a   */
+   /* NULL Pool Handle if the Pool was unable to be created.            */
+   /* * NOTE * A caller supplied MemoryRegion *MUST* be aligned on a    */
+   /*          pointer boundary and *MUST* be at least                  */
+   /*          BTPS_POOL_MEMORY_SIZE(BlockSize, NumberBlocks) bytes.    */
+   /*          The region must remain valid until the Pool is deleted.  */
+Pool_t BTPSAPI BTPS_CreatePool(unsigned int BlockSize, unsigned int NumberBlocks, void *MemoryRegion, unsigned long RegionSize)
+{
+   Pool_t         ret_val;
+   unsigned int   Index;
+   unsigned char *Block;
+   PoolHeader_t  *PoolHeader;
+
+   /* Round the block size up so that every block can hold (and is      */
+   /* aligned for) the free list link.                                  */
+   BlockSize = BTPS_POOL_BLOCK_SIZE(BlockSize);
+
+   /* Before proceeding any further we need to make sure that the       */
+   /* parameters that were passed to us appear semi-valid.              */
+   if((BlockSize) && (NumberBlocks) && ((!MemoryRegion) || ((!(((unsigned long)MemoryRegion) % sizeof(void *))) && (RegionSize >= ((unsigned long)BlockSize * NumberBlocks)))))
+   {
+      /* Parameters appear semi-valid, so now let's allocate the Pool   */
+      /* Header and bitmap (and the block storage if the caller did not */
+      /* supply a region).                                              */
+      if((PoolHeader = (PoolHeader_t *)BTPS_AllocateMemory(BTPS_POOL_BLOCK_SIZE(sizeof(PoolHeader_t)) + POOL_MAP_SIZE(NumberBlocks) + ((MemoryRegion)?0:((unsigned long)BlockSize * NumberBlocks)))) != NULL)
+      {
+         PoolHeader->AllocatedMap = ((unsigned char *)PoolHeader) + BTPS_POOL_BLOCK_SIZE(sizeof(PoolHeader_t));
+
+         BTPS_MemInitialize(PoolHeader->AllocatedMap, 0, POOL_MAP_SIZE(NumberBlocks));
+
+         if(!MemoryRegion)
+            MemoryRegion = PoolHeader->AllocatedMap + POOL_MAP_SIZE(NumberBlocks);
+
+         PoolHeader->BlockSize          = BlockSize;
+         PoolHeader->NumberBlocks       = NumberBlocks;
+         PoolHeader->BlocksInUse        = 0;
+         PoolHeader->MaximumBlocksInUse = 0;
+         PoolHeader->AllocationFailures = 0;
+         PoolHeader->FirstBlock         = (unsigned char *)MemoryRegion;
+         PoolHeader->LastBlock          = PoolHeader->FirstBlock + ((NumberBlocks - 1) * BlockSize);
+
+         /* Thread every block onto the free list, in address order so  */
+         /* that the first allocations are handed out from the start of */
+         /* the region.                                                 */
+         for(Index = NumberBlocks, Block = PoolHeader->LastBlock, PoolHeader->FreeList = NULL; Index; Index--, Block -= BlockSize)
+         {
+            POOL_BLOCK_NEXT(Block) = PoolHeader->FreeList;
+            PoolHeader->FreeList   = Block;
+         }
+
+         /* All finished, return success to the caller (the Pool        */
+         /* Header).                                                    */
+         ret_val = (Pool_t)PoolHeader;
+      }
+      else
+         ret_val = NULL;
+   }
+   else
+      ret_val = NULL;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* allocate a single block from the specified Memory Pool.  This     */
+   /* function accepts as input the Pool Handle that was returned from  */
+   /* a successful call to BTPS_CreatePool().  This function returns a  */
+   /* NON-NULL pointer to the block if a block was available, or a NULL */
+   /* value if all blocks of the pool are currently in use.             */
+void *BTPSAPI BTPS_AllocateFromPool(Pool_t Pool)
+{
+   void         *ret_val;
+   unsigned int  Index;
+
+   if(Pool)
+   {
+      /* Simply pop the first block from the free list (and flag it as  */
+      /* allocated).                                                    */
+      if((ret_val = ((PoolHeader_t *)Pool)->FreeList) != NULL)
+      {
+         ((PoolHeader_t *)Pool)->FreeList = POOL_BLOCK_NEXT(ret_val);
+
+         Index = (unsigned int)(((unsigned char *)ret_val) - ((PoolHeader_t *)Pool)->FirstBlock) / ((PoolHeader_t *)Pool)->BlockSize;
+
+         POOL_MAP_BYTE((PoolHeader_t *)Pool, Index) |= POOL_MAP_BIT(Index);
+
+         if(++(((PoolHeader_t *)Pool)->BlocksInUse) > ((PoolHeader_t *)Pool)->MaximumBlocksInUse)
+            ((PoolHeader_t *)Pool)->MaximumBlocksInUse = ((PoolHeader_t *)Pool)->BlocksInUse;
+      }
+      else
+         ((PoolHeader_t *)Pool)->AllocationFailures++;
+   }
+   else
+      ret_val = NULL;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for returning a block that  */
+   /* was allocated with BTPS_AllocateFromPool() to the specified Memory*/
+   /* Pool.  This function accepts as input the Pool Handle and the     */
+   /* block to free.  This function returns TRUE if the block was       */
+   /* returned to the pool, or FALSE if the block does not belong to the*/
+   /* specified pool or is not allocated (in which case nothing is      */
+   /* done).                                                            */
+   /* * NOTE * The return value allows callers that fall back to the    */
+   /*          heap (when the pool is exhausted) to simply call         */
+   /*          BTPS_FreeMemory() when this function returns FALSE.      */
+Boolean_t BTPSAPI BTPS_FreeToPool(Pool_t Pool, void *MemoryPointer)
+{
+   Boolean_t    ret_val;
+   unsigned int Index;
+
+   /* Verify that the block lies within the pool region and is on a     */
+   /* block boundary.                                                   */
+   if((Pool) && (((unsigned char *)MemoryPointer) >= ((PoolHeader_t *)Pool)->FirstBlock) && (((unsigned char *)MemoryPointer) <= ((PoolHeader_t *)Pool)->LastBlock) && (!((unsigned int)(((unsigned char *)MemoryPointer) - ((PoolHeader_t *)Pool)->FirstBlock) % ((PoolHeader_t *)Pool)->BlockSize)))
+   {
+      Index = (unsigned int)(((unsigned char *)MemoryPointer) - ((PoolHeader_t *)Pool)->FirstBlock) / ((PoolHeader_t *)Pool)->BlockSize;
+
+      /* A block that is not flagged as allocated is already on the free*/
+      /* list, pushing it again would hand it out twice.                */
+      if(POOL_MAP_BYTE((PoolHeader_t *)Pool, Index) & POOL_MAP_BIT(Index))
+      {
+         POOL_MAP_BYTE((PoolHeader_t *)Pool, Index) &= (unsigned char)(~POOL_MAP_BIT(Index));
+
+         /* Push the block back onto the head of the free list.         */
+         POOL_BLOCK_NEXT(MemoryPointer)   = ((PoolHeader_t *)Pool)->FreeList;
+         ((PoolHeader_t *)Pool)->FreeList = MemoryPointer;
+
+         ((PoolHeader_t *)Pool)->BlocksInUse--;
+
+         ret_val = TRUE;
+      }
+      else
+      {
+         DBG_MSG(DBG_ZONE_BTPSKRNL, ("Pool Block Not Allocated: %p.\r\n", MemoryPointer));
+
+         ret_val = FALSE;
+      }
+   }
+   else
+      ret_val = FALSE;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for querying the current    */
+   /* statistics of the specified Memory Pool.  This function accepts as*/
+   /* input the Pool Handle and a pointer to a structure that is to     */
+   /* receive the statistics.  This function returns zero if successful */
+   /* or a negative value if there is an error.                         */
+int BTPSAPI BTPS_QueryPoolStatistics(Pool_t Pool, BTPS_PoolStatistics_t *PoolStatistics)
+{
+   int ret_val;
+
+   if((Pool) && (PoolStatistics))
+   {
+      PoolStatistics->BlockSize          = ((PoolHeader_t *)Pool)->BlockSize;
+      PoolStatistics->NumberBlocks       = ((PoolHeader_t *)Pool)->NumberBlocks;
+      PoolStatistics->BlocksInUse        = ((PoolHeader_t *)Pool)->BlocksInUse;
+      PoolStatistics->MaximumBlocksInUse = ((PoolHeader_t *)Pool)->MaximumBlocksInUse;
+      PoolStatistics->AllocationFailures = ((PoolHeader_t *)Pool)->AllocationFailures;
+
+      ret_val                            = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is responsible for destroying a Memory Pool*/
+   /* that was created with BTPS_CreatePool().  Once this function has  */
+   /* completed the Pool Handle (and ALL blocks that were allocated from*/
+   /* the pool) are NO longer valid.                                    */
+void BTPSAPI BTPS_DeletePool(Pool_t Pool)
+{
+   /* The block storage (if it was carved from the heap) lives in the   */
+   /* same allocation as the header, so simply free the header.         */
+   if(Pool)
+      BTPS_FreeMemory(Pool);
+}
+
+   /* The following function is responsible for copying a block of      */
+   /* memory of the specified size from the specified source pointer to */
+   /* the specified destination memory pointer.  This function accepts  */
+   /* as input a pointer to the memory block that is to be Destination  */
+   /* Buffer (first parameter), a pointer to memory block that points to*/
+   /* the data to be copied into the destination buffer, and the size   */
+   /* (in bytes) of the Data to copy.  The Source and Destination Memory*/
+   /* Buffers must contain AT LEAST as many bytes as specified by the   */
+   /* Size parameter.                                                   */
+   /* * NOTE * This function does not allow the overlapping of the      */
+   /*          Source and Destination Buffers !!!!                      */
+void BTPSAPI BTPS_MemCopy(void *Destination, BTPSCONST void *Source, unsigned long Size)
+{
+   CopyMemoryForward((unsigned char *)Destination, (BTPSCONST unsigned char *)Source, Size);
+}
+
+   /* The following function is responsible for moving a block of memory*/
+   /* of the specified size from the specified source pointer to the    */
+   /* specified destination memory pointer.  This function accepts as   */
+   /* input a pointer to the memory block that is to be Destination     */
+   /* Buffer (first parameter), a pointer to memory block that points to*/
+   /* the data to be copied into the destination buffer, and the size   */
+   /* (in bytes) of the Data to copy.  The Source and Destination Memory*/
+   /* Buffers must contain AT LEAST as many bytes as specified by the   */
+   /* Size parameter.                                                   */
+   /* * NOTE * This function DOES allow the overlapping of the Source   */
+   /*          and Destination Buffers.                                 */
+void BTPSAPI BTPS_MemMove(void *Destination, BTPSCONST void *Source, unsigned long Size)
+{
+   /* Copy in ascending order unless the destination overlaps the end   */
+   /* of the source.                                                    */
+   if((((unsigned char *)Destination) <= ((BTPSCONST unsigned char *)Source)) || (((unsigned char *)Destination) >= (((BTPSCONST unsigned char *)Source) + Size)))
+      CopyMemoryForward((unsigned char *)Destination, (BTPSCONST unsigned char *)Source, Size);
+   else
+      CopyMemoryBackward((unsigned char *)Destination, (BTPSCONST unsigned char *)Source, Size);
+}
+
+   /* The following function is provided to allow a mechanism to fill a */
+   /* block of memory with the specified value.  This function accepts  */
+   /* as input a pointer to the Data Buffer (first parameter) that is to*/
+   /* filled with the specified value (second parameter).  The final    */
+   /* parameter to this function specifies the number of bytes that are */
+   /* to be filled in the Data Buffer.  The Destination Buffer must     */
+   /* point to a Buffer that is AT LEAST the size of the Size parameter.*/
+void BTPSAPI BTPS_MemInitialize(void *Destination, unsigned char Value, unsigned long Size)
+{
+   unsigned char *Byte;
+   MemoryWord_t   Pattern;
+   MemoryWord_t  *Word;
+
+   Byte = (unsigned char *)Destination;
+
+   if(Size >= MEMORY_WORD_THRESHOLD)
+   {
+      /* Fill the leading bytes up to the first word boundary.          */
+      while(((unsigned long)Byte) & MEMORY_WORD_MASK)
+      {
+         *(Byte++) = Value;
+         Size--;
+      }
+
+      /* Replicate the value into every byte of a word.                 */
+      Pattern = (((MemoryWord_t)-1) / 0xFF) * Value;
+      Word    = (MemoryWord_t *)Byte;
+
+      /* Fill blocks of four words (a single STM on the Cortex-M).      */
+      while(Size >= MEMORY_BLOCK_SIZE)
+      {
+         Word[0]  = Pattern;
+         Word[1]  = Pattern;
+         Word[2]  = Pattern;
+         Word[3]  = Pattern;
+
+         Word    += 4;
+         Size    -= MEMORY_BLOCK_SIZE;
+      }
+
+      /* Fill the remaining whole words.                                */
+      while(Size >= MEMORY_WORD_SIZE)
+      {
+         *(Word++)  = Pattern;
+         Size      -= MEMORY_WORD_SIZE;
+      }
+
+      Byte = (unsigned char *)Word;
+   }
+
+   /* Fill the trailing bytes (or the entire block if it is small).     */
+   while(Size--)
+      *(Byte++) = Value;
+}
+
+   /* The following function is provided to allow a mechanism to Compare*/
+   /* two blocks of memory to see if the two memory blocks (each of size*/
+   /* Size (in bytes)) are equal (each and every byte up to Size bytes).*/
+   /* This function returns a negative number if Source1 is less than   */
+   /* Source2, zero if Source1 equals Source2, and a positive value if  */
+   /* Source1 is greater than Source2.                                  */
+int BTPSAPI BTPS_MemCompare(BTPSCONST void *Source1, BTPSCONST void *Source2, unsigned long Size)
+{
+   int           ret_val;
+   unsigned long Index;
+
+   /* Locate the first differing byte (if any) and compare it.          */
+   if((Index = CountMatchingBytes((BTPSCONST unsigned char *)Source1, (BTPSCONST unsigned char *)Source2, Size)) < Size)
+      ret_val = (int)((BTPSCONST unsigned char *)Source1)[Index] - (int)((BTPSCONST unsigned char *)Source2)[Index];
+   else
+      ret_val = 0;
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to Compare*/
+   /* two blocks of memory to see if the two memory blocks (each of size*/
+   /* Size (in bytes)) are equal (each and every byte up to Size bytes) */
+   /* using a Case-Insensitive Compare.  This function returns a        */
+   /* negative number if Source1 is less than Source2, zero if Source1  */
+   /* equals Source2, and a positive value if Source1 is greater than   */
+   /* Source2.                                                          */
+int BTPSAPI BTPS_MemCompareI(BTPSCONST void *Source1, BTPSCONST void *Source2, unsigned long Size)
+{
+   int                      ret_val = 0;
+   unsigned char            Byte1;
+   unsigned char            Byte2;
+   unsigned long            Index;
+   BTPSCONST unsigned char *Data1;
+   BTPSCONST unsigned char *Data2;
+
+   Data1 = (BTPSCONST unsigned char *)Source1;
+   Data2 = (BTPSCONST unsigned char *)Source2;
+
+   /* Simply loop until a difference is found.  Identical bytes are     */
+   /* skipped (a word at a time where possible), only bytes that differ */
+   /* need to be folded to upper case before they are compared.         */
+   for(Index = 0; ((Index < Size) && (!ret_val)); Index++)
+   {
+      Index += CountMatchingBytes(&(Data1[Index]), &(Data2[Index]), (Size - Index));
+
+      if(Index < Size)
+      {
+         Byte1 = CaseFoldTable[Data1[Index]];
+         Byte2 = CaseFoldTable[Data2[Index]];
+
+         /* If the two Bytes are equal then there is nothing to do.     */
+         if(Byte1 != Byte2)
+         {
+            /* Bytes are not equal, so set the return value accordingly.*/
+            if(Byte1 < Byte2)
+               ret_val = -1;
+            else
+               ret_val = 1;
+         }
+      }
+   }
+
+   /* Simply return the result of the above comparison(s).              */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to copy a */
+   /* source NULL Terminated ASCII (character) String to the specified  */
+   /* Destination String Buffer.  This function accepts as input a      */
+   /* pointer to a buffer (Destination) that is to receive the NULL     */
+   /* Terminated ASCII String pointed to by the Source parameter.  This */
+   /* function copies the string byte by byte from the Source to the    */
+   /* Destination (including the NULL terminator).                      */
+void BTPSAPI BTPS_StringCopy(char *Destination, BTPSCONST char *Source)
+{
+   /* Simply wrap the C Run-Time strcpy() function.                     */
+   strcpy(Destination, Source);
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* determine the Length (in characters) of the specified NULL        */
+   /* Terminated ASCII (character) String.  This function accepts as    */
+   /* input a pointer to a NULL Terminated ASCII String and returns the */
+   /* number of characters present in the string (NOT including the     */
+   /* terminating NULL character).                                      */
+unsigned int BTPSAPI BTPS_StringLength(BTPSCONST char *Source)
+{
+   /* Simply wrap the C Run-Time strlen() function.                     */
+   return(strlen(Source));
+}
+
+   /* The following function is provided to allow a mechanism for a C   */
+   /* Run-Time Library sprintf() function implementation.  This function*/
+   /* accepts as its input the output buffer, a format string and a     */
+   /* variable number of arguments determined by the format string.     */
+int BTPSAPI BTPS_SprintF(char *Buffer, BTPSCONST char *Format, ...)
+{
+   int     ret_val;
+   va_list args;
+
+   /* The buffer size is not known so simply do not limit the output.   */
+   va_start(args, Format);
+   ret_val = (int)FormatString(Buffer, (unsigned int)-1, Format, args);
+   va_end(args);
+
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to create */
+   /* a Mailbox.  A Mailbox is a Data Store that contains slots (all of */
+   /* the same size) that can have data placed into (and retrieved      */
+   /* from).  Once Data is placed into a Mailbox (via the               */
+   /* BTPS_AddMailbox() function, it can be retrieved by using the      */
+   /* BTPS_WaitMailbox() function.  Data placed into the Mailbox is     */
+   /* retrieved in a FIFO method.  This function accepts as input the   */
+   /* Maximum Number of Slots that will be present in the Mailbox and   */
+   /* the Size of each of the Slots.  This function returns a NON-NULL  */
+   /* Mailbox Handle if the Mailbox is successfully created, or a NULL  */
+   /* Mailbox Handle if the Mailbox was unable to be created.           */
+Mailbox_t BTPSAPI BTPS_CreateMailbox(unsigned int NumberSlots, unsigned int SlotSize)
+{
+   Mailbox_t        ret_val;
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further we need to make sure that the       */
+   /* parameters that were passed to us appear semi-valid.              */
+   if((NumberSlots) && (SlotSize))
+   {
+      /* Parameters appear semi-valid, so now let's allocate enough     */
+      /* Memory to hold the Mailbox Header AND enough space to hold all */
+      /* requested Mailbox Slots.                                       */
+      if((MailboxHeader = (MailboxHeader_t *)BTPS_AllocateMemory(sizeof(MailboxHeader_t)+(NumberSlots*SlotSize))) != NULL)
+      {
+         /* Memory allocated, now let's initialize the state of the     */
+         /* Mailbox such that it contains NO Data.                      */
+         MailboxHeader->NumberSlots   = NumberSlots;
+         MailboxHeader->SlotSize      = SlotSize;
+         MailboxHeader->HeadSlot      = 0;
+         MailboxHeader->TailSlot      = 0;
+         MailboxHeader->OccupiedSlots = 0;
+         MailboxHeader->Slots         = ((unsigned char *)MailboxHeader) + sizeof(MailboxHeader_t);
+
+         /* Initialize the occupancy statistics and flag that there is  */
+         /* no watermark callback registered.                           */
+         MailboxHeader->MaximumOccupiedSlots = 0;
+         MailboxHeader->NumberAdded          = 0;
+         MailboxHeader->NumberRejected       = 0;
+         MailboxHeader->NumberRemoved        = 0;
+         MailboxHeader->LastChangeTick       = BTPS_GetTickCount();
+         MailboxHeader->OccupancyTime        = 0;
+         MailboxHeader->WatermarkCallback    = NULL;
+         MailboxHeader->AboveHighWatermark   = FALSE;
+
+         /* All finished, return success to the caller (the Mailbox     */
+         /* Header).                                                    */
+         ret_val                      = (Mailbox_t)MailboxHeader;
+      }
+      else
+         ret_val = NULL;
+   }
+   else
+      ret_val = NULL;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to Add data to*/
+   /* the Mailbox (where it can be retrieved via the BTPS_WaitMailbox() */
+   /* function.  This function accepts as input the Mailbox Handle of   */
+   /* the Mailbox to place the data into and a pointer to a buffer that */
+   /* contains the data to be added.  This pointer *MUST* point to a    */
+   /* data buffer that is AT LEAST the Size of the Slots in the Mailbox */
+   /* (specified when the Mailbox was created) and this pointer CANNOT  */
+   /* be NULL.  The data that the MailboxData pointer points to is      */
+   /* placed into the Mailbox where it can be retrieved via the         */
+   /* BTPS_WaitMailbox() function.                                      */
+   /* * NOTE * This function copies from the MailboxData Pointer the    */
+   /*          first SlotSize Bytes.  The SlotSize was specified when   */
+   /*          the Mailbox was created via a successful call to the     */
+   /*          BTPS_CreateMailbox() function.                           */
+Boolean_t BTPSAPI BTPS_AddMailbox(Mailbox_t Mailbox, void *MailboxData)
+{
+   Boolean_t ret_val;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* and the MailboxData pointer that was specified appears semi-valid.*/
+   if((Mailbox) && (MailboxData))
+   {
+      /* Before adding the data to the Mailbox, make sure that the      */
+      /* Mailbox is not already full.                                   */
+      if(((MailboxHeader_t *)Mailbox)->OccupiedSlots < ((MailboxHeader_t *)Mailbox)->NumberSlots)
+      {
+         /* Mailbox is NOT full, so add the specified User Data to the  */
+         /* next available free Mailbox Slot.                           */
+         BTPS_MemCopy(&(((unsigned char *)(((MailboxHeader_t *)Mailbox)->Slots))[((MailboxHeader_t *)Mailbox)->HeadSlot*((MailboxHeader_t *)Mailbox)->SlotSize]), MailboxData, ((MailboxHeader_t *)Mailbox)->SlotSize);
+
+         /* Update the Next available Free Mailbox Slot (taking into    */
+         /* account wrapping the pointer).                              */
+         if(++(((MailboxHeader_t *)Mailbox)->HeadSlot) == ((MailboxHeader_t *)Mailbox)->NumberSlots)
+            ((MailboxHeader_t *)Mailbox)->HeadSlot = 0;
+
+         /* Update the Number of occupied slots to signify that there   */
+         /* was additional Mailbox Data added to the Mailbox.           */
+         UpdateMailboxOccupancy((MailboxHeader_t *)Mailbox, 1, 0);
+
+         /* Finally, return success to the caller.                      */
+         ret_val = TRUE;
+      }
+      else
+      {
+         ((MailboxHeader_t *)Mailbox)->NumberRejected++;
+
+         ret_val = FALSE;
+      }
+   }
+   else
+      ret_val = FALSE;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to retrieve   */
+   /* data from the specified Mailbox.  This function will block until  */
+   /* either Data is placed in the Mailbox or an error with the Mailbox */
+   /* was detected.  This function accepts as its first parameter a     */
+   /* Mailbox Handle that represents the Mailbox to wait for the data   */
+   /* with.  This function accepts as its second parameter, a pointer to*/
+   /* a data buffer that is AT LEAST the size of a single Slot of the   */
+   /* Mailbox (specified when the BTPS_CreateMailbox() function was     */
+   /* called).  The MailboxData parameter CANNOT be NULL.  This function*/
+   /* will return TRUE if data was successfully retrieved from the      */
+   /* Mailbox or FALSE if there was an error retrieving data from the   */
+   /* Mailbox.  If this function returns TRUE then the first SlotSize   */
+   /* bytes of the MailboxData pointer will contain the data that was   */
+   /* retrieved from the Mailbox.                                       */
+   /* * NOTE * This function copies to the MailboxData Pointer the data */
+   /*          that is present in the Mailbox Slot (of size SlotSize).  */
+   /*          The SlotSize was specified when the Mailbox was created  */
+   /*          via a successful call to the BTPS_CreateMailbox()        */
+   /*          function.                                                */
+Boolean_t BTPSAPI BTPS_WaitMailbox(Mailbox_t Mailbox, void *MailboxData)
+{
+   Boolean_t ret_val;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* and the MailboxData pointer that was specified appears semi-valid.*/
+   if((Mailbox) && (MailboxData))
+   {
+      /* Let's check to see if there exists at least one slot with      */
+      /* Mailbox Data present in it.                                    */
+      if(((MailboxHeader_t *)Mailbox)->OccupiedSlots)
+      {
+         /* Flag success to the caller.                                 */
+         ret_val = TRUE;
+
+         /* Now copy the Data into the Memory Buffer specified by the   */
+         /* caller.                                                     */
+         BTPS_MemCopy(MailboxData, &((((unsigned char *)((MailboxHeader_t *)Mailbox)->Slots))[((MailboxHeader_t *)Mailbox)->TailSlot*((MailboxHeader_t *)Mailbox)->SlotSize]), ((MailboxHeader_t *)Mailbox)->SlotSize);
+
+         /* Now that we've copied the data into the Memory Buffer       */
+         /* specified by the caller we need to mark the Mailbox Slot as */
+         /* free.                                                       */
+         if(++(((MailboxHeader_t *)Mailbox)->TailSlot) == ((MailboxHeader_t *)Mailbox)->NumberSlots)
+            ((MailboxHeader_t *)Mailbox)->TailSlot = 0;
+
+         UpdateMailboxOccupancy((MailboxHeader_t *)Mailbox, 0, 1);
+      }
+      else
+         ret_val = FALSE;
+   }
+   else
+      ret_val = FALSE;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to Add several*/
+   /* messages to the Mailbox in a single call.  This function accepts  */
+   /* as input the Mailbox Handle of the Mailbox to place the data into,*/
+   /* the number of messages to add, and a pointer to a buffer that     */
+   /* contains the messages (stored back to back, each message is the   */
+   /* Size of the Slots in the Mailbox).  This function returns the     */
+   /* number of messages that were added to the Mailbox (zero if the    */
+   /* Mailbox is full or there was an error).                           */
+unsigned int BTPSAPI BTPS_AddMailboxBatch(Mailbox_t Mailbox, unsigned int NumberMessages, void *MailboxData)
+{
+   unsigned int     ret_val;
+   unsigned int     FirstMessages;
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* and the MailboxData pointer that was specified appears semi-valid.*/
+   if((Mailbox) && (NumberMessages) && (MailboxData))
+   {
+      MailboxHeader = (MailboxHeader_t *)Mailbox;
+
+      /* Limit the number of messages to the number of free slots.      */
+      if((ret_val = MailboxHeader->NumberSlots - MailboxHeader->OccupiedSlots) > NumberMessages)
+         ret_val = NumberMessages;
+
+      if(ret_val)
+      {
+         /* The free slots starting at the HeadSlot may wrap around the */
+         /* end of the slots, so copy the messages that fit before the  */
+         /* end and then any remaining messages to the start.           */
+         if((FirstMessages = MailboxHeader->NumberSlots - MailboxHeader->HeadSlot) > ret_val)
+            FirstMessages = ret_val;
+
+         BTPS_MemCopy(&(((unsigned char *)MailboxHeader->Slots)[MailboxHeader->HeadSlot*MailboxHeader->SlotSize]), MailboxData, FirstMessages*MailboxHeader->SlotSize);
+
+         if(ret_val > FirstMessages)
+            BTPS_MemCopy(MailboxHeader->Slots, &(((unsigned char *)MailboxData)[FirstMessages*MailboxHeader->SlotSize]), (ret_val - FirstMessages)*MailboxHeader->SlotSize);
+
+         /* Update the Next available Free Mailbox Slot (taking into    */
+         /* account wrapping the pointer) and the Number of occupied    */
+         /* slots.                                                      */
+         if((MailboxHeader->HeadSlot += ret_val) >= MailboxHeader->NumberSlots)
+            MailboxHeader->HeadSlot -= MailboxHeader->NumberSlots;
+
+         UpdateMailboxOccupancy(MailboxHeader, ret_val, 0);
+      }
+
+      MailboxHeader->NumberRejected += (NumberMessages - ret_val);
+   }
+   else
+      ret_val = 0;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to retrieve   */
+   /* several messages from the specified Mailbox in a single call.     */
+   /* This function accepts as input the Mailbox Handle, the maximum    */
+   /* number of messages to retrieve and a pointer to a data buffer that*/
+   /* is AT LEAST the maximum number of messages multiplied by the Size */
+   /* of the Slots in the Mailbox.  This function returns the number of */
+   /* messages that were retrieved (stored back to back in the buffer in*/
+   /* FIFO order), zero if the Mailbox is empty or there was an error.  */
+unsigned int BTPSAPI BTPS_WaitMailboxBatch(Mailbox_t Mailbox, unsigned int MaximumMessages, void *MailboxData)
+{
+   unsigned int     ret_val;
+   unsigned int     FirstMessages;
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* and the MailboxData pointer that was specified appears semi-valid.*/
+   if((Mailbox) && (MaximumMessages) && (MailboxData))
+   {
+      MailboxHeader = (MailboxHeader_t *)Mailbox;
+
+      /* Limit the number of messages to the number of occupied slots.  */
+      if((ret_val = MailboxHeader->OccupiedSlots) > MaximumMessages)
+         ret_val = MaximumMessages;
+
+      if(ret_val)
+      {
+         /* The occupied slots starting at the TailSlot may wrap around */
+         /* the end of the slots, so copy the messages up to the end and*/
+         /* then any remaining messages from the start.                 */
+         if((FirstMessages = MailboxHeader->NumberSlots - MailboxHeader->TailSlot) > ret_val)
+            FirstMessages = ret_val;
+
+         BTPS_MemCopy(MailboxData, &(((unsigned char *)MailboxHeader->Slots)[MailboxHeader->TailSlot*MailboxHeader->SlotSize]), FirstMessages*MailboxHeader->SlotSize);
+
+         if(ret_val > FirstMessages)
+            BTPS_MemCopy(&(((unsigned char *)MailboxData)[FirstMessages*MailboxHeader->SlotSize]), MailboxHeader->Slots, (ret_val - FirstMessages)*MailboxHeader->SlotSize);
+
+         /* Now that we've copied the data into the Memory Buffer       */
+         /* specified by the caller we need to mark the Mailbox Slots as*/
+         /* free.                                                       */
+         if((MailboxHeader->TailSlot += ret_val) >= MailboxHeader->NumberSlots)
+            MailboxHeader->TailSlot -= MailboxHeader->NumberSlots;
+
+         UpdateMailboxOccupancy(MailboxHeader, 0, ret_val);
+      }
+   }
+   else
+      ret_val = 0;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to process the*/
+   /* messages that are queued in the specified Mailbox without copying */
+   /* them out of the Mailbox.  This function accepts as input the      */
+   /* Mailbox Handle, the maximum number of messages to process (zero to*/
+   /* process all of the messages that are currently queued), and the   */
+   /* callback function (and parameter) that is called (in FIFO order)  */
+   /* with each message.  This function returns the number of messages  */
+   /* that were processed.                                              */
+   /* * NOTE * The slot is only marked as free after the callback has   */
+   /*          returned so that the callback may add messages to the    */
+   /*          Mailbox without overwriting the message it was passed.   */
+unsigned int BTPSAPI BTPS_DrainMailbox(Mailbox_t Mailbox, unsigned int MaximumMessages, BTPS_MailboxDrainCallback_t MailboxDrainCallback, void *CallbackParameter)
+{
+   unsigned int     ret_val;
+   unsigned int     NumberMessages;
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* and the callback that was specified appears semi-valid.           */
+   if((Mailbox) && (MailboxDrainCallback))
+   {
+      MailboxHeader = (MailboxHeader_t *)Mailbox;
+
+      /* Only process the messages that are queued now, so a callback   */
+      /* that queues a new message cannot keep the drain going forever. */
+      NumberMessages = MailboxHeader->OccupiedSlots;
+      if((MaximumMessages) && (NumberMessages > MaximumMessages))
+         NumberMessages = MaximumMessages;
+
+      for(ret_val = 0; ret_val < NumberMessages; ret_val++)
+      {
+         __BTPSTRY
+         {
+            (*MailboxDrainCallback)(&(((unsigned char *)MailboxHeader->Slots)[MailboxHeader->TailSlot*MailboxHeader->SlotSize]), CallbackParameter);
+         }
+         __BTPSEXCEPT(1)
+         {
+            /* Do Nothing.                                              */
+         }
+
+         /* Now that we've called back with the data, we need to advance*/
+         /* to the next slot.                                           */
+         if(++(MailboxHeader->TailSlot) == MailboxHeader->NumberSlots)
+            MailboxHeader->TailSlot = 0;
+
+         UpdateMailboxOccupancy(MailboxHeader, 0, 1);
+      }
+   }
+   else
+      ret_val = 0;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is a utility function that exists to       */
+   /* determine if there is anything queued in the specified Mailbox.   */
+   /* This function returns TRUE if there is something queued in the    */
+   /* Mailbox, or FALSE if there is nothing queued in the specified     */
+   /* Mailbox.                                                          */
+Boolean_t BTPSAPI BTPS_QueryMailbox(Mailbox_t Mailbox)
+{
+   Boolean_t ret_val;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* and the MailboxData pointer that was specified appears semi-valid.*/
+   if(Mailbox)
+   {
+      /* Let's check to see if there exists at least one slot with      */
+      /* Mailbox Data present in it.                                    */
+      if(((MailboxHeader_t *)Mailbox)->OccupiedSlots)
+      {
+         /* Flag success to the caller.                                 */
+         ret_val = TRUE;
+      }
+      else
+         ret_val = FALSE;
+   }
+   else
+      ret_val = FALSE;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is responsible for destroying a Mailbox    */
+   /* that was created successfully via a successful call to the        */
+   /* BTPS_CreateMailbox() function.  This function accepts as input the*/
+   /* Mailbox Handle of the Mailbox to destroy.  Once this function is  */
+   /* completed the Mailbox Handle is NO longer valid and CANNOT be     */
+   /* used.  Calling this function will cause all outstanding           */
+   /* BTPS_WaitMailbox() functions to fail with an error.  The final    */
+   /* parameter specifies an (optional) callback function that is called*/
+   /* for each queued Mailbox entry.  This allows a mechanism to free   */
+   /* any resources that might be associated with each individual       */
+   /* Mailbox item.                                                     */
+void BTPSAPI BTPS_DeleteMailbox(Mailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback)
 {
-   /* Simply wrap the C Run-Time strlen() function.                     */
-   return(strlen(Source));
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      /* Check to see if a Mailbox Delete Item Callback was specified.  */
+      if(MailboxDeleteCallback)
+      {
+         /* Now loop though all of the occupied slots and call the      */
+         /* callback with the slot data.                                */
+         while(((MailboxHeader_t *)Mailbox)->OccupiedSlots)
+         {
+            __BTPSTRY
+            {
+               (*MailboxDeleteCallback)(&((((unsigned char *)((MailboxHeader_t *)Mailbox)->Slots))[((MailboxHeader_t *)Mailbox)->TailSlot*((MailboxHeader_t *)Mailbox)->SlotSize]));
+            }
+            __BTPSEXCEPT(1)
+            {
+               /* Do Nothing.                                           */
+            }
+
+            /* Now that we've called back with the data, we need to     */
+            /* advance to the next slot.                                */
+            if(++(((MailboxHeader_t *)Mailbox)->TailSlot) == ((MailboxHeader_t *)Mailbox)->NumberSlots)
+               ((MailboxHeader_t *)Mailbox)->TailSlot = 0;
+
+            /* Flag that there is one less occupied slot.               */
+            ((MailboxHeader_t *)Mailbox)->OccupiedSlots--;
+         }
+      }
+
+      /* Finally free all memory that was allocated for the Mailbox.    */
+      BTPS_FreeMemory(Mailbox);
+   }
 }
 
-   /* The following function is provided to allow a mechanism for a C   */
-   /* Run-Time Library sprintf() function implementation.  This function*/
-   /* accepts as its input the output buffer, a format string and a     */
-   /* variable number of arguments determined by the format string.     */
-int BTPSAPI BTPS_SprintF(char *Buffer, BTPSCONST char *Format, ...)
+   /* The following function is provided to allow a mechanism to query  */
+   /* the occupancy statistics of the specified Mailbox.  This function */
+   /* accepts as input the Mailbox Handle and a pointer to a buffer that*/
+   /* will receive the statistics.  This function returns zero if       */
+   /* successful or a negative value if there was an error.             */
+int BTPSAPI BTPS_QueryMailboxStatistics(Mailbox_t Mailbox, BTPS_MailboxStatistics_t *MailboxStatistics)
 {
-   int     ret_val;
-   va_list args;
+   int              ret_val;
+   QWord_t          OccupancyTime;
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the parameters that  */
+   /* were specified appear semi-valid.                                 */
+   if((Mailbox) && (MailboxStatistics))
+   {
+      MailboxHeader = (MailboxHeader_t *)Mailbox;
+
+      MailboxStatistics->NumberSlots          = MailboxHeader->NumberSlots;
+      MailboxStatistics->OccupiedSlots        = MailboxHeader->OccupiedSlots;
+      MailboxStatistics->MaximumOccupiedSlots = MailboxHeader->MaximumOccupiedSlots;
+      MailboxStatistics->NumberAdded          = MailboxHeader->NumberAdded;
+      MailboxStatistics->NumberRejected       = MailboxHeader->NumberRejected;
+      MailboxStatistics->NumberRemoved        = MailboxHeader->NumberRemoved;
+
+      /* Include the time the currently occupied slots have been        */
+      /* occupied since the last change.                                */
+      /* * NOTE * This also counts the time spent by the messages that  */
+      /*          have not yet been removed, so the residency is an     */
+      /*          approximation unless the Mailbox is empty.            */
+      OccupancyTime = MailboxHeader->OccupancyTime + ((QWord_t)MailboxHeader->OccupiedSlots * (BTPS_GetTickCount() - MailboxHeader->LastChangeTick));
+
+      if(MailboxHeader->NumberRemoved)
+         MailboxStatistics->AverageResidency = (unsigned long)(OccupancyTime / MailboxHeader->NumberRemoved);
+      else
+         MailboxStatistics->AverageResidency = 0;
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to reset  */
+   /* the occupancy statistics of the specified Mailbox.  This function */
+   /* accepts as input the Mailbox Handle.                              */
+void BTPSAPI BTPS_ResetMailboxStatistics(Mailbox_t Mailbox)
+{
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      MailboxHeader = (MailboxHeader_t *)Mailbox;
+
+      MailboxHeader->MaximumOccupiedSlots = MailboxHeader->OccupiedSlots;
+      MailboxHeader->NumberAdded          = 0;
+      MailboxHeader->NumberRejected       = 0;
+      MailboxHeader->NumberRemoved        = 0;
+      MailboxHeader->LastChangeTick       = BTPS_GetTickCount();
+      MailboxHeader->OccupancyTime        = 0;
+   }
+}
+
+   /* The following function is provided to allow a mechanism to        */
+   /* register a callback that is notified when the number of occupied  */
+   /* slots of the specified Mailbox crosses the specified watermarks.  */
+   /* This function accepts as input the Mailbox Handle, the high       */
+   /* watermark, the low watermark and the callback function (and       */
+   /* parameter).  This function returns zero if successful or a        */
+   /* negative value if there was an error.                             */
+int BTPSAPI BTPS_RegisterMailboxWatermarkCallback(Mailbox_t Mailbox, unsigned int HighWatermark, unsigned int LowWatermark, BTPS_MailboxWatermarkCallback_t MailboxWatermarkCallback, void *CallbackParameter)
+{
+   int              ret_val;
+   MailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      MailboxHeader = (MailboxHeader_t *)Mailbox;
+
+      /* Check to see if the callback is being registered or removed.   */
+      if(MailboxWatermarkCallback)
+      {
+         /* Make sure that the watermarks are valid for this Mailbox.   */
+         if((HighWatermark > LowWatermark) && (HighWatermark <= MailboxHeader->NumberSlots))
+         {
+            MailboxHeader->HighWatermark              = HighWatermark;
+            MailboxHeader->LowWatermark               = LowWatermark;
+            MailboxHeader->AboveHighWatermark         = (Boolean_t)(MailboxHeader->OccupiedSlots >= HighWatermark);
+            MailboxHeader->WatermarkCallback          = MailboxWatermarkCallback;
+            MailboxHeader->WatermarkCallbackParameter = CallbackParameter;
+
+            ret_val                                   = 0;
+         }
+         else
+            ret_val = -1;
+      }
+      else
+      {
+         MailboxHeader->WatermarkCallback = NULL;
+
+         ret_val                          = 0;
+      }
+   }
+   else
+      ret_val = -1;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a mechanism to create */
+   /* a Single Producer/Single Consumer (SPSC) Mailbox.  An SPSC Mailbox*/
+   /* may be written by exactly one producer (which may be an ISR) and  */
+   /* read by exactly one consumer without any locking.  This function  */
+   /* accepts as input the Maximum Number of Slots that will be present */
+   /* in the Mailbox and the Size of each of the Slots.  This function  */
+   /* returns a NON-NULL SPSC Mailbox Handle if the Mailbox is          */
+   /* successfully created, or a NULL Mailbox Handle if the Mailbox was */
+   /* unable to be created.                                             */
+SPSCMailbox_t BTPSAPI BTPS_CreateSPSCMailbox(unsigned int NumberSlots, unsigned int SlotSize)
+{
+   SPSCMailbox_t        ret_val;
+   SPSCMailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further we need to make sure that the       */
+   /* parameters that were passed to us appear semi-valid.              */
+   if((NumberSlots) && (SlotSize))
+   {
+      /* Round the Slot Size so that every slot is aligned and account  */
+      /* for the slot that is always left unused.                       */
+      SlotSize = BTPS_POOL_BLOCK_SIZE(SlotSize);
+      NumberSlots++;
+
+      /* Parameters appear semi-valid, so now let's allocate enough     */
+      /* Memory to hold the Mailbox Header AND enough space to hold all */
+      /* Mailbox Slots.                                                 */
+      if((MailboxHeader = (SPSCMailboxHeader_t *)BTPS_AllocateMemory(SPSC_MAILBOX_HEADER_SIZE + ((unsigned long)NumberSlots * SlotSize))) != NULL)
+      {
+         /* Memory allocated, now let's initialize the state of the     */
+         /* Mailbox such that it contains NO Data.                      */
+         MailboxHeader->NumberSlots = NumberSlots;
+         MailboxHeader->SlotSize    = SlotSize;
+         MailboxHeader->HeadSlot    = 0;
+         MailboxHeader->TailSlot    = 0;
+         MailboxHeader->Slots       = ((unsigned char *)MailboxHeader) + SPSC_MAILBOX_HEADER_SIZE;
+
+         /* All finished, return success to the caller (the Mailbox     */
+         /* Header).                                                    */
+         ret_val                    = (SPSCMailbox_t)MailboxHeader;
+      }
+      else
+         ret_val = NULL;
+   }
+   else
+      ret_val = NULL;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow the producer of an    */
+   /* SPSC Mailbox to reserve the next free slot.  This function accepts*/
+   /* as input the SPSC Mailbox Handle.  This function returns a pointer*/
+   /* to the reserved slot, or NULL if the Mailbox is full.             */
+   /* * NOTE * This function may be called from an ISR.                 */
+void *BTPSAPI BTPS_ReserveSPSCMailbox(SPSCMailbox_t Mailbox)
+{
+   void         *ret_val;
+   unsigned int  HeadSlot;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      /* The HeadSlot is only written by the producer (the caller) so it*/
+      /* is stable, only the TailSlot may change underneath us (which   */
+      /* can only make more room).                                      */
+      HeadSlot = ((SPSCMailboxHeader_t *)Mailbox)->HeadSlot;
+
+      if(SPSC_MAILBOX_NEXT_SLOT((SPSCMailboxHeader_t *)Mailbox, HeadSlot) != ((SPSCMailboxHeader_t *)Mailbox)->TailSlot)
+         ret_val = &(((SPSCMailboxHeader_t *)Mailbox)->Slots[HeadSlot*((SPSCMailboxHeader_t *)Mailbox)->SlotSize]);
+      else
+         ret_val = NULL;
+   }
+   else
+      ret_val = NULL;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow the producer of an    */
+   /* SPSC Mailbox to publish the slot that was returned from           */
+   /* BTPS_ReserveSPSCMailbox() to the consumer.  This function accepts */
+   /* as input the SPSC Mailbox Handle.  This function returns TRUE if  */
+   /* the slot was committed or FALSE if there was an error.            */
+   /* * NOTE * This function may be called from an ISR.                 */
+Boolean_t BTPSAPI BTPS_CommitSPSCMailbox(SPSCMailbox_t Mailbox)
+{
+   Boolean_t    ret_val;
+   unsigned int NextSlot;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      NextSlot = SPSC_MAILBOX_NEXT_SLOT((SPSCMailboxHeader_t *)Mailbox, ((SPSCMailboxHeader_t *)Mailbox)->HeadSlot);
+
+      if(NextSlot != ((SPSCMailboxHeader_t *)Mailbox)->TailSlot)
+      {
+         /* Make sure the message that was written into the slot is     */
+         /* complete before the slot is made visible to the consumer.   */
+         BTPS_MEMORY_BARRIER();
+
+         ((SPSCMailboxHeader_t *)Mailbox)->HeadSlot = NextSlot;
+
+         ret_val = TRUE;
+      }
+      else
+         ret_val = FALSE;
+   }
+   else
+      ret_val = FALSE;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow the consumer of an    */
+   /* SPSC Mailbox to access the oldest message in the Mailbox (in      */
+   /* place).  This function accepts as input the SPSC Mailbox Handle.  */
+   /* This function returns a pointer to the slot that holds the oldest */
+   /* message, or NULL if the Mailbox is empty.                         */
+void *BTPSAPI BTPS_PeekSPSCMailbox(SPSCMailbox_t Mailbox)
+{
+   void         *ret_val;
+   unsigned int  TailSlot;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      TailSlot = ((SPSCMailboxHeader_t *)Mailbox)->TailSlot;
+
+      if(TailSlot != ((SPSCMailboxHeader_t *)Mailbox)->HeadSlot)
+      {
+         /* Make sure the slot data is not read before the HeadSlot that*/
+         /* published it.                                               */
+         BTPS_MEMORY_BARRIER();
+
+         ret_val = &(((SPSCMailboxHeader_t *)Mailbox)->Slots[TailSlot*((SPSCMailboxHeader_t *)Mailbox)->SlotSize]);
+      }
+      else
+         ret_val = NULL;
+   }
+   else
+      ret_val = NULL;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow the consumer of an    */
+   /* SPSC Mailbox to remove the oldest message from the Mailbox, which */
+   /* returns the slot to the producer.  This function accepts as input */
+   /* the SPSC Mailbox Handle.  This function returns TRUE if a message */
+   /* was removed or FALSE if there was an error (or the Mailbox is     */
+   /* empty).                                                           */
+Boolean_t BTPSAPI BTPS_ReleaseSPSCMailbox(SPSCMailbox_t Mailbox)
+{
+   Boolean_t    ret_val;
+   unsigned int TailSlot;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      TailSlot = ((SPSCMailboxHeader_t *)Mailbox)->TailSlot;
+
+      if(TailSlot != ((SPSCMailboxHeader_t *)Mailbox)->HeadSlot)
+      {
+         /* Make sure the consumer is finished with the slot before it  */
+         /* is handed back to the producer.                             */
+         BTPS_MEMORY_BARRIER();
+
+         ((SPSCMailboxHeader_t *)Mailbox)->TailSlot = SPSC_MAILBOX_NEXT_SLOT((SPSCMailboxHeader_t *)Mailbox, TailSlot);
+
+         ret_val = TRUE;
+      }
+      else
+         ret_val = FALSE;
+   }
+   else
+      ret_val = FALSE;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is a utility function that exists to       */
+   /* determine the number of messages that are queued in the specified */
+   /* SPSC Mailbox.  This function returns the number of queued messages*/
+   /* (zero if the Mailbox Handle is invalid).                          */
+unsigned int BTPSAPI BTPS_QuerySPSCMailbox(SPSCMailbox_t Mailbox)
+{
+   unsigned int ret_val;
+   unsigned int HeadSlot;
+   unsigned int TailSlot;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      /* Take a snapshot of both indexes (each is read only once).      */
+      HeadSlot = ((SPSCMailboxHeader_t *)Mailbox)->HeadSlot;
+      TailSlot = ((SPSCMailboxHeader_t *)Mailbox)->TailSlot;
+
+      if(HeadSlot >= TailSlot)
+         ret_val = HeadSlot - TailSlot;
+      else
+         ret_val = (((SPSCMailboxHeader_t *)Mailbox)->NumberSlots - TailSlot) + HeadSlot;
+   }
+   else
+      ret_val = 0;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is responsible for destroying an SPSC      */
+   /* Mailbox that was created successfully via a successful call to the*/
+   /* BTPS_CreateSPSCMailbox() function.  This function accepts as input*/
+   /* the SPSC Mailbox Handle of the Mailbox to destroy and an          */
+   /* (optional) callback function that is called for each queued       */
+   /* message.  Once this function is completed the Mailbox Handle is NO*/
+   /* longer valid and CANNOT be used.                                  */
+void BTPSAPI BTPS_DeleteSPSCMailbox(SPSCMailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback)
+{
+   void *Slot;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if(Mailbox)
+   {
+      /* Check to see if a Mailbox Delete Item Callback was specified.  */
+      if(MailboxDeleteCallback)
+      {
+         /* Now loop though all of the queued messages and call the     */
+         /* callback with the slot data.                                */
+         while((Slot = BTPS_PeekSPSCMailbox(Mailbox)) != NULL)
+         {
+            __BTPSTRY
+            {
+               (*MailboxDeleteCallback)(Slot);
+            }
+            __BTPSEXCEPT(1)
+            {
+               /* Do Nothing.                                           */
+            }
 
-   va_start(args, Format);
-   ret_val = vsprintf(Buffer, Format, args);
-   va_end(args);
+            BTPS_ReleaseSPSCMailbox(Mailbox);
+         }
+      }
 
-   return(ret_val);
+      /* Finally free all memory that was allocated for the Mailbox.    */
+      BTPS_FreeMemory(Mailbox);
+   }
 }
 
    /* The following function is provided to allow a mechanism to create */
-   /* a Mailbox.  A Mailbox is a Data Store that contains slots (all of */
-   /* the same size) that can have data placed into (and retrieved      */
-   /* from).  Once Data is placed into a Mailbox (via the               */
-   /* BTPS_AddMailbox() function, it can be retrieved by using the      */
-   /* BTPS_WaitMailbox() function.  Data placed into the Mailbox is     */
-   /* retrieved in a FIFO method.  This function accepts as input the   */
-   /* Maximum Number of Slots that will be present in the Mailbox and   */
-   /* the Size of each of the Slots.  This function returns a NON-NULL  */
-   /* Mailbox Handle if the Mailbox is successfully created, or a NULL  */
-   /* Mailbox Handle if the Mailbox was unable to be created.           */
-Mailbox_t BTPSAPI BTPS_CreateMailbox(unsigned int NumberSlots, unsigned int SlotSize)
+   /* a Byte Mailbox.  A Byte Mailbox stores variable length messages   */
+   /* (each prefixed with its length) back to back in a ring buffer.    */
+   /* This function accepts as input the size (in bytes) of the ring    */
+   /* buffer.  This function returns a NON-NULL Byte Mailbox Handle if  */
+   /* the Mailbox is successfully created, or a NULL Mailbox Handle if  */
+   /* the Mailbox was unable to be created.                             */
+ByteMailbox_t BTPSAPI BTPS_CreateByteMailbox(unsigned int BufferSize)
 {
-   Mailbox_t        ret_val;
-   MailboxHeader_t *MailboxHeader;
+   ByteMailbox_t        ret_val;
+   ByteMailboxHeader_t *MailboxHeader;
+
+   /* Round the buffer size so that every message (and the length word  */
+   /* that precedes it) is aligned.                                     */
+   BufferSize = BTPS_POOL_BLOCK_SIZE(BufferSize);
 
    /* Before proceeding any further we need to make sure that the       */
-   /* parameters that were passed to us appear semi-valid.              */
-   if((NumberSlots) && (SlotSize))
+   /* buffer is large enough to hold at least one message.              */
+   if(BufferSize >= BTPS_BYTE_MAILBOX_MESSAGE_SIZE(1))
    {
       /* Parameters appear semi-valid, so now let's allocate enough     */
-      /* Memory to hold the Mailbox Header AND enough space to hold all */
-      /* requested Mailbox Slots.                                       */
-      if((MailboxHeader = (MailboxHeader_t *)BTPS_AllocateMemory(sizeof(MailboxHeader_t)+(NumberSlots*SlotSize))) != NULL)
+      /* Memory to hold the Mailbox Header AND the buffer.              */
+      if((MailboxHeader = (ByteMailboxHeader_t *)BTPS_AllocateMemory(BTPS_POOL_BLOCK_SIZE(sizeof(ByteMailboxHeader_t)) + BufferSize)) != NULL)
       {
          /* Memory allocated, now let's initialize the state of the     */
          /* Mailbox such that it contains NO Data.                      */
-         MailboxHeader->NumberSlots   = NumberSlots;
-         MailboxHeader->SlotSize      = SlotSize;
-         MailboxHeader->HeadSlot      = 0;
-         MailboxHeader->TailSlot      = 0;
-         MailboxHeader->OccupiedSlots = 0;
-         MailboxHeader->Slots         = ((unsigned char *)MailboxHeader) + sizeof(MailboxHeader_t);
+         MailboxHeader->HeadOffset     = 0;
+         MailboxHeader->TailOffset     = 0;
+         MailboxHeader->UsedBytes      = 0;
+         MailboxHeader->BufferSize     = BufferSize;
+         MailboxHeader->NumberMessages = 0;
+         MailboxHeader->Buffer         = ((unsigned char *)MailboxHeader) + BTPS_POOL_BLOCK_SIZE(sizeof(ByteMailboxHeader_t));
 
          /* All finished, return success to the caller (the Mailbox     */
          /* Header).                                                    */
-         ret_val                      = (Mailbox_t)MailboxHeader;
+         ret_val                       = (ByteMailbox_t)MailboxHeader;
       }
       else
          ret_val = NULL;
@@ -913,50 +6845,85 @@ Mailbox_t BTPSAPI BTPS_CreateMailbox(unsigned int NumberSlots, unsigned int Slot
    return(ret_val);
 }
 
-   /* The following function is provided to allow a means to Add data to*/
-   /* the Mailbox (where it can be retrieved via the BTPS_WaitMailbox() */
-   /* function.  This function accepts as input the Mailbox Handle of   */
-   /* the Mailbox to place the data into and a pointer to a buffer that */
-   /* contains the data to be added.  This pointer *MUST* point to a    */
-   /* data buffer that is AT LEAST the Size of the Slots in the Mailbox */
-   /* (specified when the Mailbox was created) and this pointer CANNOT  */
-   /* be NULL.  The data that the MailboxData pointer points to is      */
-   /* placed into the Mailbox where it can be retrieved via the         */
-   /* BTPS_WaitMailbox() function.                                      */
-   /* * NOTE * This function copies from the MailboxData Pointer the    */
-   /*          first SlotSize Bytes.  The SlotSize was specified when   */
-   /*          the Mailbox was created via a successful call to the     */
-   /*          BTPS_CreateMailbox() function.                           */
-Boolean_t BTPSAPI BTPS_AddMailbox(Mailbox_t Mailbox, void *MailboxData)
+   /* The following function is provided to allow a means to Add a      */
+   /* message to a Byte Mailbox.  This function accepts as input the    */
+   /* Byte Mailbox Handle, the length of the message (which CANNOT be   */
+   /* zero) and a pointer to the message data.  This function returns   */
+   /* TRUE if the message was added to the Mailbox or FALSE if there is */
+   /* not enough (contiguous) room in the Mailbox or there was an error.*/
+Boolean_t BTPSAPI BTPS_AddByteMailbox(ByteMailbox_t Mailbox, unsigned int DataLength, void *MailboxData)
 {
-   Boolean_t ret_val;
+   Boolean_t            ret_val;
+   unsigned int         MessageSize;
+   unsigned int         EndBytes;
+   ByteMailboxHeader_t *MailboxHeader;
 
    /* Before proceeding any further make sure that the Mailbox Handle   */
    /* and the MailboxData pointer that was specified appears semi-valid.*/
-   if((Mailbox) && (MailboxData))
+   if((Mailbox) && (DataLength) && (DataLength != BYTE_MAILBOX_PADDING) && (MailboxData))
    {
-      /* Before adding the data to the Mailbox, make sure that the      */
-      /* Mailbox is not already full.                                   */
-      if(((MailboxHeader_t *)Mailbox)->OccupiedSlots < ((MailboxHeader_t *)Mailbox)->NumberSlots)
+      MailboxHeader = (ByteMailboxHeader_t *)Mailbox;
+      MessageSize   = BTPS_BYTE_MAILBOX_MESSAGE_SIZE(DataLength);
+
+      /* If the Mailbox is empty, start over at the beginning of the    */
+      /* buffer so that the largest possible message will fit.          */
+      if(!MailboxHeader->UsedBytes)
       {
-         /* Mailbox is NOT full, so add the specified User Data to the  */
-         /* next available free Mailbox Slot.                           */
-         BTPS_MemCopy(&(((unsigned char *)(((MailboxHeader_t *)Mailbox)->Slots))[((MailboxHeader_t *)Mailbox)->HeadSlot*((MailboxHeader_t *)Mailbox)->SlotSize]), MailboxData, ((MailboxHeader_t *)Mailbox)->SlotSize);
+         MailboxHeader->HeadOffset = 0;
+         MailboxHeader->TailOffset = 0;
+      }
 
-         /* Update the Next available Free Mailbox Slot (taking into    */
-         /* account wrapping the pointer).                              */
-         if(++(((MailboxHeader_t *)Mailbox)->HeadSlot) == ((MailboxHeader_t *)Mailbox)->NumberSlots)
-            ((MailboxHeader_t *)Mailbox)->HeadSlot = 0;
+      ret_val = FALSE;
 
-         /* Update the Number of occupied slots to signify that there   */
-         /* was additional Mailbox Data added to the Mailbox.           */
-         ((MailboxHeader_t *)Mailbox)->OccupiedSlots++;
+      if((MailboxHeader->HeadOffset > MailboxHeader->TailOffset) || (!MailboxHeader->UsedBytes))
+      {
+         /* The free space is after the HeadOffset (up to the end of the*/
+         /* buffer) and before the TailOffset.  The message is stored   */
+         /* after the HeadOffset if it fits, otherwise the end of the   */
+         /* buffer is marked as padding and the message is stored at the*/
+         /* start of the buffer.                                        */
+         EndBytes = MailboxHeader->BufferSize - MailboxHeader->HeadOffset;
+
+         if(MessageSize <= EndBytes)
+            ret_val = TRUE;
+         else
+         {
+            if(MessageSize <= MailboxHeader->TailOffset)
+            {
+               BYTE_MAILBOX_LENGTH(MailboxHeader, MailboxHeader->HeadOffset) = BYTE_MAILBOX_PADDING;
 
-         /* Finally, return success to the caller.                      */
-         ret_val = TRUE;
+               MailboxHeader->UsedBytes  += EndBytes;
+               MailboxHeader->HeadOffset  = 0;
+
+               ret_val                    = TRUE;
+            }
+         }
       }
       else
-         ret_val = FALSE;
+      {
+         /* The free space is between the HeadOffset and the TailOffset */
+         /* (if the offsets are the same the Mailbox is full).          */
+         if(MessageSize <= (MailboxHeader->TailOffset - MailboxHeader->HeadOffset))
+            ret_val = TRUE;
+      }
+
+      if(ret_val)
+      {
+         /* There is room for the message, so store the length followed */
+         /* by the message data.                                        */
+         BYTE_MAILBOX_LENGTH(MailboxHeader, MailboxHeader->HeadOffset) = DataLength;
+
+         BTPS_MemCopy(&(MailboxHeader->Buffer[MailboxHeader->HeadOffset + BTPS_BYTE_MAILBOX_OVERHEAD]), MailboxData, DataLength);
+
+         /* Update the offset of the next message (taking into account  */
+         /* wrapping the offset) and the number of bytes in use.        */
+         if((MailboxHeader->HeadOffset += MessageSize) == MailboxHeader->BufferSize)
+            MailboxHeader->HeadOffset = 0;
+
+         MailboxHeader->UsedBytes += MessageSize;
+
+         MailboxHeader->NumberMessages++;
+      }
    }
    else
       ret_val = FALSE;
@@ -966,53 +6933,96 @@ Boolean_t BTPSAPI BTPS_AddMailbox(Mailbox_t Mailbox, void *MailboxData)
 }
 
    /* The following function is provided to allow a means to retrieve   */
-   /* data from the specified Mailbox.  This function will block until  */
-   /* either Data is placed in the Mailbox or an error with the Mailbox */
-   /* was detected.  This function accepts as its first parameter a     */
-   /* Mailbox Handle that represents the Mailbox to wait for the data   */
-   /* with.  This function accepts as its second parameter, a pointer to*/
-   /* a data buffer that is AT LEAST the size of a single Slot of the   */
-   /* Mailbox (specified when the BTPS_CreateMailbox() function was     */
-   /* called).  The MailboxData parameter CANNOT be NULL.  This function*/
-   /* will return TRUE if data was successfully retrieved from the      */
-   /* Mailbox or FALSE if there was an error retrieving data from the   */
-   /* Mailbox.  If this function returns TRUE then the first SlotSize   */
-   /* bytes of the MailboxData pointer will contain the data that was   */
-   /* retrieved from the Mailbox.                                       */
-   /* * NOTE * This function copies to the MailboxData Pointer the data */
-   /*          that is present in the Mailbox Slot (of size SlotSize).  */
-   /*          The SlotSize was specified when the Mailbox was created  */
-   /*          via a successful call to the BTPS_CreateMailbox()        */
-   /*          function.                                                */
-Boolean_t BTPSAPI BTPS_WaitMailbox(Mailbox_t Mailbox, void *MailboxData)
+   /* the oldest message from a Byte Mailbox.  This function accepts as */
+   /* input the Byte Mailbox Handle and the length and pointer of the   */
+   /* buffer to copy the message into.  This function returns the length*/
+   /* of the message that was copied into the buffer and removed from   */
+   /* the Mailbox, or zero if the Mailbox is empty, the buffer is too   */
+   /* small for the message (in which case the message is left in the   */
+   /* Mailbox) or there was an error.                                   */
+unsigned int BTPSAPI BTPS_WaitByteMailbox(ByteMailbox_t Mailbox, unsigned int BufferLength, void *MailboxData)
 {
-   Boolean_t ret_val;
+   void         *Message;
+   unsigned int  ret_val;
 
    /* Before proceeding any further make sure that the Mailbox Handle   */
    /* and the MailboxData pointer that was specified appears semi-valid.*/
    if((Mailbox) && (MailboxData))
    {
-      /* Let's check to see if there exists at least one slot with      */
-      /* Mailbox Data present in it.                                    */
-      if(((MailboxHeader_t *)Mailbox)->OccupiedSlots)
+      /* Locate the oldest message and make sure that it will fit in the*/
+      /* buffer that was specified.                                     */
+      if(((Message = BTPS_PeekByteMailbox(Mailbox, &ret_val)) != NULL) && (ret_val <= BufferLength))
       {
-         /* Flag success to the caller.                                 */
-         ret_val = TRUE;
-
-         /* Now copy the Data into the Memory Buffer specified by the   */
-         /* caller.                                                     */
-         BTPS_MemCopy(MailboxData, &((((unsigned char *)((MailboxHeader_t *)Mailbox)->Slots))[((MailboxHeader_t *)Mailbox)->TailSlot*((MailboxHeader_t *)Mailbox)->SlotSize]), ((MailboxHeader_t *)Mailbox)->SlotSize);
-
-         /* Now that we've copied the data into the Memory Buffer       */
-         /* specified by the caller we need to mark the Mailbox Slot as */
-         /* free.                                                       */
-         if(++(((MailboxHeader_t *)Mailbox)->TailSlot) == ((MailboxHeader_t *)Mailbox)->NumberSlots)
-            ((MailboxHeader_t *)Mailbox)->TailSlot = 0;
+         BTPS_MemCopy(MailboxData, Message, ret_val);
 
-         ((MailboxHeader_t *)Mailbox)->OccupiedSlots--;
+         BTPS_ReleaseByteMailbox(Mailbox);
       }
       else
-         ret_val = FALSE;
+         ret_val = 0;
+   }
+   else
+      ret_val = 0;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to access the */
+   /* oldest message in a Byte Mailbox in place.  This function accepts */
+   /* as input the Byte Mailbox Handle and an (optional) pointer to     */
+   /* return the length of the message.  This function returns a pointer*/
+   /* to the (contiguous) message, or NULL if the Mailbox is empty.     */
+void *BTPSAPI BTPS_PeekByteMailbox(ByteMailbox_t Mailbox, unsigned int *DataLength)
+{
+   void         *ret_val;
+   unsigned int  Length;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if((Mailbox) && (((ByteMailboxHeader_t *)Mailbox)->NumberMessages))
+   {
+      Length  = LocateByteMailboxMessage((ByteMailboxHeader_t *)Mailbox);
+
+      ret_val = &(((ByteMailboxHeader_t *)Mailbox)->Buffer[((ByteMailboxHeader_t *)Mailbox)->TailOffset + BTPS_BYTE_MAILBOX_OVERHEAD]);
+
+      if(DataLength)
+         *DataLength = Length;
+   }
+   else
+      ret_val = NULL;
+
+   /* Return the result to the caller.                                  */
+   return(ret_val);
+}
+
+   /* The following function is provided to allow a means to remove the */
+   /* oldest message from a Byte Mailbox (without copying it).  This    */
+   /* function accepts as input the Byte Mailbox Handle.  This function */
+   /* returns TRUE if a message was removed or FALSE if the Mailbox is  */
+   /* empty or there was an error.                                      */
+Boolean_t BTPSAPI BTPS_ReleaseByteMailbox(ByteMailbox_t Mailbox)
+{
+   Boolean_t            ret_val;
+   unsigned int         MessageSize;
+   ByteMailboxHeader_t *MailboxHeader;
+
+   /* Before proceeding any further make sure that the Mailbox Handle   */
+   /* that was specified appears semi-valid.                            */
+   if((Mailbox) && (((ByteMailboxHeader_t *)Mailbox)->NumberMessages))
+   {
+      MailboxHeader = (ByteMailboxHeader_t *)Mailbox;
+      MessageSize   = BTPS_BYTE_MAILBOX_MESSAGE_SIZE(LocateByteMailboxMessage(MailboxHeader));
+
+      /* Mark the bytes of the message as free (taking into account     */
+      /* wrapping the offset).                                          */
+      if((MailboxHeader->TailOffset += MessageSize) == MailboxHeader->BufferSize)
+         MailboxHeader->TailOffset = 0;
+
+      MailboxHeader->UsedBytes -= MessageSize;
+
+      MailboxHeader->NumberMessages--;
+
+      ret_val = TRUE;
    }
    else
       ret_val = FALSE;
@@ -1022,28 +7032,18 @@ Boolean_t BTPSAPI BTPS_WaitMailbox(Mailbox_t Mailbox, void *MailboxData)
 }
 
    /* The following function is a utility function that exists to       */
-   /* determine if there is anything queued in the specified Mailbox.   */
-   /* This function returns TRUE if there is something queued in the    */
-   /* Mailbox, or FALSE if there is nothing queued in the specified     */
-   /* Mailbox.                                                          */
-Boolean_t BTPSAPI BTPS_QueryMailbox(Mailbox_t Mailbox)
+   /* determine if there is anything queued in the specified Byte       */
+   /* Mailbox.  This function returns TRUE if there is something queued */
+   /* in the Mailbox, or FALSE if there is nothing queued in the        */
+   /* specified Mailbox.                                                */
+Boolean_t BTPSAPI BTPS_QueryByteMailbox(ByteMailbox_t Mailbox)
 {
    Boolean_t ret_val;
 
    /* Before proceeding any further make sure that the Mailbox Handle   */
-   /* and the MailboxData pointer that was specified appears semi-valid.*/
-   if(Mailbox)
-   {
-      /* Let's check to see if there exists at least one slot with      */
-      /* Mailbox Data present in it.                                    */
-      if(((MailboxHeader_t *)Mailbox)->OccupiedSlots)
-      {
-         /* Flag success to the caller.                                 */
-         ret_val = TRUE;
-      }
-      else
-         ret_val = FALSE;
-   }
+   /* that was specified appears semi-valid.                            */
+   if((Mailbox) && (((ByteMailboxHeader_t *)Mailbox)->NumberMessages))
+      ret_val = TRUE;
    else
       ret_val = FALSE;
 
@@ -1051,19 +7051,17 @@ Boolean_t BTPSAPI BTPS_QueryMailbox(Mailbox_t Mailbox)
    return(ret_val);
 }
 
-   /* The following function is responsible for destroying a Mailbox    */
-   /* that was created successfully via a successful call to the        */
-   /* BTPS_CreateMailbox() function.  This function accepts as input the*/
-   /* Mailbox Handle of the Mailbox to destroy.  Once this function is  */
-   /* completed the Mailbox Handle is NO longer valid and CANNOT be     */
-   /* used.  Calling this function will cause all outstanding           */
-   /* BTPS_WaitMailbox() functions to fail with an error.  The final    */
-   /* parameter specifies an (optional) callback function that is called*/
-   /* for each queued Mailbox entry.  This allows a mechanism to free   */
-   /* any resources that might be associated with each individual       */
-   /* Mailbox item.                                                     */
-void BTPSAPI BTPS_DeleteMailbox(Mailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback)
+   /* The following function is responsible for destroying a Byte       */
+   /* Mailbox that was created successfully via a successful call to the*/
+   /* BTPS_CreateByteMailbox() function.  This function accepts as input*/
+   /* the Byte Mailbox Handle of the Mailbox to destroy and an          */
+   /* (optional) callback function that is called for each queued       */
+   /* message.  Once this function is completed the Mailbox Handle is NO*/
+   /* longer valid and CANNOT be used.                                  */
+void BTPSAPI BTPS_DeleteByteMailbox(ByteMailbox_t Mailbox, BTPS_MailboxDeleteCallback_t MailboxDeleteCallback)
 {
+   void *Message;
+
    /* Before proceeding any further make sure that the Mailbox Handle   */
    /* that was specified appears semi-valid.                            */
    if(Mailbox)
@@ -1071,26 +7069,20 @@ void BTPSAPI BTPS_DeleteMailbox(Mailbox_t Mailbox, BTPS_MailboxDeleteCallback_t
       /* Check to see if a Mailbox Delete Item Callback was specified.  */
       if(MailboxDeleteCallback)
       {
-         /* Now loop though all of the occupied slots and call the      */
-         /* callback with the slot data.                                */
-         while(((MailboxHeader_t *)Mailbox)->OccupiedSlots)
+         /* Now loop though all of the queued messages and call the     */
+         /* callback with the message data.                             */
+         while((Message = BTPS_PeekByteMailbox(Mailbox, NULL)) != NULL)
          {
             __BTPSTRY
             {
-               (*MailboxDeleteCallback)(&((((unsigned char *)((MailboxHeader_t *)Mailbox)->Slots))[((MailboxHeader_t *)Mailbox)->TailSlot*((MailboxHeader_t *)Mailbox)->SlotSize]));
+               (*MailboxDeleteCallback)(Message);
             }
             __BTPSEXCEPT(1)
             {
                /* Do Nothing.                                           */
             }
 
-            /* Now that we've called back with the data, we need to     */
-            /* advance to the next slot.                                */
-            if(++(((MailboxHeader_t *)Mailbox)->TailSlot) == ((MailboxHeader_t *)Mailbox)->NumberSlots)
-               ((MailboxHeader_t *)Mailbox)->TailSlot = 0;
-
-            /* Flag that there is one less occupied slot.               */
-            ((MailboxHeader_t *)Mailbox)->OccupiedSlots--;
+            BTPS_ReleaseByteMailbox(Mailbox);
          }
       }
 
@@ -1126,10 +7118,44 @@ void BTPSAPI BTPS_Init(void *UserParam)
    /* Initialize the Heap.                                              */
    HeapInit(MemoryBuffer, sizeof(MemoryBuffer));
 
+   /* The default heap always occupies the first entry of the heap list.*/
+   HeapList[BTPS_DEFAULT_HEAP_ID] = (HeapInfo_t *)MemoryBuffer;
+
+   if(!NumberHeaps)
+      NumberHeaps = 1;
+
    /* Initialize the static variables for this module.                  */
    DebugZoneMask              = DEBUG_ZONES;
    NumberScheduledFunctions   = 0;
-   PreviousTickCount          = 0;
+
+   /* The Scheduler Entry table and the deadline queue are allocated    */
+   /* from the heap that was just initialized.                          */
+   SchedulerInformation       = NULL;
+   BTPS_MemInitialize(SchedulerQueue, 0, sizeof(SchedulerQueue));
+   NumberSchedulerEntries     = 0;
+   FreeSchedulerEntry         = SCHEDULER_ENTRY_INVALID;
+
+   /* No Event Handlers are registered.                                 */
+   BTPS_MemInitialize(EventInformation, 0, sizeof(EventInformation));
+
+   EventPending               = FALSE;
+
+   /* No Coroutines are ready.                                          */
+   CoroutineReadyHead         = NULL;
+   CoroutineReadyTail         = NULL;
+   NumberReadyCoroutines      = 0;
+
+   /* Use the default cycle counter of the platform unless a counter has*/
+   /* already been registered (this also resets the scheduler profile). */
+   if(GetCycleCountCallback)
+      BTPS_ResetSchedulerStatistics();
+   else
+      BTPS_RegisterCycleCounter(NULL, 0);
+
+   /* Use the default Timestamp of the platform unless a Timestamp has  */
+   /* already been registered.                                          */
+   if(!GetTimestampCallback)
+      BTPS_RegisterTimestampCallback(NULL);
 
    /* Finally flag that the Scheduler has been initialized successfully.*/
    SchedulerInitialized       = TRUE;
@@ -1147,20 +7173,90 @@ void BTPSAPI BTPS_DeInit(void)
 void BTPSAPI BTPS_OutputMessage(BTPSCONST char *DebugString, ...)
 {
    va_list args;
-   int     Length;
-   char    MsgBuffer[256];
 
    if(MessageOutputCallback)
    {
       /* Write out the Data.                                            */
       va_start(args, DebugString);
 
-      Length = vsnprintf(MsgBuffer, (sizeof(MsgBuffer) - 1), DebugString, args);
+      OutputMessageArguments(DebugString, args);
+
+      va_end(args);
+   }
+}
+
+   /* The following function is responsible for logging the specified   */
+   /* NULL terminated Debugging String.  When the kernel is built with  */
+   /* DEFERRED_LOG_ENABLED defined the message is not formatted, instead*/
+   /* the format string, the timestamp and the arguments are recorded in*/
+   /* the deferred log and written to the Debug output when the         */
+   /* scheduler is idle.  Otherwise the message is written immediately  */
+   /* (exactly as BTPS_OutputMessage() does).                           */
+void BTPSAPI BTPS_LogMessage(BTPSCONST char *DebugString, ...)
+{
+   va_list       args;
+#ifdef DEFERRED_LOG_ENABLED
+   unsigned int  Index;
+   unsigned int  NumberArguments;
+   LogRecord_t  *LogRecord;
+
+   if(DebugString)
+   {
+      /* If the ring is full overwrite the oldest record.               */
+      if(NumberLogRecords == DEFERRED_LOG_BUFFER_RECORDS)
+      {
+         if(++LogRecordOut == DEFERRED_LOG_BUFFER_RECORDS)
+            LogRecordOut = 0;
+
+         NumberLostLogRecords++;
+      }
+      else
+         NumberLogRecords++;
+
+      LogRecord = &(LogRecordList[LogRecordIn]);
+
+      if(++LogRecordIn == DEFERRED_LOG_BUFFER_RECORDS)
+         LogRecordIn = 0;
+
+      LogRecord->Format    = DebugString;
+      LogRecord->TimeStamp = (unsigned long)BTPS_GetTimestamp();
+
+      /* Record the raw arguments, only the arguments that the format   */
+      /* string consumes are read.                                      */
+      NumberArguments      = CountLogArguments(DebugString);
+
+      va_start(args, DebugString);
+
+      for(Index = 0; Index < DEFERRED_LOG_MAXIMUM_ARGUMENTS; Index++)
+         LogRecord->Argument[Index] = (Index < NumberArguments)?va_arg(args, unsigned long):0;
 
       va_end(args);
+   }
+
+#else
 
-      MessageOutputCallback((unsigned int)Length, MsgBuffer);
+   if(MessageOutputCallback)
+   {
+      va_start(args, DebugString);
+
+      OutputMessageArguments(DebugString, args);
+
+      va_end(args);
    }
+
+#endif
+}
+
+   /* The following function is responsible for writing all records     */
+   /* that are currently held in the deferred log to the Debug output   */
+   /* (when the kernel is built with DEFERRED_LOG_ENABLED defined).     */
+void BTPSAPI BTPS_FlushLog(void)
+{
+#ifdef DEFERRED_LOG_ENABLED
+
+   FlushLog(DEFERRED_LOG_BUFFER_RECORDS);
+
+#endif
 }
 
    /* The following function is used to set the Debug Mask that controls*/
@@ -1186,42 +7282,61 @@ int BTPSAPI BTPS_TestDebugZone(unsigned long Zone)
    /* pointer to the binary data to be displayed.                       */
 int BTPSAPI BTPS_DumpData(unsigned int DataLength, BTPSCONST unsigned char *DataPtr)
 {
-   int          ret_val;
-   unsigned int Index;
-   unsigned int Offset;
+   int                   ret_val;
+   char                  Line[(DUMP_DATA_BYTES_PER_LINE * 3) + 16];
+   unsigned int          Index;
+   unsigned int          Offset;
+   unsigned int          Length;
+   static BTPSCONST char HexDigits[] = "0123456789ABCDEF";
 
    /* Before proceeding any further, lets make sure that the parameters */
    /* passed to us appear semi-valid.                                   */
    if((DataLength > 0) && (DataPtr != NULL))
    {
-      /* Print out the header.                                          */
-      BTPS_OutputMessage("\r\n");
-      BTPS_OutputMessage("  -OFFSET- | 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F\r\n");
-      BTPS_OutputMessage(" ----------+-------------------------------------------------\r\n");
-
-      Offset = 0;
-
-      /* Output the Debug Data, 16 bytes per line.                      */
-      while(DataLength)
+      if(MessageOutputCallback)
       {
-         /* Print the line header.                                      */
-         BTPS_OutputMessage("  %08X |", Offset);
-         Offset += 16;
+         /* Print out the header.                                       */
+         BTPS_OutputMessage("\r\n  -OFFSET- | 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F\r\n ----------+-------------------------------------------------\r\n");
 
-         /* Print the row of data.                                      */
-         for(Index = 0; (Index < 16) && (DataLength); Index ++)
+         Offset = 0;
+
+         /* Output the Debug Data, 16 bytes per line.  Each line is     */
+         /* formatted directly into the line buffer and written with a  */
+         /* single call.                                                */
+         while(DataLength)
          {
-            BTPS_OutputMessage(" %02X", *DataPtr);
+            /* Format the line header.                                  */
+            Line[0] = ' ';
+            Line[1] = ' ';
+            for(Index = 0; Index < 8; Index++)
+               Line[2 + Index] = HexDigits[(Offset >> (28 - (Index * 4))) & 0x0F];
+
+            Line[10] = ' ';
+            Line[11] = '|';
+            Length   = 12;
+            Offset  += DUMP_DATA_BYTES_PER_LINE;
+
+            /* Format the row of data.                                  */
+            for(Index = 0; (Index < DUMP_DATA_BYTES_PER_LINE) && (DataLength); Index ++)
+            {
+               Line[Length++] = ' ';
+               Line[Length++] = HexDigits[(*DataPtr) >> 4];
+               Line[Length++] = HexDigits[(*DataPtr) & 0x0F];
 
-            DataLength --;
-            DataPtr    ++;
+               DataLength --;
+               DataPtr    ++;
+            }
+
+            Line[Length++] = '\r';
+            Line[Length++] = '\n';
+            Line[Length]   = '\0';
+
+            MessageOutputCallback(Length, Line);
          }
 
          BTPS_OutputMessage("\r\n");
       }
 
-      BTPS_OutputMessage("\r\n");
-
       /* Finally, set the return value to indicate success.             */
       ret_val = 0;
    }
@@ -0,0 +1,408 @@
+/*****< fmtbench.c >***********************************************************/
+/*      Copyright 2015 Texas Instruments Incorporated.                        */
+/*      All Rights Reserved.                                                  */
+/*                                                                            */
+/*  FMTBENCH - Host tool that benchmarks the BTPS Kernel message formatter.   */
+/*                                                                            */
+/*  The BTPS Kernel formats Debug messages (BTPS_OutputMessage()), strings    */
+/*  (BTPS_SprintF()) and data dumps (BTPS_DumpData()) with its own formatter. */
+/*  This tool compares the time taken by each of these functions against the */
+/*  previous implementations (which used the C Run-Time vsnprintf() and       */
+/*  vsprintf() functions and wrote a data dump one byte at a time) for a set  */
+/*  of typical messages, and reports the code size of both formatters.        */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -static -I../include -I../btpskrnl FmtBench.c                  */
+/*         ../btpskrnl/BTPSKRNL.c -o fmtbench                                 */
+/*                                                                            */
+/*  Usage:                                                                    */
+/*                                                                            */
+/*     fmtbench [-n Iterations] [-m NmCommand]                                */
+/*                                                                            */
+/*        -n  Number of calls of each function that are timed (default        */
+/*            100000).                                                        */
+/*        -m  Command used to read the symbol sizes of this tool (default     */
+/*            nm).                                                            */
+/*                                                                            */
+/*  * NOTE * The code size of the C Run-Time formatter can only be reported   */
+/*           when the tool is linked statically.  The sizes are those of the  */
+/*           host build, build the kernel for the target and compare the      */
+/*           FormatString symbol against _vfprintf_r of the target C Run-Time */
+/*           library for the sizes on the target.                             */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SS1BTPS.h"          /* Bluetopia Core Prototypes/Constants.         */
+
+   /* The following MACRO is used to flag a parameter that is not used  */
+   /* so that the compiler does not warn about it.                      */
+#define UNREFERENCED_PARAMETER(_x)     ((void)(_x))
+
+   /* The following constant represents the default number of calls of  */
+   /* each function that are timed.                                     */
+#define DEFAULT_ITERATIONS                             (100000)
+
+   /* The following constant represents the number of bytes in the data */
+   /* that is dumped (the size of a typical HCI ACL packet).            */
+#define DUMP_DATA_LENGTH                               (64)
+
+   /* The following type declaration represents a single benchmark.     */
+   /* Each benchmark calls the same function with the same arguments    */
+   /* via the previous implementation (Old) and the BTPS Kernel (New).  */
+typedef struct _tagBenchmark_t
+{
+   const char  *Name;
+   void       (*Old)(void);
+   void       (*New)(void);
+} Benchmark_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+   /* Variable which holds the number of times that the message output  */
+   /* callback was called.                                              */
+static unsigned long  NumberOutputCalls;
+
+   /* Variable which holds the buffer that strings are formatted into.  */
+static char           StringBuffer[256];
+
+   /* Variable which holds the data that is dumped.                     */
+static unsigned char  DumpData[DUMP_DATA_LENGTH];
+
+   /* Internal Function Prototypes.                                     */
+static unsigned long BTPSAPI GetTickCountCallback(void);
+static void BTPSAPI MessageOutputCallback(unsigned int Length, char *Message);
+
+static int OldSprintF(char *Buffer, const char *Format, ...);
+static void OldOutputMessage(const char *DebugString, ...);
+static int OldDumpData(unsigned int DataLength, const unsigned char *DataPtr);
+
+static void OldAddress(void);
+static void NewAddress(void);
+static void OldStatus(void);
+static void NewStatus(void);
+static void OldCounters(void);
+static void NewCounters(void);
+static void OldDump(void);
+static void NewDump(void);
+
+static unsigned long long GetTime(void);
+static void RunBenchmark(const Benchmark_t *Benchmark, unsigned long Iterations);
+static void DisplayCodeSize(const char *NmCommand);
+static void DisplayUsage(const char *ProgramName);
+
+   /* The list of benchmarks that are run.                              */
+static const Benchmark_t BenchmarkList[] =
+{
+   { "SprintF BD_ADDR",      OldAddress,  NewAddress  },
+   { "OutputMessage status", OldStatus,   NewStatus   },
+   { "OutputMessage stats",  OldCounters, NewCounters },
+   { "DumpData 64 bytes",    OldDump,     NewDump     }
+};
+
+#define NUMBER_BENCHMARKS                              (sizeof(BenchmarkList) / sizeof(Benchmark_t))
+
+   /* The following function is the tick count callback of the BTPS     */
+   /* Kernel (the tick count is not used).                              */
+static unsigned long BTPSAPI GetTickCountCallback(void)
+{
+   return(0);
+}
+
+   /* The following function is the message output callback of the BTPS*/
+   /* Kernel.  The calls are counted but the output is discarded so that*/
+   /* only the cost of formatting is measured.                          */
+static void BTPSAPI MessageOutputCallback(unsigned int Length, char *Message)
+{
+   UNREFERENCED_PARAMETER(Length);
+   UNREFERENCED_PARAMETER(Message);
+
+   NumberOutputCalls++;
+}
+
+   /* The following function is the previous implementation of          */
+   /* BTPS_SprintF().                                                   */
+static int OldSprintF(char *Buffer, const char *Format, ...)
+{
+   int     ret_val;
+   va_list args;
+
+   va_start(args, Format);
+   ret_val = vsprintf(Buffer, Format, args);
+   va_end(args);
+
+   return(ret_val);
+}
+
+   /* The following function is the previous implementation of          */
+   /* BTPS_OutputMessage().                                             */
+static void OldOutputMessage(const char *DebugString, ...)
+{
+   va_list args;
+   int     Length;
+   char    MsgBuffer[256];
+
+   va_start(args, DebugString);
+
+   Length = vsnprintf(MsgBuffer, (sizeof(MsgBuffer) - 1), DebugString, args);
+
+   va_end(args);
+
+   MessageOutputCallback((unsigned int)Length, MsgBuffer);
+}
+
+   /* The following function is the previous implementation of          */
+   /* BTPS_DumpData().                                                  */
+static int OldDumpData(unsigned int DataLength, const unsigned char *DataPtr)
+{
+   int          ret_val;
+   unsigned int Index;
+   unsigned int Offset;
+
+   if((DataLength > 0) && (DataPtr != NULL))
+   {
+      OldOutputMessage("\r\n");
+      OldOutputMessage("  -OFFSET- | 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F\r\n");
+      OldOutputMessage(" ----------+-------------------------------------------------\r\n");
+
+      Offset = 0;
+
+      while(DataLength)
+      {
+         OldOutputMessage("  %08X |", Offset);
+         Offset += 16;
+
+         for(Index = 0; (Index < 16) && (DataLength); Index ++)
+         {
+            OldOutputMessage(" %02X", *DataPtr);
+
+            DataLength --;
+            DataPtr    ++;
+         }
+
+         OldOutputMessage("\r\n");
+      }
+
+      OldOutputMessage("\r\n");
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following functions format a Bluetooth device address (as the */
+   /* sample applications do).                                          */
+static void OldAddress(void)
+{
+   OldSprintF(StringBuffer, "0x%02X%02X%02X%02X%02X%02X", 0x00, 0x1B, 0xDC, 0x0F, 0x42, 0xA7);
+}
+
+static void NewAddress(void)
+{
+   BTPS_SprintF(StringBuffer, "0x%02X%02X%02X%02X%02X%02X", 0x00, 0x1B, 0xDC, 0x0F, 0x42, 0xA7);
+}
+
+   /* The following functions output a typical status message.          */
+static void OldStatus(void)
+{
+   OldOutputMessage("Connection %u: %s (status %d, handle 0x%04X).\r\n", 3, "Established", -12, 0x0042);
+}
+
+static void NewStatus(void)
+{
+   BTPS_OutputMessage("Connection %u: %s (status %d, handle 0x%04X).\r\n", 3, "Established", -12, 0x0042);
+}
+
+   /* The following functions output a line of a statistics table.      */
+static void OldCounters(void)
+{
+   OldOutputMessage("  %-10s %9lu %9lu %08lX\r\n", "RFCOMM", 123456UL, 987UL, 0x20001F00UL);
+}
+
+static void NewCounters(void)
+{
+   BTPS_OutputMessage("  %-10s %9lu %9lu %08lX\r\n", "RFCOMM", 123456UL, 987UL, 0x20001F00UL);
+}
+
+   /* The following functions dump an HCI packet.                        */
+static void OldDump(void)
+{
+   OldDumpData(DUMP_DATA_LENGTH, DumpData);
+}
+
+static void NewDump(void)
+{
+   BTPS_DumpData(DUMP_DATA_LENGTH, DumpData);
+}
+
+   /* The following function is used to read the monotonic clock (in    */
+   /* nanoseconds).                                                     */
+static unsigned long long GetTime(void)
+{
+   struct timespec TimeSpec;
+
+   clock_gettime(CLOCK_MONOTONIC, &TimeSpec);
+
+   return(((unsigned long long)TimeSpec.tv_sec * 1000000000ULL) + (unsigned long long)TimeSpec.tv_nsec);
+}
+
+   /* The following function is used to time both implementations of a */
+   /* single benchmark and display the result.                          */
+static void RunBenchmark(const Benchmark_t *Benchmark, unsigned long Iterations)
+{
+   unsigned long      Index;
+   unsigned long      OldCalls;
+   unsigned long      NewCalls;
+   unsigned long long OldTime;
+   unsigned long long NewTime;
+
+   /* Time the previous implementation.                                 */
+   NumberOutputCalls = 0;
+   OldTime           = GetTime();
+
+   for(Index = 0; Index < Iterations; Index++)
+      (*Benchmark->Old)();
+
+   OldTime  = GetTime() - OldTime;
+   OldCalls = NumberOutputCalls;
+
+   /* Time the BTPS Kernel implementation.                              */
+   NumberOutputCalls = 0;
+   NewTime           = GetTime();
+
+   for(Index = 0; Index < Iterations; Index++)
+      (*Benchmark->New)();
+
+   NewTime  = GetTime() - NewTime;
+   NewCalls = NumberOutputCalls;
+
+   printf("  %-22s %10.1f %10.1f %7.2fx %6lu %6lu\n", Benchmark->Name, ((double)OldTime / Iterations), ((double)NewTime / Iterations), ((NewTime)?((double)OldTime / NewTime):0.0), (OldCalls / Iterations), (NewCalls / Iterations));
+}
+
+   /* The following function is used to display the code size of both  */
+   /* formatters, as reported by the specified nm command for this tool.*/
+static void DisplayCodeSize(const char *NmCommand)
+{
+   FILE          *Pipe;
+   char           Line[512];
+   char           Command[256];
+   char           Type;
+   char           Name[256];
+   unsigned long  Address;
+   unsigned long  Size;
+   unsigned long  NewSize;
+   unsigned long  OldSize;
+
+   NewSize = 0;
+   OldSize = 0;
+
+   /* Note that /proc/self/exe refers to the nm command when it is      */
+   /* opened by nm, so open it via the process ID of this tool.         */
+   snprintf(Command, sizeof(Command), "%s -S /proc/%ld/exe 2>/dev/null", NmCommand, (long)getpid());
+
+   if((Pipe = popen(Command, "r")) != NULL)
+   {
+      while(fgets(Line, sizeof(Line), Pipe))
+      {
+         if(sscanf(Line, "%lx %lx %c %255s", &Address, &Size, &Type, Name) != 4)
+            continue;
+
+         /* The BTPS Kernel formatter.                                  */
+         if((!strcmp(Name, "FormatString")) || (!strcmp(Name, "OutputMessageArguments")) || (!strcmp(Name, "BTPS_OutputMessage")) || (!strcmp(Name, "BTPS_SprintF")) || (!strcmp(Name, "BTPS_DumpData")))
+            NewSize += Size;
+
+         /* The C Run-Time formatter (only present when linked          */
+         /* statically).                                                */
+         if((strstr(Name, "vfprintf")) || (strstr(Name, "printf_positional")) || (strstr(Name, "printf_fp")) || (strstr(Name, "printf_buffer")) || (strstr(Name, "vsnprintf")) || (strstr(Name, "vsprintf")))
+            OldSize += Size;
+      }
+
+      pclose(Pipe);
+   }
+
+   printf("\nCode size (bytes, host build):\n");
+
+   if(NewSize)
+      printf("  BTPS Kernel formatter   %lu\n", NewSize);
+   else
+      printf("  BTPS Kernel formatter   n/a (unable to run %s)\n", NmCommand);
+
+   if(OldSize)
+      printf("  C Run-Time formatter    %lu\n", OldSize);
+   else
+      printf("  C Run-Time formatter    n/a (link with -static)\n");
+}
+
+   /* The following function is used to display the usage of this tool. */
+static void DisplayUsage(const char *ProgramName)
+{
+   printf("Usage: %s [-n Iterations] [-m NmCommand]\n", ProgramName);
+   printf("   -n  Number of calls of each function that are timed (default %u).\n", DEFAULT_ITERATIONS);
+   printf("   -m  Command used to read the symbol sizes (default nm).\n");
+}
+
+int main(int argc, char *argv[])
+{
+   int                    ret_val;
+   int                    ArgumentIndex;
+   const char            *NmCommand;
+   unsigned int           Index;
+   unsigned long          Iterations;
+   BTPS_Initialization_t  Initialization;
+
+   Iterations = DEFAULT_ITERATIONS;
+   NmCommand  = "nm";
+   ret_val    = 0;
+
+   for(ArgumentIndex = 1; (ArgumentIndex < argc) && (!ret_val); ArgumentIndex++)
+   {
+      if((!strcmp(argv[ArgumentIndex], "-n")) && ((ArgumentIndex + 1) < argc))
+         Iterations = strtoul(argv[++ArgumentIndex], NULL, 0);
+      else
+      {
+         if((!strcmp(argv[ArgumentIndex], "-m")) && ((ArgumentIndex + 1) < argc))
+            NmCommand = argv[++ArgumentIndex];
+         else
+            ret_val = 1;
+      }
+   }
+
+   if((!ret_val) && (Iterations))
+   {
+      Initialization.GetTickCountCallback  = GetTickCountCallback;
+      Initialization.MessageOutputCallback = MessageOutputCallback;
+
+      BTPS_Init(&Initialization);
+
+      for(Index = 0; Index < DUMP_DATA_LENGTH; Index++)
+         DumpData[Index] = (unsigned char)(Index * 7);
+
+      printf("Iterations: %lu\n\n", Iterations);
+      printf("  %-22s %10s %10s %8s %6s %6s\n", "Benchmark", "Old ns", "New ns", "Speedup", "Old IO", "New IO");
+
+      for(Index = 0; Index < NUMBER_BENCHMARKS; Index++)
+         RunBenchmark(&(BenchmarkList[Index]), Iterations);
+
+      DisplayCodeSize(NmCommand);
+
+      BTPS_DeInit();
+   }
+   else
+   {
+      DisplayUsage(argv[0]);
+
+      ret_val = 1;
+   }
+
+   return(ret_val);
+}
@@ -44,14 +44,16 @@
    /* module.                                                           */
 #define TRANSPORT_ID                   1
 
-   /* The following macros are used disable and enable interrupts.  They*/
-   /* are defined here using compiler-intrinsic functions instead of    */
-   /* using the MSPWare functions in order to prevent jumping into the  */
-   /* functions and to save time, which will reduce the amount of time  */
-   /* that ISRs are disabled allowing us to support a higher UART baud  */
-   /* rate.                                                             */
-#define _CPU_cpsid()                   __disable_irq();
-#define _CPU_cpsie()                   __enable_irq()
+   /* The following macros are used to enter and leave a critical       */
+   /* section.  Interrupts are disabled using compiler-intrinsic        */
+   /* functions (and the previous PRIMASK is restored) so that the UART */
+   /* state is protected whether or not interrupt callbacks have been   */
+   /* registered with the kernel, and so that ISRs are disabled for as  */
+   /* short a time as possible.  The kernel critical section is entered */
+   /* as well so that these sections appear in the critical section     */
+   /* profile.                                                          */
+#define ENTER_CRITICAL_SECTION(_p, _s) do { (_p) = __get_PRIMASK(); __disable_irq(); (_s) = BTPS_EnterCriticalSection(); } while(0)
+#define LEAVE_CRITICAL_SECTION(_p, _s) do { BTPS_LeaveCriticalSection(_s); __set_PRIMASK(_p); } while(0)
 
    /* The following macros are used to turn Rx flow on or off by setting*/
    /* RTS low or high, respectively.  Note that the Bluetooth controller*/
@@ -103,6 +105,31 @@ static UartContext_t UartContext;
 static HCITR_COMDataCallback_t _COMDataCallback;
 static unsigned long _COMCallbackParameter;
 
+   /* Event ID of the Rx Event Handler which is posted from the UART ISR*/
+   /* so that received data is delivered on the next pass through the   */
+   /* scheduler.                                                        */
+static unsigned int RxEventID;
+
+   /*********************************************************************/
+   /* Local/Static Functions                                            */
+   /*********************************************************************/
+
+static void BTPSAPI RxEventHandler(void *EventParameter);
+
+   /* The following function is the Event Handler that is called by the */
+   /* scheduler when the UART ISR has received data.  This function     */
+   /* delivers all received data to the upper layer.                    */
+static void BTPSAPI RxEventHandler(void *EventParameter)
+{
+   /* HCITR_COMProcess() stops at the end of the Rx buffer, so call it a*/
+   /* second time to deliver any data that wrapped to the start of the  */
+   /* buffer.                                                           */
+   HCITR_COMProcess(TRANSPORT_ID);
+
+   if(UartContext.RxBytesFree != RX_BUFFER_SIZE)
+      HCITR_COMProcess(TRANSPORT_ID);
+}
+
    /*********************************************************************/
    /* Global/Non-Static Functions                                       */
    /*********************************************************************/
@@ -140,6 +167,11 @@ int BTPSAPI HCITR_COMOpen(HCI_COMMDriverInformation_t *COMMDriverInformation, HC
       UartContext.RxBytesFree = RX_BUFFER_SIZE;
       UartContext.TxBytesFree = TX_BUFFER_SIZE;
 
+      /* Register the Rx Event Handler so that received data is         */
+      /* delivered as soon as possible.  Note that if this fails the    */
+      /* data is still delivered by the periodic HCI processing.        */
+      RxEventID = BTPS_RegisterEventHandler(RxEventHandler, NULL);
+
       /* The controller should be disabled before this function was     */
       /* called and it needs to be enabled, enable it now.              */
       HAL_EnableController();
@@ -205,6 +237,12 @@ void BTPSAPI HCITR_COMClose(unsigned int HCITransportID)
       /* Input parameters appear to be valid, disable the controller.   */
       HAL_DisableController();
 
+      /* The UART is no longer receiving data, remove the Rx Event      */
+      /* Handler.                                                       */
+      BTPS_UnRegisterEventHandler(RxEventID);
+
+      RxEventID = 0;
+
       /* Clear the UART's context flags.                                */
       UartContext.StatusFlags = 0;
 
@@ -239,6 +277,8 @@ void BTPSAPI HCITR_COMClose(unsigned int HCITransportID)
    /*          via the HCI_COMClose() function.                         */
 void BTPSAPI HCITR_COMReconfigure(unsigned int HCITransportID, HCI_Driver_Reconfigure_Data_t *DriverReconfigureData)
 {
+   uint32_t                          PriMask;
+   unsigned long                     InterruptState;
    HCI_COMMReconfigureInformation_t *ReconfigureInformation;
 
    /* Check to make sure that the specified Transport ID is valid.      */
@@ -264,13 +304,13 @@ void BTPSAPI HCITR_COMReconfigure(unsigned int HCITransportID, HCI_Driver_Reconf
                      ;
 
                   /* Disable interrupts.                                */
-                  _CPU_cpsid();
+                  ENTER_CRITICAL_SECTION(PriMask, InterruptState);
 
                   /* Reconfigure the UART with the new baud rate.       */
                   HAL_EnableUART(HRDWCFG_HCI_UART_MODULE, HRDWCFG_HCI_UART_INT_NUM, ReconfigureInformation->BaudRate);
 
                   /* Re-enable interrupts.                              */
-                  _CPU_cpsie();
+                  LEAVE_CRITICAL_SECTION(PriMask, InterruptState);
 
                   /* Turn Rx flow on.                                   */
                   RX_FLOW_ON();
@@ -288,8 +328,10 @@ void BTPSAPI HCITR_COMReconfigure(unsigned int HCITransportID, HCI_Driver_Reconf
    /*          stacks that are operating in threaded environments.      */
 void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID)
 {
-   unsigned int MaxAvailable;
-   unsigned int Count;
+   unsigned int  MaxAvailable;
+   unsigned int  Count;
+   uint32_t      PriMask;
+   unsigned long InterruptState;
 
    /* Check to make sure that the specified Transport ID is valid.      */
    if((HCITransportID == TRANSPORT_ID) && (UartContext.StatusFlags & STATUS_FLAG_OPEN))
@@ -318,11 +360,11 @@ void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID)
          /* Disable interrupts, credit the amount that was sent to the  */
          /* upper layer, and re-enable the receive interrupt.  Note that*/
          /* we actually see slightly less time that the Rx interrupt is */
-         /* disabled when using cpsid/cpsie versus disabling only the Rx*/
-         /* interrupt.                                                  */
-         _CPU_cpsid();
+         /* disabled when using a critical section versus disabling only*/
+         /* the Rx interrupt.                                           */
+         ENTER_CRITICAL_SECTION(PriMask, InterruptState);
          UartContext.RxBytesFree += Count;
-         _CPU_cpsie();
+         LEAVE_CRITICAL_SECTION(PriMask, InterruptState);
 
          /* Check if Rx flow is off and if we have reached the          */
          /* threshold when we should re-enable it.                      */
@@ -355,9 +397,11 @@ void BTPSAPI HCITR_COMProcess(unsigned int HCITransportID)
    /*          to this function.                                        */
 int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, unsigned char *Buffer)
 {
-   int          ret_val = 0;
-   unsigned int TempTxBytesFree;
-   unsigned int Count;
+   int           ret_val = 0;
+   unsigned int  TempTxBytesFree;
+   unsigned int  Count;
+   uint32_t      PriMask;
+   unsigned long InterruptState;
 
    /* Check to make sure that the specified Transport ID is valid and   */
    /* the output buffer appears to be valid as well.                    */
@@ -411,9 +455,9 @@ int BTPSAPI HCITR_COMWrite(unsigned int HCITransportID, unsigned int Length, uns
          /* Update the number of free bytes in the buffer.  This        */
          /* variable can also be updated in the interrupt service       */
          /* routine so we disable interrupts before accessing it.       */
-         _CPU_cpsid();
+         ENTER_CRITICAL_SECTION(PriMask, InterruptState);
          UartContext.TxBytesFree -= Count;
-         _CPU_cpsie();
+         LEAVE_CRITICAL_SECTION(PriMask, InterruptState);
 
          /* Enable the transmit interrupt.  Note that this will have no */
          /* effect if the interrupt is already enabled, nor will it     */
@@ -636,6 +680,10 @@ void HCI_UART_eUSCI_A_ISR(void)
 
       /* Save the volatile variable back to memory.                     */
       UartContext.RxBytesFree = RxBytesFree;
+
+      /* Signal the scheduler that received data is ready to be         */
+      /* delivered.                                                     */
+      BTPS_PostEventFromISR(RxEventID);
    }
    else
    {
@@ -355,6 +355,8 @@
 #define BTPS_CONFIGURATION_HRS_MAXIMUM_SUPPORTED_INSTANCES                1
 #define BTPS_CONFIGURATION_HRS_SUPPORT_BODY_SENSOR_LOCATION               1
 #define BTPS_CONFIGURATION_HRS_SUPPORT_ENERGY_EXPENDED_STATUS             1
+#define BTPS_CONFIGURATION_HRS_NOTIFICATION_POOL_BLOCKS                   2
+#define BTPS_CONFIGURATION_HRS_NOTIFICATION_POOL_BLOCK_SIZE               20
 
    /* HTS Configuration.                                                */
 #define BTPS_CONFIGURATION_HTS_MAXIMUM_SUPPORTED_INSTANCES                1
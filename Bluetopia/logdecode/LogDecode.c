@@ -0,0 +1,369 @@
+/*****< logdecode.c >**********************************************************/
+/*      Copyright 2015 Texas Instruments Incorporated.                        */
+/*      All Rights Reserved.                                                  */
+/*                                                                            */
+/*  LOGDECODE - Host tool that decodes an exported BTPS Kernel deferred log.  */
+/*                                                                            */
+/*  The log is the console output of a target that was built with             */
+/*  DEFERRED_LOG_ENABLED and DEFERRED_LOG_EXPORT defined (see                 */
+/*  BTPS_LogMessage()).  All lines that do not contain "DL " are ignored so   */
+/*  the complete console log can be used as is.  Each record holds only the   */
+/*  address of the format string, so the format strings (and any string       */
+/*  arguments) are read from a binary image of the target firmware, which     */
+/*  must be the image that produced the log.                                  */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 LogDecode.c -o logdecode                                       */
+/*                                                                            */
+/*  Usage:                                                                    */
+/*                                                                            */
+/*     logdecode -i Image [-b BaseAddress] LogFile                            */
+/*                                                                            */
+/*        -i  Binary image of the target firmware (for example the output of  */
+/*            arm-none-eabi-objcopy -O binary).                               */
+/*        -b  Address at which the image is located on the target (default 0, */
+/*            the start of the MSP432 flash).                                 */
+/*                                                                            */
+/*  * NOTE * The arguments are recorded on the target as 32 bit values, so    */
+/*           length modifiers in the format strings are ignored.              */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+   /* The following constant represents the number of arguments that are*/
+   /* recorded for each message (this must match the                    */
+   /* DEFERRED_LOG_MAXIMUM_ARGUMENTS of the kernel).                    */
+#define NUMBER_LOG_ARGUMENTS                           (6)
+
+   /* The following constant represents the maximum length of a single  */
+   /* conversion specification that is passed to the host printf().     */
+#define MAXIMUM_SPECIFICATION_LENGTH                   (32)
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+   /* Variables which hold the firmware image, its size and the address */
+   /* of the image on the target.                                       */
+static unsigned char      *Image;
+static unsigned long       ImageSize;
+static unsigned long       ImageBaseAddress;
+
+   /* Variables which hold the upper bits of the timestamp (the target  */
+   /* only records the lower 32 bits) and the last timestamp that was   */
+   /* decoded.                                                          */
+static unsigned long long  TimeStampHigh;
+static unsigned long       LastTimeStamp;
+
+   /* Internal Function Prototypes.                                     */
+static int ReadImage(const char *FileName);
+static const char *LookupString(unsigned long Address);
+static void DisplayRecord(unsigned long TimeStamp, unsigned long FormatAddress, unsigned long *Arguments);
+static int DecodeLog(const char *FileName);
+static void DisplayUsage(const char *ProgramName);
+
+   /* The following function is used to read the firmware image into    */
+   /* memory.  The function returns zero if successful or a negative    */
+   /* value if there was an error.                                      */
+static int ReadImage(const char *FileName)
+{
+   int   ret_val;
+   long  Size;
+   FILE *File;
+
+   if((File = fopen(FileName, "rb")) != NULL)
+   {
+      if((!fseek(File, 0, SEEK_END)) && ((Size = ftell(File)) > 0) && (!fseek(File, 0, SEEK_SET)))
+      {
+         /* Allocate an extra byte so that a string at the very end of  */
+         /* the image is always terminated.                             */
+         if((Image = (unsigned char *)calloc(1, (size_t)Size + 1)) != NULL)
+         {
+            if(fread(Image, 1, (size_t)Size, File) == (size_t)Size)
+            {
+               ImageSize = (unsigned long)Size;
+
+               ret_val   = 0;
+            }
+            else
+               ret_val = -1;
+         }
+         else
+            ret_val = -1;
+      }
+      else
+         ret_val = -1;
+
+      fclose(File);
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is used to locate the string at the       */
+   /* specified target address in the firmware image.  The function     */
+   /* returns a pointer to the string if found or NULL if the address is*/
+   /* not in the image.                                                 */
+static const char *LookupString(unsigned long Address)
+{
+   const char *ret_val;
+
+   if((Image) && (Address >= ImageBaseAddress) && ((Address - ImageBaseAddress) < ImageSize))
+      ret_val = (const char *)&(Image[Address - ImageBaseAddress]);
+   else
+      ret_val = NULL;
+
+   return(ret_val);
+}
+
+   /* The following function is used to format and display a single log */
+   /* record.  The function takes as its parameters the (32 bit)        */
+   /* timestamp, the address of the format string and the list of       */
+   /* recorded arguments.                                               */
+static void DisplayRecord(unsigned long TimeStamp, unsigned long FormatAddress, unsigned long *Arguments)
+{
+   char                Specification[MAXIMUM_SPECIFICATION_LENGTH + 16];
+   unsigned int        Length;
+   unsigned int        ArgumentIndex;
+   unsigned long       Argument;
+   const char         *Format;
+   const char         *String;
+   unsigned long long  Time;
+
+   /* The timestamp wraps every 71 minutes, records are always written  */
+   /* in order so simply carry into the upper bits.                     */
+   TimeStamp &= 0xFFFFFFFFUL;
+
+   if(TimeStamp < LastTimeStamp)
+      TimeStampHigh += 0x100000000ULL;
+
+   LastTimeStamp = TimeStamp;
+   Time          = TimeStampHigh + TimeStamp;
+
+   printf("%llu.%06llu ", (Time / 1000000), (Time % 1000000));
+
+   if((Format = LookupString(FormatAddress)) != NULL)
+   {
+      ArgumentIndex = 0;
+
+      while(*Format)
+      {
+         if(*Format != '%')
+         {
+            /* The console line endings are replaced by the host line   */
+            /* ending.                                                  */
+            if(*Format != '\r')
+               putchar(*Format);
+
+            Format++;
+            continue;
+         }
+
+         /* Copy the flags, field width and precision of the conversion */
+         /* (a '*' is replaced by the recorded argument), the length    */
+         /* modifiers are dropped.                                      */
+         Specification[0] = *(Format++);
+         Length           = 1;
+
+         while((*Format) && (strchr("-+ #0123456789.*hlzjt", *Format)))
+         {
+            if(Length < MAXIMUM_SPECIFICATION_LENGTH)
+            {
+               if(*Format == '*')
+               {
+                  Argument = (ArgumentIndex < NUMBER_LOG_ARGUMENTS)?Arguments[ArgumentIndex++]:0;
+
+                  Length  += sprintf(&(Specification[Length]), "%d", (int)(Argument & 0xFFFFFFFFUL));
+               }
+               else
+               {
+                  if(!strchr("hlzjt", *Format))
+                     Specification[Length++] = *Format;
+               }
+            }
+
+            Format++;
+         }
+
+         if(!*Format)
+            break;
+
+         if(*Format == '%')
+         {
+            putchar('%');
+
+            Format++;
+            continue;
+         }
+
+         Argument = (ArgumentIndex < NUMBER_LOG_ARGUMENTS)?Arguments[ArgumentIndex++]:0;
+
+         switch(*Format)
+         {
+            case 'd':
+            case 'i':
+               strcpy(&(Specification[Length]), "ld");
+               printf(Specification, (long)(int)(Argument & 0xFFFFFFFFUL));
+               break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+               Specification[Length++] = 'l';
+               Specification[Length++] = *Format;
+               Specification[Length]   = '\0';
+
+               printf(Specification, (Argument & 0xFFFFFFFFUL));
+               break;
+            case 'c':
+               strcpy(&(Specification[Length]), "c");
+               printf(Specification, (int)(Argument & 0xFF));
+               break;
+            case 's':
+               strcpy(&(Specification[Length]), "s");
+
+               if((String = LookupString(Argument)) != NULL)
+                  printf(Specification, String);
+               else
+                  printf("<0x%08lX>", Argument);
+               break;
+            case 'p':
+               printf("0x%08lX", Argument);
+               break;
+            default:
+               printf("<%%%c 0x%08lX>", *Format, Argument);
+               break;
+         }
+
+         Format++;
+      }
+   }
+   else
+   {
+      /* The format string is not in the image, simply display the raw  */
+      /* record.                                                        */
+      printf("<0x%08lX>", FormatAddress);
+
+      for(ArgumentIndex = 0; ArgumentIndex < NUMBER_LOG_ARGUMENTS; ArgumentIndex++)
+         printf(" 0x%08lX", Arguments[ArgumentIndex]);
+
+      printf("\n");
+   }
+}
+
+   /* The following function is used to read the log from the specified */
+   /* file and display each record.  The function returns zero if       */
+   /* successful or a negative value if there was an error.             */
+static int DecodeLog(const char *FileName)
+{
+   int            ret_val;
+   FILE          *File;
+   char           Line[256];
+   char          *Start;
+   unsigned long  TimeStamp;
+   unsigned long  FormatAddress;
+   unsigned long  Arguments[NUMBER_LOG_ARGUMENTS];
+
+   if((File = fopen(FileName, "r")) != NULL)
+   {
+      while(fgets(Line, sizeof(Line), File))
+      {
+         /* The line may be prefixed by other console output, so search */
+         /* for the start of the log record.                            */
+         if((Start = strstr(Line, "DL ")) == NULL)
+            continue;
+
+         if(Start[3] == 'L')
+         {
+            if(sscanf(&Start[4], "%lx", &TimeStamp) == 1)
+               printf("*** %lu log records lost ***\n", TimeStamp);
+         }
+         else
+         {
+            memset(Arguments, 0, sizeof(Arguments));
+
+            if(sscanf(&Start[3], "%lx %lx %lx %lx %lx %lx %lx %lx", &TimeStamp, &FormatAddress, &Arguments[0], &Arguments[1], &Arguments[2], &Arguments[3], &Arguments[4], &Arguments[5]) == (2 + NUMBER_LOG_ARGUMENTS))
+               DisplayRecord(TimeStamp, FormatAddress, Arguments);
+         }
+      }
+
+      fclose(File);
+
+      ret_val = 0;
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is used to display the usage of this tool. */
+static void DisplayUsage(const char *ProgramName)
+{
+   printf("Usage: %s -i Image [-b BaseAddress] LogFile\n", ProgramName);
+   printf("   -i  Binary image of the target firmware.\n");
+   printf("   -b  Address of the image on the target (default 0).\n");
+}
+
+int main(int argc, char *argv[])
+{
+   int         ret_val;
+   int         ArgumentIndex;
+   const char *ImageName;
+   const char *FileName;
+
+   ImageName = NULL;
+   FileName  = NULL;
+   ret_val   = 0;
+
+   for(ArgumentIndex = 1; (ArgumentIndex < argc) && (!ret_val); ArgumentIndex++)
+   {
+      if((!strcmp(argv[ArgumentIndex], "-i")) && ((ArgumentIndex + 1) < argc))
+         ImageName = argv[++ArgumentIndex];
+      else
+      {
+         if((!strcmp(argv[ArgumentIndex], "-b")) && ((ArgumentIndex + 1) < argc))
+            ImageBaseAddress = strtoul(argv[++ArgumentIndex], NULL, 0);
+         else
+         {
+            if((argv[ArgumentIndex][0] != '-') && (!FileName))
+               FileName = argv[ArgumentIndex];
+            else
+               ret_val = 1;
+         }
+      }
+   }
+
+   if((!ret_val) && (ImageName) && (FileName))
+   {
+      if(!ReadImage(ImageName))
+      {
+         if(DecodeLog(FileName))
+         {
+            printf("Unable to read log %s.\n", FileName);
+
+            ret_val = 1;
+         }
+      }
+      else
+      {
+         printf("Unable to read image %s.\n", ImageName);
+
+         ret_val = 1;
+      }
+   }
+   else
+   {
+      DisplayUsage(argv[0]);
+
+      ret_val = 1;
+   }
+
+   free(Image);
+
+   return(ret_val);
+}
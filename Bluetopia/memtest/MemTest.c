@@ -0,0 +1,489 @@
+/*****< memtest.c >************************************************************/
+/*      Copyright 2015 Texas Instruments Incorporated.                        */
+/*      All Rights Reserved.                                                  */
+/*                                                                            */
+/*  MEMTEST - Host tool that checks the BTPS Kernel memory functions.         */
+/*                                                                            */
+/*  BTPS_MemCopy(), BTPS_MemMove(), BTPS_MemInitialize(), BTPS_MemCompare()   */
+/*  and BTPS_MemCompareI() copy, fill and compare a word at a time where      */
+/*  possible.  This tool checks each of them (and so the internal word copy   */
+/*  and compare routines that they are built on) against the C Run-Time for   */
+/*  every destination and source alignment, both overlap directions of a move */
+/*  and every length up to the specified maximum.  The complete buffer        */
+/*  (including the bytes either side of the block) is checked so that writes  */
+/*  outside of the block are also detected.                                   */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -I../include -I../btpskrnl MemTest.c ../btpskrnl/BTPSKRNL.c    */
+/*         -o memtest                                                         */
+/*                                                                            */
+/*  Usage:                                                                    */
+/*                                                                            */
+/*     memtest [-n MaximumLength] [-q]                                        */
+/*                                                                            */
+/*        -n  Largest block length that is checked (default 96).              */
+/*        -q  Do not report the individual failures.                          */
+/*                                                                            */
+/*  The exit status is zero if every check passed.                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SS1BTPS.h"          /* Bluetopia Core Prototypes/Constants.         */
+
+   /* The following constant represents the number of alignments of the */
+   /* destination and source that are checked (this covers every        */
+   /* alignment of up to two 64 bit words).                             */
+#define NUMBER_OFFSETS                                 (16)
+
+   /* The following constant represents the default largest block length*/
+   /* that is checked (several blocks of four words on a 64 bit host).  */
+#define DEFAULT_MAXIMUM_LENGTH                         (96)
+
+   /* The following constant represents the number of failures that are */
+   /* reported for each check.                                          */
+#define MAXIMUM_REPORTED_FAILURES                      (10)
+
+   /* The following constant represents the number of bytes before and  */
+   /* after the largest block that are also checked.                    */
+#define GUARD_SIZE                                     (4 * NUMBER_OFFSETS)
+
+   /* The following type declaration represents a single check.  Each   */
+   /* check returns the number of failures and the number of cases that */
+   /* were checked.                                                     */
+typedef struct _tagCheck_t
+{
+   const char      *Name;
+   unsigned long  (*Function)(unsigned long MaximumLength, unsigned long *NumberCases);
+} Check_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+   /* Variables which hold the buffers that the checks are performed in */
+   /* and the size of each buffer.                                      */
+static unsigned char *TestBuffer;
+static unsigned char *ReferenceBuffer;
+static unsigned char *SourceBuffer;
+static unsigned long  BufferSize;
+
+   /* Variable which holds the seed of the pattern generator.           */
+static unsigned long  PatternSeed;
+
+   /* Variable which flags that the individual failures are not         */
+   /* reported.                                                         */
+static int            Quiet;
+
+   /* The following table holds the masks that are applied to a byte to */
+   /* create a difference in the compare checks (a low bit, the case bit*/
+   /* of an ASCII letter and the sign bit).                             */
+static const unsigned char DifferenceMaskList[] = { 0x01, 0x20, 0x80 };
+
+#define NUMBER_DIFFERENCE_MASKS                        (sizeof(DifferenceMaskList) / sizeof(unsigned char))
+
+   /* Internal Function Prototypes.                                     */
+static void FillPattern(unsigned char *Buffer, unsigned long Size, int Letters);
+static int Sign(int Value);
+static int ReferenceCompareI(const unsigned char *Source1, const unsigned char *Source2, unsigned long Size);
+static void ReportFailure(unsigned long *NumberFailures, const char *Name, unsigned int Offset1, unsigned int Offset2, long Shift, unsigned long Length);
+
+static unsigned long CheckCopy(unsigned long MaximumLength, unsigned long *NumberCases);
+static unsigned long CheckMove(unsigned long MaximumLength, unsigned long *NumberCases);
+static unsigned long CheckFill(unsigned long MaximumLength, unsigned long *NumberCases);
+static unsigned long CheckCompare(unsigned long MaximumLength, unsigned long *NumberCases);
+static unsigned long CheckCompareI(unsigned long MaximumLength, unsigned long *NumberCases);
+
+static void DisplayUsage(const char *ProgramName);
+
+   /* The list of checks that are performed.                            */
+static const Check_t CheckList[] =
+{
+   { "MemCopy",       CheckCopy     },
+   { "MemMove",       CheckMove     },
+   { "MemInitialize", CheckFill     },
+   { "MemCompare",    CheckCompare  },
+   { "MemCompareI",   CheckCompareI }
+};
+
+#define NUMBER_CHECKS                                  (sizeof(CheckList) / sizeof(Check_t))
+
+   /* The following function is used to fill a buffer with a pseudo     */
+   /* random pattern.  If Letters is set, most of the bytes are upper or*/
+   /* lower case ASCII letters (to exercise the case insensitive        */
+   /* compare).                                                         */
+static void FillPattern(unsigned char *Buffer, unsigned long Size, int Letters)
+{
+   unsigned long Index;
+   unsigned long Value;
+
+   for(Index = 0; Index < Size; Index++)
+   {
+      PatternSeed = (PatternSeed * 1103515245UL) + 12345UL;
+      Value       = (PatternSeed >> 16) & 0xFF;
+
+      if((Letters) && (Value & 0x03))
+         Buffer[Index] = (unsigned char)(((Value & 0x04)?'a':'A') + ((Value >> 3) % 26));
+      else
+         Buffer[Index] = (unsigned char)Value;
+   }
+}
+
+   /* The following function is used to reduce a compare result to -1, 0*/
+   /* or 1.                                                             */
+static int Sign(int Value)
+{
+   return((Value > 0)?1:((Value < 0)?-1:0));
+}
+
+   /* The following function is the previous implementation of          */
+   /* BTPS_MemCompareI() (only the ASCII letters are folded).           */
+static int ReferenceCompareI(const unsigned char *Source1, const unsigned char *Source2, unsigned long Size)
+{
+   int           ret_val = 0;
+   unsigned char Byte1;
+   unsigned char Byte2;
+   unsigned long Index;
+
+   for(Index = 0; ((Index < Size) && (!ret_val)); Index++)
+   {
+      Byte1 = Source1[Index];
+      Byte2 = Source2[Index];
+
+      if((Byte1 >= 'a') && (Byte1 <= 'z'))
+         Byte1 = (unsigned char)(Byte1 - ('a' - 'A'));
+
+      if((Byte2 >= 'a') && (Byte2 <= 'z'))
+         Byte2 = (unsigned char)(Byte2 - ('a' - 'A'));
+
+      if(Byte1 != Byte2)
+         ret_val = (Byte1 < Byte2)?-1:1;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to count a single failure and to   */
+   /* report it (unless the failures are not reported).                 */
+static void ReportFailure(unsigned long *NumberFailures, const char *Name, unsigned int Offset1, unsigned int Offset2, long Shift, unsigned long Length)
+{
+   if((!Quiet) && (*NumberFailures < MAXIMUM_REPORTED_FAILURES))
+      printf("   Failure: %s Offsets %u/%u, Shift %ld, Length %lu\n", Name, Offset1, Offset2, Shift, Length);
+
+   (*NumberFailures)++;
+}
+
+   /* The following function checks BTPS_MemCopy() against memcpy() for */
+   /* every destination and source alignment.                           */
+static unsigned long CheckCopy(unsigned long MaximumLength, unsigned long *NumberCases)
+{
+   unsigned int  DestinationOffset;
+   unsigned int  SourceOffset;
+   unsigned long Length;
+   unsigned long ret_val;
+
+   ret_val = 0;
+
+   FillPattern(SourceBuffer, BufferSize, 0);
+
+   for(DestinationOffset = 0; DestinationOffset < NUMBER_OFFSETS; DestinationOffset++)
+   {
+      for(SourceOffset = 0; SourceOffset < NUMBER_OFFSETS; SourceOffset++)
+      {
+         for(Length = 0; Length <= MaximumLength; Length++)
+         {
+            FillPattern(TestBuffer, BufferSize, 0);
+            memcpy(ReferenceBuffer, TestBuffer, BufferSize);
+
+            BTPS_MemCopy(&(TestBuffer[NUMBER_OFFSETS + DestinationOffset]), &(SourceBuffer[NUMBER_OFFSETS + SourceOffset]), Length);
+            memcpy(&(ReferenceBuffer[NUMBER_OFFSETS + DestinationOffset]), &(SourceBuffer[NUMBER_OFFSETS + SourceOffset]), Length);
+
+            if(memcmp(TestBuffer, ReferenceBuffer, BufferSize))
+               ReportFailure(&ret_val, "MemCopy", DestinationOffset, SourceOffset, 0, Length);
+
+            (*NumberCases)++;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks BTPS_MemMove() against memmove() for*/
+   /* every source alignment and every destination within two offsets   */
+   /* either side of the source.  This covers every relative alignment  */
+   /* of overlapping blocks in both directions (a positive shift is     */
+   /* copied backwards) as well as adjacent and identical blocks.       */
+static unsigned long CheckMove(unsigned long MaximumLength, unsigned long *NumberCases)
+{
+   long          Shift;
+   unsigned int  SourceOffset;
+   unsigned long Source;
+   unsigned long Length;
+   unsigned long ret_val;
+
+   ret_val = 0;
+
+   for(SourceOffset = 0; SourceOffset < NUMBER_OFFSETS; SourceOffset++)
+   {
+      Source = (2 * NUMBER_OFFSETS) + SourceOffset;
+
+      for(Shift = -((2 * NUMBER_OFFSETS) - 1); Shift < (2 * NUMBER_OFFSETS); Shift++)
+      {
+         for(Length = 0; Length <= MaximumLength; Length++)
+         {
+            FillPattern(TestBuffer, BufferSize, 0);
+            memcpy(ReferenceBuffer, TestBuffer, BufferSize);
+
+            BTPS_MemMove(&(TestBuffer[Source + Shift]), &(TestBuffer[Source]), Length);
+            memmove(&(ReferenceBuffer[Source + Shift]), &(ReferenceBuffer[Source]), Length);
+
+            if(memcmp(TestBuffer, ReferenceBuffer, BufferSize))
+               ReportFailure(&ret_val, "MemMove", SourceOffset, (unsigned int)((Source + Shift) % NUMBER_OFFSETS), Shift, Length);
+
+            (*NumberCases)++;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks BTPS_MemInitialize() against        */
+   /* memset() for every alignment and a zero, a mixed and an all ones  */
+   /* value.                                                            */
+static unsigned long CheckFill(unsigned long MaximumLength, unsigned long *NumberCases)
+{
+   unsigned int                Offset;
+   unsigned int                ValueIndex;
+   unsigned long               Length;
+   unsigned long               ret_val;
+   static const unsigned char  ValueList[] = { 0x00, 0x5A, 0xFF };
+
+   ret_val = 0;
+
+   for(Offset = 0; Offset < NUMBER_OFFSETS; Offset++)
+   {
+      for(ValueIndex = 0; ValueIndex < (sizeof(ValueList) / sizeof(unsigned char)); ValueIndex++)
+      {
+         for(Length = 0; Length <= MaximumLength; Length++)
+         {
+            FillPattern(TestBuffer, BufferSize, 0);
+            memcpy(ReferenceBuffer, TestBuffer, BufferSize);
+
+            BTPS_MemInitialize(&(TestBuffer[NUMBER_OFFSETS + Offset]), ValueList[ValueIndex], Length);
+            memset(&(ReferenceBuffer[NUMBER_OFFSETS + Offset]), ValueList[ValueIndex], Length);
+
+            if(memcmp(TestBuffer, ReferenceBuffer, BufferSize))
+               ReportFailure(&ret_val, "MemInitialize", Offset, ValueList[ValueIndex], 0, Length);
+
+            (*NumberCases)++;
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks BTPS_MemCompare() against memcmp()  */
+   /* for every alignment of both blocks, identical blocks and a single */
+   /* difference at every position of the block.  Only the sign of the  */
+   /* result is compared.                                               */
+static unsigned long CheckCompare(unsigned long MaximumLength, unsigned long *NumberCases)
+{
+   unsigned int   Offset1;
+   unsigned int   Offset2;
+   unsigned int   MaskIndex;
+   unsigned long  Length;
+   unsigned long  Position;
+   unsigned long  ret_val;
+   unsigned char *Source1;
+   unsigned char *Source2;
+
+   ret_val = 0;
+
+   FillPattern(SourceBuffer, BufferSize, 0);
+
+   for(Offset1 = 0; Offset1 < NUMBER_OFFSETS; Offset1++)
+   {
+      for(Offset2 = 0; Offset2 < NUMBER_OFFSETS; Offset2++)
+      {
+         Source1 = &(SourceBuffer[NUMBER_OFFSETS + Offset1]);
+         Source2 = &(TestBuffer[NUMBER_OFFSETS + Offset2]);
+
+         for(Length = 0; Length <= MaximumLength; Length++)
+         {
+            memcpy(Source2, Source1, Length);
+
+            /* A position equal to the length checks identical blocks.  */
+            for(Position = 0; Position <= Length; Position++)
+            {
+               for(MaskIndex = 0; MaskIndex < ((Position < Length)?NUMBER_DIFFERENCE_MASKS:1); MaskIndex++)
+               {
+                  if(Position < Length)
+                     Source2[Position] ^= DifferenceMaskList[MaskIndex];
+
+                  if(Sign(BTPS_MemCompare(Source1, Source2, Length)) != Sign(memcmp(Source1, Source2, Length)))
+                     ReportFailure(&ret_val, "MemCompare", Offset1, Offset2, (long)Position, Length);
+
+                  if(Position < Length)
+                     Source2[Position] ^= DifferenceMaskList[MaskIndex];
+
+                  (*NumberCases)++;
+               }
+            }
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function checks BTPS_MemCompareI() against the      */
+   /* previous implementation for every alignment of both blocks, blocks*/
+   /* that only differ in case and a single difference at every position*/
+   /* of the block.                                                     */
+static unsigned long CheckCompareI(unsigned long MaximumLength, unsigned long *NumberCases)
+{
+   unsigned int   Offset1;
+   unsigned int   Offset2;
+   unsigned int   MaskIndex;
+   unsigned long  Index;
+   unsigned long  Length;
+   unsigned long  Position;
+   unsigned long  ret_val;
+   unsigned char *Source1;
+   unsigned char *Source2;
+
+   ret_val = 0;
+
+   FillPattern(SourceBuffer, BufferSize, 1);
+
+   for(Offset1 = 0; Offset1 < NUMBER_OFFSETS; Offset1++)
+   {
+      for(Offset2 = 0; Offset2 < NUMBER_OFFSETS; Offset2++)
+      {
+         Source1 = &(SourceBuffer[NUMBER_OFFSETS + Offset1]);
+         Source2 = &(TestBuffer[NUMBER_OFFSETS + Offset2]);
+
+         for(Length = 0; Length <= MaximumLength; Length++)
+         {
+            /* Change the case of every third letter so that the blocks */
+            /* are only equal when the case is ignored.                 */
+            for(Index = 0; Index < Length; Index++)
+            {
+               Source2[Index] = Source1[Index];
+
+               if((!(Index % 3)) && (((Source2[Index] | 0x20) >= 'a') && ((Source2[Index] | 0x20) <= 'z')))
+                  Source2[Index] ^= 0x20;
+            }
+
+            /* A position equal to the length checks equal blocks.      */
+            for(Position = 0; Position <= Length; Position++)
+            {
+               for(MaskIndex = 0; MaskIndex < ((Position < Length)?NUMBER_DIFFERENCE_MASKS:1); MaskIndex++)
+               {
+                  if(Position < Length)
+                     Source2[Position] ^= DifferenceMaskList[MaskIndex];
+
+                  if(BTPS_MemCompareI(Source1, Source2, Length) != ReferenceCompareI(Source1, Source2, Length))
+                     ReportFailure(&ret_val, "MemCompareI", Offset1, Offset2, (long)Position, Length);
+
+                  if(Position < Length)
+                     Source2[Position] ^= DifferenceMaskList[MaskIndex];
+
+                  (*NumberCases)++;
+               }
+            }
+         }
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to display the usage of this tool. */
+static void DisplayUsage(const char *ProgramName)
+{
+   printf("Usage: %s [-n MaximumLength] [-q]\n", ProgramName);
+   printf("   -n  Largest block length that is checked (default %u).\n", DEFAULT_MAXIMUM_LENGTH);
+   printf("   -q  Do not report the individual failures.\n");
+}
+
+int main(int argc, char *argv[])
+{
+   int           ret_val;
+   int           ArgumentIndex;
+   unsigned int  Index;
+   unsigned long MaximumLength;
+   unsigned long NumberCases;
+   unsigned long NumberFailures;
+   unsigned long TotalFailures;
+
+   MaximumLength = DEFAULT_MAXIMUM_LENGTH;
+   ret_val       = 0;
+
+   for(ArgumentIndex = 1; (ArgumentIndex < argc) && (!ret_val); ArgumentIndex++)
+   {
+      if((!strcmp(argv[ArgumentIndex], "-n")) && ((ArgumentIndex + 1) < argc))
+         MaximumLength = strtoul(argv[++ArgumentIndex], NULL, 0);
+      else
+      {
+         if(!strcmp(argv[ArgumentIndex], "-q"))
+            Quiet = 1;
+         else
+            ret_val = 1;
+      }
+   }
+
+   if(!ret_val)
+   {
+      /* Each buffer holds the largest block at the largest offset plus */
+      /* the guard bytes either side.                                   */
+      BufferSize      = MaximumLength + (2 * GUARD_SIZE);
+      TestBuffer      = (unsigned char *)malloc(BufferSize);
+      ReferenceBuffer = (unsigned char *)malloc(BufferSize);
+      SourceBuffer    = (unsigned char *)malloc(BufferSize);
+
+      if((TestBuffer) && (ReferenceBuffer) && (SourceBuffer))
+      {
+         printf("Maximum Length: %lu, Offsets: %u\n\n", MaximumLength, NUMBER_OFFSETS);
+         printf("   %-14s %10s %10s\n", "Function", "Cases", "Failures");
+
+         TotalFailures = 0;
+
+         for(Index = 0; Index < NUMBER_CHECKS; Index++)
+         {
+            NumberCases    = 0;
+            NumberFailures = (*CheckList[Index].Function)(MaximumLength, &NumberCases);
+            TotalFailures += NumberFailures;
+
+            printf("   %-14s %10lu %10lu\n", CheckList[Index].Name, NumberCases, NumberFailures);
+         }
+
+         printf("\n%s\n", (TotalFailures)?"FAILED":"PASSED");
+
+         ret_val = (TotalFailures)?1:0;
+      }
+      else
+      {
+         printf("Unable to allocate the buffers.\n");
+
+         ret_val = 1;
+      }
+
+      free(TestBuffer);
+      free(ReferenceBuffer);
+      free(SourceBuffer);
+   }
+   else
+   {
+      DisplayUsage(argv[0]);
+
+      ret_val = 1;
+   }
+
+   return(ret_val);
+}
@@ -0,0 +1,1384 @@
+/*****< memreplay.c >**********************************************************/
+/*      Copyright 2015 Texas Instruments Incorporated.                        */
+/*      All Rights Reserved.                                                  */
+/*                                                                            */
+/*  MEMREPLAY - Host tool that replays a BTPS Kernel allocation trace.        */
+/*                                                                            */
+/*  The trace is the console output of a target that was built with           */
+/*  MEMORY_TRACE_ENABLED defined (see BTPS_EnableMemoryTrace()).  All lines   */
+/*  that do not start with "MT " are ignored so the complete console log can  */
+/*  be used as is.  The trace is replayed against each selected allocator     */
+/*  and the heap usage and fragmentation over time, the peak usage, the       */
+/*  points at which allocations fail and the time taken by each operation     */
+/*  are reported.                                                             */
+/*                                                                            */
+/*  Every heap that is recorded in the trace (the default heap and each heap  */
+/*  that was registered with BTPS_RegisterHeap()) is replayed as a separate   */
+/*  heap of the recorded size and each operation is replayed against the heap */
+/*  that it was recorded for.  The statistics that are reported are the       */
+/*  totals of all heaps.  Traces that were captured before the Heap ID was    */
+/*  recorded are replayed against the default heap.                           */
+/*                                                                            */
+/*  Build (from this directory):                                              */
+/*                                                                            */
+/*     gcc -O2 -DBTPS_MAXIMUM_NUMBER_HEAPS=9 -I../include -I../btpskrnl       */
+/*         MemReplay.c ../btpskrnl/BTPSKRNL.c -o memreplay                    */
+/*                                                                            */
+/*  Each heap in the trace is registered with the BTPS Kernel, so the kernel  */
+/*  is built with room for MAXIMUM_NUMBER_HEAPS registered heaps in addition  */
+/*  to its own default heap.                                                  */
+/*                                                                            */
+/*  Add -DBTPS_LARGE_ALLOCATION_SIZE=<Bytes> to evaluate a different large    */
+/*  allocation threshold of the BTPS Kernel allocator.                        */
+/*                                                                            */
+/*  Usage:                                                                    */
+/*                                                                            */
+/*     memreplay [-a Allocator] [-s HeapSize] [-i Interval] [-q] TraceFile    */
+/*                                                                            */
+/*        -a  Allocator to replay against (btps, firstfit, libc or all,       */
+/*            default all).                                                   */
+/*        -s  Size of the default heap in bytes (default is the size recorded */
+/*            in the trace).                                                  */
+/*        -i  Number of operations between timeline samples (default 100, 0   */
+/*            disables the timeline).                                         */
+/*        -q  Do not report the individual failure points.                    */
+/*                                                                            */
+/*  * NOTE * The heap header is larger on a 64 bit host than on the target    */
+/*           so slightly less memory is available to the replay.              */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "SS1BTPS.h"          /* Bluetopia Core Prototypes/Constants.         */
+
+   /* The following MACRO is used to flag a parameter that is not used  */
+   /* (for example by an allocator that does not support multiple heaps)*/
+   /* so that the compiler does not warn about it.                      */
+#define UNREFERENCED_PARAMETER(_x)     ((void)(_x))
+
+   /* The following constants represent the operations that are read    */
+   /* from the trace (these match the trace line identifiers).          */
+#define OPERATION_ALLOCATE                             ('A')
+#define OPERATION_FREE                                 ('F')
+#define OPERATION_REALLOCATE                           ('R')
+
+   /* The following constant represents the number of operation types   */
+   /* that timing information is kept for.                              */
+#define NUMBER_OPERATION_TYPES                         (3)
+
+   /* The following constant represents the default number of operations*/
+   /* between each sample of the timeline.                              */
+#define DEFAULT_TIMELINE_INTERVAL                      (100)
+
+   /* The following constant represents the largest number of heaps that*/
+   /* can be replayed (records for any heap with a larger Heap ID are   */
+   /* ignored).                                                         */
+#define MAXIMUM_NUMBER_HEAPS                           (8)
+
+   /* The following type declaration represents a single operation that */
+   /* was read from the trace.                                          */
+typedef struct _tagTraceOperation_t
+{
+   char          Operation;
+   unsigned int  HeapID;
+   unsigned long TimeStamp;
+   unsigned long Size;
+   unsigned long Pointer;
+   unsigned long PreviousPointer;
+} TraceOperation_t;
+
+   /* The following type declaration represents the statistics that an  */
+   /* allocator reports during the replay.  Any statistic that is not   */
+   /* available is set to -1.                                           */
+typedef struct _tagAllocatorStatistics_t
+{
+   long UsedBytes;
+   long FreeFragmentCount;
+   long LargestFreeFragment;
+   long FragmentationIndex;
+} AllocatorStatistics_t;
+
+   /* The following type declaration represents an allocator that the   */
+   /* trace can be replayed against.  To evaluate another allocator     */
+   /* simply implement these functions and add an entry to the          */
+   /* AllocatorList.  Initialize() is passed the size of each heap (a   */
+   /* size of zero means the heap is not used), the other functions are */
+   /* passed the index of the heap to operate on and QueryStatistics()  */
+   /* reports the totals of all heaps.                                  */
+typedef struct _tagAllocator_t
+{
+   const char  *Name;
+   int        (*Initialize)(unsigned int NumberHeaps, const unsigned long *HeapSizeList);
+   void       (*Cleanup)(void);
+   void      *(*Allocate)(unsigned int HeapID, unsigned long Size);
+   void       (*Free)(unsigned int HeapID, void *Pointer, unsigned long Size);
+   void      *(*Reallocate)(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size);
+   void       (*QueryStatistics)(AllocatorStatistics_t *Statistics);
+} Allocator_t;
+
+   /* The following constants and types represent the first fit         */
+   /* allocator that the BTPS Kernel used before the segregated fit     */
+   /* allocator.  They are kept here (unchanged apart from the names)   */
+   /* so that traces can be compared against the original allocator.    */
+typedef unsigned int FirstFitAlignment_t;
+
+#define FIRST_FIT_ALIGNMENT_SIZE                       (sizeof(FirstFitAlignment_t))
+
+typedef struct _tagFirstFitBlockInfo_t
+{
+   Word_t              PrevSize;
+   Word_t              Size;
+   FirstFitAlignment_t Data[1];
+} FirstFitBlockInfo_t;
+
+#define FIRST_FIT_BLOCK_INFO_SIZE(_x)                  ((BTPS_STRUCTURE_OFFSET(FirstFitBlockInfo_t, Data) / FIRST_FIT_ALIGNMENT_SIZE) + (_x))
+
+#define FIRST_FIT_SIZE_BITMASK                         ((Word_t)(((Word_t)-1) >> 1))
+#define FIRST_FIT_ALLOCATED_BITMASK                    ((Word_t)(~FIRST_FIT_SIZE_BITMASK))
+
+#define FIRST_FIT_LARGE_SIZE                           (256 / FIRST_FIT_ALIGNMENT_SIZE)
+
+#define FIRST_FIT_MINIMUM_MEMORY_SIZE                  (FIRST_FIT_BLOCK_INFO_SIZE(1))
+#define FIRST_FIT_MAXIMUM_MEMORY_SIZE                  (FIRST_FIT_SIZE_BITMASK)
+
+typedef struct _tagFirstFitHeapInfo_t
+{
+   Boolean_t            Initialized;
+   unsigned int         CurrentHeapUsed;
+   unsigned int         MaximumHeapUsed;
+   FirstFitBlockInfo_t *HeapTail;
+   FirstFitBlockInfo_t  HeapHead[1];
+} FirstFitHeapInfo_t;
+
+#define FIRST_FIT_HEAP_INFO_SIZE(_x)                   (BTPS_STRUCTURE_OFFSET(FirstFitHeapInfo_t, HeapHead) + (_x))
+
+   /* The following type declaration represents an entry in the table   */
+   /* that maps the pointers that were recorded in the trace to the     */
+   /* pointers that were returned during the replay.                    */
+typedef struct _tagPointerEntry_t
+{
+   unsigned long  TracePointer;
+   void          *ReplayPointer;
+   unsigned long  Size;
+   unsigned int   HeapID;
+} PointerEntry_t;
+
+   /* The following type declaration represents the timing information  */
+   /* that is kept for each operation type.                             */
+typedef struct _tagOperationTiming_t
+{
+   unsigned long      Count;
+   unsigned long long TotalTime;
+   unsigned long long MaximumTime;
+} OperationTiming_t;
+
+   /* Internal Variables to this Module (Remember that all variables    */
+   /* declared static are initialized to 0 automatically by the         */
+   /* compiler as part of standard C/C++).                              */
+
+   /* Variables which hold the operations that were read from the trace */
+   /* and the size of each heap that was recorded in the trace.         */
+static TraceOperation_t *OperationList;
+static unsigned long     NumberOperations;
+static unsigned long     TraceHeapSizeList[MAXIMUM_NUMBER_HEAPS];
+static unsigned int      NumberTraceHeaps;
+
+   /* Variables which hold the pointer map (open addressing, the size is*/
+   /* always a power of two) and the number of entries in use.          */
+static PointerEntry_t   *PointerTable;
+static unsigned long     PointerTableSize;
+static unsigned long     NumberPointers;
+
+   /* Variable which holds the tick count of the operation that is being*/
+   /* replayed (returned to the BTPS Kernel as the current tick count). */
+static unsigned long     CurrentTickCount;
+
+   /* Variables which hold the state of the BTPS Kernel allocator (the  */
+   /* region and the BTPS Kernel Heap ID of each heap).                 */
+static void             *KernelHeapRegionList[MAXIMUM_NUMBER_HEAPS];
+static int               KernelHeapIDList[MAXIMUM_NUMBER_HEAPS];
+
+   /* Variable which holds the number of bytes that are currently       */
+   /* allocated from the C library allocator.                           */
+static unsigned long     LibraryUsedBytes;
+
+   /* Variable which holds the heaps of the first fit allocator.        */
+static FirstFitHeapInfo_t *FirstFitHeapList[MAXIMUM_NUMBER_HEAPS];
+
+   /* Internal Function Prototypes.                                     */
+static unsigned long BTPSAPI GetTickCountCallback(void);
+static void BTPSAPI MessageOutputCallback(unsigned int Length, char *Message);
+
+static int KernelInitialize(unsigned int NumberHeaps, const unsigned long *HeapSizeList);
+static void KernelCleanup(void);
+static void *KernelAllocate(unsigned int HeapID, unsigned long Size);
+static void KernelFree(unsigned int HeapID, void *Pointer, unsigned long Size);
+static void *KernelReallocate(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size);
+static void KernelQueryStatistics(AllocatorStatistics_t *Statistics);
+
+static int LibraryInitialize(unsigned int NumberHeaps, const unsigned long *HeapSizeList);
+static void LibraryCleanup(void);
+static void *LibraryAllocate(unsigned int HeapID, unsigned long Size);
+static void LibraryFree(unsigned int HeapID, void *Pointer, unsigned long Size);
+static void *LibraryReallocate(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size);
+static void LibraryQueryStatistics(AllocatorStatistics_t *Statistics);
+
+static void FirstFitHeapInit(FirstFitHeapInfo_t *HeapInfo, unsigned long Size);
+static void *FirstFitMemAlloc(FirstFitHeapInfo_t *HeapInfo, unsigned long Size);
+static void FirstFitMemFree(FirstFitHeapInfo_t *HeapInfo, void *MemoryPtr);
+
+static int FirstFitInitialize(unsigned int NumberHeaps, const unsigned long *HeapSizeList);
+static void FirstFitCleanup(void);
+static void *FirstFitAllocate(unsigned int HeapID, unsigned long Size);
+static void FirstFitFree(unsigned int HeapID, void *Pointer, unsigned long Size);
+static void *FirstFitReallocate(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size);
+static void FirstFitQueryStatistics(AllocatorStatistics_t *Statistics);
+
+static int ReadTrace(const char *FileName);
+static PointerEntry_t *FindPointer(unsigned long TracePointer);
+static int AddPointer(unsigned long TracePointer, void *ReplayPointer, unsigned long Size, unsigned int HeapID);
+static void RemovePointer(PointerEntry_t *PointerEntry);
+static unsigned long long GetTime(void);
+static void DisplayTimelineSample(const Allocator_t *Allocator, unsigned long Index, long *PeakBytes);
+static void Replay(const Allocator_t *Allocator, unsigned int NumberHeaps, const unsigned long *HeapSizeList, unsigned long Interval, int Quiet);
+static void DisplayUsage(const char *ProgramName);
+
+   /* The list of allocators that the trace can be replayed against.    */
+static const Allocator_t AllocatorList[] =
+{
+   { "btps",     KernelInitialize,   KernelCleanup,   KernelAllocate,   KernelFree,   KernelReallocate,   KernelQueryStatistics   },
+   { "firstfit", FirstFitInitialize, FirstFitCleanup, FirstFitAllocate, FirstFitFree, FirstFitReallocate, FirstFitQueryStatistics },
+   { "libc",     LibraryInitialize,  LibraryCleanup,  LibraryAllocate,  LibraryFree,  LibraryReallocate,  LibraryQueryStatistics  }
+};
+
+#define NUMBER_ALLOCATORS                              (sizeof(AllocatorList) / sizeof(Allocator_t))
+
+   /* The following function is the tick count callback that is        */
+   /* registered with the BTPS Kernel.  The tick count of the operation */
+   /* that is being replayed is returned.                               */
+static unsigned long BTPSAPI GetTickCountCallback(void)
+{
+   return(CurrentTickCount);
+}
+
+   /* The following function is the message output callback that is    */
+   /* registered with the BTPS Kernel.                                  */
+static void BTPSAPI MessageOutputCallback(unsigned int Length, char *Message)
+{
+   fwrite(Message, 1, Length, stdout);
+}
+
+   /* The following functions implement the BTPS Kernel allocator.  The */
+   /* trace is replayed against heaps that are registered with          */
+   /* BTPS_RegisterHeap() so that the size of each heap can be set at   */
+   /* run time.                                                         */
+static int KernelInitialize(unsigned int NumberHeaps, const unsigned long *HeapSizeList)
+{
+   int                   ret_val;
+   unsigned int          Index;
+   BTPS_Initialization_t Initialization;
+
+   memset(&Initialization, 0, sizeof(Initialization));
+
+   Initialization.GetTickCountCallback  = GetTickCountCallback;
+   Initialization.MessageOutputCallback = MessageOutputCallback;
+
+   BTPS_Init(&Initialization);
+
+   for(Index = 0, ret_val = 0; (Index < NumberHeaps) && (!ret_val); Index++)
+   {
+      if(HeapSizeList[Index])
+      {
+         if((KernelHeapRegionList[Index] = malloc(HeapSizeList[Index])) != NULL)
+         {
+            if((KernelHeapIDList[Index] = BTPS_RegisterHeap(KernelHeapRegionList[Index], HeapSizeList[Index])) <= 0)
+               ret_val = -1;
+         }
+         else
+            ret_val = -1;
+      }
+   }
+
+   if(ret_val)
+      KernelCleanup();
+
+   return(ret_val);
+}
+
+static void KernelCleanup(void)
+{
+   unsigned int Index;
+
+   /* Any blocks that are still allocated are simply abandoned along    */
+   /* with the regions.                                                 */
+   for(Index = 0; Index < MAXIMUM_NUMBER_HEAPS; Index++)
+   {
+      KernelHeapIDList[Index] = 0;
+
+      if(KernelHeapRegionList[Index])
+      {
+         free(KernelHeapRegionList[Index]);
+
+         KernelHeapRegionList[Index] = NULL;
+      }
+   }
+
+   BTPS_DeInit();
+}
+
+static void *KernelAllocate(unsigned int HeapID, unsigned long Size)
+{
+   void *ret_val;
+
+   if(KernelHeapIDList[HeapID] > 0)
+      ret_val = BTPS_AllocateMemoryFromHeap((unsigned int)KernelHeapIDList[HeapID], Size);
+   else
+      ret_val = NULL;
+
+   return(ret_val);
+}
+
+static void KernelFree(unsigned int HeapID, void *Pointer, unsigned long Size)
+{
+   UNREFERENCED_PARAMETER(HeapID);
+   UNREFERENCED_PARAMETER(Size);
+
+   BTPS_FreeMemory(Pointer);
+}
+
+static void *KernelReallocate(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size)
+{
+   UNREFERENCED_PARAMETER(HeapID);
+   UNREFERENCED_PARAMETER(PreviousSize);
+
+   return(BTPS_ReallocateMemory(Pointer, Size));
+}
+
+static void KernelQueryStatistics(AllocatorStatistics_t *Statistics)
+{
+   unsigned int                   Index;
+   unsigned long                  FreeBytes;
+   unsigned long                  LargestFreeBytes;
+   BTPS_MemoryStatistics_t        MemoryStatistics;
+   BTPS_FragmentationStatistics_t FragmentationStatistics;
+
+   memset(Statistics, 0, sizeof(AllocatorStatistics_t));
+
+   FreeBytes        = 0;
+   LargestFreeBytes = 0;
+
+   for(Index = 0; (Index < MAXIMUM_NUMBER_HEAPS) && (Statistics->UsedBytes >= 0); Index++)
+   {
+      if(KernelHeapIDList[Index] > 0)
+      {
+         if((!BTPS_QueryHeapUsage((unsigned int)KernelHeapIDList[Index], &MemoryStatistics, FALSE)) && (!BTPS_QueryHeapFragmentation((unsigned int)KernelHeapIDList[Index], &FragmentationStatistics)))
+         {
+            Statistics->UsedBytes         += (long)MemoryStatistics.CurrentHeapUsed;
+            Statistics->FreeFragmentCount += (long)FragmentationStatistics.FreeFragmentCount;
+
+            if(Statistics->LargestFreeFragment < (long)FragmentationStatistics.LargestFreeFragment)
+               Statistics->LargestFreeFragment = (long)FragmentationStatistics.LargestFreeFragment;
+
+            FreeBytes        += FragmentationStatistics.FreeBytes;
+            LargestFreeBytes += FragmentationStatistics.LargestFreeFragment;
+         }
+         else
+            Statistics->UsedBytes = -1;
+      }
+   }
+
+   if(Statistics->UsedBytes >= 0)
+   {
+      /* The fragmentation index is that of the BTPS Kernel, weighted   */
+      /* by the free memory of each heap (the portion of all free memory*/
+      /* that is NOT part of the largest free block of its heap).       */
+      if(FreeBytes)
+         Statistics->FragmentationIndex = 1000 - (long)((LargestFreeBytes * 1000) / FreeBytes);
+   }
+   else
+   {
+      Statistics->UsedBytes           = -1;
+      Statistics->FreeFragmentCount   = -1;
+      Statistics->LargestFreeFragment = -1;
+      Statistics->FragmentationIndex  = -1;
+   }
+}
+
+   /* The following functions implement the C library allocator.  This  */
+   /* is not limited to the heap sizes (all heaps are replayed against  */
+   /* the C library heap) and is mainly useful as a timing reference    */
+   /* (only the requested bytes are reported as used).                  */
+static int LibraryInitialize(unsigned int NumberHeaps, const unsigned long *HeapSizeList)
+{
+   UNREFERENCED_PARAMETER(NumberHeaps);
+   UNREFERENCED_PARAMETER(HeapSizeList);
+
+   LibraryUsedBytes = 0;
+
+   return(0);
+}
+
+static void LibraryCleanup(void)
+{
+   LibraryUsedBytes = 0;
+}
+
+static void *LibraryAllocate(unsigned int HeapID, unsigned long Size)
+{
+   void *ret_val;
+
+   UNREFERENCED_PARAMETER(HeapID);
+
+   if((ret_val = malloc(Size)) != NULL)
+      LibraryUsedBytes += Size;
+
+   return(ret_val);
+}
+
+static void LibraryFree(unsigned int HeapID, void *Pointer, unsigned long Size)
+{
+   UNREFERENCED_PARAMETER(HeapID);
+
+   free(Pointer);
+
+   LibraryUsedBytes -= Size;
+}
+
+static void *LibraryReallocate(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size)
+{
+   void *ret_val;
+
+   UNREFERENCED_PARAMETER(HeapID);
+
+   if((ret_val = realloc(Pointer, Size)) != NULL)
+      LibraryUsedBytes += Size - PreviousSize;
+
+   return(ret_val);
+}
+
+static void LibraryQueryStatistics(AllocatorStatistics_t *Statistics)
+{
+   Statistics->UsedBytes           = (long)LibraryUsedBytes;
+   Statistics->FreeFragmentCount   = -1;
+   Statistics->LargestFreeFragment = -1;
+   Statistics->FragmentationIndex  = -1;
+}
+
+   /* The following function is used to initialize the first fit heap.  */
+   /* The function takes as its parameters the heap and its size in     */
+   /* bytes.                                                            */
+static void FirstFitHeapInit(FirstFitHeapInfo_t *HeapInfo, unsigned long Size)
+{
+   /* Confirm that the parameters are valid and that the heap has not   */
+   /* already been initialized.                                         */
+   if((HeapInfo) && (!(HeapInfo->Initialized)) && (Size > FIRST_FIT_HEAP_INFO_SIZE(FIRST_FIT_MINIMUM_MEMORY_SIZE)))
+   {
+      Size = (Size - FIRST_FIT_HEAP_INFO_SIZE(0)) / FIRST_FIT_ALIGNMENT_SIZE;
+
+      /* Confirm that the size is valid.                                */
+      if((Size >= FIRST_FIT_MINIMUM_MEMORY_SIZE) && (Size <= FIRST_FIT_MAXIMUM_MEMORY_SIZE))
+      {
+         /* Initialize the Heap information.                            */
+         memset(HeapInfo, 0, sizeof(FirstFitHeapInfo_t));
+         HeapInfo->HeapHead->PrevSize = (Word_t)Size;
+         HeapInfo->HeapHead->Size     = (Word_t)Size;
+         HeapInfo->HeapTail           = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)HeapInfo->HeapHead) + Size);
+
+         /* Indicate the heap has been initialized.                     */
+         HeapInfo->Initialized        = TRUE;
+      }
+   }
+}
+
+   /* The following function is used to allocate a fragment of memory   */
+   /* from the first fit heap.  The function takes as its parameters the*/
+   /* heap and the size in bytes of the fragment to be allocated.       */
+   /* Requests of FIRST_FIT_LARGE_SIZE or larger are taken from the end */
+   /* of the heap while small fragments are taken from the start.       */
+static void *FirstFitMemAlloc(FirstFitHeapInfo_t *HeapInfo, unsigned long Size)
+{
+   void                *ret_val;
+   FirstFitBlockInfo_t *BlockInfo;
+   FirstFitBlockInfo_t *TempBlockInfo;
+   Word_t               RemainingSize;
+
+   /* Convert the requested memory allocation in bytes to alignment     */
+   /* size, rounding up, and add the block info header size to it.      */
+   Size = FIRST_FIT_BLOCK_INFO_SIZE((Size + (FIRST_FIT_ALIGNMENT_SIZE - 1)) / FIRST_FIT_ALIGNMENT_SIZE);
+
+   /* Verify that the parameters are valid.                             */
+   if((HeapInfo) && (HeapInfo->Initialized) && (Size >= FIRST_FIT_MINIMUM_MEMORY_SIZE) && (Size <= FIRST_FIT_MAXIMUM_MEMORY_SIZE))
+   {
+      /* Start at the beginning of the heap for small segments and the  */
+      /* end for large segments.                                        */
+      if(Size < FIRST_FIT_LARGE_SIZE)
+         BlockInfo = HeapInfo->HeapHead;
+      else
+         BlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)(HeapInfo->HeapTail)) - HeapInfo->HeapHead->PrevSize);
+
+      /* Loop until we have walked the entire list.                     */
+      while(((Size < FIRST_FIT_LARGE_SIZE) || (BlockInfo != HeapInfo->HeapHead)) && (BlockInfo != HeapInfo->HeapTail))
+      {
+         /* Check to see if the current entry is free and is large      */
+         /* enough to hold the data being requested.                    */
+         if((BlockInfo->Size & FIRST_FIT_ALLOCATED_BITMASK) || (BlockInfo->Size < Size))
+         {
+            /* Search backwards for large requests and forwards for     */
+            /* small requests.                                          */
+            if(Size >= FIRST_FIT_LARGE_SIZE)
+               BlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) - (BlockInfo->PrevSize));
+            else
+               BlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) + (BlockInfo->Size & FIRST_FIT_SIZE_BITMASK));
+         }
+         else
+         {
+            /* Suitable memory block found.                             */
+            break;
+         }
+      }
+
+      /* Check to see if we found a segment large enough for the        */
+      /* request.                                                       */
+      if((BlockInfo != HeapInfo->HeapTail) && (BlockInfo->Size >= Size) && (!(BlockInfo->Size & FIRST_FIT_ALLOCATED_BITMASK)))
+      {
+         /* Check to see if we need to split this into two entries.     */
+         /* * NOTE * If there is not enough room to make another entry  */
+         /*          then we will not adjust the size of this entry to  */
+         /*          match the amount requested.                        */
+         if((RemainingSize = (Word_t)(BlockInfo->Size - Size)) >= FIRST_FIT_MINIMUM_MEMORY_SIZE)
+         {
+            /* If this is a large segment allocation, then split the    */
+            /* segment so that the free segment is at the beginning.    */
+            if(Size >= FIRST_FIT_LARGE_SIZE)
+            {
+               /* Re-size the current block for the remaining space.    */
+               BlockInfo->Size = RemainingSize;
+
+               /* Initialize the new block, setting it to allocated.    */
+               BlockInfo           = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) + RemainingSize);
+               BlockInfo->PrevSize = RemainingSize;
+               BlockInfo->Size     = (Word_t)(Size | FIRST_FIT_ALLOCATED_BITMASK);
+
+               /* Set the temporary block to the current block and the  */
+               /* remaining size to its size for setting the previous   */
+               /* size of the next block.                               */
+               TempBlockInfo = BlockInfo;
+               RemainingSize = (Word_t)Size;
+            }
+            else
+            {
+               /* Re-size the current block and set it as allocated.    */
+               BlockInfo->Size = (Word_t)(Size | FIRST_FIT_ALLOCATED_BITMASK);
+
+               /* Initialize the new block.                             */
+               TempBlockInfo           = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) + Size);
+               TempBlockInfo->PrevSize = (Word_t)Size;
+               TempBlockInfo->Size     = RemainingSize;
+            }
+
+            /* Update the previous size of the next segment (or of the  */
+            /* heap head if this is the last segment).                  */
+            if((TempBlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)TempBlockInfo) + RemainingSize)) != HeapInfo->HeapTail)
+               TempBlockInfo->PrevSize = RemainingSize;
+            else
+               HeapInfo->HeapHead->PrevSize = RemainingSize;
+         }
+         else
+         {
+            /* Update the allocated size to be that of the block that   */
+            /* was found and set the block to allocated.                */
+            Size             = BlockInfo->Size;
+            BlockInfo->Size |= FIRST_FIT_ALLOCATED_BITMASK;
+         }
+
+         /* Get the address of the start of the allocated memory.       */
+         ret_val = (void *)(BlockInfo->Data);
+
+         /* Adjust the memory statistics.                               */
+         HeapInfo->CurrentHeapUsed += Size;
+         if(HeapInfo->MaximumHeapUsed < HeapInfo->CurrentHeapUsed)
+            HeapInfo->MaximumHeapUsed = HeapInfo->CurrentHeapUsed;
+      }
+      else
+         ret_val = NULL;
+   }
+   else
+      ret_val = NULL;
+
+   return(ret_val);
+}
+
+   /* The following function is used to free memory that was previously */
+   /* allocated with FirstFitMemAlloc().  The function takes as its     */
+   /* parameters the heap and a pointer to the memory that was          */
+   /* allocated.  The freed fragment is combined with adjacent free     */
+   /* fragments.                                                        */
+static void FirstFitMemFree(FirstFitHeapInfo_t *HeapInfo, void *MemoryPtr)
+{
+   FirstFitBlockInfo_t *BlockInfo;
+   FirstFitBlockInfo_t *TempBlockInfo;
+
+   /* Verify that the parameter passed in appears valid.                */
+   if((HeapInfo) && (HeapInfo->Initialized) && (MemoryPtr) && (MemoryPtr >= (void *)(HeapInfo->HeapHead->Data)) && (MemoryPtr < (void *)(HeapInfo->HeapTail)))
+   {
+      /* Get a pointer to the Block Info.                               */
+      BlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)MemoryPtr) - FIRST_FIT_BLOCK_INFO_SIZE(0));
+
+      /* Verify that this segment is allocated.                         */
+      if(BlockInfo->Size & FIRST_FIT_ALLOCATED_BITMASK)
+      {
+         /* Set the current block as unallocated.                       */
+         BlockInfo->Size &= FIRST_FIT_SIZE_BITMASK;
+
+         /* Update the Heap Statistics.                                 */
+         HeapInfo->CurrentHeapUsed -= BlockInfo->Size;
+
+         /* Try to combine this segment with the previous segment.      */
+         if(BlockInfo != HeapInfo->HeapHead)
+         {
+            TempBlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) - BlockInfo->PrevSize);
+
+            if(!(TempBlockInfo->Size & FIRST_FIT_ALLOCATED_BITMASK))
+            {
+               TempBlockInfo->Size += BlockInfo->Size;
+               BlockInfo            = TempBlockInfo;
+            }
+         }
+
+         /* Try to combine this segment with the following segment.     */
+         if((TempBlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) + BlockInfo->Size)) < HeapInfo->HeapTail)
+         {
+            if(!(TempBlockInfo->Size & FIRST_FIT_ALLOCATED_BITMASK))
+               BlockInfo->Size += TempBlockInfo->Size;
+         }
+
+         /* Update the previous size of the next block (or of the heap  */
+         /* head if this is the last block).                            */
+         if((TempBlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) + BlockInfo->Size)) != HeapInfo->HeapTail)
+            TempBlockInfo->PrevSize = BlockInfo->Size;
+         else
+            HeapInfo->HeapHead->PrevSize = BlockInfo->Size;
+      }
+   }
+}
+
+   /* The following functions implement the first fit allocator.  The   */
+   /* original allocator had no reallocation, so a reallocation is      */
+   /* replayed as an allocation, a copy and a free (which is what the   */
+   /* applications did at the time).                                    */
+   /* * NOTE * The block sizes are 15 bit Alignment_t counts, so the    */
+   /*          heap can not be larger than 128KB.                       */
+static int FirstFitInitialize(unsigned int NumberHeaps, const unsigned long *HeapSizeList)
+{
+   int          ret_val;
+   unsigned int Index;
+
+   for(Index = 0, ret_val = 0; (Index < NumberHeaps) && (!ret_val); Index++)
+   {
+      if(HeapSizeList[Index])
+      {
+         if((FirstFitHeapList[Index] = (FirstFitHeapInfo_t *)calloc(1, HeapSizeList[Index])) != NULL)
+         {
+            FirstFitHeapInit(FirstFitHeapList[Index], HeapSizeList[Index]);
+
+            if(!FirstFitHeapList[Index]->Initialized)
+               ret_val = -1;
+         }
+         else
+            ret_val = -1;
+      }
+   }
+
+   if(ret_val)
+      FirstFitCleanup();
+
+   return(ret_val);
+}
+
+static void FirstFitCleanup(void)
+{
+   unsigned int Index;
+
+   for(Index = 0; Index < MAXIMUM_NUMBER_HEAPS; Index++)
+   {
+      if(FirstFitHeapList[Index])
+      {
+         free(FirstFitHeapList[Index]);
+
+         FirstFitHeapList[Index] = NULL;
+      }
+   }
+}
+
+static void *FirstFitAllocate(unsigned int HeapID, unsigned long Size)
+{
+   return(FirstFitMemAlloc(FirstFitHeapList[HeapID], Size));
+}
+
+static void FirstFitFree(unsigned int HeapID, void *Pointer, unsigned long Size)
+{
+   UNREFERENCED_PARAMETER(Size);
+
+   FirstFitMemFree(FirstFitHeapList[HeapID], Pointer);
+}
+
+static void *FirstFitReallocate(unsigned int HeapID, void *Pointer, unsigned long PreviousSize, unsigned long Size)
+{
+   void *ret_val;
+
+   if((ret_val = FirstFitMemAlloc(FirstFitHeapList[HeapID], Size)) != NULL)
+   {
+      memcpy(ret_val, Pointer, (PreviousSize < Size)?PreviousSize:Size);
+
+      FirstFitMemFree(FirstFitHeapList[HeapID], Pointer);
+   }
+
+   return(ret_val);
+}
+
+static void FirstFitQueryStatistics(AllocatorStatistics_t *Statistics)
+{
+   unsigned int         Index;
+   unsigned long        FreeSize;
+   unsigned long        LargestFreeSize;
+   unsigned long        HeapLargestFreeSize;
+   FirstFitBlockInfo_t *BlockInfo;
+
+   memset(Statistics, 0, sizeof(AllocatorStatistics_t));
+
+   FreeSize        = 0;
+   LargestFreeSize = 0;
+
+   for(Index = 0; Index < MAXIMUM_NUMBER_HEAPS; Index++)
+   {
+      if(FirstFitHeapList[Index])
+      {
+         Statistics->UsedBytes += (long)(FirstFitHeapList[Index]->CurrentHeapUsed * FIRST_FIT_ALIGNMENT_SIZE);
+
+         /* The original allocator kept no free list, so walk the heap. */
+         HeapLargestFreeSize = 0;
+         BlockInfo           = FirstFitHeapList[Index]->HeapHead;
+
+         while(BlockInfo < FirstFitHeapList[Index]->HeapTail)
+         {
+            if(!(BlockInfo->Size & FIRST_FIT_ALLOCATED_BITMASK))
+            {
+               Statistics->FreeFragmentCount++;
+
+               FreeSize += BlockInfo->Size;
+
+               if(HeapLargestFreeSize < BlockInfo->Size)
+                  HeapLargestFreeSize = BlockInfo->Size;
+            }
+
+            BlockInfo = (FirstFitBlockInfo_t *)(((FirstFitAlignment_t *)BlockInfo) + (BlockInfo->Size & FIRST_FIT_SIZE_BITMASK));
+         }
+
+         LargestFreeSize += HeapLargestFreeSize;
+
+         if(Statistics->LargestFreeFragment < (long)(HeapLargestFreeSize * FIRST_FIT_ALIGNMENT_SIZE))
+            Statistics->LargestFreeFragment = (long)(HeapLargestFreeSize * FIRST_FIT_ALIGNMENT_SIZE);
+      }
+   }
+
+   /* The fragmentation index is calculated the same way as for the BTPS*/
+   /* Kernel allocator.                                                 */
+   if(FreeSize)
+      Statistics->FragmentationIndex = 1000 - (long)((LargestFreeSize * 1000) / FreeSize);
+}
+
+   /* The following function is used to read the trace from the        */
+   /* specified file.  Only the first trace session (up to the first "MT*/
+   /* E" line) is read.  Lines that do not contain a Heap ID (traces    */
+   /* captured by earlier versions) are read as default heap records.   */
+   /* The function returns zero if successful or a negative value if    */
+   /* there was an error.                                               */
+static int ReadTrace(const char *FileName)
+{
+   int               ret_val;
+   FILE             *File;
+   char              Line[256];
+   char             *Start;
+   unsigned long     MaximumOperations;
+   TraceOperation_t  Operation;
+   TraceOperation_t *NewList;
+   int               SessionComplete;
+   unsigned long     HeapSize;
+
+   if((File = fopen(FileName, "r")) != NULL)
+   {
+      ret_val           = 0;
+      MaximumOperations = 0;
+      SessionComplete   = 0;
+
+      while((!ret_val) && (!SessionComplete) && (fgets(Line, sizeof(Line), File)))
+      {
+         /* The line may be prefixed by other console output, so search */
+         /* for the start of the trace record.                          */
+         if((Start = strstr(Line, "MT ")) == NULL)
+            continue;
+
+         memset(&Operation, 0, sizeof(Operation));
+
+         Operation.Operation = Start[3];
+
+         /* Each record is first read with a Heap ID, if one field is   */
+         /* missing the record is read again without it.                */
+         switch(Operation.Operation)
+         {
+            case 'H':
+               if(sscanf(&Start[4], "%x %lx", &Operation.HeapID, &HeapSize) != 2)
+               {
+                  Operation.HeapID = 0;
+
+                  if(sscanf(&Start[4], "%lx", &HeapSize) != 1)
+                     continue;
+               }
+
+               /* Only the first size that is recorded for each heap is */
+               /* used.                                                 */
+               if((Operation.HeapID < MAXIMUM_NUMBER_HEAPS) && (!TraceHeapSizeList[Operation.HeapID]))
+               {
+                  TraceHeapSizeList[Operation.HeapID] = HeapSize;
+
+                  if(Operation.HeapID >= NumberTraceHeaps)
+                     NumberTraceHeaps = Operation.HeapID + 1;
+               }
+               continue;
+            case 'E':
+               if(NumberTraceHeaps)
+                  SessionComplete = 1;
+               continue;
+            case OPERATION_ALLOCATE:
+               if(sscanf(&Start[4], "%lx %x %lx %lx", &Operation.TimeStamp, &Operation.HeapID, &Operation.Size, &Operation.Pointer) != 4)
+               {
+                  Operation.HeapID = 0;
+
+                  if(sscanf(&Start[4], "%lx %lx %lx", &Operation.TimeStamp, &Operation.Size, &Operation.Pointer) != 3)
+                     continue;
+               }
+               break;
+            case OPERATION_FREE:
+               if(sscanf(&Start[4], "%lx %x %lx", &Operation.TimeStamp, &Operation.HeapID, &Operation.Pointer) != 3)
+               {
+                  Operation.HeapID = 0;
+
+                  if(sscanf(&Start[4], "%lx %lx", &Operation.TimeStamp, &Operation.Pointer) != 2)
+                     continue;
+               }
+               break;
+            case OPERATION_REALLOCATE:
+               if(sscanf(&Start[4], "%lx %x %lx %lx %lx", &Operation.TimeStamp, &Operation.HeapID, &Operation.Size, &Operation.Pointer, &Operation.PreviousPointer) != 5)
+               {
+                  Operation.HeapID = 0;
+
+                  if(sscanf(&Start[4], "%lx %lx %lx %lx", &Operation.TimeStamp, &Operation.Size, &Operation.Pointer, &Operation.PreviousPointer) != 4)
+                     continue;
+               }
+               break;
+            default:
+               continue;
+         }
+
+         if(Operation.HeapID >= MAXIMUM_NUMBER_HEAPS)
+            continue;
+
+         if(NumberOperations == MaximumOperations)
+         {
+            MaximumOperations = (MaximumOperations)?(MaximumOperations * 2):1024;
+
+            if((NewList = (TraceOperation_t *)realloc(OperationList, MaximumOperations * sizeof(TraceOperation_t))) != NULL)
+               OperationList = NewList;
+            else
+               ret_val = -1;
+         }
+
+         if(!ret_val)
+            OperationList[NumberOperations++] = Operation;
+      }
+
+      fclose(File);
+   }
+   else
+      ret_val = -1;
+
+   return(ret_val);
+}
+
+   /* The following function is used to locate the entry of the pointer */
+   /* map for the specified trace pointer.  The function returns a      */
+   /* pointer to the entry if found or NULL if the pointer is not in the*/
+   /* map.                                                              */
+static PointerEntry_t *FindPointer(unsigned long TracePointer)
+{
+   PointerEntry_t *ret_val;
+   unsigned long   Index;
+
+   ret_val = NULL;
+
+   if((TracePointer) && (PointerTableSize))
+   {
+      Index = (TracePointer >> 2) & (PointerTableSize - 1);
+
+      while(PointerTable[Index].TracePointer)
+      {
+         if(PointerTable[Index].TracePointer == TracePointer)
+         {
+            ret_val = &(PointerTable[Index]);
+            break;
+         }
+
+         Index = (Index + 1) & (PointerTableSize - 1);
+      }
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to add an entry to the pointer map */
+   /* (growing the map if required).  The Heap ID of the replayed block */
+   /* is kept with the entry.  The function returns zero if successful  */
+   /* or a negative value if there was an error.                        */
+static int AddPointer(unsigned long TracePointer, void *ReplayPointer, unsigned long Size, unsigned int HeapID)
+{
+   int             ret_val;
+   unsigned long   Index;
+   unsigned long   OldSize;
+   PointerEntry_t *OldTable;
+
+   ret_val = 0;
+
+   /* Keep the map at most half full.                                   */
+   if(((NumberPointers + 1) * 2) > PointerTableSize)
+   {
+      OldTable         = PointerTable;
+      OldSize          = PointerTableSize;
+      PointerTableSize = (PointerTableSize)?(PointerTableSize * 2):1024;
+
+      if((PointerTable = (PointerEntry_t *)calloc(PointerTableSize, sizeof(PointerEntry_t))) != NULL)
+      {
+         NumberPointers = 0;
+
+         for(Index = 0; Index < OldSize; Index++)
+         {
+            if(OldTable[Index].TracePointer)
+               AddPointer(OldTable[Index].TracePointer, OldTable[Index].ReplayPointer, OldTable[Index].Size, OldTable[Index].HeapID);
+         }
+
+         free(OldTable);
+      }
+      else
+      {
+         PointerTable     = OldTable;
+         PointerTableSize = OldSize;
+         ret_val          = -1;
+      }
+   }
+
+   if(!ret_val)
+   {
+      Index = (TracePointer >> 2) & (PointerTableSize - 1);
+
+      while(PointerTable[Index].TracePointer)
+         Index = (Index + 1) & (PointerTableSize - 1);
+
+      PointerTable[Index].TracePointer  = TracePointer;
+      PointerTable[Index].ReplayPointer = ReplayPointer;
+      PointerTable[Index].Size          = Size;
+      PointerTable[Index].HeapID        = HeapID;
+
+      NumberPointers++;
+   }
+
+   return(ret_val);
+}
+
+   /* The following function is used to remove an entry from the       */
+   /* pointer map.  Any entries that follow the removed entry in the    */
+   /* same probe sequence are re-inserted so that they can still be     */
+   /* located.                                                          */
+static void RemovePointer(PointerEntry_t *PointerEntry)
+{
+   unsigned long  Index;
+   PointerEntry_t Entry;
+
+   Index = (unsigned long)(PointerEntry - PointerTable);
+
+   PointerTable[Index].TracePointer = 0;
+   NumberPointers--;
+
+   Index = (Index + 1) & (PointerTableSize - 1);
+
+   while(PointerTable[Index].TracePointer)
+   {
+      Entry                            = PointerTable[Index];
+      PointerTable[Index].TracePointer = 0;
+      NumberPointers--;
+
+      AddPointer(Entry.TracePointer, Entry.ReplayPointer, Entry.Size, Entry.HeapID);
+
+      Index = (Index + 1) & (PointerTableSize - 1);
+   }
+}
+
+   /* The following function is used to read the monotonic clock (in    */
+   /* nanoseconds).                                                     */
+static unsigned long long GetTime(void)
+{
+   struct timespec TimeSpec;
+
+   clock_gettime(CLOCK_MONOTONIC, &TimeSpec);
+
+   return(((unsigned long long)TimeSpec.tv_sec * 1000000000ULL) + (unsigned long long)TimeSpec.tv_nsec);
+}
+
+   /* The following function is used to display a single sample of the  */
+   /* timeline (and to update the peak usage).                          */
+static void DisplayTimelineSample(const Allocator_t *Allocator, unsigned long Index, long *PeakBytes)
+{
+   AllocatorStatistics_t Statistics;
+
+   (*Allocator->QueryStatistics)(&Statistics);
+
+   if(Statistics.UsedBytes > *PeakBytes)
+      *PeakBytes = Statistics.UsedBytes;
+
+   printf("   %8lu %10lu %8ld %8ld %6ld %8ld %7ld\n", Index, CurrentTickCount, Statistics.UsedBytes, *PeakBytes, Statistics.FreeFragmentCount, Statistics.LargestFreeFragment, Statistics.FragmentationIndex);
+}
+
+   /* The following function is used to replay the trace against the   */
+   /* specified allocator (with the specified heaps) and display the    */
+   /* results.                                                          */
+static void Replay(const Allocator_t *Allocator, unsigned int NumberHeaps, const unsigned long *HeapSizeList, unsigned long Interval, int Quiet)
+{
+   void                  *Pointer;
+   unsigned int           HeapIndex;
+   long                   PeakBytes;
+   unsigned long          Index;
+   unsigned long          TraceFailures;
+   unsigned long          ReplayFailures;
+   unsigned long          RecoveredFailures;
+   unsigned long          UnmatchedFrees;
+   unsigned long          TypeIndex;
+   unsigned long long     StartTime;
+   unsigned long long     ElapsedTime;
+   PointerEntry_t        *PointerEntry;
+   TraceOperation_t      *Operation;
+   OperationTiming_t      Timing[NUMBER_OPERATION_TYPES];
+   AllocatorStatistics_t  Statistics;
+   static const char     *TypeName[NUMBER_OPERATION_TYPES] = { "Allocate", "Free", "Reallocate" };
+
+   printf("\nAllocator: %s (Heap Sizes", Allocator->Name);
+
+   for(HeapIndex = 0; HeapIndex < NumberHeaps; HeapIndex++)
+   {
+      if(HeapSizeList[HeapIndex])
+         printf(" %u:%lu", HeapIndex, HeapSizeList[HeapIndex]);
+   }
+
+   printf(")\n");
+
+   if(!(*Allocator->Initialize)(NumberHeaps, HeapSizeList))
+   {
+      memset(Timing, 0, sizeof(Timing));
+
+      PeakBytes         = 0;
+      TraceFailures     = 0;
+      ReplayFailures    = 0;
+      RecoveredFailures = 0;
+      UnmatchedFrees    = 0;
+      CurrentTickCount  = 0;
+
+      if(Interval)
+         printf("\n   %8s %10s %8s %8s %6s %8s %7s\n", "Op", "Tick", "Used", "Peak", "Frags", "Largest", "FragIdx");
+
+      for(Index = 0, Operation = OperationList; Index < NumberOperations; Index++, Operation++)
+      {
+         /* Tick counts of zero are the heap state at the start of the  */
+         /* trace.                                                      */
+         if(Operation->TimeStamp)
+            CurrentTickCount = Operation->TimeStamp;
+
+         switch(Operation->Operation)
+         {
+            case OPERATION_ALLOCATE:
+               TypeIndex   = 0;
+               StartTime   = GetTime();
+               Pointer     = (*Allocator->Allocate)(Operation->HeapID, Operation->Size);
+               ElapsedTime = GetTime() - StartTime;
+
+               if(Operation->Pointer)
+               {
+                  if(Pointer)
+                  {
+                     /* A pointer that is still in the map was freed    */
+                     /* outside of the trace, drop the stale entry.     */
+                     if((PointerEntry = FindPointer(Operation->Pointer)) != NULL)
+                        RemovePointer(PointerEntry);
+
+                     AddPointer(Operation->Pointer, Pointer, Operation->Size, Operation->HeapID);
+                  }
+                  else
+                  {
+                     ReplayFailures++;
+
+                     if(!Quiet)
+                     {
+                        (*Allocator->QueryStatistics)(&Statistics);
+
+                        printf("   Failure: Op %lu, Tick %lu, Heap %u, Allocate %lu bytes (Used %ld, Largest Free %ld)\n", Index, CurrentTickCount, Operation->HeapID, Operation->Size, Statistics.UsedBytes, Statistics.LargestFreeFragment);
+                     }
+                  }
+               }
+               else
+               {
+                  /* The allocation failed on the target, release the    */
+                  /* block (if any) as the application never used it.    */
+                  TraceFailures++;
+
+                  if(Pointer)
+                  {
+                     RecoveredFailures++;
+
+                     (*Allocator->Free)(Operation->HeapID, Pointer, Operation->Size);
+                  }
+               }
+               break;
+            case OPERATION_FREE:
+               TypeIndex = 1;
+
+               if((PointerEntry = FindPointer(Operation->Pointer)) != NULL)
+               {
+                  StartTime   = GetTime();
+                  (*Allocator->Free)(PointerEntry->HeapID, PointerEntry->ReplayPointer, PointerEntry->Size);
+                  ElapsedTime = GetTime() - StartTime;
+
+                  RemovePointer(PointerEntry);
+               }
+               else
+               {
+                  UnmatchedFrees++;
+                  TypeIndex = NUMBER_OPERATION_TYPES;
+               }
+               break;
+            default:
+               TypeIndex = 2;
+
+               /* A reallocation that failed on the target left the     */
+               /* original block unchanged, so it is not replayed.      */
+               if(!Operation->Pointer)
+               {
+                  TraceFailures++;
+                  TypeIndex = NUMBER_OPERATION_TYPES;
+               }
+               else
+               {
+                  if((PointerEntry = FindPointer(Operation->PreviousPointer)) != NULL)
+                  {
+                     StartTime   = GetTime();
+                     Pointer     = (*Allocator->Reallocate)(PointerEntry->HeapID, PointerEntry->ReplayPointer, PointerEntry->Size, Operation->Size);
+                     ElapsedTime = GetTime() - StartTime;
+
+                     if(!Pointer)
+                     {
+                        /* The application continues to use the block   */
+                        /* (at its new trace address) so keep the       */
+                        /* original block.                              */
+                        ReplayFailures++;
+
+                        if(!Quiet)
+                        {
+                           (*Allocator->QueryStatistics)(&Statistics);
+
+                           printf("   Failure: Op %lu, Tick %lu, Heap %u, Reallocate %lu to %lu bytes (Used %ld, Largest Free %ld)\n", Index, CurrentTickCount, PointerEntry->HeapID, PointerEntry->Size, Operation->Size, Statistics.UsedBytes, Statistics.LargestFreeFragment);
+                        }
+
+                        Pointer         = PointerEntry->ReplayPointer;
+                        Operation->Size = PointerEntry->Size;
+                     }
+
+                     /* The block stays in the heap that it was         */
+                     /* allocated from.                                 */
+                     HeapIndex = PointerEntry->HeapID;
+
+                     RemovePointer(PointerEntry);
+
+                     AddPointer(Operation->Pointer, Pointer, Operation->Size, HeapIndex);
+                  }
+                  else
+                  {
+                     /* The original block was allocated before the     */
+                     /* trace started, replay this as an allocation.    */
+                     StartTime   = GetTime();
+                     Pointer     = (*Allocator->Allocate)(Operation->HeapID, Operation->Size);
+                     ElapsedTime = GetTime() - StartTime;
+
+                     if(Pointer)
+                        AddPointer(Operation->Pointer, Pointer, Operation->Size, Operation->HeapID);
+                     else
+                        ReplayFailures++;
+                  }
+               }
+               break;
+         }
+
+         if(TypeIndex < NUMBER_OPERATION_TYPES)
+         {
+            Timing[TypeIndex].Count++;
+            Timing[TypeIndex].TotalTime += ElapsedTime;
+
+            if(ElapsedTime > Timing[TypeIndex].MaximumTime)
+               Timing[TypeIndex].MaximumTime = ElapsedTime;
+         }
+
+         /* Keep track of the peak usage and display the timeline.      */
+         if((Interval) && (!(Index % Interval)))
+            DisplayTimelineSample(Allocator, Index, &PeakBytes);
+         else
+         {
+            (*Allocator->QueryStatistics)(&Statistics);
+
+            if(Statistics.UsedBytes > PeakBytes)
+               PeakBytes = Statistics.UsedBytes;
+         }
+      }
+
+      if(Interval)
+         DisplayTimelineSample(Allocator, Index, &PeakBytes);
+
+      printf("\n   Operations:          %lu\n", NumberOperations);
+      printf("   Peak Used:           %ld\n", PeakBytes);
+      printf("   Replay Failures:     %lu\n", ReplayFailures);
+      printf("   Trace Failures:      %lu (%lu succeeded in the replay)\n", TraceFailures, RecoveredFailures);
+      printf("   Unmatched Frees:     %lu\n", UnmatchedFrees);
+
+      printf("\n   %-10s %10s %10s %10s\n", "Operation", "Count", "Avg (ns)", "Max (ns)");
+
+      for(TypeIndex = 0; TypeIndex < NUMBER_OPERATION_TYPES; TypeIndex++)
+         printf("   %-10s %10lu %10llu %10llu\n", TypeName[TypeIndex], Timing[TypeIndex].Count, (Timing[TypeIndex].Count)?(Timing[TypeIndex].TotalTime / Timing[TypeIndex].Count):0, Timing[TypeIndex].MaximumTime);
+
+      /* Release the blocks that are still allocated and clear the map. */
+      for(Index = 0; Index < PointerTableSize; Index++)
+      {
+         if(PointerTable[Index].TracePointer)
+            (*Allocator->Free)(PointerTable[Index].HeapID, PointerTable[Index].ReplayPointer, PointerTable[Index].Size);
+      }
+
+      if(PointerTable)
+         memset(PointerTable, 0, PointerTableSize * sizeof(PointerEntry_t));
+
+      NumberPointers = 0;
+
+      (*Allocator->Cleanup)();
+   }
+   else
+      printf("   Unable to initialize the allocator.\n");
+}
+
+   /* The following function is used to display the usage of this tool. */
+static void DisplayUsage(const char *ProgramName)
+{
+   printf("Usage: %s [-a Allocator] [-s HeapSize] [-i Interval] [-q] TraceFile\n", ProgramName);
+   printf("   -a  Allocator to replay against (btps, firstfit, libc or all, default all).\n");
+   printf("   -s  Size of the default heap in bytes (default is the size recorded in the trace).\n");
+   printf("   -i  Operations between timeline samples (default %u, 0 disables).\n", DEFAULT_TIMELINE_INTERVAL);
+   printf("   -q  Do not report the individual failure points.\n");
+}
+
+int main(int argc, char *argv[])
+{
+   int            ret_val;
+   int            Quiet;
+   int            ArgumentIndex;
+   const char    *AllocatorName;
+   const char    *FileName;
+   unsigned int   Index;
+   unsigned long  HeapSize;
+   unsigned long  Interval;
+
+   AllocatorName = "all";
+   FileName      = NULL;
+   HeapSize      = 0;
+   Interval      = DEFAULT_TIMELINE_INTERVAL;
+   Quiet         = 0;
+   ret_val       = 0;
+
+   for(ArgumentIndex = 1; (ArgumentIndex < argc) && (!ret_val); ArgumentIndex++)
+   {
+      if((!strcmp(argv[ArgumentIndex], "-a")) && ((ArgumentIndex + 1) < argc))
+         AllocatorName = argv[++ArgumentIndex];
+      else
+      {
+         if((!strcmp(argv[ArgumentIndex], "-s")) && ((ArgumentIndex + 1) < argc))
+            HeapSize = strtoul(argv[++ArgumentIndex], NULL, 0);
+         else
+         {
+            if((!strcmp(argv[ArgumentIndex], "-i")) && ((ArgumentIndex + 1) < argc))
+               Interval = strtoul(argv[++ArgumentIndex], NULL, 0);
+            else
+            {
+               if(!strcmp(argv[ArgumentIndex], "-q"))
+                  Quiet = 1;
+               else
+               {
+                  if((argv[ArgumentIndex][0] != '-') && (!FileName))
+                     FileName = argv[ArgumentIndex];
+                  else
+                     ret_val = 1;
+               }
+            }
+         }
+      }
+   }
+
+   if((!ret_val) && (FileName))
+   {
+      if(!ReadTrace(FileName))
+      {
+         /* The specified size replaces the size of the default heap.   */
+         if(HeapSize)
+         {
+            TraceHeapSizeList[0] = HeapSize;
+
+            if(!NumberTraceHeaps)
+               NumberTraceHeaps = 1;
+         }
+
+         if(TraceHeapSizeList[0])
+         {
+            printf("Trace: %s (%lu operations, %u heaps)\n", FileName, NumberOperations, NumberTraceHeaps);
+
+            for(Index = 0; Index < NUMBER_ALLOCATORS; Index++)
+            {
+               if((!strcmp(AllocatorName, "all")) || (!strcmp(AllocatorName, AllocatorList[Index].Name)))
+                  Replay(&(AllocatorList[Index]), NumberTraceHeaps, TraceHeapSizeList, Interval, Quiet);
+            }
+         }
+         else
+         {
+            printf("No default heap size in the trace, use -s to specify the heap size.\n");
+
+            ret_val = 1;
+         }
+      }
+      else
+      {
+         printf("Unable to read trace %s.\n", FileName);
+
+         ret_val = 1;
+      }
+   }
+   else
+   {
+      DisplayUsage(argv[0]);
+
+      ret_val = 1;
+   }
+
+   free(OperationList);
+   free(PointerTable);
+
+   return(ret_val);
+}
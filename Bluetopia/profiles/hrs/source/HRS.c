@@ -23,6 +23,15 @@
    /* The following controls the number of supported HRS instances.     */
 #define HRS_MAXIMUM_SUPPORTED_INSTANCES                 (BTPS_CONFIGURATION_HRS_MAXIMUM_SUPPORTED_INSTANCES)
 
+   /* The following control the fixed size Memory Pool that is used to  */
+   /* hold Heart Rate Measurement notifications.  The default block size*/
+   /* holds a notification on a connection using the default LE ATT MTU.*/
+   /* Larger notifications (or notifications sent while the pool is     */
+   /* exhausted) are allocated from the heap.  Setting the number of    */
+   /* blocks to zero disables the pool.                                 */
+#define HRS_NOTIFICATION_POOL_BLOCKS                    (BTPS_CONFIGURATION_HRS_NOTIFICATION_POOL_BLOCKS)
+#define HRS_NOTIFICATION_POOL_BLOCK_SIZE                (BTPS_CONFIGURATION_HRS_NOTIFICATION_POOL_BLOCK_SIZE)
+
 #if BTPS_CONFIGURATION_HRS_SUPPORT_BODY_SENSOR_LOCATION
 
    /* The following defines the HRS Instance Data, that contains data   */
@@ -192,6 +201,14 @@ static Boolean_t InstanceListInitialized;   /* Variable that flags that */
                                             /* this module has been     */
                                             /* successfully initialized.*/
 
+#if HRS_NOTIFICATION_POOL_BLOCKS
+
+static Pool_t NotificationPool;             /* Variable which holds the */
+                                            /* Memory Pool that is used */
+                                            /* for notification buffers.*/
+
+#endif
+
    /* The following are the prototypes of local functions.              */
 static Boolean_t InitializeModule(void);
 static void CleanupModule(void);
@@ -224,12 +241,21 @@ static void BTPSAPI GATT_ServerEventCallback(unsigned int BluetoothStackID, GATT
    /* between module initialization for Threaded and NonThreaded stacks.*/
 static Boolean_t InitializeModule(void)
 {
-   /* All we need to do is flag that we are initialized.                */
+   /* Flag that we are initialized, clear the instance list and create  */
+   /* the notification buffer pool (the first time only).               */
    if(!InstanceListInitialized)
    {
       InstanceListInitialized = TRUE;
 
       BTPS_MemInitialize(InstanceList, 0, sizeof(InstanceList));
+
+#if HRS_NOTIFICATION_POOL_BLOCKS
+
+      /* Create the notification buffer pool.  If this fails the        */
+      /* notification buffers are simply allocated from the heap.       */
+      NotificationPool = BTPS_CreatePool(HRS_NOTIFICATION_POOL_BLOCK_SIZE, HRS_NOTIFICATION_POOL_BLOCKS, NULL, 0);
+
+#endif
    }
 
    return(TRUE);
@@ -241,6 +267,15 @@ static void CleanupModule(void)
 {
    /* Flag that we are no longer initialized.                           */
    InstanceListInitialized = FALSE;
+
+#if HRS_NOTIFICATION_POOL_BLOCKS
+
+   /* Free the notification buffer pool.                                */
+   BTPS_DeletePool(NotificationPool);
+
+   NotificationPool = NULL;
+
+#endif
 }
 
    /* The following function is used to calculate the maximum number of */
@@ -1311,7 +1346,18 @@ int BTPSAPI HRS_Notify_Heart_Rate_Measurement(unsigned int BluetoothStackID, uns
             /* Allocate a buffer that is big enough to hold the         */
             /* notification.                                            */
             NotificationDataLength = HRS_HEART_RATE_MEASUREMENT_LENGTH(Heart_Rate_Measurement->Flags, Heart_Rate_Measurement->Number_Of_RR_Intervals);
+#if HRS_NOTIFICATION_POOL_BLOCKS
+
+            if((NotificationDataLength > HRS_NOTIFICATION_POOL_BLOCK_SIZE) || ((NotificationData = (Byte_t *)BTPS_AllocateFromPool(NotificationPool)) == NULL))
+               NotificationData = (Byte_t *)BTPS_AllocateMemory(NotificationDataLength);
+
+            if(NotificationData != NULL)
+
+#else
+
             if((NotificationData = BTPS_AllocateMemory(NotificationDataLength)) != NULL)
+
+#endif
             {
                /* Initialize the Notification Data memory.              */
                BTPS_MemInitialize(NotificationData, 0, NotificationDataLength);
@@ -1326,8 +1372,18 @@ int BTPSAPI HRS_Notify_Heart_Rate_Measurement(unsigned int BluetoothStackID, uns
                      ret_val = 0;
                }
 
-               /* Free the previously allocated memory.                 */
+               /* Free the previously allocated memory (returning it to */
+               /* the pool if that is where it came from).              */
+#if HRS_NOTIFICATION_POOL_BLOCKS
+
+               if(!BTPS_FreeToPool(NotificationPool, NotificationData))
+                  BTPS_FreeMemory(NotificationData);
+
+#else
+
                BTPS_FreeMemory(NotificationData);
+
+#endif
             }
             else
                ret_val = HRS_ERROR_INSUFFICIENT_RESOURCES;
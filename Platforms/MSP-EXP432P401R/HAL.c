@@ -51,6 +51,11 @@
 #define MCLK_DIVIDER                1
 #define MCLK_FREQUENCY              (HFXTCLK_FREQUENCY / MCLK_DIVIDER)
 
+   /* The processor cycle counter counts MCLK cycles.                   */
+#if (MCLK_FREQUENCY != HAL_CYCLE_COUNT_FREQUENCY)
+   #error HAL_CYCLE_COUNT_FREQUENCY does not match MCLK_FREQUENCY
+#endif
+
    /* The following constants specify information about HSMCLK.         */
 #define HSMCLK_SOURCE               CS_HFXTCLK_SELECT
 #define HSMCLK_DIVIDER              2
@@ -78,6 +83,24 @@
 #define PRIORITY_HIGH               (0)
 #define PRIORITY_NORMAL             (1 << 5)
 
+   /* The following constants are used to stretch the SysTick period    */
+   /* while the system is idle (tickless idle).  The SysTick counter is */
+   /* 24 bits which limits a single idle period to approximately 349 ms */
+   /* at 48 MHz.                                                        */
+#define SYSTICK_COUNTS_PER_TICK     ((BTPS_TICK_COUNT_INTERVAL * MCLK_FREQUENCY) / 1000)
+#define SYSTICK_MAXIMUM_COUNT       (0x00FFFFFF)
+#define SYSTICK_MAXIMUM_IDLE_TICKS  (SYSTICK_MAXIMUM_COUNT / SYSTICK_COUNTS_PER_TICK)
+
+   /* The following constant represents the minimum number of SysTick   */
+   /* counts that must remain in the current tick for the SysTick period*/
+   /* to be stretched (otherwise the tick is about to expire and the    */
+   /* processor simply waits for it).                                   */
+#define SYSTICK_MINIMUM_REMAINING   (64)
+
+   /* The following constant represents the number of SysTick counts in */
+   /* a Microsecond (used to compute the Timestamp).                    */
+#define SYSTICK_COUNTS_PER_USEC     (MCLK_FREQUENCY / 1000000)
+
    /*********************************************************************/
    /* Local/Static Variables                                            */
    /*********************************************************************/
@@ -89,6 +112,11 @@
    /* Bluetopia No-OS stack.                                            */
 static volatile unsigned long TickCount;
 
+   /* The following variable holds the number of times the system tick  */
+   /* count has wrapped (the upper 32 bits of the tick count) so that   */
+   /* the Timestamp does not wrap.                                      */
+static volatile unsigned long TickCountHigh;
+
    /* The following is used to store characters read from the debug UART*/
    /* into a circular buffer.                                           */
 static volatile unsigned char DebugUARTRxBuffer[DEBUG_UART_RX_BUFFER_SIZE];
@@ -96,6 +124,10 @@ static unsigned int DebugUARTRxInIndex;
 static unsigned int DebugUARTRxOutIndex;
 static volatile unsigned int DebugUARTRxBytesFree = DEBUG_UART_RX_BUFFER_SIZE;
 
+   /* The following variable holds the Event ID that is posted to the   */
+   /* scheduler when a character is read from the debug UART.           */
+static unsigned int DebugUARTRxEventID;
+
    /* The following is used to store characters written to the debug    */
    /* UART into a circular buffer.                                      */
 static volatile unsigned char DebugUARTTxBuffer[DEBUG_UART_TX_BUFFER_SIZE];
@@ -190,6 +222,91 @@ static void ConfigureClocks(void)
    CS_initClockSignal(CS_SMCLK, SMCLK_SOURCE, CONCAT(CS_CLOCK_DIVIDER_,SMCLK_DIVIDER));
 }
 
+   /* The following function is used to enter a low power mode until the*/
+   /* specified number of ticks has elapsed or an interrupt occurs.  The*/
+   /* SysTick interrupt is suppressed while idle and the tick count is  */
+   /* corrected when the processor wakes.                               */
+   /* * NOTE * This function *MUST* be called with interrupts disabled. */
+static void EnterLowPowerMode(unsigned long IdleTicks)
+{
+   uint32_t      Control;
+   uint32_t      Reload;
+   uint32_t      Elapsed;
+   uint32_t      Remaining;
+   unsigned long ElapsedTicks;
+
+   if(IdleTicks)
+   {
+      if(IdleTicks > SYSTICK_MAXIMUM_IDLE_TICKS)
+         IdleTicks = SYSTICK_MAXIMUM_IDLE_TICKS;
+
+      if((IdleTicks > 1) && (SysTick->VAL >= SYSTICK_MINIMUM_REMAINING) && (!(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)))
+      {
+         /* Stop the SysTick timer and note the counts remaining in the */
+         /* current tick.                                               */
+         SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+         Remaining      = SysTick->VAL;
+
+         /* Program a single SysTick period that ends on the tick       */
+         /* boundary at which the idle period ends.                     */
+         Reload        = Remaining + ((IdleTicks - 1) * SYSTICK_COUNTS_PER_TICK);
+         SysTick->LOAD = Reload - 1;
+         SysTick->VAL  = 0;
+         SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+         PCM_gotoLPM0();
+
+         /* Stop the SysTick timer, reading the control register clears */
+         /* the count flag so it is only read once.                     */
+         Control       = SysTick->CTRL;
+         SysTick->CTRL = Control & ~SysTick_CTRL_ENABLE_Msk;
+
+         if(Control & SysTick_CTRL_COUNTFLAG_Msk)
+         {
+            /* The complete period elapsed, the SysTick interrupt is    */
+            /* pending and will count the final tick.                   */
+            ElapsedTicks = IdleTicks - 1;
+            Remaining    = SYSTICK_COUNTS_PER_TICK;
+         }
+         else
+         {
+            /* Another interrupt woke the processor, determine how many */
+            /* complete ticks elapsed and how far into the current tick */
+            /* we are.                                                  */
+            Elapsed = Reload - SysTick->VAL;
+
+            if(Elapsed < Remaining)
+            {
+               ElapsedTicks  = 0;
+               Remaining    -= Elapsed;
+            }
+            else
+            {
+               Elapsed      -= Remaining;
+               ElapsedTicks  = 1 + (Elapsed / SYSTICK_COUNTS_PER_TICK);
+               Remaining     = SYSTICK_COUNTS_PER_TICK - (Elapsed % SYSTICK_COUNTS_PER_TICK);
+            }
+         }
+
+         if((TickCount += ElapsedTicks) < ElapsedTicks)
+            TickCountHigh++;
+
+         /* Restart the SysTick timer for the remainder of the current  */
+         /* tick, the normal period is loaded when this expires.        */
+         SysTick->LOAD  = Remaining - 1;
+         SysTick->VAL   = 0;
+         SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+         SysTick->LOAD  = SYSTICK_COUNTS_PER_TICK - 1;
+      }
+      else
+      {
+         /* The next tick is due (or is about to expire), simply wait   */
+         /* for the SysTick interrupt (or any other interrupt).         */
+         PCM_gotoLPM0();
+      }
+   }
+}
+
    /*********************************************************************/
    /* Global/Non-Static Functions                                       */
    /*********************************************************************/
@@ -201,7 +318,11 @@ void HAL_ConfigureHardware(void)
    /* Hold the Watchdog Timer.                                          */
    WDT_A_holdTimer();
 
-   /* Disable interrupts.                                               */
+   /* Disable interrupts.  Note that the kernel critical section        */
+   /* functions are not used here (or to enable interrupts below) as the*/
+   /* interrupt callbacks have not been registered with the kernel yet, */
+   /* and interrupts are enabled for the first time rather than restored*/
+   /* to a previous state.                                              */
    Interrupt_disableMaster();
 
    /* Configure the clocks.                                             */
@@ -213,6 +334,12 @@ void HAL_ConfigureHardware(void)
    SysTick_enableInterrupt();
    Interrupt_setPriority(FAULT_SYSTICK, PRIORITY_NORMAL);
 
+   /* Start the DWT cycle counter, which is used to profile the         */
+   /* Scheduler.                                                        */
+   CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+   DWT->CYCCNT       = 0;
+   DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
    /* Configure the nSHUT pin, drive it low to put the radio into reset.*/
    GPIO_setOutputLowOnPin(HRDWCFG_NSHUTD_PORT_NUM, HRDWCFG_NSHUTD_PIN_NUM);
    GPIO_setAsOutputPin(HRDWCFG_NSHUTD_PORT_NUM, HRDWCFG_NSHUTD_PIN_NUM);
@@ -339,8 +466,11 @@ void HAL_DisableController(void)
 
    if(!SysInit)
    {
-      /* The system is not initializing, we can use BTPS_Delay().       */
-      BTPS_Delay(CONTROLLER_MINIMUM_NSHUTD_LOW_TIME);
+      /* The system is not initializing, the cycle counter has been     */
+      /* registered with the kernel so BTPS_DelayMicroseconds() can be  */
+      /* used.  This busy waits, so it does not depend on the SysTick   */
+      /* interrupt and is also correct with interrupts disabled.        */
+      BTPS_DelayMicroseconds(CONTROLLER_MINIMUM_NSHUTD_LOW_TIME * 1000);
    }
    else
    {
@@ -397,6 +527,7 @@ int HAL_ConsoleRead(unsigned int Length, char *Buffer)
    int CopyLength;
    int MaxRead;
    int Count;
+   unsigned long InterruptState;
 
    /* Make sure the passed in parameters seem valid.                    */
    if((Buffer) && (Length))
@@ -428,24 +559,35 @@ int HAL_ConsoleRead(unsigned int Length, char *Buffer)
             DebugUARTRxOutIndex = 0;
 
          /* The Rx bytes free variable is changed in an interrupt so we */
-         /* must disable the UART interrupt before reading and writing  */
-         /* to it.                                                      */
-         Interrupt_disableInterrupt(HRDWCFG_DEBUG_UART_INT_NUM);
+         /* must enter a critical section before reading and writing to */
+         /* it.                                                         */
+         InterruptState        = BTPS_EnterCriticalSection();
          DebugUARTRxBytesFree += CopyLength;
-         Interrupt_enableInterrupt(HRDWCFG_DEBUG_UART_INT_NUM);
+         BTPS_LeaveCriticalSection(InterruptState);
       }
    }
 
    return(Processed);
 }
 
+   /* The following function is used to register the event (returned    */
+   /* from BTPS_RegisterEventHandler()) that is posted each time a      */
+   /* character is received from the debug UART.  This allows the       */
+   /* console to be processed as soon as input arrives instead of       */
+   /* waiting for a periodic task.  Passing zero removes the event.     */
+void HAL_RegisterConsoleEvent(unsigned int EventID)
+{
+   DebugUARTRxEventID = EventID;
+}
+
    /* The following function is used to send data to the UART output    */
    /* queue.  The function receives a pointer to a buffer that will     */
    /* contains the data to send and the length of the data.             */
 void HAL_ConsoleWrite(unsigned int Length, char *String)
 {
-   unsigned int Count;
-   unsigned int TempDebugUARTTxBytesFree;
+   unsigned int  Count;
+   unsigned int  TempDebugUARTTxBytesFree;
+   unsigned long InterruptState;
 
    /* First make sure the parameters seem semi valid.                   */
    if((Length) && (String))
@@ -477,11 +619,11 @@ void HAL_ConsoleWrite(unsigned int Length, char *String)
          /* Copy as much data as we can.                                */
          BTPS_MemCopy((void *)&DebugUARTTxBuffer[DebugUARTTxInIndex], String, Count);
 
-         /* Adjust the number of free bytes, disable the UART interrupt */
+         /* Adjust the number of free bytes, enter a critical section   */
          /* because the variable is also modified in the UART ISR.      */
-         Interrupt_disableInterrupt(HRDWCFG_DEBUG_UART_INT_NUM);
+         InterruptState        = BTPS_EnterCriticalSection();
          DebugUARTTxBytesFree -= Count;
-         Interrupt_enableInterrupt(HRDWCFG_DEBUG_UART_INT_NUM);
+         BTPS_LeaveCriticalSection(InterruptState);
 
          /* Enable the transmit interrupt.  Note that this will have no */
          /* effect if the interrupt is already enabled, nor will it     */
@@ -507,6 +649,160 @@ unsigned long HAL_GetTickCount(void)
    return(TickCount);
 }
 
+   /* The following function is used to read the processor cycle        */
+   /* counter.                                                          */
+unsigned long HAL_GetCycleCount(void)
+{
+   return(DWT->CYCCNT);
+}
+
+   /* The following function is used to read the Timestamp (a 64 bit    */
+   /* monotonic time in microseconds).  The Timestamp is computed from  */
+   /* the tick count and the position of the SysTick counter within the */
+   /* current tick.                                                     */
+uint64_t HAL_GetTimestamp(void)
+{
+   uint32_t      Counts;
+   unsigned long TickCountLow;
+   unsigned long TickCountUpper;
+   unsigned long InterruptState;
+
+   /* Disable interrupts so that the tick count and the SysTick counter */
+   /* are read consistently.                                            */
+   InterruptState     = BTPS_EnterCriticalSection();
+
+   TickCountLow       = TickCount;
+   TickCountUpper     = TickCountHigh;
+   Counts             = SysTick->VAL;
+
+   /* If the SysTick counter has reloaded but the SysTick interrupt has */
+   /* not been serviced (interrupts are disabled), the tick has not yet */
+   /* been counted.  Re-read the counter as it may have reloaded after  */
+   /* it was read above.                                                */
+   if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+   {
+      Counts = SysTick->VAL;
+
+      if(++TickCountLow == 0)
+         TickCountUpper++;
+   }
+
+   BTPS_LeaveCriticalSection(InterruptState);
+
+   /* Note that the counter counts down from the end of the tick.       */
+   return(((((uint64_t)TickCountUpper << 32) + TickCountLow) * (BTPS_TICK_COUNT_INTERVAL * 1000)) + ((SYSTICK_COUNTS_PER_TICK - 1 - Counts) / SYSTICK_COUNTS_PER_USEC));
+}
+
+   /* The following function is used to disable interrupts.  The        */
+   /* function returns the previous interrupt state (the PRIMASK        */
+   /* register) which is to be passed to HAL_RestoreInterrupts().       */
+   /* * NOTE * The compiler intrinsics are used rather than the MSPWare */
+   /*          functions to keep the time that interrupts are disabled  */
+   /*          as short as possible.                                    */
+unsigned long HAL_DisableInterrupts(void)
+{
+   unsigned long ret_val;
+
+   ret_val = (unsigned long)__get_PRIMASK();
+
+   __disable_irq();
+
+   return(ret_val);
+}
+
+   /* The following function is used to restore the interrupt state that*/
+   /* was returned by HAL_DisableInterrupts().                          */
+void HAL_RestoreInterrupts(unsigned long InterruptState)
+{
+   __set_PRIMASK((uint32_t)InterruptState);
+}
+
+   /* The following function is used to determine the lowest address of */
+   /* the main stack (which is HAL_STACK_SIZE bytes long).              */
+   /* * NOTE * The top of the stack is the initial stack pointer, which */
+   /*          is the first entry of the vector table, so this does not */
+   /*          depend on the symbols of any specific toolchain.         */
+void *HAL_GetStackBase(void)
+{
+   return((void *)(((uint32_t *)SCB->VTOR)[0] - HAL_STACK_SIZE));
+}
+
+   /* The following function is used to enter a low power mode until the*/
+   /* specified number of ticks has elapsed or an interrupt occurs.  The*/
+   /* SysTick interrupt is suppressed while idle and the tick count is  */
+   /* corrected when the processor wakes.                               */
+   /* * NOTE * Interrupts are disabled while entering the low power mode*/
+   /*          so that an interrupt that occurs after the Scheduler     */
+   /*          determined the timeout still wakes the processor (the    */
+   /*          interrupt remains pending and is serviced on return).    */
+   /*          The previous interrupt state is restored on return, so   */
+   /*          interrupts are not enabled if the caller had disabled    */
+   /*          them.                                                    */
+void HAL_Idle(unsigned long Timeout)
+{
+   unsigned long IdleTicks;
+   unsigned long InterruptState;
+
+   InterruptState = HAL_DisableInterrupts();
+
+   /* Re-check the timeout now that interrupts are disabled.            */
+   if((IdleTicks = BTPS_QuerySchedulerTimeout()) > Timeout)
+      IdleTicks = Timeout;
+
+   EnterLowPowerMode(IdleTicks);
+
+   HAL_RestoreInterrupts(InterruptState);
+}
+
+   /* The following function is used to enter a low power mode until the*/
+   /* specified number of ticks has elapsed or an interrupt occurs.     */
+   /* Unlike HAL_Idle() the timeout is not limited by the Scheduler (the*/
+   /* Scheduler is not running while the caller is delayed).            */
+   /* * NOTE * This function is reached through BTPS_Delay(), which can */
+   /*          be called with interrupts disabled (for example from     */
+   /*          within a critical section), so the previous interrupt    */
+   /*          state is restored rather than enabling interrupts.       */
+void HAL_Sleep(unsigned long Timeout)
+{
+   unsigned long InterruptState;
+
+   InterruptState = HAL_DisableInterrupts();
+
+   EnterLowPowerMode(Timeout);
+
+   HAL_RestoreInterrupts(InterruptState);
+}
+
+   /* The following function is used to register the HAL functions that */
+   /* the Bluetopia kernel uses for its critical sections, low power    */
+   /* modes, cycle counter and Timestamps.                              */
+   /* * NOTE * This function must be called after                       */
+   /*          HAL_ConfigureHardware() (which starts the SysTick timer  */
+   /*          and the cycle counter) and before the Bluetooth Stack is */
+   /*          initialized (so that the critical sections of the HCI    */
+   /*          transport disable interrupts).                           */
+void HAL_RegisterKernelCallbacks(void)
+{
+   /* Critical sections (including those of the HCI transport) disable  */
+   /* interrupts with the PRIMASK register.                             */
+   BTPS_RegisterInterruptCallbacks(HAL_DisableInterrupts, HAL_RestoreInterrupts);
+
+   /* Let the processor enter a low power mode (without the SysTick     */
+   /* interrupt) whenever no scheduled function is due.                 */
+   BTPS_RegisterIdleCallback(HAL_Idle);
+
+   /* Let BTPS_Delay() sleep (rather than busy wait) for the duration of*/
+   /* the delay.                                                        */
+   BTPS_RegisterSleepCallback(HAL_Sleep);
+
+   /* Measure the time spent in each task (and short delays) with the   */
+   /* processor cycle counter.                                          */
+   BTPS_RegisterCycleCounter(HAL_GetCycleCount, HAL_CYCLE_COUNT_FREQUENCY);
+
+   /* Provide Microsecond Timestamps from the SysTick timer.            */
+   BTPS_RegisterTimestampCallback(HAL_GetTimestamp);
+}
+
    /* The following function is used to set the color of the LED.       */
 void HAL_SetLEDColor(HAL_LED_Color_t LEDColor)
 {
@@ -653,7 +949,8 @@ void HAL_DisableAudioCodec(void)
    /* SysTick interrupt handler.  This handler toggles RGB LED on/off.  */
 void SysTick_ISR(void)
 {
-   TickCount += 1;
+   if(++TickCount == 0)
+      TickCountHigh++;
 }
 
    /* Debug UART Interrupt Handler.                                     */
@@ -681,6 +978,9 @@ void Debug_UART_eUSCI_A_ISR(void)
          /* Wrap the buffer if necessary.                               */
          if(DebugUARTRxInIndex >= DEBUG_UART_RX_BUFFER_SIZE)
             DebugUARTRxInIndex = 0;
+
+         /* Signal the scheduler that console input is ready.           */
+         BTPS_PostEventFromISR(DebugUARTRxEventID);
       }
    }
    else
@@ -28,6 +28,22 @@
    /* currently supported by this platform.                             */
 #define HAL_HCI_UART_MAX_BAUD_RATE      2000000
 
+   /* The following constant specifies the frequency (in counts per     */
+   /* second) of the processor cycle counter (see HAL_GetCycleCount()). */
+#define HAL_CYCLE_COUNT_FREQUENCY       48000000
+
+   /* The following constant specifies the size (in bytes) of the main  */
+   /* stack (see HAL_GetStackBase()).  This must match the stack size of*/
+   /* the startup code (SYSTEM_STACK_SIZE) or of the linker options when*/
+   /* building with CCS.                                                */
+#ifndef HAL_STACK_SIZE
+   #ifdef SYSTEM_STACK_SIZE
+      #define HAL_STACK_SIZE            SYSTEM_STACK_SIZE
+   #else
+      #define HAL_STACK_SIZE            4000
+   #endif
+#endif
+
    /* The following enumerated type defines the possible audio use      */
    /* cases.                                                            */
 typedef enum
@@ -80,6 +96,12 @@ void HAL_EnableController(void);
    /* in Buffer.                                                        */
 int HAL_ConsoleRead(unsigned int Length, char *Buffer);
 
+   /* The following function is used to register the event (returned    */
+   /* from BTPS_RegisterEventHandler()) that is posted each time a      */
+   /* character is received from the console.  Passing zero removes the */
+   /* event.                                                            */
+void HAL_RegisterConsoleEvent(unsigned int EventID);
+
    /* The following function is used to send data to the UART output    */
    /* queue.  The function receives a pointer to a buffer that will     */
    /* contains the data to send and the length of the data.             */
@@ -88,6 +110,57 @@ void HAL_ConsoleWrite(unsigned int Length, char *Buffer);
    /* This function is called to get the system tick count.             */
 unsigned long HAL_GetTickCount(void);
 
+   /* The following function is used to read the processor cycle        */
+   /* counter (which counts at HAL_CYCLE_COUNT_FREQUENCY).  This        */
+   /* function is intended to be registered with                        */
+   /* BTPS_RegisterCycleCounter().                                      */
+unsigned long HAL_GetCycleCount(void);
+
+   /* The following function is used to read the Timestamp (a 64 bit    */
+   /* monotonic time in microseconds).  This function is intended to be */
+   /* registered with BTPS_RegisterTimestampCallback().                 */
+uint64_t HAL_GetTimestamp(void);
+
+   /* The following function is used to disable interrupts.  The        */
+   /* function returns the previous interrupt state (the PRIMASK        */
+   /* register) which is to be passed to HAL_RestoreInterrupts().  This */
+   /* function is intended to be registered with                        */
+   /* BTPS_RegisterInterruptCallbacks().                                */
+unsigned long HAL_DisableInterrupts(void);
+
+   /* The following function is used to restore the interrupt state that*/
+   /* was returned by HAL_DisableInterrupts().  This function is        */
+   /* intended to be registered with BTPS_RegisterInterruptCallbacks(). */
+void HAL_RestoreInterrupts(unsigned long InterruptState);
+
+   /* The following function is used to determine the lowest address of */
+   /* the main stack (which is HAL_STACK_SIZE bytes long).  This        */
+   /* function is intended to be used with BTPS_RegisterStack().        */
+void *HAL_GetStackBase(void);
+
+   /* The following function is used to enter a low power mode until the*/
+   /* specified number of ticks has elapsed or an interrupt occurs.  The*/
+   /* SysTick interrupt is suppressed while idle and the tick count is  */
+   /* corrected when the processor wakes.  This function is intended to */
+   /* be registered with BTPS_RegisterIdleCallback().                   */
+void HAL_Idle(unsigned long Timeout);
+
+   /* The following function is used to enter a low power mode until the*/
+   /* specified number of ticks has elapsed or an interrupt occurs      */
+   /* (regardless of the Scheduler).  This function is intended to be   */
+   /* registered with BTPS_RegisterSleepCallback() so that BTPS_Delay() */
+   /* does not busy wait.                                               */
+void HAL_Sleep(unsigned long Timeout);
+
+   /* The following function is used to register the HAL functions that */
+   /* the Bluetopia kernel uses for its critical sections, low power    */
+   /* modes, cycle counter and Timestamps (HAL_DisableInterrupts(),     */
+   /* HAL_RestoreInterrupts(), HAL_Idle(), HAL_Sleep(),                 */
+   /* HAL_GetCycleCount() and HAL_GetTimestamp()).  This function must  */
+   /* be called after HAL_ConfigureHardware() and before the Bluetooth  */
+   /* Stack is initialized.                                             */
+void HAL_RegisterKernelCallbacks(void);
+
    /* The following function is used to set the color of the LED.       */
 void HAL_SetLEDColor(HAL_LED_Color_t LEDColor);
 
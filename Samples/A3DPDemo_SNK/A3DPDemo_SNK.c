@@ -432,6 +432,7 @@ static int SendRemoteControlCommand(RemoteControlCommand_t Command);
 static void RemoteControlCommandAsync(unsigned int BluetoothStackID, unsigned long CallbackParameter);
 static int QueueRemoteControlCommand(BD_ADDR_t BD_ADDR, RemoteControlCommand_t Command);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 
 
 static int Inquiry(ParameterList_t *TempParam);
@@ -504,6 +505,7 @@ static void UserInterface(void)
    AddCommand("REMOTEPREV", RemotePrev);
    AddCommand("PCMLOOPBACK", PcmLoopback);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 
    /* Next display the available commands.                              */
    DisplayHelp(NULL);
@@ -1872,6 +1874,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
    /* The following function is used to send the specified remote       */
    /* control to the currently connected remote control device.         */
 static int SendRemoteControlCommand(RemoteControlCommand_t Command)
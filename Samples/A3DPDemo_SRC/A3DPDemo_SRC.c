@@ -400,6 +400,7 @@ static void FormatEIRData(unsigned int BluetoothStackID, BD_ADDR_t BD_ADDR);
 static int Initialize_Source(void);
 
 static int DisplayHelp(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 
 static int Inquiry(ParameterList_t *TempParam);
 static int DisplayInquiryList(ParameterList_t *TempParam);
@@ -467,6 +468,7 @@ static void UserInterface(void)
    AddCommand("GETREMOTENAME", GetRemoteName);
    AddCommand("SETBAUDRATE", SetBaudRate);
    AddCommand("HELP", DisplayHelp);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
    AddCommand("OPENSINK", OpenRemoteEndpoint);
    AddCommand("CLOSESINK", CloseRemoteEndpoint);
    AddCommand("PLAY", Play);
@@ -1675,6 +1677,22 @@ static int DisplayHelp(ParameterList_t *TempParam)
    Display(("*                  Pause, Help                                   *\r\n"));
    Display(("******************************************************************\r\n"));
 
+   return(0);
+}
+
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
    return(0);
 }
 
@@ -441,6 +441,7 @@ static void DisplayFWVersion (void);
    /* Generic Function Commands                                         */
 static int DisplayHelp(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 static int SetBaudRate(ParameterList_t *TempParam);
 
    /* Generic Helper Functions                                          */
@@ -635,6 +636,7 @@ static void UserInterface(void)
 
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* The following function is responsible for parsing user input      */
@@ -1276,6 +1278,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
 
    /* This function displays the usage of DisplayConnectLEUsage command */
 static void DisplayConnectLEUsage(char *CharacteristicName)
@@ -28,7 +28,7 @@
 #include "HAL.h"
 #include "BTVSAPI.h"
 
-#define MAX_SUPPORTED_COMMANDS                     (36)  /* Denotes the       */
+#define MAX_SUPPORTED_COMMANDS                     (37)  /* Denotes the       */
                                                          /* maximum number of */
                                                          /* User Commands that*/
                                                          /* are supported by  */
@@ -456,6 +456,7 @@ static int GetClassOfDevice(ParameterList_t *TempParam);
 static int GetRemoteName(ParameterList_t *TempParam);
 
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 
 static int OpenRemoteHandsFreePort(ParameterList_t *TempParam);
 static int CloseClient(ParameterList_t *TempParam);
@@ -534,6 +535,7 @@ static void UserInterface(void)
    AddCommand("SENDSUBNUMBER", SendSubscriberNumber);
    AddCommand("SENDCALLLIST", SendCallEntryCommand);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
    AddCommand("HELP", DisplayHelp);
 }
 
@@ -4013,6 +4015,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
    /* The following function is responsible for setting up              */
    /* an audio connection.  This function returns zero on successful    */
    /* execution and a negative value on all errors.                     */
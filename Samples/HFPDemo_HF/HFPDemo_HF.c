@@ -445,6 +445,7 @@ static int HoldingMultiPhonesCall(ParameterList_t *TempParam);
 static int SwitchAudioFor2PhonesWithActiveCall(ParameterList_t *TempParam);
 static int AnswerSeconePhoneIncomingCallAndSwitchAudio(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 
    /* Callback Function Prototypes.                                     */
 static void BTPSAPI GAP_Event_Callback(unsigned int BluetoothStackID, GAP_Event_Data_t *GAPEventData, unsigned long CallbackParameter);
@@ -491,6 +492,7 @@ static void UserInterface(void)
    AddCommand("HANGUPCALL", HangUpCall);
    AddCommand("QUERYACTIVECONNECTIONS", QueryActiveConnections);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
    AddCommand("PCMLOOPBACK", PcmLoopback);
    AddCommand("HELP", DisplayHelp);
 }
@@ -1051,6 +1053,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
    /* The following function is responsible for querying all portIDs    */
    /* that are in active connection. This function will return zero     */
    /* on successful execution and a negative value on errors.           */
@@ -338,6 +338,7 @@ static void DisplayFWVersion(void);
 
 static int DisplayHelp(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 
 static int InitializeHIDHost(void);
 static int InitializeHIDDevice(void);
@@ -524,6 +525,7 @@ static void PopulateHIDHostCommandTable(void)
    AddCommand("DATAWRITE", HIDDataWrite);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* The following function Clears all commands currently in the       */
@@ -565,6 +567,7 @@ static void PopulateHIDDeviceCommandTable(void)
    AddCommand("DATAWRITE", HIDDataWrite);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* This function is responsible for taking the users input and do the*/
@@ -1157,6 +1160,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
 
    /* The following function is responsible for setting the initial     */
    /* state of the Main Application to be a HID Device.  This function  */
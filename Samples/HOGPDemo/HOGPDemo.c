@@ -504,6 +504,7 @@ static int EncryptionInformationRequestResponse(unsigned int BluetoothStackID, B
 
 static int DisplayHelp(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 static int SetLEDiscoverabilityMode(ParameterList_t *TempParam);
 static int SetLEConnectabilityMode(ParameterList_t *TempParam);
 static int SetLEPairabilityMode(ParameterList_t *TempParam);
@@ -724,6 +725,7 @@ static void UserInterface_Device(void)
    AddCommand("NOTIFYBATTERYLEVEL", NotifyBatteryLevel);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 
    DisplayPrompt();
 }
@@ -1324,6 +1326,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
 
    /* The following function is a utility function that is used to      */
    /* configure the Device Information Service that is registered by    */
@@ -214,6 +214,11 @@ typedef struct _tagDeviceInfo_t
 
 #define DEVICE_INFO_DATA_SIZE                            (sizeof(DeviceInfo_t))
 
+   /* The following defines the number of DeviceInfo_t entries that are */
+   /* allocated from a fixed size Memory Pool (rather than the heap).   */
+   /* Any entries beyond this number are allocated from the heap.       */
+#define DEVICE_INFO_POOL_ENTRIES                         4
+
    /* Defines the bit mask flags that may be set in the DeviceInfo_t    */
    /* structure.                                                        */
 #define DEVICE_INFO_FLAGS_LTK_VALID                         0x01
@@ -275,6 +280,14 @@ static GAPLE_Parameters_t  LE_Parameters;           /* Holds GAP Parameters like
 static DeviceInfo_t       *DeviceInfoList;          /* Holds the list head for the     */
                                                     /* device info list.               */
 
+static Pool_t              DeviceInfoPool;          /* Holds the Memory Pool that the  */
+                                                    /* device info entries are         */
+                                                    /* allocated from.                 */
+
+   /* The following holds the memory for the device info Memory Pool    */
+   /* blocks.                                                           */
+static void               *DeviceInfoPoolMemory[BTPS_POOL_MEMORY_SIZE(DEVICE_INFO_DATA_SIZE, DEVICE_INFO_POOL_ENTRIES) / sizeof(void *)];
+
 static unsigned int        BluetoothStackID;        /* Variable which holds the Handle */
                                                     /* of the opened Bluetooth Protocol*/
                                                     /* Stack.                          */
@@ -451,6 +464,7 @@ static void DisplayFWVersion (void);
    /* Generic Function Commands                                         */
 static int DisplayHelp(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 static int SetBaudRate(ParameterList_t *TempParam);
 
    /* Generic Helper Functions                                          */
@@ -544,8 +558,12 @@ static Boolean_t CreateNewDeviceInfoEntry(DeviceInfo_t **ListHead, GAP_LE_Addres
    /* Verify that the passed in parameters seem semi-valid.             */
    if((ListHead) && (!COMPARE_NULL_BD_ADDR(ConnectionBD_ADDR)))
    {
-      /* Allocate the memory for the entry.                             */
-      if((DeviceInfoPtr = BTPS_AllocateMemory(sizeof(DeviceInfo_t))) != NULL)
+      /* Allocate the memory for the entry (from the pool if there is   */
+      /* a free entry, otherwise from the heap).                        */
+      if((DeviceInfoPtr = BTPS_AllocateFromPool(DeviceInfoPool)) == NULL)
+         DeviceInfoPtr = BTPS_AllocateMemory(sizeof(DeviceInfo_t));
+
+      if(DeviceInfoPtr != NULL)
       {
          /* Initialize the entry.                                       */
          BTPS_MemInitialize(DeviceInfoPtr, 0, sizeof(DeviceInfo_t));
@@ -557,7 +575,7 @@ static Boolean_t CreateNewDeviceInfoEntry(DeviceInfo_t **ListHead, GAP_LE_Addres
          {
             /* Failed to add to list so we should free the memory that  */
             /* we allocated for the entry.                              */
-            BTPS_FreeMemory(DeviceInfoPtr);
+            FreeDeviceInfoEntryMemory(DeviceInfoPtr);
          }
       }
    }
@@ -590,7 +608,10 @@ static DeviceInfo_t *DeleteDeviceInfoEntry(DeviceInfo_t **ListHead, BD_ADDR_t BD
    /* memory.                                                           */
 static void FreeDeviceInfoEntryMemory(DeviceInfo_t *EntryToFree)
 {
-   BSC_FreeGenericListEntryMemory((void *)(EntryToFree));
+   /* Entries that did not come from the pool were allocated from the   */
+   /* heap.                                                             */
+   if(!BTPS_FreeToPool(DeviceInfoPool, (void *)(EntryToFree)))
+      BSC_FreeGenericListEntryMemory((void *)(EntryToFree));
 }
 
    /* The following function deletes (and frees all memory) every       */
@@ -598,7 +619,19 @@ static void FreeDeviceInfoEntryMemory(DeviceInfo_t *EntryToFree)
    /* function, the Head Pointer is set to NULL.                        */
 static void FreeDeviceInfoList(DeviceInfo_t **ListHead)
 {
-   BSC_FreeGenericListEntryList((void **)(ListHead), BTPS_STRUCTURE_OFFSET(DeviceInfo_t, NextDeviceInfoPtr));
+   DeviceInfo_t *EntryToFree;
+
+   /* Walk the list (rather than using BSC_FreeGenericListEntryList())  */
+   /* as some entries may have been allocated from the pool.            */
+   if(ListHead)
+   {
+      while((EntryToFree = *ListHead) != NULL)
+      {
+         *ListHead = EntryToFree->NextDeviceInfoPtr;
+
+         FreeDeviceInfoEntryMemory(EntryToFree);
+      }
+   }
 }
 
    /* This function is responsible for taking the input from the user   */
@@ -644,6 +677,7 @@ static void UserInterface(void)
    AddCommand("RESETENERGYEXPENDED", ResetEnergyExpended);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* The following function is responsible for parsing user input      */
@@ -1278,6 +1312,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
 
    /* This function displays the usage of DisplayConnectLEUsage command */
 static void DisplayConnectLEUsage(char *CharacteristicName)
@@ -1391,6 +1441,10 @@ static int OpenStack(HCI_DriverInformation_t *HCI_DriverInformation, BTPS_Initia
             /* Flag that we have no Key Information in the Key List.    */
             DeviceInfoList = NULL;
 
+            /* Create the Memory Pool for the Key List entries.  If this*/
+            /* fails the entries are simply allocated from the heap.    */
+            DeviceInfoPool = BTPS_CreatePool(DEVICE_INFO_DATA_SIZE, DEVICE_INFO_POOL_ENTRIES, DeviceInfoPoolMemory, sizeof(DeviceInfoPoolMemory));
+
             /* Initialize the GATT Service.                             */
             if((Result = GATT_Initialize(BluetoothStackID, GATT_INITIALIZATION_FLAGS_SUPPORT_LE, GATT_Connection_Event_Callback, 0)) == 0)
             {
@@ -1520,6 +1574,11 @@ static int CloseStack(void)
       /* Free the Key List.                                             */
       FreeDeviceInfoList(&DeviceInfoList);
 
+      /* Free the Key List Memory Pool.                                 */
+      BTPS_DeletePool(DeviceInfoPool);
+
+      DeviceInfoPool   = NULL;
+
       /* Flag that the Stack is no longer initialized.                  */
       BluetoothStackID = 0;
 
@@ -437,6 +437,7 @@ static void DisplaySDPAttributeResponse(SDP_Service_Attribute_Response_Data_t *S
 static void DisplaySDPSearchAttributeResponse(SDP_Service_Search_Attribute_Response_Data_t *SDPServiceSearchAttributeResponse);
 static void DisplayDataElement(SDP_Data_Element_t *SDPDataElement, unsigned int Level);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 
 
    /* Callback Function Prototypes.                                     */
@@ -484,6 +485,7 @@ static void UserInterface_Server(void)
    AddCommand("CHANGEMICROPHONEGAIN", ChangeMicrophoneGain);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
 static void UserInterface_Client(void)
@@ -522,6 +524,7 @@ static void UserInterface_Client(void)
     AddCommand("MANAGEAUDIO", ManageAudioConnection);
     AddCommand("HELP", DisplayHelp);
     AddCommand("QUERYMEMORY", QueryMemory);
+    AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
 
@@ -538,6 +541,7 @@ static void UserInterface_Selection(void)
     AddCommand("AUDIOGATEWAY", AudioGatewayMode);
     AddCommand("HELP", DisplayHelp);
     AddCommand("QUERYMEMORY", QueryMemory);
+    AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* The following function is responsible for parsing user input      */
@@ -1041,6 +1045,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
    /* The following function is responsible for opening the SS1         */
    /* Bluetooth Protocol Stack.  This function accepts a pre-populated  */
    /* HCI Driver Information structure that contains the HCI Driver     */
@@ -457,6 +457,7 @@ static int DeleteLinkKey(BD_ADDR_t BD_ADDR);
 
 static int DisplayHelp(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 static int Inquiry(ParameterList_t *TempParam);
 static int DisplayInquiryList(ParameterList_t *TempParam);
 static int SetDiscoverabilityMode(ParameterList_t *TempParam);
@@ -571,6 +572,7 @@ static void UserInterface_Client(void)
 
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
    /* Go ahead and make sure that the input command parser buffer is    */
    /* fully empty.                                                      */
    BTPS_MemInitialize(Input, 0, sizeof(Input));
@@ -616,6 +618,7 @@ static void UserInterface_Server(void)
    AddCommand("SETBAUDRATE", SetBaudRate);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 
    /* Go ahead and make sure that the input command parser buffer is    */
    /* fully empty.                                                      */
@@ -1161,6 +1164,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
    /* The following function is responsible for opening the SS1         */
    /* Bluetooth Protocol Stack.  This function accepts a pre-populated  */
    /* HCI Driver Information structure that contains the HCI Driver     */
@@ -769,6 +769,7 @@ static int DeleteLinkKey(BD_ADDR_t BD_ADDR);
 
 static int DisplayHelp(ParameterList_t *TempParam);
 static int QueryMemory(ParameterList_t *TempParam);
+static int QueryScheduler(ParameterList_t *TempParam);
 static int SetLEDiscoverabilityMode(ParameterList_t *TempParam);
 static int SetLEConnectabilityMode(ParameterList_t *TempParam);
 static int SetLEPairabilityMode(ParameterList_t *TempParam);
@@ -1001,6 +1002,7 @@ static void UserInterface_Client(void)
    AddCommand("LEREAD", ReadDataCommand);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* This function is responsible for taking the input from the user   */
@@ -1076,6 +1078,7 @@ static void UserInterface_Server(void)
    AddCommand("LEREAD", ReadDataCommand);
    AddCommand("HELP", DisplayHelp);
    AddCommand("QUERYMEMORY", QueryMemory);
+   AddCommand("QUERYSCHEDULER", QueryScheduler);
 }
 
    /* The following function is responsible for choosing the user       */
@@ -1743,6 +1746,22 @@ static int QueryMemory(ParameterList_t *TempParam)
    return(ret_val);
 }
 
+   /* The following function is responsible for displaying the CPU load */
+   /* and the tasks that have used the most processor time (when the    */
+   /* Bluetopia kernel is built with SCHEDULER_PROFILE_ENABLED defined).*/
+   /* If a non-zero parameter is specified the statistics are reset     */
+   /* after they are displayed.  This function returns zero.            */
+static int QueryScheduler(ParameterList_t *TempParam)
+{
+   BTPS_DumpSchedulerStatistics(8);
+
+   /* Start a new measurement if requested.                             */
+   if((TempParam) && (TempParam->NumberofParameters > 0) && (TempParam->Params[0].intParam))
+      BTPS_ResetSchedulerStatistics();
+
+   return(0);
+}
+
 
    /* This function displays the usage of DisplayConnectLEUsage command */
 static void DisplayConnectLEUsage(char *CharacteristicName)
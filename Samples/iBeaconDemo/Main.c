@@ -230,6 +230,10 @@ int main(void)
    HCI_HCILLConfiguration_t      HCILLConfig;
    HCI_Driver_Reconfigure_Data_t DriverReconfigureData;
 
+   /* Paint the main stack first so that all of its usage can be        */
+   /* measured (see BTPS_QueryStackUsage()).                            */
+   BTPS_RegisterStack(HAL_GetStackBase(), HAL_STACK_SIZE);
+
    /* Configure the hardware for its intended use.                      */
    HAL_ConfigureHardware();
 
@@ -243,6 +247,10 @@ int main(void)
    BTPS_Initialization.GetTickCountCallback  = HAL_GetTickCount;
    BTPS_Initialization.MessageOutputCallback = HAL_ConsoleWrite;
 
+   /* Register the HAL functions that the kernel uses for its critical  */
+   /* sections, low power modes, cycle counter and Timestamps.          */
+   HAL_RegisterKernelCallbacks();
+
    /* Initialize the application.                                       */
    if((Result = InitializeApplication(&HCI_DriverInformation, &BTPS_Initialization)) > 0)
    {
@@ -270,15 +278,21 @@ int main(void)
          }
       }
 
+      /* Process console input as soon as it is received.  The periodic */
+      /* task below still processes any input that remains after a      */
+      /* complete command line has been handled.                        */
+      HAL_RegisterConsoleEvent(BTPS_RegisterEventHandler(ProcessCharactersTask, NULL));
+
       /* We need to execute Add a function to process the command line  */
-      /* to the BTPS Scheduler.                                         */
-      if(BTPS_AddFunctionToScheduler(ProcessCharactersTask, NULL, 100))
+      /* to the BTPS Scheduler.  The application tasks are added at low */
+      /* priority so that they never delay the processing of the stack. */
+      if(BTPS_AddFunctionToSchedulerWithPriority(ProcessCharactersTask, NULL, 100, BTPS_SCHEDULER_PRIORITY_LOW))
       {
          /* Add the idle task (which determines if LPM3 may be entered) */
          /* to the scheduler.                                           */
-         if(BTPS_AddFunctionToScheduler(IdleTask, NULL, 100))
+         if(BTPS_AddFunctionToSchedulerWithPriority(IdleTask, NULL, 100, BTPS_SCHEDULER_PRIORITY_LOW))
          {
-            if(BTPS_AddFunctionToScheduler(ToggleLEDTask, NULL, 750))
+            if(BTPS_AddFunctionToSchedulerWithPriority(ToggleLEDTask, NULL, 750, BTPS_SCHEDULER_PRIORITY_LOW))
             {
                HAL_SetLEDColor(hlcGreen);
 